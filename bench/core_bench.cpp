@@ -0,0 +1,252 @@
+#include <benchmark/benchmark.h>
+#include "core/alu.hpp"
+#include "core/arena.hpp"
+#include "core/bitvec.hpp"
+#include "core/f32.hpp"
+#include "core/mdu.hpp"
+#include "core/shifter.hpp"
+#include "core/twos.hpp"
+#include <cstdint>
+#include <vector>
+
+using namespace rv::core;
+
+/***** core_bench *****
+ *   ns/op baseline for the numeric core
+ *   - Each op cycles through a fixed table of operands so the compiler
+ *     can't fold the call away
+ *   - "Bits" benches call the bit-vector API (what the tests use),
+ *     "U32" benches call the packed-word paths where they exist
+ *   - Build with -DCMAKE_BUILD_TYPE=Release for numbers worth comparing
+ ******************************/
+
+namespace {
+
+    constexpr std::size_t kOperands = 64;
+
+    /***** operand_words *****
+     *   Fixed pseudo-random operands (same every run)
+     ******************************/
+    const std::vector<uint32_t>& operand_words() {
+        static const std::vector<uint32_t> words = [] {
+            std::vector<uint32_t> w(kOperands);
+            uint32_t x = 0x12345678u;
+            for (auto& v : w) {
+                x = x * 1664525u + 1013904223u;
+                v = x;
+            }
+            return w;
+        }();
+        return words;
+    }
+
+    /***** operand_floats *****
+     *   Fixed finite float32 patterns with moderate exponents
+     ******************************/
+    const std::vector<uint32_t>& operand_floats() {
+        static const std::vector<uint32_t> words = [] {
+            std::vector<uint32_t> w = operand_words();
+            for (auto& v : w) {
+                v = (v & 0x807fffffu) | ((0x70u + (v >> 27)) << 23);
+            }
+            return w;
+        }();
+        return words;
+    }
+
+    std::vector<Bits> as_bits(const std::vector<uint32_t>& words) {
+        std::vector<Bits> out;
+        out.reserve(words.size());
+        for (uint32_t w : words) out.push_back(bv_from_u32(w));
+        return out;
+    }
+
+    const std::vector<Bits>& operand_bits() {
+        static const std::vector<Bits> bits = as_bits(operand_words());
+        return bits;
+    }
+
+    const std::vector<Bits>& operand_float_bits() {
+        static const std::vector<Bits> bits = as_bits(operand_floats());
+        return bits;
+    }
+
+    /***** bench_pairs *****
+     *   Runs fn(a[i], a[i + 1]) over the table until the timer is done
+     ******************************/
+    template <typename T, typename Fn>
+    void bench_pairs(benchmark::State& state, const std::vector<T>& ops, Fn fn) {
+        std::size_t i = 0;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(fn(ops[i], ops[(i + 1) % kOperands]));
+            i = (i + 1) % kOperands;
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+} // namespace
+
+static void BM_AluAdd_Bits(benchmark::State& state) {
+    bench_pairs(state, operand_bits(), [](const Bits& a, const Bits& b) {
+        return alu_execute(a, b, AluOp::Add);
+    });
+}
+BENCHMARK(BM_AluAdd_Bits);
+
+static void BM_AluSub_U32(benchmark::State& state) {
+    bench_pairs(state, operand_words(), [](uint32_t a, uint32_t b) {
+        return alu_execute_u32(a, b, AluOp::Sub);
+    });
+}
+BENCHMARK(BM_AluSub_U32);
+
+static void BM_AluSub_U32_ZeroOnly(benchmark::State& state) {
+    bench_pairs(state, operand_words(), [](uint32_t a, uint32_t b) {
+        return alu_lazy_u32(a, b, AluOp::Sub).Z();
+    });
+}
+BENCHMARK(BM_AluSub_U32_ZeroOnly);
+
+static void BM_ShifterSra_Bits(benchmark::State& state) {
+    bench_pairs(state, operand_bits(), [](const Bits& a, const Bits& b) {
+        return shifter_execute(a, static_cast<uint32_t>(b[0] | (b[3] << 3)), ShiftOp::Sra);
+    });
+}
+BENCHMARK(BM_ShifterSra_Bits);
+
+static void BM_ShifterSra_U32(benchmark::State& state) {
+    bench_pairs(state, operand_words(), [](uint32_t a, uint32_t b) {
+        return shifter_execute_u32(a, b, ShiftOp::Sra);
+    });
+}
+BENCHMARK(BM_ShifterSra_U32);
+
+static void BM_MduMul_Bits(benchmark::State& state) {
+    bench_pairs(state, operand_bits(), [](const Bits& a, const Bits& b) {
+        return mdu_mul(MulOp::Mul, a, b, TraceSink{});
+    });
+}
+BENCHMARK(BM_MduMul_Bits);
+
+static void BM_MduMul_Traced(benchmark::State& state) {
+    bench_pairs(state, operand_bits(), [](const Bits& a, const Bits& b) {
+        return mdu_mul(MulOp::Mul, a, b);
+    });
+}
+BENCHMARK(BM_MduMul_Traced);
+
+static void BM_MduMul_ArenaTrace(benchmark::State& state) {
+    TraceArena traces;
+    bench_pairs(state, operand_bits(), [&](const Bits& a, const Bits& b) {
+        if (traces.size() >= 64 * 33) traces.reset(); // a batch of 64 traced ops
+        return mdu_mul(MulOp::Mul, a, b, traces.sink());
+    });
+}
+BENCHMARK(BM_MduMul_ArenaTrace);
+
+static void BM_MduMul_U32(benchmark::State& state) {
+    bench_pairs(state, operand_words(), [](uint32_t a, uint32_t b) {
+        return mdu_mul_u32(MulOp::Mulh, a, b);
+    });
+}
+BENCHMARK(BM_MduMul_U32);
+
+static void BM_MduDiv_Bits(benchmark::State& state) {
+    bench_pairs(state, operand_bits(), [](const Bits& a, const Bits& b) {
+        return mdu_div(DivOp::Div, a, b, TraceSink{});
+    });
+}
+BENCHMARK(BM_MduDiv_Bits);
+
+static void BM_MduMul_Radix4(benchmark::State& state) {
+    bench_pairs(state, operand_bits(), [](const Bits& a, const Bits& b) {
+        return mdu_mul(MulOp::Mul, a, b, TraceSink{}, MduEngine::Radix4);
+    });
+}
+BENCHMARK(BM_MduMul_Radix4);
+
+static void BM_MduMul_Radix16(benchmark::State& state) {
+    bench_pairs(state, operand_bits(), [](const Bits& a, const Bits& b) {
+        return mdu_mul(MulOp::Mul, a, b, TraceSink{}, MduEngine::Radix16);
+    });
+}
+BENCHMARK(BM_MduMul_Radix16);
+
+static void BM_MduDiv_Radix4(benchmark::State& state) {
+    bench_pairs(state, operand_bits(), [](const Bits& a, const Bits& b) {
+        return mdu_div(DivOp::Div, a, b, TraceSink{}, MduEngine::Radix4);
+    });
+}
+BENCHMARK(BM_MduDiv_Radix4);
+
+static void BM_MduDiv_Radix16(benchmark::State& state) {
+    bench_pairs(state, operand_bits(), [](const Bits& a, const Bits& b) {
+        return mdu_div(DivOp::Div, a, b, TraceSink{}, MduEngine::Radix16);
+    });
+}
+BENCHMARK(BM_MduDiv_Radix16);
+
+static void BM_MduDiv_U32(benchmark::State& state) {
+    bench_pairs(state, operand_words(), [](uint32_t a, uint32_t b) {
+        return mdu_div_u32(DivOp::Div, a, b);
+    });
+}
+BENCHMARK(BM_MduDiv_U32);
+
+static void BM_Fadd_Traced(benchmark::State& state) {
+    bench_pairs(state, operand_float_bits(), [](const Bits& a, const Bits& b) {
+        return fadd_f32(a, b);
+    });
+}
+BENCHMARK(BM_Fadd_Traced);
+
+static void BM_Fadd_Bits(benchmark::State& state) {
+    bench_pairs(state, operand_float_bits(), [](const Bits& a, const Bits& b) {
+        return fadd_f32(a, b, TraceSink{});
+    });
+}
+BENCHMARK(BM_Fadd_Bits);
+
+static void BM_Fadd_U32(benchmark::State& state) {
+    bench_pairs(state, operand_floats(), [](uint32_t a, uint32_t b) {
+        return fadd_f32_u32(a, b);
+    });
+}
+BENCHMARK(BM_Fadd_U32);
+
+static void BM_Fmul_Traced(benchmark::State& state) {
+    bench_pairs(state, operand_float_bits(), [](const Bits& a, const Bits& b) {
+        return fmul_f32(a, b);
+    });
+}
+BENCHMARK(BM_Fmul_Traced);
+
+static void BM_Fmul_Bits(benchmark::State& state) {
+    bench_pairs(state, operand_float_bits(), [](const Bits& a, const Bits& b) {
+        return fmul_f32(a, b, TraceSink{});
+    });
+}
+BENCHMARK(BM_Fmul_Bits);
+
+static void BM_Fmul_U32(benchmark::State& state) {
+    bench_pairs(state, operand_floats(), [](uint32_t a, uint32_t b) {
+        return fmul_f32_u32(a, b);
+    });
+}
+BENCHMARK(BM_Fmul_U32);
+
+static void BM_EncodeTwosI32(benchmark::State& state) {
+    bench_pairs(state, operand_words(), [](uint32_t a, uint32_t b) {
+        return encode_twos_i32(static_cast<int64_t>(static_cast<int32_t>(a)) * (b & 7));
+    });
+}
+BENCHMARK(BM_EncodeTwosI32);
+
+static void BM_EncodeTwosI32_Fixed(benchmark::State& state) {
+    bench_pairs(state, operand_words(), [](uint32_t a, uint32_t b) {
+        return encode_twos_i32_fixed(static_cast<int64_t>(static_cast<int32_t>(a)) * (b & 7));
+    });
+}
+BENCHMARK(BM_EncodeTwosI32_Fixed);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,333 @@
+#include <benchmark/benchmark.h>
+#include "bench/rv32_asm.hpp"
+#include "core/rv32_cpu.hpp"
+#include "core/rv32_trace.hpp"
+#include "core/rv32_profile.hpp"
+#include "core/rv32_simt.hpp"
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace rv::cpu;
+using namespace rv::bench;
+
+/***** cpu_bench *****
+ *   Instructions-per-second suite for the RV32 interpreter
+ *   - Each kernel is an endless loop, so run(s, n) always retires n
+ *     instructions and the numbers are comparable across kernels
+ *   - Every kernel runs in both ExecMode::Interpret and ExecMode::Blocks,
+ *     with run_traced writing a binary trace to /dev/null, under
+ *     a ProfileProbe, and as kLanes lockstep lanes with different data
+ *   - Reports MIPS and time per instruction (the "per_instr" column
+ *     is in seconds, so 5n = 5 ns)
+ *
+ *   Build with -DCMAKE_BUILD_TYPE=Release for numbers worth comparing.
+ ******************************/
+
+namespace {
+
+    constexpr std::size_t kMemSize   = 4096;
+    constexpr uint32_t    kDataBase  = 0x400;
+    constexpr uint32_t    kDstBase   = 0x600;
+    constexpr std::size_t kDataWords = 64;
+    constexpr std::size_t kChunk     = 100000; // instructions per timed run() call
+    constexpr std::size_t kLanes     = 250;    // lanes of the lockstep runs (divides kChunk)
+
+    /***** Kernel *****
+     *   name      - shown in the benchmark name
+     *   program   - words loaded at address 0
+     *   fill_data - true if kDataBase should hold pseudo-random words
+     ******************************/
+    struct Kernel {
+        std::string           name;
+        std::vector<uint32_t> program;
+        bool                  fill_data;
+    };
+
+    /***** addi_loop *****
+     *   Micro: straight-line ADDIs closed by one JAL
+     ******************************/
+    Kernel addi_loop() {
+        return {"addi_loop", {
+            addi(1, 1, 1),       // 0x00
+            addi(2, 2, -1),      // 0x04
+            addi(3, 3, 3),       // 0x08
+            addi(4, 4, 1),       // 0x0c
+            addi(5, 5, 7),       // 0x10
+            addi(6, 6, -2),      // 0x14
+            addi(7, 7, 1),       // 0x18
+            jal(0, -28),         // 0x1c -> 0x00
+        }, false};
+    }
+
+    /***** memcpy_loop *****
+     *   Micro: copy 64 words with LW/SW, then start over
+     ******************************/
+    Kernel memcpy_loop() {
+        return {"memcpy_loop", {
+            addi(10, 0, kDataBase),   // 0x00 src
+            addi(11, 0, kDstBase),    // 0x04 dst
+            addi(12, 0, kDataWords),  // 0x08 count
+            lw(5, 10, 0),             // 0x0c
+            sw(5, 11, 0),             // 0x10
+            addi(10, 10, 4),          // 0x14
+            addi(11, 11, 4),          // 0x18
+            addi(12, 12, -1),         // 0x1c
+            bne(12, 0, -20),          // 0x20 -> 0x0c
+            jal(0, -36),              // 0x24 -> 0x00
+        }, true};
+    }
+
+    /***** branch_mix *****
+     *   Micro: taken / not-taken branches driven by a counter's low bits
+     ******************************/
+    Kernel branch_mix() {
+        return {"branch_mix", {
+            addi(1, 1, 1),            // 0x00
+            andi(2, 1, 1),            // 0x04
+            beq(2, 0, 12),            // 0x08 -> 0x14 on even
+            addi(3, 3, 1),            // 0x0c
+            jal(0, 8),                // 0x10 -> 0x18
+            addi(4, 4, 1),            // 0x14
+            andi(5, 1, 2),            // 0x18
+            bne(5, 0, 8),             // 0x1c -> 0x24
+            addi(6, 6, 1),            // 0x20
+            jal(0, -36),              // 0x24 -> 0x00
+        }, false};
+    }
+
+    /***** call_chain *****
+     *   Micro: three nested JAL calls, each returning with JALR
+     ******************************/
+    Kernel call_chain() {
+        return {"call_chain", {
+            jal(1, 12),               // 0x00 call f1
+            addi(10, 10, 1),          // 0x04
+            jal(0, -8),               // 0x08 -> 0x00
+            addi(11, 11, 1),          // 0x0c f1
+            jal(5, 12),               // 0x10 call f2
+            jalr(0, 1, 0),            // 0x14 ret
+            nop(),                    // 0x18
+            addi(12, 12, 1),          // 0x1c f2
+            jal(6, 12),               // 0x20 call f3
+            jalr(0, 5, 0),            // 0x24 ret
+            nop(),                    // 0x28
+            addi(13, 13, 1),          // 0x2c f3
+            jalr(0, 6, 0),            // 0x30 ret
+        }, false};
+    }
+
+    /***** checksum *****
+     *   Macro: load, shift/xor mix, data-dependent branch and a store
+     *   of the result, over a 64-word array
+     ******************************/
+    Kernel checksum() {
+        return {"checksum", {
+            addi(10, 0, kDataBase),   // 0x00 ptr
+            addi(12, 0, kDataWords),  // 0x04 count
+            addi(20, 0, 0),           // 0x08 acc
+            lw(5, 10, 0),             // 0x0c
+            slli(6, 5, 3),            // 0x10
+            srli(7, 5, 5),            // 0x14
+            xor_(6, 6, 7),            // 0x18
+            add(20, 20, 6),           // 0x1c
+            andi(8, 5, 1),            // 0x20
+            beq(8, 0, 8),             // 0x24 -> 0x2c
+            sub(20, 20, 5),           // 0x28
+            addi(10, 10, 4),          // 0x2c
+            addi(12, 12, -1),         // 0x30
+            bne(12, 0, -40),          // 0x34 -> 0x0c
+            sw(20, 0, 0x7fc),         // 0x38
+            jal(0, -60),              // 0x3c -> 0x00
+        }, true};
+    }
+
+    /***** mul_hash *****
+     *   Macro: M-extension mix (MUL/MULHU/REMU/DIVU) over the data
+     *   array with a byte store per word
+     ******************************/
+    Kernel mul_hash() {
+        return {"mul_hash", {
+            addi(10, 0, kDataBase),   // 0x00 ptr
+            addi(12, 0, kDataWords),  // 0x04 count
+            addi(13, 0, 1000),        // 0x08 modulus
+            lw(5, 10, 0),             // 0x0c
+            mul(6, 5, 5),             // 0x10
+            mulhu(7, 5, 6),           // 0x14
+            xor_(20, 20, 7),          // 0x18
+            remu(8, 6, 13),           // 0x1c
+            add(21, 21, 8),           // 0x20
+            divu(9, 5, 13),           // 0x24
+            sb(9, 10, 0x200),         // 0x28 into the kDstBase area
+            addi(10, 10, 4),          // 0x2c
+            addi(12, 12, -1),         // 0x30
+            bne(12, 0, -40),          // 0x34 -> 0x0c
+            jal(0, -56),              // 0x38 -> 0x00
+        }, true};
+    }
+
+    /***** fir4 *****
+     *   Macro: 4-tap float FIR (FLW/FMUL.S/FADD.S/FSW) over the data
+     *   array, taps reloaded from the array head on every pass
+     ******************************/
+    Kernel fir4() {
+        return {"fir4", {
+            addi(10, 0, kDataBase),       // 0x00 ptr
+            addi(12, 0, kDataWords - 4),  // 0x04 count
+            flw(20, 0, kDataBase),        // 0x08 taps
+            flw(21, 0, kDataBase + 4),    // 0x0c
+            flw(22, 0, kDataBase + 8),    // 0x10
+            flw(23, 0, kDataBase + 12),   // 0x14
+            flw(1, 10, 0),                // 0x18
+            flw(2, 10, 4),                // 0x1c
+            flw(3, 10, 8),                // 0x20
+            flw(4, 10, 12),               // 0x24
+            fmul_s(5, 1, 20),             // 0x28
+            fmul_s(6, 2, 21),             // 0x2c
+            fmul_s(7, 3, 22),             // 0x30
+            fmul_s(8, 4, 23),             // 0x34
+            fadd_s(5, 5, 6),              // 0x38
+            fadd_s(7, 7, 8),              // 0x3c
+            fadd_s(5, 5, 7),              // 0x40
+            fsw(5, 10, 0x200),            // 0x44 into the kDstBase area
+            addi(10, 10, 4),              // 0x48
+            addi(12, 12, -1),             // 0x4c
+            bne(12, 0, -56),              // 0x50 -> 0x18
+            jal(0, -84),                  // 0x54 -> 0x00
+        }, true};
+    }
+
+    /***** make_cpu *****
+     *   Fresh CPU with the kernel loaded at address 0
+     ******************************/
+    CpuState make_cpu(const Kernel& k) {
+        CpuState s(kMemSize);
+        load_program(s, k.program, 0);
+        if (k.fill_data) {
+            uint32_t x = 0x2468ace1u;
+            for (std::size_t i = 0; i < kDataWords; ++i) {
+                x = x * 1664525u + 1013904223u;
+                s.mem.store_u32(static_cast<uint32_t>(kDataBase + 4 * i), x);
+            }
+        }
+        return s;
+    }
+
+    /***** same_state *****
+     *   Interpreter and block engine must agree before we time either
+     ******************************/
+    bool same_state(const Kernel& k) {
+        CpuState a = make_cpu(k);
+        CpuState b = make_cpu(k);
+        run(a, 5000, ExecMode::Interpret);
+        run(b, 5000, ExecMode::Blocks);
+        return a.pc == b.pc && std::memcmp(a.regs, b.regs, sizeof a.regs) == 0 &&
+               std::memcmp(a.fregs, b.fregs, sizeof a.fregs) == 0 && a.fcsr == b.fcsr && a.mem == b.mem;
+    }
+
+    /***** make_lanes *****
+     *   kLanes copies of the kernel, each lane with its own data words
+     ******************************/
+    LaneGroup make_lanes(const Kernel& k) {
+        CpuState image = make_cpu(k);
+        LaneGroup g = make_lane_group(image, kLanes, 0, static_cast<uint32_t>(4 * k.program.size()));
+        if (k.fill_data) {
+            for (std::size_t l = 1; l < kLanes; ++l) {
+                uint32_t x = 0x2468ace1u ^ static_cast<uint32_t>(l * 0x9e3779b9u);
+                for (std::size_t i = 0; i < kDataWords; ++i) {
+                    x = x * 1664525u + 1013904223u;
+                    g.mem[l].store_u32(static_cast<uint32_t>(kDataBase + 4 * i), x);
+                }
+            }
+        }
+        return g;
+    }
+
+    void set_counters(benchmark::State& state) {
+        double instrs = static_cast<double>(state.iterations()) * kChunk;
+        state.SetItemsProcessed(static_cast<int64_t>(instrs));
+        state.counters["MIPS"] = benchmark::Counter(instrs / 1e6, benchmark::Counter::kIsRate);
+        state.counters["per_instr"] = benchmark::Counter(
+            instrs, benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+    }
+
+    void bench_kernel(benchmark::State& state, const Kernel& k, ExecMode mode) {
+        if (!same_state(k)) {
+            state.SkipWithError("interpreter and block engine disagree");
+            return;
+        }
+
+        CpuState s = make_cpu(k);
+        for (auto _ : state) {
+            run(s, kChunk, mode);
+            benchmark::DoNotOptimize(s.regs);
+        }
+        set_counters(state);
+    }
+
+    void bench_profiled(benchmark::State& state, const Kernel& k) {
+        CpuState s = make_cpu(k);
+        Profile prof;
+        ProfileProbe probe(prof, s.pc);
+        for (auto _ : state) {
+            run_with(s, kChunk, probe);
+            benchmark::DoNotOptimize(s.regs);
+        }
+        set_counters(state);
+    }
+
+    void bench_traced(benchmark::State& state, const Kernel& k) {
+        CpuState s = make_cpu(k);
+        TraceWriter out("/dev/null");
+        for (auto _ : state) {
+            run_traced(s, kChunk, out);
+            benchmark::DoNotOptimize(s.regs);
+        }
+        out.close();
+        set_counters(state);
+    }
+
+    /***** bench_lockstep *****
+     *   kChunk lane-instructions per iteration; "lanes" is how many
+     *   lanes ran together per issued instruction on average
+     ******************************/
+    void bench_lockstep(benchmark::State& state, const Kernel& k) {
+        LaneGroup g = make_lanes(k);
+        LockstepStats total{0, 0};
+        for (auto _ : state) {
+            LockstepStats st = run_lockstep(g, kChunk / kLanes);
+            total.issues += st.issues;
+            total.lane_steps += st.lane_steps;
+            benchmark::DoNotOptimize(g.regs.data());
+        }
+        set_counters(state);
+        state.counters["lanes"] = total.issues ? double(total.lane_steps) / double(total.issues) : 0.0;
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    static const std::vector<Kernel> kernels = {
+        addi_loop(), memcpy_loop(), branch_mix(), call_chain(), checksum(), mul_hash(), fir4(),
+    };
+
+    for (const Kernel& k : kernels) {
+        benchmark::RegisterBenchmark(("BM_" + k.name + "/interp").c_str(),
+                                     bench_kernel, k, ExecMode::Interpret);
+        benchmark::RegisterBenchmark(("BM_" + k.name + "/blocks").c_str(),
+                                     bench_kernel, k, ExecMode::Blocks);
+        benchmark::RegisterBenchmark(("BM_" + k.name + "/traced").c_str(),
+                                     bench_traced, k);
+        benchmark::RegisterBenchmark(("BM_" + k.name + "/profiled").c_str(),
+                                     bench_profiled, k);
+        benchmark::RegisterBenchmark(("BM_" + k.name + "/lockstep").c_str(),
+                                     bench_lockstep, k);
+    }
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <cstdint>
+
+namespace rv::bench {
+
+    /***** rv32_asm *****
+     *   Tiny RV32I encoder for building bench kernels in C++
+     *   - One function per format, plus the mnemonics the kernels use
+     *   - Branch and jump offsets are in bytes, relative to the
+     *     instruction itself (same as the assembler)
+     *   - No range checks: immediates are cut to the field width
+     ******************************/
+
+    constexpr uint32_t enc_r(uint32_t funct7, uint32_t rs2, uint32_t rs1,
+                             uint32_t funct3, uint32_t rd, uint32_t opcode) {
+        return (funct7 << 25) | (rs2 << 20) | (rs1 << 15) | (funct3 << 12) | (rd << 7) | opcode;
+    }
+
+    constexpr uint32_t enc_i(int32_t imm, uint32_t rs1, uint32_t funct3, uint32_t rd, uint32_t opcode) {
+        return ((static_cast<uint32_t>(imm) & 0xFFF) << 20) | (rs1 << 15) | (funct3 << 12) | (rd << 7) | opcode;
+    }
+
+    constexpr uint32_t enc_s(int32_t imm, uint32_t rs2, uint32_t rs1, uint32_t funct3, uint32_t opcode) {
+        uint32_t u = static_cast<uint32_t>(imm);
+        return (((u >> 5) & 0x7F) << 25) | (rs2 << 20) | (rs1 << 15) | (funct3 << 12) |
+               ((u & 0x1F) << 7) | opcode;
+    }
+
+    constexpr uint32_t enc_b(int32_t offset, uint32_t rs2, uint32_t rs1, uint32_t funct3) {
+        uint32_t u = static_cast<uint32_t>(offset);
+        return (((u >> 12) & 0x1) << 31) | (((u >> 5) & 0x3F) << 25) | (rs2 << 20) | (rs1 << 15) |
+               (funct3 << 12) | (((u >> 1) & 0xF) << 8) | (((u >> 11) & 0x1) << 7) | 0x63;
+    }
+
+    constexpr uint32_t enc_u(uint32_t imm20, uint32_t rd, uint32_t opcode) {
+        return ((imm20 & 0xFFFFF) << 12) | (rd << 7) | opcode;
+    }
+
+    constexpr uint32_t enc_j(int32_t offset, uint32_t rd) {
+        uint32_t u = static_cast<uint32_t>(offset);
+        return (((u >> 20) & 0x1) << 31) | (((u >> 1) & 0x3FF) << 21) | (((u >> 11) & 0x1) << 20) |
+               (((u >> 12) & 0xFF) << 12) | (rd << 7) | 0x6F;
+    }
+
+    // I-type ALU
+    constexpr uint32_t addi(uint32_t rd, uint32_t rs1, int32_t imm) { return enc_i(imm, rs1, 0x0, rd, 0x13); }
+    constexpr uint32_t xori(uint32_t rd, uint32_t rs1, int32_t imm) { return enc_i(imm, rs1, 0x4, rd, 0x13); }
+    constexpr uint32_t andi(uint32_t rd, uint32_t rs1, int32_t imm) { return enc_i(imm, rs1, 0x7, rd, 0x13); }
+    constexpr uint32_t slli(uint32_t rd, uint32_t rs1, uint32_t sh) { return enc_i(static_cast<int32_t>(sh), rs1, 0x1, rd, 0x13); }
+    constexpr uint32_t srli(uint32_t rd, uint32_t rs1, uint32_t sh) { return enc_i(static_cast<int32_t>(sh), rs1, 0x5, rd, 0x13); }
+    constexpr uint32_t nop() { return addi(0, 0, 0); }
+
+    // R-type ALU
+    constexpr uint32_t add(uint32_t rd, uint32_t rs1, uint32_t rs2)  { return enc_r(0x00, rs2, rs1, 0x0, rd, 0x33); }
+    constexpr uint32_t sub(uint32_t rd, uint32_t rs1, uint32_t rs2)  { return enc_r(0x20, rs2, rs1, 0x0, rd, 0x33); }
+    constexpr uint32_t xor_(uint32_t rd, uint32_t rs1, uint32_t rs2) { return enc_r(0x00, rs2, rs1, 0x4, rd, 0x33); }
+
+    // M extension
+    constexpr uint32_t mul(uint32_t rd, uint32_t rs1, uint32_t rs2)   { return enc_r(0x01, rs2, rs1, 0x0, rd, 0x33); }
+    constexpr uint32_t mulhu(uint32_t rd, uint32_t rs1, uint32_t rs2) { return enc_r(0x01, rs2, rs1, 0x3, rd, 0x33); }
+    constexpr uint32_t divu(uint32_t rd, uint32_t rs1, uint32_t rs2)  { return enc_r(0x01, rs2, rs1, 0x5, rd, 0x33); }
+    constexpr uint32_t remu(uint32_t rd, uint32_t rs1, uint32_t rs2)  { return enc_r(0x01, rs2, rs1, 0x7, rd, 0x33); }
+
+    // F extension (rm = dynamic)
+    constexpr uint32_t fadd_s(uint32_t rd, uint32_t rs1, uint32_t rs2) { return enc_r(0x00, rs2, rs1, 0x7, rd, 0x53); }
+    constexpr uint32_t fmul_s(uint32_t rd, uint32_t rs1, uint32_t rs2) { return enc_r(0x08, rs2, rs1, 0x7, rd, 0x53); }
+    constexpr uint32_t flw(uint32_t rd, uint32_t rs1, int32_t imm)     { return enc_i(imm, rs1, 0x2, rd, 0x07); }
+    constexpr uint32_t fsw(uint32_t rs2, uint32_t rs1, int32_t imm)    { return enc_s(imm, rs2, rs1, 0x2, 0x27); }
+
+    // memory
+    constexpr uint32_t lw(uint32_t rd, uint32_t rs1, int32_t imm)  { return enc_i(imm, rs1, 0x2, rd, 0x03); }
+    constexpr uint32_t sw(uint32_t rs2, uint32_t rs1, int32_t imm) { return enc_s(imm, rs2, rs1, 0x2, 0x23); }
+    constexpr uint32_t sb(uint32_t rs2, uint32_t rs1, int32_t imm) { return enc_s(imm, rs2, rs1, 0x0, 0x23); }
+
+    // control flow
+    constexpr uint32_t beq(uint32_t rs1, uint32_t rs2, int32_t off) { return enc_b(off, rs2, rs1, 0x0); }
+    constexpr uint32_t bne(uint32_t rs1, uint32_t rs2, int32_t off) { return enc_b(off, rs2, rs1, 0x1); }
+    constexpr uint32_t jal(uint32_t rd, int32_t off)                { return enc_j(off, rd); }
+    constexpr uint32_t jalr(uint32_t rd, uint32_t rs1, int32_t imm) { return enc_i(imm, rs1, 0x0, rd, 0x67); }
+
+    // upper immediates
+    constexpr uint32_t lui(uint32_t rd, uint32_t imm20)   { return enc_u(imm20, rd, 0x37); }
+    constexpr uint32_t auipc(uint32_t rd, uint32_t imm20) { return enc_u(imm20, rd, 0x17); }
+
+} // namespace rv::bench
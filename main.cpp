@@ -1,7 +1,64 @@
-#include <iostream>
+#include "core/rv32_jobs.hpp"
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <unistd.h>
 
-int main()
-{
-    std::cout << "Hello, World!" << std::endl;
+using namespace rv::cpu;
+
+/***** RISC_V_Simulator *****
+ *   Resident job server: takes simulation jobs as length-prefixed
+ *   frames and answers each with the final registers and run result
+ *   (frame layout in core/rv32_jobs.hpp)
+ *
+ *   usage: RISC_V_Simulator --stdio [options]          jobs on stdin, results on stdout
+ *          RISC_V_Simulator --socket <path> [options]  jobs over a Unix socket
+ *   options: --batch <n>  --queue <n>  --threads <n>  --quantum <n>
+ ******************************/
+int main(int argc, char** argv) {
+    const char* socket_path = nullptr;
+    bool stdio = false;
+    JobServerOptions opts;
+
+    for (int i = 1; i < argc; ++i) {
+        bool has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--stdio") == 0) {
+            stdio = true;
+        } else if (std::strcmp(argv[i], "--socket") == 0 && has_value) {
+            socket_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--batch") == 0 && has_value) {
+            opts.batch = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--queue") == 0 && has_value) {
+            opts.queue = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--threads") == 0 && has_value) {
+            opts.threads = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--quantum") == 0 && has_value) {
+            opts.quantum = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            stdio = false;
+            socket_path = nullptr;
+            break;
+        }
+    }
+
+    if (stdio == (socket_path != nullptr)) {
+        std::fprintf(stderr,
+                     "usage: %s --stdio | --socket <path> [--batch n] [--queue n] [--threads n] [--quantum n]\n",
+                     argv[0]);
+        return 2;
+    }
+
+    std::signal(SIGPIPE, SIG_IGN); // a client that goes away is a write error, not a kill
+
+    try {
+        if (socket_path) serve_unix_socket(socket_path, opts);
+        std::size_t n = serve_jobs(STDIN_FILENO, STDOUT_FILENO, opts);
+        std::fprintf(stderr, "%zu jobs\n", n);
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "%s: %s\n", argv[0], e.what());
+        return 1;
+    }
     return 0;
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "core/bitvec.hpp"
+#include <cstdint>
 
 namespace rv::core {
 
@@ -34,6 +35,16 @@ namespace rv::core {
         Bit V;
     };
 
+    /***** AluFlag mask bits *****
+     *   Which flags a caller wants, for alu_execute_u32 / alu_execute
+     *   with a mask and AluLazy32::flags
+     ******************************/
+    constexpr uint8_t kAluFlagN    = 1u << 0;
+    constexpr uint8_t kAluFlagZ    = 1u << 1;
+    constexpr uint8_t kAluFlagC    = 1u << 2;
+    constexpr uint8_t kAluFlagV    = 1u << 3;
+    constexpr uint8_t kAluFlagsAll = kAluFlagN | kAluFlagZ | kAluFlagC | kAluFlagV;
+
     /***** AluResult *****
      *   The output of one ALU operation
      *   result - the 32-bit result
@@ -48,13 +59,111 @@ namespace rv::core {
      *   Runs one ALU operation on two 32-bit inputs
      *****************************
      * Inputs:
-     *   a  - first operand
-     *   b  - second operand
-     *   op - which ALU operation to do
+     *   a    - first operand
+     *   b    - second operand
+     *   op   - which ALU operation to do
+     *   mask - flags to compute (kAluFlag* bits below), all by default
      * Output:
      *     - result
      *     - flags
      ******************************/
-    AluResult alu_execute(const Bits& a, const Bits& b, AluOp op);
+    AluResult alu_execute(const Bits& a, const Bits& b, AluOp op, uint8_t mask = kAluFlagsAll);
+
+    /***** AluResult32 *****
+     *   The output of one ALU operation on packed words
+     *   result - the 32-bit result
+     *   flags  - the status flags, same meaning as in AluResult
+     ******************************/
+    struct AluResult32 {
+        uint32_t result;
+        AluFlags flags;
+    };
+
+    /***** AluLazy32 *****
+     *   An ALU operation with only its result worked out
+     *   - Keeps the operands and op, and computes a flag only when it
+     *     is read (N(), Z(), C(), V(), or flags(mask) for several)
+     *   - Every flag has the same meaning as in alu_execute_u32
+     *
+     *   a, b   - the operands
+     *   op     - the operation
+     *   result - the 32-bit result
+     ******************************/
+    struct AluLazy32 {
+        uint32_t a;
+        uint32_t b;
+        AluOp    op;
+        uint32_t result;
+
+        constexpr bool is_add_sub() const { return op == AluOp::Add || op == AluOp::Sub; }
+
+        constexpr Bit N() const { return static_cast<Bit>(result >> 31); }
+        constexpr Bit Z() const { return result == 0 ? 1 : 0; }
+
+        // carry out of a + b, or of a + (~b + 1) for Sub (b == 0 gives 0)
+        constexpr Bit C() const {
+            if (!is_add_sub()) return 0;
+            uint32_t addend = (op == AluOp::Sub) ? ~b + 1u : b;
+            return static_cast<Bit>((static_cast<uint64_t>(a) + addend) >> 32);
+        }
+
+        constexpr Bit V() const {
+            if (!is_add_sub()) return 0;
+            Bit sign_a = static_cast<Bit>(a >> 31);
+            Bit sign_b = static_cast<Bit>(b >> 31);
+            bool same_in = (op == AluOp::Add) ? (sign_a == sign_b) : (sign_a != sign_b);
+            return (same_in && N() != sign_a) ? 1 : 0;
+        }
+
+        /***** flags *****
+         *   The flags named in mask; the others read as 0
+         ******************************/
+        constexpr AluFlags flags(uint8_t mask = kAluFlagsAll) const {
+            return AluFlags{
+                (mask & kAluFlagN) ? N() : Bit(0),
+                (mask & kAluFlagZ) ? Z() : Bit(0),
+                (mask & kAluFlagC) ? C() : Bit(0),
+                (mask & kAluFlagV) ? V() : Bit(0)
+            };
+        }
+    };
+
+    /***** alu_lazy_u32 *****
+     *   Runs one ALU operation on packed words, flags left for later
+     *   - Costs the same as the bare add/sub, so the interpreter can
+     *     use it; shift ops pass a through, like alu_execute_u32
+     ******************************/
+    constexpr AluLazy32 alu_lazy_u32(uint32_t a, uint32_t b, AluOp op) {
+        uint32_t r = a;
+        if (op == AluOp::Add) r = a + b;
+        else if (op == AluOp::Sub) r = a - b;
+        return AluLazy32{ a, b, op, r };
+    }
+
+    /***** alu_execute_u32 *****
+     *   Word-level version of alu_execute
+     *   - Same result and N/Z/C/V flags, bit for bit
+     *   - No heap allocation, and constexpr, so golden values can be
+     *     worked out at compile time
+     *   - alu_execute is a thin wrapper around this
+     *   - Sub is done as a + (-b), where -b = ~b + 1 kept to 32 bits,
+     *     so C is the carry out of that add (b == 0 gives C = 0)
+     *   - Shift ops are not done here, they pass a through
+     *   - mask picks which flags are worked out (see kAluFlag*); the
+     *     rest come back as 0
+     *****************************
+     * Inputs:
+     *   a    - first operand
+     *   b    - second operand
+     *   op   - which ALU operation to do
+     *   mask - flags to compute, all of them by default
+     * Output:
+     *   AluResult32
+     ******************************/
+    constexpr AluResult32 alu_execute_u32(uint32_t a, uint32_t b, AluOp op,
+                                          uint8_t mask = kAluFlagsAll) {
+        AluLazy32 r = alu_lazy_u32(a, b, op);
+        return AluResult32{ r.result, r.flags(mask) };
+    }
 
 } // namespace rv::core
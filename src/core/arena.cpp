@@ -0,0 +1,91 @@
+#include "core/arena.hpp"
+#include <cstdint>
+#include <cstring>
+
+namespace rv::core {
+
+    /***** Arena constructor / destructor *****
+     *   The first chunk is taken on the first allocation
+     ******************************/
+    Arena::Arena(std::size_t first_chunk, std::pmr::memory_resource* upstream)
+        : upstream_(upstream), first_chunk_(first_chunk ? first_chunk : 64) {}
+
+    Arena::~Arena() {
+        for (const Chunk& c : chunks_) {
+            upstream_->deallocate(c.data, c.size, alignof(std::max_align_t));
+        }
+    }
+
+    /***** reset *****
+     *   Rewinds to the start of the first chunk
+     ******************************/
+    void Arena::reset() {
+        cur_  = 0;
+        done_ = 0;
+        if (chunks_.empty()) {
+            ptr_ = end_ = nullptr;
+        } else {
+            ptr_ = chunks_[0].data;
+            end_ = ptr_ + chunks_[0].size;
+        }
+    }
+
+    std::size_t Arena::bytes_used() const {
+        if (chunks_.empty()) return 0;
+        return done_ + static_cast<std::size_t>(ptr_ - chunks_[cur_].data);
+    }
+
+    /***** next_chunk *****
+     *   Moves to the next chunk that can hold min_bytes
+     *   - Reuses chunks kept from before a reset; takes a new one
+     *     from upstream (double the last, or min_bytes) otherwise
+     *   - A kept chunk that is too small is skipped for this round
+     ******************************/
+    void Arena::next_chunk(std::size_t min_bytes) {
+        if (!chunks_.empty()) done_ += static_cast<std::size_t>(ptr_ - chunks_[cur_].data);
+
+        std::size_t next = chunks_.empty() ? 0 : cur_ + 1;
+        while (next < chunks_.size() && chunks_[next].size < min_bytes) ++next;
+
+        if (next == chunks_.size()) {
+            std::size_t size = chunks_.empty() ? first_chunk_ : chunks_.back().size * 2;
+            if (size < min_bytes) size = min_bytes;
+            auto* data = static_cast<std::byte*>(upstream_->allocate(size, alignof(std::max_align_t)));
+            chunks_.push_back(Chunk{ data, size });
+            reserved_ += size;
+        }
+
+        cur_ = next;
+        ptr_ = chunks_[cur_].data;
+        end_ = ptr_ + chunks_[cur_].size;
+    }
+
+    /***** do_allocate *****
+     *   Aligns the bump pointer and hands out the next bytes
+     ******************************/
+    void* Arena::do_allocate(std::size_t bytes, std::size_t align) {
+        auto aligned = [&]() {
+            auto p = reinterpret_cast<std::uintptr_t>(ptr_);
+            return (p + align - 1) & ~(std::uintptr_t(align) - 1);
+        };
+
+        std::uintptr_t p = aligned();
+        if (!ptr_ || p + bytes > reinterpret_cast<std::uintptr_t>(end_)) {
+            next_chunk(bytes + align);
+            p = aligned();
+        }
+        ptr_ = reinterpret_cast<std::byte*>(p) + bytes;
+        return reinterpret_cast<void*>(p);
+    }
+
+    /***** TraceArena::emit_line *****
+     *   Copies the line into the arena and records a view of it
+     ******************************/
+    void TraceArena::emit_line(void* ctx, std::string_view line) {
+        auto* self = static_cast<TraceArena*>(ctx);
+        char* text = static_cast<char*>(self->arena_.allocate(line.size() ? line.size() : 1, 1));
+        std::memcpy(text, line.data(), line.size());
+        self->lines_.emplace_back(text, line.size());
+    }
+
+} // namespace rv::core
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "core/trace.hpp"
+#include <cstddef>
+#include <memory_resource>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace rv::core {
+
+    /***** Arena *****
+     *   Bump allocator for short-lived results (trace lines, batches
+     *   of op records)
+     *   - A std::pmr::memory_resource, so pmr containers can use it
+     *   - allocate() moves a pointer through the current chunk; a full
+     *     chunk is followed by a new one from upstream, at least twice
+     *     as big
+     *   - deallocate() does nothing; reset() frees everything at once
+     *     in O(1) and keeps the chunks, so a steady workload stops
+     *     calling upstream after the first round
+     *
+     *   One Arena per thread: it has no locking.
+     *
+     * Constructor: Arena(first_chunk, upstream)
+     *     - first_chunk - size of the first chunk in bytes
+     *     - upstream    - where chunks come from (new/delete by default)
+     ******************************/
+    class Arena : public std::pmr::memory_resource {
+    public:
+        explicit Arena(std::size_t first_chunk = 64 * 1024,
+                       std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+        ~Arena() override;
+
+        Arena(const Arena&) = delete;
+        Arena& operator=(const Arena&) = delete;
+
+        /***** reset *****
+         *   Drops every allocation; the chunks stay for reuse
+         *   - Anything allocated from the arena is dangling afterwards
+         ******************************/
+        void reset();
+
+        /***** bytes_used / bytes_reserved *****
+         *   bytes_used     - bytes handed out since the last reset
+         *                    (with alignment padding)
+         *   bytes_reserved - total size of the chunks held
+         ******************************/
+        std::size_t bytes_used() const;
+        std::size_t bytes_reserved() const { return reserved_; }
+
+    private:
+        struct Chunk {
+            std::byte*  data;
+            std::size_t size;
+        };
+
+        void* do_allocate(std::size_t bytes, std::size_t align) override;
+        void  do_deallocate(void*, std::size_t, std::size_t) override {}
+        bool  do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+
+        void next_chunk(std::size_t min_bytes);
+
+        std::pmr::memory_resource* upstream_;
+        std::vector<Chunk>         chunks_;
+        std::size_t                cur_ = 0;      // chunk in use
+        std::byte*                 ptr_ = nullptr; // next free byte in it
+        std::byte*                 end_ = nullptr;
+        std::size_t                done_ = 0;     // bytes used in chunks before cur_
+        std::size_t                reserved_ = 0;
+        std::size_t                first_chunk_;
+    };
+
+    /***** TraceArena *****
+     *   Trace lines kept in an Arena instead of a vector of strings
+     *   - sink() is a TraceSink that copies each line into the arena,
+     *     so a traced MDU/F32 call does no malloc once the arena has
+     *     warmed up
+     *   - lines() are views into the arena, in emit order; read
+     *     size() before a call to find where its lines start
+     *   - reset() drops every line in O(1)
+     ******************************/
+    class TraceArena {
+    public:
+        explicit TraceArena(std::size_t first_chunk = 64 * 1024)
+            : arena_(first_chunk), lines_(&arena_) {}
+
+        TraceSink sink() { return TraceSink(this, &emit_line); }
+
+        std::span<const std::string_view> lines() const { return lines_; }
+        std::size_t size() const { return lines_.size(); }
+
+        void reset() {
+            // the old line table lives in the arena too, so let go of
+            // it (deallocate is a no-op) before rewinding
+            std::pmr::vector<std::string_view>(&arena_).swap(lines_);
+            arena_.reset();
+        }
+
+        Arena&       arena()       { return arena_; }
+        const Arena& arena() const { return arena_; }
+
+    private:
+        static void emit_line(void* ctx, std::string_view line);
+
+        Arena                              arena_;
+        std::pmr::vector<std::string_view> lines_;
+    };
+
+} // namespace rv::core
@@ -0,0 +1,323 @@
+#include "core/batch.hpp"
+#include <cstring>
+#include <stdexcept>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define RV_BATCH_AVX2 1
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON)
+#define RV_BATCH_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace rv::core {
+
+    namespace {
+
+        /***** check_len / check_flag_len *****
+         *   Span size checks shared by every batch call
+         ******************************/
+        void check_len(std::size_t n, std::size_t m, const char* what) {
+            if (m != n) throw std::invalid_argument(what);
+        }
+
+        void check_flag_len(std::size_t n, std::span<Bit> f, const char* what) {
+            if (!f.empty() && f.size() != n) throw std::invalid_argument(what);
+        }
+
+        /***** alu_scalar *****
+         *   Plain loop for the lanes the vector code does not cover
+         ******************************/
+        void alu_scalar(AluOp op, const uint32_t* a, const uint32_t* b,
+                        const AluBatchOut& out, std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                AluResult32 r = alu_execute_u32(a[i], b[i], op);
+                out.result[i] = r.result;
+                if (!out.N.empty()) out.N[i] = r.flags.N;
+                if (!out.Z.empty()) out.Z[i] = r.flags.Z;
+                if (!out.C.empty()) out.C[i] = r.flags.C;
+                if (!out.V.empty()) out.V[i] = r.flags.V;
+            }
+        }
+
+        void shift_scalar(ShiftOp op, const uint32_t* v, const uint32_t* sh,
+                          uint32_t* out, std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                out[i] = shifter_execute_u32(v[i], sh[i], op);
+            }
+        }
+
+#if RV_BATCH_AVX2
+        /***** has_avx2 *****
+         *   Asks the CPU once whether AVX2 is there
+         ******************************/
+        bool has_avx2() {
+            static const bool yes = __builtin_cpu_supports("avx2");
+            return yes;
+        }
+
+        /***** store_flags8 *****
+         *   Narrows eight 0/1 lanes to eight bytes
+         ******************************/
+        __attribute__((target("avx2")))
+        inline void store_flags8(Bit* dst, __m256i lanes) {
+            __m128i lo  = _mm256_castsi256_si128(lanes);
+            __m128i hi  = _mm256_extracti128_si256(lanes, 1);
+            __m128i w16 = _mm_packus_epi32(lo, hi);
+            __m128i w8  = _mm_packus_epi16(w16, w16);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(dst), w8);
+        }
+
+        /***** alu_avx2 *****
+         *   Eight lanes per loop, same flag rules as alu_execute_u32
+         *   - unsigned x < y is done as signed compare after flipping bit 31
+         * Returns:
+         *   how many lanes were done (a multiple of 8)
+         ******************************/
+        template <AluOp Op>
+        __attribute__((target("avx2")))
+        std::size_t alu_avx2(const uint32_t* a, const uint32_t* b,
+                             const AluBatchOut& out, std::size_t n) {
+            const __m256i zero = _mm256_setzero_si256();
+            const __m256i one  = _mm256_set1_epi32(1);
+            const __m256i bias = _mm256_set1_epi32(static_cast<int>(0x80000000u));
+
+            std::size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+                __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+                __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+                __m256i r, c, v;
+
+                if constexpr (Op == AluOp::Add || Op == AluOp::Sub) {
+                    __m256i addend = (Op == AluOp::Add) ? vb : _mm256_sub_epi32(zero, vb);
+                    r = _mm256_add_epi32(va, addend);
+
+                    // carry out of a + addend  <=>  r < a (unsigned)
+                    c = _mm256_and_si256(
+                            _mm256_cmpgt_epi32(_mm256_xor_si256(va, bias), _mm256_xor_si256(r, bias)),
+                            one);
+
+                    __m256i ov = (Op == AluOp::Add)
+                        ? _mm256_and_si256(_mm256_xor_si256(va, r), _mm256_xor_si256(vb, r))
+                        : _mm256_and_si256(_mm256_xor_si256(va, vb), _mm256_xor_si256(va, r));
+                    v = _mm256_srli_epi32(ov, 31);
+                } else {
+                    r = va;
+                    c = zero;
+                    v = zero;
+                }
+
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out.result.data() + i), r);
+                if (!out.N.empty()) store_flags8(out.N.data() + i, _mm256_srli_epi32(r, 31));
+                if (!out.Z.empty()) store_flags8(out.Z.data() + i, _mm256_and_si256(_mm256_cmpeq_epi32(r, zero), one));
+                if (!out.C.empty()) store_flags8(out.C.data() + i, c);
+                if (!out.V.empty()) store_flags8(out.V.data() + i, v);
+            }
+            return i;
+        }
+
+        __attribute__((target("avx2")))
+        std::size_t shift_avx2(ShiftOp op, const uint32_t* v, const uint32_t* sh,
+                               uint32_t* out, std::size_t n) {
+            const __m256i mask = _mm256_set1_epi32(31);
+
+            std::size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+                __m256i vv = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(v + i));
+                __m256i vs = _mm256_and_si256(
+                        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(sh + i)), mask);
+                __m256i r;
+                switch (op) {
+                    case ShiftOp::Sll: r = _mm256_sllv_epi32(vv, vs); break;
+                    case ShiftOp::Srl: r = _mm256_srlv_epi32(vv, vs); break;
+                    default:           r = _mm256_srav_epi32(vv, vs); break;
+                }
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), r);
+            }
+            return i;
+        }
+#endif // RV_BATCH_AVX2
+
+#if RV_BATCH_NEON
+        /***** store_flags4 *****
+         *   Narrows four 0/1 lanes to four bytes
+         ******************************/
+        inline void store_flags4(Bit* dst, uint32x4_t lanes) {
+            uint16x4_t w16 = vmovn_u32(lanes);
+            uint8x8_t  w8  = vmovn_u16(vcombine_u16(w16, w16));
+            uint8_t tmp[8];
+            vst1_u8(tmp, w8);
+            std::memcpy(dst, tmp, 4);
+        }
+
+        /***** alu_neon *****
+         *   Four lanes per loop, same flag rules as alu_execute_u32
+         ******************************/
+        template <AluOp Op>
+        std::size_t alu_neon(const uint32_t* a, const uint32_t* b,
+                             const AluBatchOut& out, std::size_t n) {
+            const uint32x4_t zero = vdupq_n_u32(0);
+            const uint32x4_t one  = vdupq_n_u32(1);
+
+            std::size_t i = 0;
+            for (; i + 4 <= n; i += 4) {
+                uint32x4_t va = vld1q_u32(a + i);
+                uint32x4_t vb = vld1q_u32(b + i);
+                uint32x4_t r, c, v;
+
+                if constexpr (Op == AluOp::Add || Op == AluOp::Sub) {
+                    uint32x4_t addend = (Op == AluOp::Add) ? vb : vsubq_u32(zero, vb);
+                    r = vaddq_u32(va, addend);
+                    c = vandq_u32(vcltq_u32(r, va), one);
+
+                    uint32x4_t ov = (Op == AluOp::Add)
+                        ? vandq_u32(veorq_u32(va, r), veorq_u32(vb, r))
+                        : vandq_u32(veorq_u32(va, vb), veorq_u32(va, r));
+                    v = vshrq_n_u32(ov, 31);
+                } else {
+                    r = va;
+                    c = zero;
+                    v = zero;
+                }
+
+                vst1q_u32(out.result.data() + i, r);
+                if (!out.N.empty()) store_flags4(out.N.data() + i, vshrq_n_u32(r, 31));
+                if (!out.Z.empty()) store_flags4(out.Z.data() + i, vandq_u32(vceqq_u32(r, zero), one));
+                if (!out.C.empty()) store_flags4(out.C.data() + i, c);
+                if (!out.V.empty()) store_flags4(out.V.data() + i, v);
+            }
+            return i;
+        }
+
+        std::size_t shift_neon(ShiftOp op, const uint32_t* v, const uint32_t* sh,
+                               uint32_t* out, std::size_t n) {
+            const uint32x4_t mask = vdupq_n_u32(31);
+
+            std::size_t i = 0;
+            for (; i + 4 <= n; i += 4) {
+                uint32x4_t vv = vld1q_u32(v + i);
+                int32x4_t  vs = vreinterpretq_s32_u32(vandq_u32(vld1q_u32(sh + i), mask));
+                uint32x4_t r;
+                switch (op) {
+                    case ShiftOp::Sll: r = vshlq_u32(vv, vs); break;
+                    case ShiftOp::Srl: r = vshlq_u32(vv, vnegq_s32(vs)); break;
+                    default:
+                        r = vreinterpretq_u32_s32(vshlq_s32(vreinterpretq_s32_u32(vv), vnegq_s32(vs)));
+                        break;
+                }
+                vst1q_u32(out + i, r);
+            }
+            return i;
+        }
+#endif // RV_BATCH_NEON
+
+        /***** alu_vector *****
+         *   Runs the widest vector loop the host has
+         * Returns:
+         *   how many lanes were done
+         ******************************/
+        template <AluOp Op>
+        std::size_t alu_vector(const uint32_t* a, const uint32_t* b,
+                               const AluBatchOut& out, std::size_t n) {
+#if RV_BATCH_AVX2
+            if (has_avx2()) return alu_avx2<Op>(a, b, out, n);
+#endif
+#if RV_BATCH_NEON
+            return alu_neon<Op>(a, b, out, n);
+#endif
+            (void)a; (void)b; (void)out; (void)n;
+            return 0;
+        }
+
+    } // anonymous namespace
+
+    /***** alu_execute_batch *****
+     *   Vector loop first, scalar loop for the leftover lanes
+     ******************************/
+    void alu_execute_batch(AluOp op,
+                           std::span<const uint32_t> a,
+                           std::span<const uint32_t> b,
+                           const AluBatchOut& out) {
+        const std::size_t n = a.size();
+        check_len(n, b.size(),          "alu_execute_batch: b size");
+        check_len(n, out.result.size(), "alu_execute_batch: result size");
+        check_flag_len(n, out.N, "alu_execute_batch: N size");
+        check_flag_len(n, out.Z, "alu_execute_batch: Z size");
+        check_flag_len(n, out.C, "alu_execute_batch: C size");
+        check_flag_len(n, out.V, "alu_execute_batch: V size");
+
+        std::size_t done = 0;
+        switch (op) {
+            case AluOp::Add: done = alu_vector<AluOp::Add>(a.data(), b.data(), out, n); break;
+            case AluOp::Sub: done = alu_vector<AluOp::Sub>(a.data(), b.data(), out, n); break;
+            default:         done = alu_vector<AluOp::Sll>(a.data(), b.data(), out, n); break;
+        }
+        alu_scalar(op, a.data(), b.data(), out, done, n);
+    }
+
+    /***** shifter_execute_batch *****
+     *   Vector loop first, scalar loop for the leftover lanes
+     ******************************/
+    void shifter_execute_batch(ShiftOp op,
+                               std::span<const uint32_t> value,
+                               std::span<const uint32_t> shamt,
+                               std::span<uint32_t> out) {
+        const std::size_t n = value.size();
+        check_len(n, shamt.size(), "shifter_execute_batch: shamt size");
+        check_len(n, out.size(),   "shifter_execute_batch: out size");
+
+        std::size_t done = 0;
+#if RV_BATCH_AVX2
+        if (has_avx2()) done = shift_avx2(op, value.data(), shamt.data(), out.data(), n);
+#endif
+#if RV_BATCH_NEON
+        done = shift_neon(op, value.data(), shamt.data(), out.data(), n);
+#endif
+        shift_scalar(op, value.data(), shamt.data(), out.data(), done, n);
+    }
+
+    /***** mdu_mul_batch *****
+     *   One 64-bit multiply per lane
+     ******************************/
+    void mdu_mul_batch(MulOp op,
+                       std::span<const uint32_t> rs1,
+                       std::span<const uint32_t> rs2,
+                       const MulBatchOut& out) {
+        const std::size_t n = rs1.size();
+        check_len(n, rs2.size(),    "mdu_mul_batch: rs2 size");
+        check_len(n, out.lo.size(), "mdu_mul_batch: lo size");
+        check_len(n, out.hi.size(), "mdu_mul_batch: hi size");
+        check_flag_len(n, out.overflow, "mdu_mul_batch: overflow size");
+
+        for (std::size_t i = 0; i < n; ++i) {
+            MulResult32 r = mdu_mul_u32(op, rs1[i], rs2[i]);
+            out.lo[i] = r.lo;
+            out.hi[i] = r.hi;
+            if (!out.overflow.empty()) out.overflow[i] = r.overflow ? 1 : 0;
+        }
+    }
+
+    /***** mdu_div_batch *****
+     *   One divide per lane
+     ******************************/
+    void mdu_div_batch(DivOp op,
+                       std::span<const uint32_t> rs1,
+                       std::span<const uint32_t> rs2,
+                       const DivBatchOut& out) {
+        const std::size_t n = rs1.size();
+        check_len(n, rs2.size(),   "mdu_div_batch: rs2 size");
+        check_len(n, out.q.size(), "mdu_div_batch: q size");
+        check_len(n, out.r.size(), "mdu_div_batch: r size");
+        check_flag_len(n, out.overflow, "mdu_div_batch: overflow size");
+
+        for (std::size_t i = 0; i < n; ++i) {
+            DivResult32 r = mdu_div_u32(op, rs1[i], rs2[i]);
+            out.q[i] = r.q;
+            out.r[i] = r.r;
+            if (!out.overflow.empty()) out.overflow[i] = r.overflow ? 1 : 0;
+        }
+    }
+
+} // namespace rv::core
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "core/alu.hpp"
+#include "core/mdu.hpp"
+#include "core/shifter.hpp"
+#include <cstdint>
+#include <span>
+
+namespace rv::core {
+
+    /***** AluBatchOut *****
+     *   Where alu_execute_batch writes its results (struct-of-arrays)
+     *
+     *   result     - one 32-bit result per lane
+     *   N, Z, C, V - one flag (0 or 1) per lane; an empty span means
+     *                "don't compute this flag"
+     ******************************/
+    struct AluBatchOut {
+        std::span<uint32_t> result;
+        std::span<Bit>      N;
+        std::span<Bit>      Z;
+        std::span<Bit>      C;
+        std::span<Bit>      V;
+    };
+
+    /***** MulBatchOut / DivBatchOut *****
+     *   Where the MDU batch calls write their results
+     *   - overflow may be empty to skip it
+     ******************************/
+    struct MulBatchOut {
+        std::span<uint32_t> lo;
+        std::span<uint32_t> hi;
+        std::span<Bit>      overflow;
+    };
+
+    struct DivBatchOut {
+        std::span<uint32_t> q;
+        std::span<uint32_t> r;
+        std::span<Bit>      overflow;
+    };
+
+    /***** alu_execute_batch *****
+     *   Runs the same ALU op on many operand pairs
+     *   - Lane i gives exactly alu_execute_u32(a[i], b[i], op)
+     *   - Uses AVX2 or NEON when the host has it, scalar otherwise
+     *   - Throws std::invalid_argument if the span sizes do not match
+     ******************************
+     * Inputs:
+     *   op  - which ALU operation to do
+     *   a   - first operands
+     *   b   - second operands (same length as a)
+     *   out - result and flag spans (same length as a, or empty flags)
+     ******************************/
+    void alu_execute_batch(AluOp op,
+                           std::span<const uint32_t> a,
+                           std::span<const uint32_t> b,
+                           const AluBatchOut& out);
+
+    /***** shifter_execute_batch *****
+     *   Runs the same shift on many values
+     *   - Lane i gives exactly shifter_execute_u32(value[i], shamt[i], op)
+     *   - Throws std::invalid_argument if the span sizes do not match
+     ******************************
+     * Inputs:
+     *   op    - which kind of shift
+     *   value - values to shift
+     *   shamt - shift amounts (only the low 5 bits are used)
+     *   out   - shifted values
+     ******************************/
+    void shifter_execute_batch(ShiftOp op,
+                               std::span<const uint32_t> value,
+                               std::span<const uint32_t> shamt,
+                               std::span<uint32_t> out);
+
+    /***** mdu_mul_batch / mdu_div_batch *****
+     *   Runs mdu_mul_u32 / mdu_div_u32 on many operand pairs
+     *   - Throws std::invalid_argument if the span sizes do not match
+     ******************************
+     * Inputs:
+     *   op       - which multiply/divide mode
+     *   rs1, rs2 - operands
+     *   out      - result spans
+     ******************************/
+    void mdu_mul_batch(MulOp op,
+                       std::span<const uint32_t> rs1,
+                       std::span<const uint32_t> rs2,
+                       const MulBatchOut& out);
+
+    void mdu_div_batch(DivOp op,
+                       std::span<const uint32_t> rs1,
+                       std::span<const uint32_t> rs2,
+                       const DivBatchOut& out);
+
+} // namespace rv::core
@@ -1,23 +1,25 @@
 #include "core/bitvec.hpp"
+#include <bit>
 #include <cctype>
+#include <cstring>
 
 namespace rv::core {
 
     /***** hex_nibble_from_char *****
      *   Converts a single hex character into 4-bit value
-     *   - Throws std::invalid_argument if the character is not a valid hex digit
+     *   - Returns 0xff if the character is not a valid hex digit
      ******************************
      * Inputs:
      *   c - a single character to convert
      * Returns:
-     *   uint8_t - the numeric value of the hex digit
+     *   uint8_t - the numeric value of the hex digit, or 0xff
      ******************************/
 
     static uint8_t hex_nibble_from_char(char c) {
         if (c >= '0' && c <= '9') return static_cast<uint8_t>(c - '0');
         c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
         if (c >= 'a' && c <= 'f') return static_cast<uint8_t>(10 + (c - 'a'));
-        throw std::invalid_argument("Invalid hex digit");
+        return 0xff;
     }
     /***** char_from_nibble *****
      *   Converts a 4-bit value into a hex character
@@ -35,6 +37,215 @@ namespace rv::core {
         return lut[v];
     }
 
+    namespace {
+
+        constexpr uint64_t kOnes = 0x0101010101010101ull;
+        constexpr uint64_t kHigh = 0x8080808080808080ull;
+
+        // The SWAR paths load 8 characters as one little-endian word,
+        // so the first character is in the low byte.
+        constexpr bool kSwar = std::endian::native == std::endian::little;
+
+        uint64_t bswap64(uint64_t v) {
+    #if defined(__GNUC__) || defined(__clang__)
+            return __builtin_bswap64(v);
+    #else
+            uint64_t out = 0;
+            for (int i = 0; i < 8; ++i) {
+                out = (out << 8) | (v & 0xff);
+                v >>= 8;
+            }
+            return out;
+    #endif
+        }
+
+        /***** bytes_in_range *****
+         *   Per byte: 0x80 if lo <= byte <= hi, else 0
+         *   - Every byte of x must be < 0x80 so the adds never carry
+         ******************************/
+        constexpr uint64_t bytes_in_range(uint64_t x, uint8_t lo, uint8_t hi) {
+            uint64_t ge_lo = x + kOnes * (0x80u - lo);
+            uint64_t gt_hi = x + kOnes * (0x7fu - hi);
+            return ge_lo & ~gt_hi & kHigh;
+        }
+
+        /***** hex8_to_u32 *****
+         *   Parses 8 hex characters (first character = top nibble)
+         *   - Returns false if any of them is not a hex digit
+         ******************************/
+        bool hex8_to_u32(const char* p, uint32_t& out) {
+            uint64_t x;
+            std::memcpy(&x, p, 8);
+            if (x & kHigh) return false;
+
+            uint64_t digit  = bytes_in_range(x, '0', '9');
+            uint64_t letter = bytes_in_range(x | (kOnes * 0x20u), 'a', 'f');
+            if ((digit | letter) != kHigh) return false;
+
+            // '0'-'9' -> low nibble is the value, 'a'-'f'/'A'-'F' -> low nibble + 9
+            uint64_t v = (x & (kOnes * 0x0fu)) + (letter >> 7) * 9;
+
+            // first character into the top byte, then fold nibble pairs together
+            v = bswap64(v);
+            v = (v | (v >> 4))  & 0x00ff00ff00ff00ffull;
+            v = (v | (v >> 8))  & 0x0000ffff0000ffffull;
+            v = (v | (v >> 16)) & 0x00000000ffffffffull;
+            out = static_cast<uint32_t>(v);
+            return true;
+        }
+
+        /***** u32_to_hex8 *****
+         *   Writes 8 lowercase hex characters, top nibble first
+         ******************************/
+        void u32_to_hex8(uint32_t w, char* p) {
+            // spread the 8 nibbles into 8 bytes, nibble 0 in byte 0
+            uint64_t v = w;
+            v = (v | (v << 16)) & 0x0000ffff0000ffffull;
+            v = (v | (v << 8))  & 0x00ff00ff00ff00ffull;
+            v = (v | (v << 4))  & 0x0f0f0f0f0f0f0f0full;
+
+            // 0-9 -> '0'-'9', 10-15 -> 'a'-'f' ('a' - '0' - 10 = 39)
+            uint64_t ge10 = ((v + kOnes * 0x76u) >> 7) & kOnes;
+            v = v + kOnes * '0' + ge10 * 39;
+
+            v = bswap64(v);
+            std::memcpy(p, &v, 8);
+        }
+
+        /***** bits_to_words *****
+         *   Packs a byte-per-bit vector into 64-bit words (LSB-first)
+         ******************************/
+        std::vector<uint64_t> bits_to_words(const Bits& b) {
+            std::vector<uint64_t> words((b.size() + 63) / 64, 0);
+            std::size_t i = 0;
+            if constexpr (kSwar) {
+                // 8 bits at a time: each byte is 0 or 1, the multiply
+                // gathers byte k into bit 56 + k
+                for (; i + 8 <= b.size(); i += 8) {
+                    uint64_t x;
+                    std::memcpy(&x, b.data() + i, 8);
+                    uint64_t byte = ((x & kOnes) * 0x0102040810204080ull) >> 56;
+                    words[i / 64] |= byte << (i % 64);
+                }
+            }
+            for (; i < b.size(); ++i) {
+                words[i / 64] |= static_cast<uint64_t>(b[i] & 1) << (i % 64);
+            }
+            return words;
+        }
+
+    } // namespace
+
+    /***** hex_to_words *****
+     *   Bulk hex parser into packed 64-bit words
+     *   - The leading partial word (fewer than 16 digits) is read one
+     *     digit at a time, every full word after it 8 digits per step,
+     *     so the first bad character found is also the leftmost one
+     ******************************
+     * Inputs:
+     *   hex          - hex text
+     *   words        - output, resized to hold every digit
+     *   allow_prefix - false if the caller already stripped the prefix
+     * Returns:
+     *   HexParseResult
+     ******************************/
+    HexParseResult hex_to_words(std::string_view hex, std::vector<uint64_t>& words,
+                                bool allow_prefix) {
+        std::size_t base = 0;
+        if (allow_prefix && hex.size() >= 2 && hex[0] == '0' && (hex[1] == 'x' || hex[1] == 'X')) {
+            base = 2;
+        }
+        const char* p = hex.data() + base;
+        const std::size_t n = hex.size() - base;
+
+        words.assign((n + 15) / 16, 0);
+        if (n == 0) return {true, 0, 0};
+
+        // digits are MSB-first, so the top word is filled first
+        std::size_t pos = 0;
+        std::size_t k = words.size();
+
+        std::size_t head = n % 16;
+        if (head) {
+            uint64_t w = 0;
+            for (; pos < head; ++pos) {
+                uint8_t nib = hex_nibble_from_char(p[pos]);
+                if (nib > 15) return {false, base + pos, pos};
+                w = (w << 4) | nib;
+            }
+            words[--k] = w;
+        }
+
+        for (; pos < n; pos += 16) {
+            uint32_t hi = 0;
+            uint32_t lo = 0;
+            for (std::size_t half = 0; half < 2; ++half) {
+                uint32_t& out = half ? lo : hi;
+                const char* q = p + pos + half * 8;
+                bool ok = false;
+                if constexpr (kSwar) {
+                    ok = hex8_to_u32(q, out);
+                }
+                if (!ok) {
+                    // slow path: find the exact bad character (or parse
+                    // on a big-endian host)
+                    out = 0;
+                    for (std::size_t j = 0; j < 8; ++j) {
+                        uint8_t nib = hex_nibble_from_char(q[j]);
+                        if (nib > 15) {
+                            std::size_t at = pos + half * 8 + j;
+                            return {false, base + at, at};
+                        }
+                        out = (out << 4) | nib;
+                    }
+                }
+            }
+            words[--k] = (static_cast<uint64_t>(hi) << 32) | lo;
+        }
+        return {true, 0, n};
+    }
+
+    /***** words_to_hex *****
+     *   Bulk formatter for packed 64-bit words
+     ******************************
+     * Inputs:
+     *   words      - LSB-first packed value
+     *   width_bits - how many low bits are part of the value
+     *   prefix0x   - if true, prefix the string with 0x
+     * Returns:
+     *   std::string - lowercase hex string
+     ******************************/
+    std::string words_to_hex(std::span<const uint64_t> words, std::size_t width_bits, bool prefix0x) {
+        std::size_t nwords = (width_bits + 63) / 64;
+        if (nwords > words.size()) nwords = words.size();
+        if (nwords == 0) return prefix0x ? "0x0" : "0";
+
+        std::string s(nwords * 16, '0');
+        for (std::size_t k = 0; k < nwords; ++k) {
+            uint64_t w = words[k];
+            if (k * 64 + 64 > width_bits) {
+                std::size_t keep = width_bits - k * 64;
+                w &= (uint64_t(1) << keep) - 1;
+            }
+            char* out = s.data() + (nwords - 1 - k) * 16;
+            if constexpr (kSwar) {
+                u32_to_hex8(static_cast<uint32_t>(w >> 32), out);
+                u32_to_hex8(static_cast<uint32_t>(w), out + 8);
+            } else {
+                for (std::size_t j = 0; j < 16; ++j) {
+                    out[15 - j] = char_from_nibble(static_cast<uint8_t>((w >> (4 * j)) & 0xf));
+                }
+            }
+        }
+
+        // trim leading zeros (but keep at least one)
+        std::size_t nz = 0;
+        while (nz + 1 < s.size() && s[nz] == '0') ++nz;
+        if (nz) s.erase(0, nz);
+
+        return prefix0x ? std::string("0x") + s : s;
+    }
+
     /***** trim_leading *****
      *   Removes leading zeros from the MSB side of a bit vector.
      *   - Bits are stored LSB-first, so this looks at the back of the vector.
@@ -65,23 +276,32 @@ namespace rv::core {
      *   Bits - bit vector representing the hex value LSB-first.
      ******************************/
     Bits bv_from_hex_string(std::string hex) {
-        // strip 0x
+        // strip 0x here only; hex_to_words must not strip a second one
+        std::size_t prefix = 0;
         if (hex.rfind("0x", 0) == 0 || hex.rfind("0X", 0) == 0) {
-            hex = hex.substr(2);
+            prefix = 2;
         }
 
-        hex.erase(std::remove(hex.begin(), hex.end(), '_'), hex.end());
+        std::string digits(hex, prefix);
+        digits.erase(std::remove(digits.begin(), digits.end(), '_'), digits.end());
 
-        if (hex.empty()) return Bits{0};
+        if (digits.empty()) return Bits{0};
 
-        Bits out;
-        out.reserve(hex.size() * 4);
-
-        for (auto it = hex.rbegin(); it != hex.rend(); ++it) {
-            uint8_t nib = hex_nibble_from_char(*it);
-            for (int i = 0; i < 4; ++i) {
-                out.push_back( (nib >> i) & 0x1 );
+        std::vector<uint64_t> words;
+        HexParseResult r = hex_to_words(digits, words, false);
+        if (!r.ok) {
+            // r.bad_offset counts digits; map it back to the offset in hex
+            std::size_t at = prefix;
+            for (std::size_t left = r.bad_offset;; ++at) {
+                if (hex[at] == '_') continue;
+                if (left-- == 0) break;
             }
+            throw std::invalid_argument("Invalid hex digit at offset " + std::to_string(at));
+        }
+
+        Bits out(r.digits * 4);
+        for (std::size_t i = 0; i < out.size(); ++i) {
+            out[i] = static_cast<Bit>((words[i / 64] >> (i % 64)) & 1u);
         }
         return trim_leading(out);
     }
@@ -100,32 +320,9 @@ namespace rv::core {
      ******************************/
     // AI-BEGIN: This part was confusing to me, AI helped with logic, code, and understanding
     std::string bv_to_hex_string(const Bits& b_in, bool prefix0x) {
-        Bits b = b_in;
-        if (b.empty()) b = Bits{0};
-
-        // pad up to nibble multiple
-        std::size_t rem = b.size() % 4;
-        if (rem != 0) {
-            b.insert(b.end(), 4 - rem, 0);
-        }
-        // from LSB nibble upward (storage is LSB-first)
-        std::string s;
-        for (std::size_t i = 0; i < b.size(); i += 4) {
-            uint8_t nib = (b[i] & 1)
-                        | ((b[i+1] & 1) << 1)
-                        | ((b[i+2] & 1) << 2)
-                        | ((b[i+3] & 1) << 3);
-            s.push_back(char_from_nibble(nib));
-        }
-        // reverse to MSB-first for human-readable hex
-        std::reverse(s.begin(), s.end());
-
-        // trim leading zeros (but keep at least one)
-        std::size_t nz = 0;
-        while (nz + 1 < s.size() && s[nz] == '0') ++nz;
-        if (nz) s.erase(0, nz);
-
-        return prefix0x ? std::string("0x") + s : s;
+        if (b_in.empty()) return prefix0x ? "0x0" : "0";
+        std::vector<uint64_t> words = bits_to_words(b_in);
+        return words_to_hex(words, b_in.size(), prefix0x);
     }
     // AI-END
     /***** bv_pad_left *****
@@ -183,14 +380,32 @@ namespace rv::core {
     std::string bv_to_pretty_bin(const Bits& b_in, std::size_t group, char sep) {
         Bits b = b_in;
         if (b.empty()) b = Bits{0};
-        // Print MSB->LSB
+
+        // Print MSB->LSB: bit i lands at position size-1-i, so each run of
+        // 8 bits is a byte-reversed copy plus '0'
+        const std::size_t n = b.size();
+        std::string flat(n, '0');
+        std::size_t i = 0;
+        if constexpr (kSwar) {
+            for (; i + 8 <= n; i += 8) {
+                uint64_t x;
+                std::memcpy(&x, b.data() + i, 8);
+                x = bswap64((x & kOnes) + kOnes * '0');
+                std::memcpy(flat.data() + (n - 8 - i), &x, 8);
+            }
+        }
+        for (; i < n; ++i) {
+            flat[n - 1 - i] = b[i] ? '1' : '0';
+        }
+
+        if (group == 0 || group >= n) return flat;
+
+        // groups are counted from the MSB end
         std::string s;
-        s.reserve(b.size() + (group ? b.size() / group : 0));
-        std::size_t cnt = 0;
-        for (std::size_t i = b.size(); i-- > 0; ) {
-            s.push_back(b[i] ? '1' : '0');
-            ++cnt;
-            if (group && i != 0 && (cnt % group == 0)) s.push_back(sep);
+        s.reserve(n + n / group);
+        for (std::size_t pos = 0; pos < n; pos += group) {
+            if (pos) s.push_back(sep);
+            s.append(flat, pos, group);
         }
         return s;
     }
@@ -225,6 +440,29 @@ namespace rv::core {
         return bv_pad_left(b, width, sign);
     }
 
+    /***** bv_to_u32 *****
+     *   Packs the low 32 bits into a word
+     ******************************/
+    uint32_t bv_to_u32(const Bits& b) {
+        std::size_t n = b.size() < 32 ? b.size() : 32;
+        uint32_t v = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            v |= static_cast<uint32_t>(b[i] & 1) << i;
+        }
+        return v;
+    }
+
+    /***** bv_from_u32 *****
+     *   Unpacks a word into 32 bits
+     ******************************/
+    Bits bv_from_u32(uint32_t v) {
+        Bits out(32, 0);
+        for (std::size_t i = 0; i < 32; ++i) {
+            out[i] = static_cast<Bit>((v >> i) & 0x1);
+        }
+        return out;
+    }
+
     /***** twos_negate *****
      *   Computes the two's-complement of a bit vector
      *   - Inverts all bits.
@@ -1,6 +1,8 @@
 #pragma once        // include "once" guard to prevent double definitions
 #include <cstdint>
+#include <span>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <stdexcept>
 #include <algorithm>
@@ -23,6 +25,54 @@ namespace rv::core {
      ******************************/
     Bits bv_from_hex_string(std::string hex);
 
+    /***** HexParseResult *****
+     *   What hex_to_words found
+     *
+     *   ok         - true if every character was a hex digit
+     *   bad_offset - index (in the input string) of the first bad
+     *                character; only meaningful when ok is false
+     *   digits     - how many hex digits were read
+     ******************************/
+    struct HexParseResult {
+        bool        ok;
+        std::size_t bad_offset;
+        std::size_t digits;
+    };
+
+    /***** hex_to_words *****
+     *   Bulk hex parser into packed 64-bit words
+     *   - Optional "0x"/"0X" prefix (unless allow_prefix is false),
+     *     no '_' separators
+     *   - Reads 8 digits per 64-bit chunk and checks the whole chunk at
+     *     once, instead of one character at a time
+     *   - words[0] holds the lowest 16 digits (LSB-first, like Bits)
+     *   - Does not throw: a bad digit is reported through the result
+     ******************************
+     * Inputs:
+     *   hex          - hex text
+     *   words        - output, resized to hold every digit
+     *   allow_prefix - false if the caller already stripped the prefix,
+     *                  so a second "0x" is a bad digit
+     * Returns:
+     *   HexParseResult
+     ******************************/
+    HexParseResult hex_to_words(std::string_view hex, std::vector<uint64_t>& words,
+                                bool allow_prefix = true);
+
+    /***** words_to_hex *****
+     *   Bulk formatter for packed 64-bit words
+     *   - Writes 16 digits per word, then trims leading zeros the same
+     *     way bv_to_hex_string does
+     ******************************
+     * Inputs:
+     *   words      - LSB-first packed value
+     *   width_bits - how many low bits are part of the value
+     *   prefix0x   - if true, prefix the string with 0x
+     * Returns:
+     *   std::string - lowercase hex string
+     ******************************/
+    std::string words_to_hex(std::span<const uint64_t> words, std::size_t width_bits, bool prefix0x = true);
+
     /***** bv_to_hex_string *****
      *   Turns a bit vector into a hex string.
      *   - Works with LSB-first bit vectors
@@ -118,6 +168,28 @@ namespace rv::core {
      ******************************/
     Bits twos_negate(Bits b);
 
+    /***** bv_to_u32 *****
+     *   Packs the low 32 bits of a bit vector into a machine word
+     *   - Missing bits count as 0, bits above 31 are dropped
+     *   - Same width rule as zero_extend(b, 32)
+     ******************************
+     * Inputs:
+     *   b - bit vector (LSB-first)
+     * Returns:
+     *   uint32_t - packed value, bit i of the word is b[i]
+     ******************************/
+    uint32_t bv_to_u32(const Bits& b);
+
+    /***** bv_from_u32 *****
+     *   Unpacks a machine word into a 32-bit vector
+     ******************************
+     * Inputs:
+     *   v - packed value
+     * Returns:
+     *   Bits - 32 bits, LSB-first
+     ******************************/
+    Bits bv_from_u32(uint32_t v);
+
     /***** bit_width *****
      *   Returns how many bits are in the vector
      ******************************
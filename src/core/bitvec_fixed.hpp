@@ -0,0 +1,225 @@
+#pragma once        // include "once" guard to prevent double definitions
+#include "core/bitvec.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace rv::core {
+
+    /***** BitVec<N> *****
+     *   A fixed-width bit vector that lives on the stack
+     *   - Bits are packed 64 to a word, LSB is bit 0 (same order as Bits)
+     *   - Converts to and from Bits, so it can be passed to anything
+     *     that takes the heap-backed type
+     *   - Field helpers (slice, extend, pad, to_hex) are constexpr
+     *
+     *   Bits32 / Bits64 are the widths the ALU, MDU and F32 code use.
+     ******************************/
+    template <std::size_t N>
+    class BitVec {
+        static_assert(N > 0, "BitVec needs at least one bit");
+
+    public:
+        static constexpr std::size_t kWords = (N + 63) / 64;
+
+        /***** constructors *****
+         *   BitVec()          - all zeros
+         *   BitVec(uint64_t)  - low N bits of the value
+         *   BitVec(Bits)      - same as zero_extend(b, N): pads with 0
+         *                       or drops bits above N
+         ******************************/
+        constexpr BitVec() : w_{} {}
+
+        constexpr explicit BitVec(uint64_t v) : w_{} {
+            w_[0] = v;
+            mask_top();
+        }
+
+        BitVec(const Bits& b) : w_{} {
+            std::size_t n = b.size() < N ? b.size() : N;
+            for (std::size_t i = 0; i < n; ++i) {
+                set(i, b[i]);
+            }
+        }
+
+        /***** operator Bits *****
+         *   Unpacks into an N-bit heap vector
+         ******************************/
+        operator Bits() const {
+            Bits out(N, 0);
+            for (std::size_t i = 0; i < N; ++i) {
+                out[i] = get(i);
+            }
+            return out;
+        }
+
+        static constexpr std::size_t size() { return N; }
+
+        /***** get / set *****
+         *   Read or write one bit, i must be < N
+         ******************************/
+        constexpr Bit get(std::size_t i) const {
+            return static_cast<Bit>((w_[i / 64] >> (i % 64)) & 1u);
+        }
+
+        constexpr void set(std::size_t i, Bit v) {
+            uint64_t m = uint64_t(1) << (i % 64);
+            if (v & 1) w_[i / 64] |= m;
+            else       w_[i / 64] &= ~m;
+        }
+
+        constexpr Bit operator[](std::size_t i) const { return get(i); }
+
+        /***** msb *****
+         *   The top bit (the sign bit for signed values)
+         ******************************/
+        constexpr Bit msb() const { return get(N - 1); }
+
+        /***** word / to_u64 *****
+         *   word(k) - the k-th 64-bit storage word
+         *   to_u64  - low 64 bits as an integer
+         ******************************/
+        constexpr uint64_t word(std::size_t k) const { return w_[k]; }
+        constexpr uint64_t to_u64() const { return w_[0]; }
+
+        /***** is_zero / is_all_ones *****/
+        constexpr bool is_zero() const {
+            for (std::size_t k = 0; k < kWords; ++k) {
+                if (w_[k] != 0) return false;
+            }
+            return true;
+        }
+
+        constexpr bool is_all_ones() const {
+            return (~BitVec(*this)).is_zero();
+        }
+
+        /***** operator~ *****
+         *   Flips every bit (only the N real bits)
+         ******************************/
+        constexpr BitVec operator~() const {
+            BitVec out;
+            for (std::size_t k = 0; k < kWords; ++k) {
+                out.w_[k] = ~w_[k];
+            }
+            out.mask_top();
+            return out;
+        }
+
+        /***** operator<<= / operator>>= *****
+         *   Logical shifts by n; bits shifted past either end are lost
+         ******************************/
+        constexpr BitVec& operator<<=(std::size_t n) {
+            if (n >= N) { *this = BitVec(); return *this; }
+            std::size_t ws = n / 64;
+            std::size_t bs = n % 64;
+            for (std::size_t k = kWords; k-- > 0; ) {
+                uint64_t v = 0;
+                if (k >= ws) {
+                    v = w_[k - ws] << bs;
+                    if (bs && k >= ws + 1) v |= w_[k - ws - 1] >> (64 - bs);
+                }
+                w_[k] = v;
+            }
+            mask_top();
+            return *this;
+        }
+
+        constexpr BitVec& operator>>=(std::size_t n) {
+            if (n >= N) { *this = BitVec(); return *this; }
+            std::size_t ws = n / 64;
+            std::size_t bs = n % 64;
+            for (std::size_t k = 0; k < kWords; ++k) {
+                uint64_t v = 0;
+                if (k + ws < kWords) {
+                    v = w_[k + ws] >> bs;
+                    if (bs && k + ws + 1 < kWords) v |= w_[k + ws + 1] << (64 - bs);
+                }
+                w_[k] = v;
+            }
+            return *this;
+        }
+
+        /***** slice<Hi, Lo> *****
+         *   Bits Lo..Hi (inclusive) as a new vector, like bv_slice
+         ******************************/
+        template <std::size_t Hi, std::size_t Lo>
+        constexpr BitVec<Hi - Lo + 1> slice() const {
+            static_assert(Lo <= Hi, "slice: lo>hi");
+            static_assert(Hi < N, "slice: hi out of range");
+            BitVec<Hi - Lo + 1> out;
+            for (std::size_t i = 0; i <= Hi - Lo; ++i) {
+                out.set(i, get(Lo + i));
+            }
+            return out;
+        }
+
+        /***** pad_left<M> *****
+         *   Same rule as bv_pad_left: cut down to M bits, or fill the
+         *   new MSB-side bits with fill
+         ******************************/
+        template <std::size_t M>
+        constexpr BitVec<M> pad_left(Bit fill) const {
+            BitVec<M> out;
+            for (std::size_t i = 0; i < M; ++i) {
+                out.set(i, i < N ? get(i) : fill);
+            }
+            return out;
+        }
+
+        /***** zero_extend<M> / sign_extend<M> *****
+         *   Widen to M bits with 0s, or with copies of the top bit
+         ******************************/
+        template <std::size_t M>
+        constexpr BitVec<M> zero_extend() const { return pad_left<M>(0); }
+
+        template <std::size_t M>
+        constexpr BitVec<M> sign_extend() const { return pad_left<M>(msb()); }
+
+        /***** to_hex *****
+         *   Same text as bv_to_hex_string: lowercase, leading zero
+         *   digits trimmed (at least one digit kept)
+         ******************************/
+        constexpr std::string to_hex(bool prefix0x = true) const {
+            const char* lut = "0123456789abcdef";
+            std::string s = prefix0x ? "0x" : "";
+
+            bool started = false;
+            for (std::size_t nib = (N + 3) / 4; nib-- > 0; ) {
+                unsigned v = 0;
+                for (std::size_t j = 0; j < 4; ++j) {
+                    std::size_t i = nib * 4 + j;
+                    if (i < N) v |= static_cast<unsigned>(get(i)) << j;
+                }
+                if (v != 0 || started || nib == 0) {
+                    s.push_back(lut[v]);
+                    started = true;
+                }
+            }
+            return s;
+        }
+
+        friend constexpr bool operator==(const BitVec& a, const BitVec& b) {
+            for (std::size_t k = 0; k < kWords; ++k) {
+                if (a.w_[k] != b.w_[k]) return false;
+            }
+            return true;
+        }
+
+    private:
+        /***** mask_top *****
+         *   Clears the unused bits above N in the last word
+         ******************************/
+        constexpr void mask_top() {
+            if constexpr (N % 64 != 0) {
+                w_[kWords - 1] &= (uint64_t(1) << (N % 64)) - 1;
+            }
+        }
+
+        uint64_t w_[kWords];
+    };
+
+    using Bits32 = BitVec<32>;
+    using Bits64 = BitVec<64>;
+
+} // namespace rv::core
@@ -1,5 +1,6 @@
 #include "core/f32.hpp"
 #include "core/bitvec.hpp"
+#include <bit>
 #include <cassert>
 
 namespace rv::core {
@@ -147,6 +148,32 @@ namespace {
         return true;
     }
 
+    constexpr uint32_t kSignMask = 0x80000000u;
+    constexpr uint32_t kExpMask  = 0xffu;
+    constexpr uint32_t kFracMask = 0x007fffffu;
+    constexpr uint32_t kSigMask  = 0x00ffffffu;
+    constexpr uint32_t kHidden   = 0x00800000u;
+    constexpr uint32_t kInfBits  = 0x7f800000u;
+    constexpr uint32_t kNaNBits  = 0x7fc00000u;
+
+    constexpr uint32_t f32_sign(uint32_t x) { return x >> 31; }
+    constexpr uint32_t f32_exp(uint32_t x)  { return (x >> 23) & kExpMask; }
+    constexpr uint32_t f32_frac(uint32_t x) { return x & kFracMask; }
+
+    constexpr uint32_t f32_pack(uint32_t sign, uint32_t exp, uint32_t frac) {
+        return (sign << 31) | ((exp & kExpMask) << 23) | (frac & kFracMask);
+    }
+
+    /***** to_fpu_result *****
+     *   Widens a word-level result into the Bits-based FpuResult
+     ******************************/
+    FpuResult to_fpu_result(const FpuResult32& r) {
+        FpuResult out;
+        out.bits = bv_from_u32(r.bits);
+        out.flags = r.flags;
+        return out;
+    }
+
 } // anonymous namespace
 
     /***** unpack_f32 *****
@@ -228,12 +255,16 @@ namespace {
      * Inputs:
      *   a - first float32 value
      *   b - second float32 value
+     *   trace - where the step trace goes
      * Returns:
-     *   FpuResult
+     *   FpuResult (the trace field is left empty)
      ******************************/
-    FpuResult fadd_f32(const Bits& a, const Bits& b) {
+    FpuResult fadd_f32(const Bits& a, const Bits& b, TraceSink trace) {
+        if (!trace.enabled()) {
+            return to_fpu_result(fadd_f32_u32(bv_to_u32(a), bv_to_u32(b)));
+        }
         FpuResult out = make_zero_fpu_result();
-        out.trace.push_back("fadd_f32 start");
+        trace.emit("fadd_f32 start");
 
         Bits a32 = zero_extend(a, 32);
         Bits b32 = zero_extend(b, 32);
@@ -243,12 +274,12 @@ namespace {
 
         if (bits_all_zero(fa.exponent) && bits_all_zero(fa.fraction)) {
             out.bits = b32;
-            out.trace.push_back("a is zero → return b");
+            trace.emit("a is zero → return b");
             return out;
         }
         if (bits_all_zero(fb.exponent) && bits_all_zero(fb.fraction)) {
             out.bits = a32;
-            out.trace.push_back("b is zero → return a");
+            trace.emit("b is zero → return a");
             return out;
         }
 
@@ -329,7 +360,7 @@ namespace {
             }
 
             out.bits = pack_f32(fres);
-            out.trace.push_back("fadd_f32 normal same-sign add");
+            trace.emit("fadd_f32 normal same-sign add");
             return out;
         }
 
@@ -352,7 +383,7 @@ namespace {
             fres.fraction = Bits(23, 0); // all zero
 
             out.bits = pack_f32(fres);
-            out.trace.push_back("fadd_f32 different-sign: exact zero");
+            trace.emit("fadd_f32 different-sign: exact zero");
             return out;
         }
         // AI-END
@@ -367,7 +398,7 @@ namespace {
             fres.exponent = Bits(8, 0);
             fres.fraction = Bits(23, 0);
             out.bits = pack_f32(fres);
-            out.trace.push_back("fadd_f32 different-sign: diff zero");
+            trace.emit("fadd_f32 different-sign: diff zero");
             return out;
         }
 
@@ -395,7 +426,7 @@ namespace {
         }
 
         out.bits = pack_f32(fres);
-        out.trace.push_back("fadd_f32 different-sign subtract");
+        trace.emit("fadd_f32 different-sign subtract");
         return out;
     }
 
@@ -405,16 +436,17 @@ namespace {
      * Inputs:
      *   a - first float32 value
      *   b - second float32 value
+     *   trace - where the step trace goes
      *
      * Returns:
-     *   FpuResult - result bits, flags, and trace from fadd_f32.
+     *   FpuResult - result bits and flags from fadd_f32.
      ******************************/
-    FpuResult fsub_f32(const Bits& a, const Bits& b) {
+    FpuResult fsub_f32(const Bits& a, const Bits& b, TraceSink trace) {
         Bits b32 = zero_extend(b, 32);
         Bits b_neg = b32;
         b_neg[31] = b32[31] ^ 1; // flip sign bit
 
-        return fadd_f32(a, b_neg);
+        return fadd_f32(a, b_neg, trace);
     }
 
     /***** fmul_f32 *****
@@ -423,12 +455,16 @@ namespace {
      * Inputs:
      *   a - first float32 value
      *   b - second float32 value
+     *   trace - where the step trace goes
      * Returns:
-     *   FpuResult
+     *   FpuResult (the trace field is left empty)
      ******************************/
-    FpuResult fmul_f32(const Bits& a, const Bits& b) {
+    FpuResult fmul_f32(const Bits& a, const Bits& b, TraceSink trace) {
+        if (!trace.enabled()) {
+            return to_fpu_result(fmul_f32_u32(bv_to_u32(a), bv_to_u32(b)));
+        }
         FpuResult out = make_zero_fpu_result();
-        out.trace.push_back("fmul_f32 start");
+        trace.emit("fmul_f32 start");
 
         Bits a32 = zero_extend(a, 32);
         Bits b32 = zero_extend(b, 32);
@@ -453,19 +489,19 @@ namespace {
         bool a_is_nan  = expA_ones && !fracA_zero;
         bool b_is_nan  = expB_ones && !fracB_zero;
         // AI-END
-        Bits nan_bits = bv_from_hex_string("0x7fc00000");
+        Bits nan_bits = bv_from_u32(kNaNBits);
 
         if (a_is_nan || b_is_nan) {
             out.bits = nan_bits;
             out.flags.invalid = true;
-            out.trace.push_back("fmul_f32: NaN operand");
+            trace.emit("fmul_f32: NaN operand");
             return out;
         }
 
         if ((a_is_inf && b_is_zero) || (b_is_inf && a_is_zero)) {
             out.bits = nan_bits;
             out.flags.invalid = true;
-            out.trace.push_back("fmul_f32: 0 * inf invalid");
+            trace.emit("fmul_f32: 0 * inf invalid");
             return out;
         }
 
@@ -478,7 +514,7 @@ namespace {
             }
             fres.fraction = Bits(23, 0);
             out.bits = pack_f32(fres);
-            out.trace.push_back("fmul_f32: inf result");
+            trace.emit("fmul_f32: inf result");
             return out;
         }
 
@@ -488,7 +524,7 @@ namespace {
             fres.exponent = Bits(8, 0);
             fres.fraction = Bits(23, 0);
             out.bits = pack_f32(fres);
-            out.trace.push_back("fmul_f32: zero result");
+            trace.emit("fmul_f32: zero result");
             return out;
         }
 
@@ -528,7 +564,7 @@ namespace {
             fres.fraction = Bits(23, 0);
 
             out.bits = pack_f32(fres);
-            out.trace.push_back("fmul_f32: pre-check exponent overflow");
+            trace.emit("fmul_f32: pre-check exponent overflow");
             return out;
         }
 
@@ -552,7 +588,7 @@ namespace {
             fres.exponent = Bits(8, 0);
             fres.fraction = Bits(23, 0);
             out.bits = pack_f32(fres);
-            out.trace.push_back("fmul_f32: exponent underflow before normalization");
+            trace.emit("fmul_f32: exponent underflow before normalization");
             return out;
         }
 
@@ -582,7 +618,7 @@ namespace {
             shift_left_logical(multiplicand, 48);
         }
         // AI-END
-        out.trace.push_back("fmul_f32: after significand multiply");
+        trace.emit("fmul_f32: after significand multiply");
 
         bool high = (prod[47] == 1);
         Bits exp_res = exp_tmp;
@@ -602,7 +638,7 @@ namespace {
                 }
                 fres.fraction = Bits(23, 0);
                 out.bits = pack_f32(fres);
-                out.trace.push_back("fmul_f32: exponent overflow after normalization");
+                trace.emit("fmul_f32: exponent overflow after normalization");
                 return out;
             }
         }
@@ -626,7 +662,7 @@ namespace {
             fres.exponent = Bits(8, 0);
             fres.fraction = Bits(23, 0);
             out.bits = pack_f32(fres);
-            out.trace.push_back("fmul_f32: underflow to zero");
+            trace.emit("fmul_f32: underflow to zero");
             return out;
         }
 
@@ -640,7 +676,7 @@ namespace {
             }
             fres.fraction = Bits(23, 0);
             out.bits = pack_f32(fres);
-            out.trace.push_back("fmul_f32: overflow to inf");
+            trace.emit("fmul_f32: overflow to inf");
             return out;
         }
 
@@ -653,7 +689,204 @@ namespace {
         }
 
         out.bits = pack_f32(fres);
-        out.trace.push_back("fmul_f32: normal finite result");
+        trace.emit("fmul_f32: normal finite result");
+        return out;
+    }
+
+    /***** traced wrappers *****
+     *   The two-argument versions keep the trace in FpuResult::trace
+     ******************************/
+    FpuResult fadd_f32(const Bits& a, const Bits& b) {
+        std::vector<std::string> trace;
+        FpuResult out = fadd_f32(a, b, TraceSink(trace));
+        out.trace = std::move(trace);
+        return out;
+    }
+
+    FpuResult fsub_f32(const Bits& a, const Bits& b) {
+        std::vector<std::string> trace;
+        FpuResult out = fsub_f32(a, b, TraceSink(trace));
+        out.trace = std::move(trace);
+        return out;
+    }
+
+    FpuResult fmul_f32(const Bits& a, const Bits& b) {
+        std::vector<std::string> trace;
+        FpuResult out = fmul_f32(a, b, TraceSink(trace));
+        out.trace = std::move(trace);
+        return out;
+    }
+
+    /***** fadd_f32_u32 *****
+     *   Word-level fadd_f32
+     *   - Follows the bit-level steps one for one: align by shifting the
+     *     smaller significand, add or subtract in 24 bits, then
+     *     normalize by one step right or by leading zeros left
+     *   - Truncates like the bit-level code (no rounding, no flags)
+     ******************************
+     * Inputs:
+     *   a - first float32 value
+     *   b - second float32 value
+     * Returns:
+     *   FpuResult32
+     ******************************/
+    FpuResult32 fadd_f32_u32(uint32_t a, uint32_t b) {
+        FpuResult32 out{0, FpuFlags{false, false, false, false}};
+
+        if ((a & ~kSignMask) == 0) { out.bits = b; return out; }
+        if ((b & ~kSignMask) == 0) { out.bits = a; return out; }
+
+        uint32_t exp_a = f32_exp(a);
+        uint32_t exp_b = f32_exp(b);
+        uint32_t sig_a = f32_frac(a) | kHidden;
+        uint32_t sig_b = f32_frac(b) | kHidden;
+
+        bool a_big = exp_a >= exp_b;
+        uint32_t exp_big    = a_big ? exp_a : exp_b;
+        uint32_t exp_small  = a_big ? exp_b : exp_a;
+        uint32_t sig_big    = a_big ? sig_a : sig_b;
+        uint32_t sig_small  = a_big ? sig_b : sig_a;
+        uint32_t sign_big   = f32_sign(a_big ? a : b);
+        uint32_t sign_small = f32_sign(a_big ? b : a);
+
+        uint32_t diff_exp = exp_big - exp_small;
+        sig_small = diff_exp >= 24 ? 0 : sig_small >> diff_exp;
+
+        if (sign_big == sign_small) {
+            uint32_t sum = sig_big + sig_small;
+            uint32_t exp_res = exp_big;
+            if (sum & (kSigMask + 1)) {
+                // the carry bit is shifted out, not kept as the hidden bit
+                sum = (sum & kSigMask) >> 1;
+                exp_res = (exp_res + 1) & kExpMask;
+            }
+            out.bits = f32_pack(sign_big, exp_res, sum);
+            return out;
+        }
+
+        uint32_t result_sign = sign_big;
+        if (sig_big < sig_small) {
+            uint32_t tmp = sig_big;
+            sig_big = sig_small;
+            sig_small = tmp;
+            result_sign = sign_small;
+        } else if (sig_big == sig_small) {
+            out.bits = 0; // +0
+            return out;
+        }
+
+        uint32_t diff = sig_big - sig_small;
+        uint32_t exp_res = exp_big;
+
+        // shift left until bit 23 is set; if the exponent runs out first
+        // the bit-level loop does one more shift and wraps it to 0xff
+        uint32_t lz = static_cast<uint32_t>(std::countl_zero(diff)) - 8;
+        if (exp_res >= lz) {
+            diff <<= lz;
+            exp_res -= lz;
+        } else {
+            diff <<= exp_res + 1;
+            exp_res = kExpMask;
+        }
+
+        out.bits = f32_pack(result_sign, exp_res, diff);
+        return out;
+    }
+
+    /***** fsub_f32_u32 *****
+     *   a - b as a + (-b), like fsub_f32
+     ******************************/
+    FpuResult32 fsub_f32_u32(uint32_t a, uint32_t b) {
+        return fadd_f32_u32(a, b ^ kSignMask);
+    }
+
+    /***** fmul_f32_u32 *****
+     *   Word-level fmul_f32
+     *   - Special cases and the exponent checks are done in the same
+     *     order as the bit-level code, including the 8-bit wrap of
+     *     expA + expB before the bias is taken off
+     *   - The 24x24 significand product is one 64-bit multiply
+     ******************************
+     * Inputs:
+     *   a - first float32 value
+     *   b - second float32 value
+     * Returns:
+     *   FpuResult32
+     ******************************/
+    FpuResult32 fmul_f32_u32(uint32_t a, uint32_t b) {
+        FpuResult32 out{0, FpuFlags{false, false, false, false}};
+
+        uint32_t sign_res = f32_sign(a) ^ f32_sign(b);
+        uint32_t exp_a  = f32_exp(a);
+        uint32_t exp_b  = f32_exp(b);
+        uint32_t frac_a = f32_frac(a);
+        uint32_t frac_b = f32_frac(b);
+
+        bool a_is_zero = exp_a == 0 && frac_a == 0;
+        bool b_is_zero = exp_b == 0 && frac_b == 0;
+        bool a_is_inf  = exp_a == kExpMask && frac_a == 0;
+        bool b_is_inf  = exp_b == kExpMask && frac_b == 0;
+        bool a_is_nan  = exp_a == kExpMask && frac_a != 0;
+        bool b_is_nan  = exp_b == kExpMask && frac_b != 0;
+
+        uint32_t inf_res  = (sign_res << 31) | kInfBits;
+        uint32_t zero_res = sign_res << 31;
+
+        if (a_is_nan || b_is_nan) {
+            out.bits = kNaNBits;
+            out.flags.invalid = true;
+            return out;
+        }
+        if ((a_is_inf && b_is_zero) || (b_is_inf && a_is_zero)) {
+            out.bits = kNaNBits;
+            out.flags.invalid = true;
+            return out;
+        }
+        if (a_is_inf || b_is_inf) { out.bits = inf_res;  return out; }
+        if (a_is_zero || b_is_zero) { out.bits = zero_res; return out; }
+
+        if (exp_a + exp_b >= 382) {
+            out.flags.overflow = true;
+            out.bits = inf_res;
+            return out;
+        }
+
+        uint32_t exp_sum = (exp_a + exp_b) & kExpMask;
+        if (exp_sum < 127) {
+            out.flags.underflow = true;
+            out.bits = zero_res;
+            return out;
+        }
+        uint32_t exp_res = exp_sum - 127;
+
+        uint64_t sig_a = frac_a | (exp_a != 0 ? kHidden : 0);
+        uint64_t sig_b = frac_b | (exp_b != 0 ? kHidden : 0);
+        uint64_t prod = sig_a * sig_b;
+
+        bool high = (prod >> 47) & 1;
+        if (high) {
+            if (exp_res == kExpMask) {
+                out.flags.overflow = true;
+                out.bits = inf_res;
+                return out;
+            }
+            ++exp_res;
+        }
+
+        uint32_t sig_res = static_cast<uint32_t>(prod >> (high ? 24 : 23));
+
+        if (exp_res == 0) {
+            out.flags.underflow = true;
+            out.bits = zero_res;
+            return out;
+        }
+        if (exp_res == kExpMask) {
+            out.flags.overflow = true;
+            out.bits = inf_res;
+            return out;
+        }
+
+        out.bits = f32_pack(sign_res, exp_res, sig_res);
         return out;
     }
 
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "core/bitvec.hpp"
+#include "core/trace.hpp"
+#include <cstdint>
 #include <vector>
 #include <string>
 
@@ -47,6 +49,17 @@ namespace rv::core {
         std::vector<std::string> trace;
     };
 
+    /***** FpuResult32 *****
+     *   Word-level result of a float32 operation (no trace)
+     *
+     *   bits  - 32-bit float pattern IEEE-754
+     *   flags - info/alerts
+     ******************************/
+    struct FpuResult32 {
+        uint32_t bits;
+        FpuFlags flags;
+    };
+
     /***** unpack_f32 *****
      *   Takes a 32-bit float bit  and splits it into sign, exponent,
      *   and fraction
@@ -81,6 +94,13 @@ namespace rv::core {
      ******************************/
     FpuResult fadd_f32(const Bits& a, const Bits& b);
 
+    /***** fadd_f32 (sink) *****
+     *   Same as fadd_f32, but the trace goes to a TraceSink
+     *   - TraceSink{} (null sink) skips all trace work
+     *   - FpuResult::trace is left empty
+     ******************************/
+    FpuResult fadd_f32(const Bits& a, const Bits& b, TraceSink trace);
+
     /***** fsub_f32 *****
      *   Subtracts two float32 values
      ******************************
@@ -92,6 +112,13 @@ namespace rv::core {
      ******************************/
     FpuResult fsub_f32(const Bits& a, const Bits& b);
 
+    /***** fsub_f32 (sink) *****
+     *   Same as fsub_f32, but the trace goes to a TraceSink
+     *   - TraceSink{} (null sink) skips all trace work
+     *   - FpuResult::trace is left empty
+     ******************************/
+    FpuResult fsub_f32(const Bits& a, const Bits& b, TraceSink trace);
+
     /***** fmul_f32 *****
      *   Multiplies two float32 values
      ******************************
@@ -103,4 +130,28 @@ namespace rv::core {
      ******************************/
     FpuResult fmul_f32(const Bits& a, const Bits& b);
 
+    /***** fmul_f32 (sink) *****
+     *   Same as fmul_f32, but the trace goes to a TraceSink
+     *   - TraceSink{} (null sink) skips all trace work
+     *   - FpuResult::trace is left empty
+     ******************************/
+    FpuResult fmul_f32(const Bits& a, const Bits& b, TraceSink trace);
+
+    /***** fadd_f32_u32 / fsub_f32_u32 / fmul_f32_u32 *****
+     *   Word-level versions of fadd_f32 / fsub_f32 / fmul_f32
+     *   - Plain integer arithmetic on the packed fields
+     *   - Same result bits and flags as the bit-level code, edge cases
+     *     included (the bit-level code stays the reference)
+     *   - The TraceSink overloads use these when the sink is null
+     ******************************
+     * Inputs:
+     *   a - first float32 value
+     *   b - second float32 value
+     * Returns:
+     *   FpuResult32 - result bits and flags
+     ******************************/
+    FpuResult32 fadd_f32_u32(uint32_t a, uint32_t b);
+    FpuResult32 fsub_f32_u32(uint32_t a, uint32_t b);
+    FpuResult32 fmul_f32_u32(uint32_t a, uint32_t b);
+
 } // namespace rv::core
@@ -0,0 +1,110 @@
+#include "core/golden.hpp"
+#include "core/twos.hpp"
+#include <array>
+
+namespace rv::core {
+
+    namespace {
+
+        /***** make_mul_i8_table *****
+         *   a * b with the same steps as the bit-level MDU: split into
+         *   sign and magnitude, shift-add the magnitudes, negate if the
+         *   signs differ
+         *   - Each i8 is split once with sign_magnitude_fixed; the
+         *     65536 shift-adds run on plain words to keep the
+         *     compile-time work small
+         *   - |a|, |b| <= 128, so 8 multiplier bits are enough
+         ******************************/
+        constexpr std::array<int16_t, 65536> make_mul_i8_table() {
+            uint32_t sign[256] = {};
+            uint32_t mag[256] = {};
+            for (std::size_t i = 0; i < 256; ++i) {
+                SignMagFixed sm = sign_magnitude_fixed(encode_twos_i32_fixed(static_cast<int8_t>(i)).bits);
+                sign[i] = sm.sign;
+                mag[i]  = static_cast<uint32_t>(sm.mag.to_u64());
+            }
+
+            std::array<int16_t, 65536> t{};
+            for (std::size_t i = 0; i < t.size(); ++i) {
+                std::size_t a = i >> 8;
+                std::size_t b = i & 0xFF;
+                uint32_t acc = 0;
+                for (uint32_t bit = 0; bit < 8; ++bit) {
+                    if ((mag[b] >> bit) & 1u) acc += mag[a] << bit;
+                }
+                if (sign[a] ^ sign[b]) acc = ~acc + 1u;
+                t[i] = static_cast<int16_t>(acc);
+            }
+            return t;
+        }
+
+        constexpr std::array<int16_t, 65536> kMulI8 = make_mul_i8_table();
+
+        static_assert(kMulI8[0x0000] == 0);
+        static_assert(kMulI8[0x7F7F] == 127 * 127);
+        static_assert(kMulI8[0x8080] == 16384);         // -128 * -128
+        static_assert(kMulI8[0x7F80] == -16256);        // 127 * -128
+        static_assert(kMulI8[0xFF03] == -3);            // -1 * 3
+
+        constexpr uint32_t kBoundaryWords[] = {
+            0x00000000u, 0x00000001u, 0x00000002u, 0x7FFFFFFEu,
+            0x7FFFFFFFu, 0x80000000u, 0x80000001u, 0xFFFFFFFEu,
+            0xFFFFFFFFu, 0x00008000u, 0x0000FFFFu, 0x55555555u,
+        };
+        constexpr std::size_t kBoundaryCount = std::size(kBoundaryWords);
+
+        /***** add_sub_case *****
+         *   Expected ADD/SUB result and flags from the definitions:
+         *   - result and V from encoding the exact sum of the i32 values
+         *   - C is the carry out of a + b, or of a + (~b + 1) for SUB
+         ******************************/
+        constexpr GoldenAluCase add_sub_case(uint32_t a, uint32_t b, AluOp op) {
+            int64_t sa = decode_twos_i32_fixed(Bits32(a));
+            int64_t sb = decode_twos_i32_fixed(Bits32(b));
+            bool sub = op == AluOp::Sub;
+            EncodeI32Fixed r = encode_twos_i32_fixed(sub ? sa - sb : sa + sb);
+
+            uint32_t addend = sub ? static_cast<uint32_t>(Bits32(~uint64_t(b) + 1).to_u64()) : b;
+            Bit carry = static_cast<Bit>((uint64_t(a) + addend) >> 32);
+
+            uint32_t result = static_cast<uint32_t>(r.bits.to_u64());
+            AluFlags flags{
+                /*N=*/r.bits.msb(),
+                /*Z=*/static_cast<Bit>(r.bits.is_zero() ? 1 : 0),
+                /*C=*/carry,
+                /*V=*/static_cast<Bit>(r.overflow ? 1 : 0),
+            };
+            return GoldenAluCase{ a, b, op, result, flags };
+        }
+
+        constexpr std::array<GoldenAluCase, kBoundaryCount * kBoundaryCount * 2> make_add_sub_table() {
+            std::array<GoldenAluCase, kBoundaryCount * kBoundaryCount * 2> t{};
+            std::size_t n = 0;
+            for (uint32_t a : kBoundaryWords) {
+                for (uint32_t b : kBoundaryWords) {
+                    t[n++] = add_sub_case(a, b, AluOp::Add);
+                    t[n++] = add_sub_case(a, b, AluOp::Sub);
+                }
+            }
+            return t;
+        }
+
+        constexpr auto kAddSub = make_add_sub_table();
+
+        // INT_MAX + 1 overflows to INT_MIN; 0 - 1 borrows (C = 0)
+        static_assert(add_sub_case(0x7FFFFFFFu, 1, AluOp::Add).result == 0x80000000u);
+        static_assert(add_sub_case(0x7FFFFFFFu, 1, AluOp::Add).flags.V == 1);
+        static_assert(add_sub_case(0, 1, AluOp::Sub).flags.C == 0);
+        static_assert(add_sub_case(1, 1, AluOp::Sub).flags.Z == 1);
+
+    } // anonymous namespace
+
+    std::span<const int16_t> golden_mul_i8_table() {
+        return kMulI8;
+    }
+
+    std::span<const GoldenAluCase> golden_add_sub() {
+        return kAddSub;
+    }
+
+} // namespace rv::core
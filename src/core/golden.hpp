@@ -0,0 +1,56 @@
+#pragma once
+
+#include "core/alu.hpp"
+#include <cstdint>
+#include <span>
+
+namespace rv::core {
+
+    /***** golden tables *****
+     *   Reference values worked out at compile time with the
+     *   constexpr fixed-width layer (encode_twos_i32_fixed,
+     *   sign_magnitude_fixed, BitVec) and kept as static data, so
+     *   self-checks are lookups instead of recomputing references
+     ******************************/
+
+    /***** golden_mul_i8_table *****
+     *   Every i8 x i8 product (65536 entries)
+     *   - Index with (uint8_t(a) << 8) | uint8_t(b)
+     *   - Done as shift-add on the magnitudes, then the sign fixed up
+     ******************************/
+    std::span<const int16_t> golden_mul_i8_table();
+
+    /***** golden_mul_i8 *****
+     *   a * b looked up in golden_mul_i8_table
+     ******************************/
+    inline int16_t golden_mul_i8(int8_t a, int8_t b) {
+        std::size_t i = (std::size_t(static_cast<uint8_t>(a)) << 8) | static_cast<uint8_t>(b);
+        return golden_mul_i8_table()[i];
+    }
+
+    /***** GoldenAluCase *****
+     *   One ADD or SUB with its expected result and flags
+     *
+     *   a, b   - operands
+     *   op     - AluOp::Add or AluOp::Sub
+     *   result - expected 32-bit result
+     *   flags  - expected N/Z/C/V
+     ******************************/
+    struct GoldenAluCase {
+        uint32_t a;
+        uint32_t b;
+        AluOp    op;
+        uint32_t result;
+        AluFlags flags;
+    };
+
+    /***** golden_add_sub *****
+     *   ADD and SUB on every pair of boundary words (0, 1, 2,
+     *   INT_MAX - 1, INT_MAX, INT_MIN, INT_MIN + 1, -2, -1, 0x8000,
+     *   0xffff, 0x55555555)
+     *   - The flags come from the 2's comp definitions (V is "the
+     *     exact result does not fit in i32"), not from alu_execute
+     ******************************/
+    std::span<const GoldenAluCase> golden_add_sub();
+
+} // namespace rv::core
@@ -1,77 +1,103 @@
 #include "core/mdu.hpp"
 #include "core/bitvec.hpp"
+#include "core/bitvec_fixed.hpp"
 #include "core/twos.hpp"
 #include <cassert>
+#include <charconv>
+#include <string_view>
 
 namespace rv::core {
 
     namespace {
 
-        /***** AddResult *****
-         *   The result of adding two bit vectors
-         *   sum       - the bitwise sum
-         *   carry_out
+        /***** StepLine *****
+         *   Formats one "step N: A=0x.. B=0x.." trace line in a stack
+         *   buffer, so a live sink costs no heap per line
+         *   - Hex is lowercase with leading zeros trimmed, the same
+         *     text as Bits32::to_hex
          ******************************/
-        struct AddResult {
-            Bits sum;
-            Bit  carry_out;
+        class StepLine {
+        public:
+            std::string_view format(unsigned step, const char* a_name, uint64_t a,
+                                    const char* b_name, uint64_t b) {
+                p_ = buf_;
+                put("step ");
+                p_ = std::to_chars(p_, end(), step).ptr;
+                put(": ");
+                put_field(a_name, a);
+                put(" ");
+                put_field(b_name, b);
+                return std::string_view(buf_, static_cast<std::size_t>(p_ - buf_));
+            }
+
+        private:
+            char* end() { return buf_ + sizeof buf_; }
+
+            void put(std::string_view s) {
+                for (char c : s) *p_++ = c;
+            }
+
+            void put_field(const char* name, uint64_t v) {
+                put(name);
+                put("=0x");
+                p_ = std::to_chars(p_, end(), v & 0xFFFFFFFFu, 16).ptr;
+            }
+
+            char  buf_[64];
+            char* p_ = buf_;
         };
 
-        /***** add_fixed_width *****
-         *   Adds two bit vectors as unsigned numbers
+        /***** add_32 *****
+         *   Adds two 32-bit values as unsigned numbers, one bit at a time
          ******************************
          * Inputs:
-         *   a, b  - input bits
-         *   width - how many bits to keep
+         *   a, b      - input bits
+         *   carry_out - set to the carry out of bit 31
          * Returns:
-         *   AddResult - sum bits + carry_out
+         *   Bits32 - sum bits
          ******************************/
-        AddResult add_fixed_width(const Bits& a, const Bits& b, std::size_t width) {
-            Bits sum(width, 0);
+        Bits32 add_32(const Bits32& a, const Bits32& b, Bit& carry_out) {
+            Bits32 sum;
             Bit carry = 0;
 
-            for (std::size_t i = 0; i < width; ++i) {
-                Bit ai = (i < a.size()) ? a[i] : 0;
-                Bit bi = (i < b.size()) ? b[i] : 0;
+            for (std::size_t i = 0; i < 32; ++i) {
+                Bit ai = a[i];
+                Bit bi = b[i];
 
                 Bit partial    = ai ^ bi;
                 Bit s          = partial ^ carry;
                 Bit carry_next = (ai & bi) | (ai & carry) | (bi & carry);
 
-                sum[i] = s;
-                carry  = carry_next;
+                sum.set(i, s);
+                carry = carry_next;
             }
 
-            AddResult res{ sum, carry };
-            return res;
+            carry_out = carry;
+            return sum;
         }
 
         /***** twos_negate_fixed *****
          *   Computes the 2's comp negative of a value
          *   - First flips all bits
-         *   - Then adds 1 using the same adder
+         *   - Then adds 1 with a ripple carry
          *   - Any carry past the top bit is thrown away
          ******************************
          * Inputs:
-         *   v     - original value bits
-         *   width - how many bits to use for the result
+         *   v - original value bits (N wide)
          * Returns:
-         *   Bits - negative of v in 2's comp
+         *   BitVec<N> - negative of v in 2's comp
          ******************************/
-        Bits twos_negate_fixed(const Bits& v, std::size_t width) {
-            Bits inv(width, 0);
-            for (std::size_t i = 0; i < width; ++i) {
-                Bit bit = (i < v.size()) ? v[i] : 0;
-                inv[i] = bit ^ 1;
+        template <std::size_t N>
+        BitVec<N> twos_negate_fixed(const BitVec<N>& v) {
+            BitVec<N> out = ~v;
+
+            Bit carry = 1;
+            for (std::size_t i = 0; i < N && carry; ++i) {
+                Bit bit = out[i];
+                out.set(i, bit ^ carry);
+                carry = bit & carry;
             }
-
-            Bits one(width, 0);
-            one[0] = 1;
-
-            AddResult add_res = add_fixed_width(inv, one, width);
-            (void)add_res;
-
-            return add_res.sum;
+            return out;
         }
 
         /***** compare_unsigned_32 *****
@@ -82,13 +108,10 @@ namespace rv::core {
          *    0 if a == b
          *    1 if a > b
          ******************************/
-        int compare_unsigned_32(const Bits& a, const Bits& b) {
-            assert(a.size() == 32);
-            assert(b.size() == 32);
-
-            for (int i = 31; i >= 0; --i) {
-                if (a[static_cast<std::size_t>(i)] != b[static_cast<std::size_t>(i)]) {
-                    return (a[static_cast<std::size_t>(i)] < b[static_cast<std::size_t>(i)]) ? -1 : 1;
+        int compare_unsigned_32(const Bits32& a, const Bits32& b) {
+            for (std::size_t i = 32; i-- > 0; ) {
+                if (a[i] != b[i]) {
+                    return (a[i] < b[i]) ? -1 : 1;
                 }
             }
             return 0;
@@ -98,13 +121,10 @@ namespace rv::core {
          *   Subtracts two 32-bit unsigned values: a - b.
          * *****************************
          * Returns:
-         *   Bits - 32-bit diff
+         *   Bits32 - 32-bit diff
          ******************************/
-        Bits subtract_unsigned_32(const Bits& a, const Bits& b) {
-            assert(a.size() == 32);
-            assert(b.size() == 32);
-
-            Bits diff(32, 0);
+        Bits32 subtract_unsigned_32(const Bits32& a, const Bits32& b) {
+            Bits32 diff;
             Bit borrow = 0;
 
             for (std::size_t i = 0; i < 32; ++i) {
@@ -113,7 +133,7 @@ namespace rv::core {
                 Bit bin = borrow;
 
                 Bit d = ai ^ bi ^ bin;
-                diff[i] = d;
+                diff.set(i, d);
 
                 Bit not_ai = ai ^ 1;
                 Bit borrow_out = (not_ai & (bi | bin)) | (bi & bin);
@@ -123,39 +143,12 @@ namespace rv::core {
             return diff;
         }
 
-        /***** is_zero_32 *****
-         *   Checks if a 32-bit value is exactly zero
-         ******************************/
-        bool is_zero_32(const Bits& x) {
-            assert(x.size() == 32);
-            for (Bit bit : x) {
-                if (bit != 0) return false;
-            }
-            return true;
-        }
-
-        /***** is_all_ones_32 *****
-         *   Checks if a 32-bit value is all 1s
-         ******************************/
-        bool is_all_ones_32(const Bits& x) {
-            assert(x.size() == 32);
-            for (Bit bit : x) {
-                if (bit != 1) return false;
-            }
-            return true;
-        }
-
         /***** is_int_min_32 *****
          *   Checks if a 32-bit value is the minimum signed int
+         *   0x80000000 → MSB (bit 31) = 1, all others 0
          ******************************/
-        bool is_int_min_32(const Bits& x) {
-            assert(x.size() == 32);
-            // 0x80000000 → MSB (bit 31) = 1, all others 0
-            if (x[31] != 1) return false;
-            for (std::size_t i = 0; i < 31; ++i) {
-                if (x[i] != 0) return false;
-            }
-            return true;
+        bool is_int_min_32(const Bits32& x) {
+            return x == Bits32(0x80000000u);
         }
 
         /***** UnsignedDivResult *****
@@ -163,12 +156,10 @@ namespace rv::core {
          *
          *   q     - quotient bits
          *   r     - remainder bits
-         *   trace
          ******************************/
         struct UnsignedDivResult {
-            Bits q;
-            Bits r;
-            std::vector<std::string> trace;
+            Bits32 q;
+            Bits32 r;
         };
 
         /***** div_unsigned_32 *****
@@ -177,48 +168,245 @@ namespace rv::core {
          * Inputs:
          *   dividend - 32-bit unsigned value
          *   divisor  - 32-bit unsigned value
+         *   trace    - gets one line per step (if enabled)
          * Returns:
          *   UnsignedDivResult
          ******************************/
-        UnsignedDivResult div_unsigned_32(const Bits& dividend, const Bits& divisor) {
-            assert(dividend.size() == 32);
-            assert(divisor.size() == 32);
-            assert(!is_zero_32(divisor));
-
-            Bits R(32, 0);
-            Bits Q(32, 0);
+        UnsignedDivResult div_unsigned_32(const Bits32& dividend, const Bits32& divisor, TraceSink trace) {
+            assert(!divisor.is_zero());
 
-            std::vector<std::string> trace;
+            Bits32 R;
+            Bits32 Q;
 
+            StepLine line;
             auto snapshot = [&](int step) {
-                std::string msg = "step " + std::to_string(step) +
-                                  ": R=" + bv_to_hex_string(R) +
-                                  " Q=" + bv_to_hex_string(Q);
-                trace.push_back(msg);
+                if (!trace.enabled()) return;
+                trace.emit(line.format(static_cast<unsigned>(step), "R", R.to_u64(), "Q", Q.to_u64()));
             };
             // AI-BEGIN: LOGIC & CODE HELP
             for (int i = 31; i >= 0; --i) {
                 // Shift R left by 1.
-                for (int j = 31; j >= 1; --j) {
-                    R[static_cast<std::size_t>(j)] = R[static_cast<std::size_t>(j - 1)];
-                }
-                R[0] = 0;
+                R <<= 1;
 
-                R[0] = dividend[static_cast<std::size_t>(i)];
+                R.set(0, dividend[static_cast<std::size_t>(i)]);
 
                 int cmp = compare_unsigned_32(R, divisor);
                 if (cmp >= 0) {
                     R = subtract_unsigned_32(R, divisor);
-                    Q[static_cast<std::size_t>(i)] = 1;
+                    Q.set(static_cast<std::size_t>(i), 1);
                 } else {
-                    Q[static_cast<std::size_t>(i)] = 0;
+                    Q.set(static_cast<std::size_t>(i), 0);
                 }
                 snapshot(31 - i);
             }
-            UnsignedDivResult res{ Q, R, trace };
+            UnsignedDivResult res{ Q, R };
             return res;
             // AI-END
         }
+
+        /***** mul_booth4 *****
+         *   Unsigned 32x32 -> 64 multiply, radix-4 Booth
+         *   - Each step recodes bits (2i+1, 2i, 2i-1) of b into a digit
+         *     in -2..2 and adds digit * a << 2i; 17 steps cover b with a
+         *     zero bit on top, so no sign fix-up is needed
+         *   - Works mod 2^64; the true product always fits
+         ******************************/
+        uint64_t mul_booth4(uint32_t a, uint32_t b) {
+            static constexpr int64_t kDigit[8] = { 0, 1, 1, 2, -2, -1, -1, 0 };
+
+            const int64_t m  = a;
+            const uint64_t bb = uint64_t(b) << 1; // bit -1 is 0
+            uint64_t acc = 0;
+            for (unsigned i = 0; i < 17; ++i) {
+                int64_t digit = kDigit[(bb >> (2 * i)) & 7u];
+                acc += static_cast<uint64_t>(digit * m) << (2 * i);
+            }
+            return acc;
+        }
+
+        /***** mul_radix16 *****
+         *   Unsigned 32x32 -> 64 multiply, four bits of b per step
+         *   - a * 0 .. a * 15 go in a table first, so each step is one
+         *     lookup, shift and add
+         ******************************/
+        uint64_t mul_radix16(uint32_t a, uint32_t b) {
+            uint64_t table[16];
+            table[0] = 0;
+            for (unsigned k = 1; k < 16; ++k) table[k] = table[k - 1] + a;
+
+            uint64_t acc = 0;
+            for (unsigned i = 0; i < 8; ++i) {
+                acc += table[(b >> (4 * i)) & 15u] << (4 * i);
+            }
+            return acc;
+        }
+
+        /***** PackedDiv *****
+         *   Quotient and remainder of an unsigned packed divide
+         ******************************/
+        struct PackedDiv {
+            uint32_t q;
+            uint32_t r;
+        };
+
+        /***** div_radix *****
+         *   Unsigned divide, K quotient bits per step (K = 2 or 4)
+         *   - d * 0 .. d * (2^K - 1) go in a table; each step shifts K
+         *     dividend bits into the partial remainder and picks the
+         *     largest multiple that fits with a binary search
+         *   - The partial remainder stays below d, so the digit always
+         *     fits in K bits
+         ******************************/
+        template <unsigned K>
+        PackedDiv div_radix(uint32_t n, uint32_t d) {
+            static_assert(32 % K == 0, "K must divide 32");
+            constexpr unsigned kRadix = 1u << K;
+            assert(d != 0);
+
+            uint64_t table[kRadix];
+            table[0] = 0;
+            for (unsigned k = 1; k < kRadix; ++k) table[k] = table[k - 1] + d;
+
+            uint64_t r = 0;
+            uint32_t q = 0;
+            for (unsigned i = 32 / K; i-- > 0; ) {
+                r = (r << K) | ((n >> (K * i)) & (kRadix - 1));
+                unsigned digit = 0;
+                for (unsigned step = kRadix / 2; step != 0; step >>= 1) {
+                    if (table[digit + step] <= r) digit += step;
+                }
+                r -= table[digit];
+                q = (q << K) | digit;
+            }
+            return PackedDiv{ q, static_cast<uint32_t>(r) };
+        }
+
+        /***** mul_packed / div_packed *****
+         *   Unsigned packed-word core for a packed MduEngine
+         ******************************/
+        uint64_t mul_packed(MduEngine engine, uint32_t a, uint32_t b) {
+            return engine == MduEngine::Radix16 ? mul_radix16(a, b) : mul_booth4(a, b);
+        }
+
+        PackedDiv div_packed(MduEngine engine, uint32_t n, uint32_t d) {
+            return engine == MduEngine::Radix16 ? div_radix<4>(n, d) : div_radix<2>(n, d);
+        }
+
+        /***** emit_mul_steps *****
+         *   The BitSerial multiply trace, from packed magnitudes
+         *   - After k shift-add steps the accumulator pair holds
+         *     (a * (b mod 2^k)) << (32 - k) on top of b >> k
+         ******************************/
+        void emit_mul_steps(TraceSink trace, uint32_t a, uint32_t b) {
+            StepLine line;
+            for (unsigned k = 0; k <= 32; ++k) {
+                uint64_t low = (k == 32) ? b : (b & ((uint32_t(1) << k) - 1));
+                uint64_t p = ((a * low) << (32 - k)) | (uint64_t(b) >> k);
+                trace.emit(line.format(k, "acc", p >> 32, "mul", p));
+            }
+        }
+
+        /***** emit_div_steps *****
+         *   The BitSerial divide trace, from packed magnitudes
+         *   - Runs the one-bit restoring recurrence on words to get
+         *     R and Q after each step
+         ******************************/
+        void emit_div_steps(TraceSink trace, uint32_t n, uint32_t d) {
+            StepLine line;
+            uint64_t r = 0;
+            uint32_t q = 0;
+            for (int i = 31; i >= 0; --i) {
+                r = (r << 1) | ((n >> i) & 1u);
+                if (r >= d) {
+                    r -= d;
+                    q |= uint32_t(1) << i;
+                }
+                trace.emit(line.format(static_cast<unsigned>(31 - i), "R", r, "Q", q));
+            }
+        }
+
+        /***** packed_sign_mag *****
+         *   Sign bit and magnitude of a 32-bit 2's comp word, through
+         *   the branchless sign_magnitude_fixed
+         *   - INT_MIN gives magnitude 0x80000000, like
+         *     decode_i32_to_sign_and_magnitude
+         ******************************/
+        struct PackedSignMag {
+            uint32_t sign;
+            uint32_t mag;
+        };
+
+        PackedSignMag packed_sign_mag(uint32_t v) {
+            SignMagFixed sm = sign_magnitude_fixed(Bits32(v));
+            return PackedSignMag{ uint32_t(sm.sign), static_cast<uint32_t>(sm.mag.to_u64()) };
+        }
+
+        /***** apply_sign *****
+         *   v if sign is 0, -v if it is 1, without a branch
+         ******************************/
+        template <typename U>
+        U apply_sign(U v, uint32_t sign) {
+            U mask = U(0) - U(sign);
+            return (v ^ mask) - mask;
+        }
+
+        /***** mdu_mul_packed *****
+         *   mdu_mul for the packed engines: same sign handling and
+         *   overflow rule as the bit-serial path
+         ******************************/
+        MulResult mdu_mul_packed(const Bits& rs1, const Bits& rs2, TraceSink trace,
+                                 MduEngine engine) {
+            PackedSignMag sm1 = packed_sign_mag(static_cast<uint32_t>(Bits32(rs1).to_u64()));
+            PackedSignMag sm2 = packed_sign_mag(static_cast<uint32_t>(Bits32(rs2).to_u64()));
+
+            if (trace.enabled()) emit_mul_steps(trace, sm1.mag, sm2.mag);
+
+            uint64_t prod = apply_sign(mul_packed(engine, sm1.mag, sm2.mag), sm1.sign ^ sm2.sign);
+
+            int64_t sprod = static_cast<int64_t>(prod);
+            MulResult res{
+                /*lo=*/Bits32(prod),
+                /*hi=*/Bits32(prod >> 32),
+                /*overflow=*/sprod != static_cast<int32_t>(sprod),
+                /*trace=*/{}
+            };
+            return res;
+        }
+
+        /***** mdu_div_packed *****
+         *   mdu_div for the packed engines: same op coverage, special
+         *   cases and trace lines as the bit-serial path
+         ******************************/
+        DivResult mdu_div_packed(DivOp op, const Bits& rs1, const Bits& rs2, TraceSink trace,
+                                 MduEngine engine) {
+            if (op != DivOp::Div) {
+                return DivResult{ Bits(32, 0), Bits(32, 0), false, {} };
+            }
+
+            uint32_t n = static_cast<uint32_t>(Bits32(rs1).to_u64());
+            uint32_t d = static_cast<uint32_t>(Bits32(rs2).to_u64());
+
+            if (d == 0) {
+                trace.emit("divide-by-zero: q=-1, r=dividend");
+                return DivResult{ Bits(32, 1), Bits32(n), false, {} };
+            }
+
+            if (n == 0x80000000u && d == 0xffffffffu) {
+                trace.emit("INT_MIN / -1 special case");
+                return DivResult{ Bits32(n), Bits(32, 0), true, {} };
+            }
+
+            PackedSignMag sm1 = packed_sign_mag(n);
+            PackedSignMag sm2 = packed_sign_mag(d);
+
+            if (trace.enabled()) emit_div_steps(trace, sm1.mag, sm2.mag);
+
+            PackedDiv u = div_packed(engine, sm1.mag, sm2.mag);
+            uint32_t q = apply_sign(u.q, sm1.sign ^ sm2.sign);
+            uint32_t r = apply_sign(u.r, sm1.sign);
+
+            return DivResult{ Bits32(q), Bits32(r), false, {} };
+        }
     } // anonymous namespace
 
     /***** mdu_mul *****
@@ -227,79 +415,52 @@ namespace rv::core {
      *   - Right now, it behaves like MUL
      *   - The MulOp parameter is ignored right now
      ******************************/
-    MulResult mdu_mul(MulOp op, const Bits& rs1, const Bits& rs2) {
-        Bits rs1_32 = zero_extend(rs1, 32);
-        Bits rs2_32 = zero_extend(rs2, 32);
+    MulResult mdu_mul(MulOp op, const Bits& rs1, const Bits& rs2, TraceSink trace,
+                      MduEngine engine) {
+        (void)op;
+        if (engine != MduEngine::BitSerial) return mdu_mul_packed(rs1, rs2, trace, engine);
 
-        SignMag32 sm1 = decode_i32_to_sign_and_magnitude(rs1_32);
-        SignMag32 sm2 = decode_i32_to_sign_and_magnitude(rs2_32);
+        Bits32 rs1_32(rs1);
+        Bits32 rs2_32(rs2);
+
+        SignMagFixed sm1 = sign_magnitude_fixed(rs1_32);
+        SignMagFixed sm2 = sign_magnitude_fixed(rs2_32);
 
         Bit sign1 = sm1.sign;
         Bit sign2 = sm2.sign;
         Bit sign_res = sign1 ^ sign2;
 
-        Bits mag1_32 = zero_extend(sm1.mag, 32);
-        Bits mag2_32 = zero_extend(sm2.mag, 32);
-
-        Bits p(64, 0);
-        for (std::size_t i = 0; i < 32; ++i) {
-            p[i] = mag2_32[i];
-        }
+        const Bits32& mag1_32 = sm1.mag;
+        const Bits32& mag2_32 = sm2.mag;
 
-        std::vector<std::string> trace;
+        // p = acc (high 32) : multiplier (low 32)
+        Bits64 p = mag2_32.zero_extend<64>();
 
+        StepLine line;
         auto snapshot = [&](std::size_t step) {
-            Bits lo(32, 0);
-            Bits hi(32, 0);
-            for (std::size_t i = 0; i < 32; ++i) {
-                lo[i] = p[i];
-                hi[i] = p[32 + i];
-            }
-            std::string msg = "step " + std::to_string(step) +
-                              ": acc=" + bv_to_hex_string(hi) +
-                              " mul=" + bv_to_hex_string(lo);
-            trace.push_back(msg);
+            if (!trace.enabled()) return;
+            trace.emit(line.format(static_cast<unsigned>(step), "acc", p.slice<63, 32>().to_u64(),
+                                   "mul", p.slice<31, 0>().to_u64()));
         };
 
         for (std::size_t step = 0; step < 32; ++step) {
             snapshot(step);
 
             if (p[0] == 1) {
-                Bits hi(32, 0);
-                for (std::size_t i = 0; i < 32; ++i) {
-                    hi[i] = p[32 + i];
-                }
-
-                AddResult add_res = add_fixed_width(hi, mag1_32, 32);
+                Bit carry = 0;
+                Bits32 sum = add_32(p.slice<63, 32>(), mag1_32, carry);
 
                 for (std::size_t i = 0; i < 32; ++i) {
-                    p[32 + i] = add_res.sum[i];
+                    p.set(32 + i, sum[i]);
                 }
             }
 
-            for (std::size_t i = 0; i + 1 < 64; ++i) {
-                p[i] = p[i + 1];
-            }
-            p[63] = 0;
+            p >>= 1;
         }
 
         snapshot(32);
 
-        Bits mag_prod_64 = p; // 64 bits
-
-        Bits signed_prod_64(64, 0);
-        if (sign_res == 0) {
-            signed_prod_64 = mag_prod_64;
-        } else {
-            signed_prod_64 = twos_negate_fixed(mag_prod_64, 64);
-        }
-
-        Bits lo(32, 0);
-        Bits hi(32, 0);
-        for (std::size_t i = 0; i < 32; ++i) {
-            lo[i] = signed_prod_64[i];
-            hi[i] = signed_prod_64[32 + i];
-        }
+        Bits64 signed_prod_64 = (sign_res == 0) ? p : twos_negate_fixed(p);
 
         Bit sign32 = signed_prod_64[31];
         bool overflow = false;
@@ -311,14 +472,12 @@ namespace rv::core {
         }
 
         MulResult res{
-            /*lo=*/lo,
-            /*hi=*/hi,
+            /*lo=*/signed_prod_64.slice<31, 0>(),
+            /*hi=*/signed_prod_64.slice<63, 32>(),
             /*overflow=*/overflow,
-            /*trace=*/trace
+            /*trace=*/{}
         };
 
-        (void)op;
-
         return res;
     }
 
@@ -330,15 +489,19 @@ namespace rv::core {
      *   - Handles special RISC-V rules:
      ******************************
      * Inputs:
-     *   op  - which divide/remainder mode to use
-     *   rs1 - dividend
-     *   rs2 - divisor
+     *   op     - which divide/remainder mode to use
+     *   rs1    - dividend
+     *   rs2    - divisor
+     *   engine - BitSerial runs below; the others go to mdu_div_packed
      * Returns:
      *   DivResult
      ******************************/
-    DivResult mdu_div(DivOp op, const Bits& rs1, const Bits& rs2) {
-        Bits rs1_32 = zero_extend(rs1, 32); // dividend
-        Bits rs2_32 = zero_extend(rs2, 32); // divisor
+    DivResult mdu_div(DivOp op, const Bits& rs1, const Bits& rs2, TraceSink trace,
+                      MduEngine engine) {
+        if (engine != MduEngine::BitSerial) return mdu_div_packed(op, rs1, rs2, trace, engine);
+
+        Bits32 rs1_32(rs1); // dividend
+        Bits32 rs2_32(rs2); // divisor
 
         if (op != DivOp::Div) {
             Bits q(32, 0);
@@ -347,31 +510,29 @@ namespace rv::core {
             return res;
         }
 
-        SignMag32 sm1 = decode_i32_to_sign_and_magnitude(rs1_32);
-        SignMag32 sm2 = decode_i32_to_sign_and_magnitude(rs2_32);
+        SignMagFixed sm1 = sign_magnitude_fixed(rs1_32);
+        SignMagFixed sm2 = sign_magnitude_fixed(rs2_32);
 
-        Bits mag1 = zero_extend(sm1.mag, 32);
-        Bits mag2 = zero_extend(sm2.mag, 32);
+        const Bits32& mag1 = sm1.mag;
+        const Bits32& mag2 = sm2.mag;
 
-        bool divisor_is_zero = is_zero_32(mag2);
+        bool divisor_is_zero = mag2.is_zero();
         bool dividend_is_int_min = is_int_min_32(rs1_32);
-        bool divisor_is_minus_one = is_all_ones_32(rs2_32);
+        bool divisor_is_minus_one = rs2_32.is_all_ones();
 
         if (divisor_is_zero) {
             Bits q(32, 1);
             Bits r = rs1_32;
-            std::vector<std::string> trace;
-            trace.push_back("divide-by-zero: q=-1, r=dividend");
-            DivResult res{ q, r, false, trace };
+            trace.emit("divide-by-zero: q=-1, r=dividend");
+            DivResult res{ q, r, false, {} };
             return res;
         }
 
         if (dividend_is_int_min && divisor_is_minus_one) {
             Bits q = rs1_32;
             Bits r(32, 0);
-            std::vector<std::string> trace;
-            trace.push_back("INT_MIN / -1 special case");
-            DivResult res{ q, r, true, trace };
+            trace.emit("INT_MIN / -1 special case");
+            DivResult res{ q, r, true, {} };
             return res;
         }
 
@@ -379,23 +540,10 @@ namespace rv::core {
         Bit sign2 = sm2.sign;
         Bit sign_q = sign1 ^ sign2;
 
-        UnsignedDivResult ures = div_unsigned_32(mag1, mag2);
-        Bits q_abs = ures.q;
-        Bits r_abs = ures.r;
-
-        Bits q_signed(32, 0);
-        if (sign_q == 0) {
-            q_signed = q_abs;
-        } else {
-            q_signed = twos_negate_fixed(q_abs, 32);
-        }
+        UnsignedDivResult ures = div_unsigned_32(mag1, mag2, trace);
 
-        Bits r_signed(32, 0);
-        if (sign1 == 0) {
-            r_signed = r_abs;
-        } else {
-            r_signed = twos_negate_fixed(r_abs, 32);
-        }
+        Bits32 q_signed = (sign_q == 0) ? ures.q : twos_negate_fixed(ures.q);
+        Bits32 r_signed = (sign1 == 0)  ? ures.r : twos_negate_fixed(ures.r);
 
         bool overflow = false;
 
@@ -403,8 +551,93 @@ namespace rv::core {
             /*q=*/q_signed,
             /*r=*/r_signed,
             /*overflow=*/overflow,
-            /*trace=*/ures.trace
+            /*trace=*/{}
         };
         return res;
     }
+
+    /***** mdu_mul_u32 *****
+     *   Multiplies two packed words with one 64-bit multiply
+     ******************************/
+    MulResult32 mdu_mul_u32(MulOp op, uint32_t rs1, uint32_t rs2) {
+        int64_t  s1 = static_cast<int32_t>(rs1);
+        int64_t  s2 = static_cast<int32_t>(rs2);
+        uint64_t u1 = rs1;
+        uint64_t u2 = rs2;
+
+        uint64_t prod = 0;
+        bool overflow = false;
+
+        switch (op) {
+            case MulOp::Mul:
+            case MulOp::Mulh: {
+                int64_t p = s1 * s2;
+                prod = static_cast<uint64_t>(p);
+                overflow = (p != static_cast<int32_t>(p));
+                break;
+            }
+            case MulOp::Mulhu: {
+                prod = u1 * u2;
+                overflow = (prod >> 32) != 0;
+                break;
+            }
+            case MulOp::Mulhsu: {
+                // |s1| < 2^32 and u2 < 2^32, so the product fits in int64
+                int64_t p = s1 * static_cast<int64_t>(u2);
+                prod = static_cast<uint64_t>(p);
+                overflow = (p != static_cast<int32_t>(p));
+                break;
+            }
+        }
+
+        MulResult32 res{
+            /*lo=*/static_cast<uint32_t>(prod),
+            /*hi=*/static_cast<uint32_t>(prod >> 32),
+            /*overflow=*/overflow
+        };
+        return res;
+    }
+
+    /***** mdu_div_u32 *****
+     *   Divides two packed words, with the RISC-V special cases
+     ******************************/
+    DivResult32 mdu_div_u32(DivOp op, uint32_t rs1, uint32_t rs2) {
+        if (rs2 == 0) {
+            return DivResult32{ 0xffffffffu, rs1, false };
+        }
+
+        bool is_signed = (op == DivOp::Div || op == DivOp::Rem);
+        if (!is_signed) {
+            return DivResult32{ rs1 / rs2, rs1 % rs2, false };
+        }
+
+        if (rs1 == 0x80000000u && rs2 == 0xffffffffu) {
+            return DivResult32{ rs1, 0u, true };
+        }
+
+        int32_t a = static_cast<int32_t>(rs1);
+        int32_t b = static_cast<int32_t>(rs2);
+        return DivResult32{
+            static_cast<uint32_t>(a / b), // C++ truncates toward zero, like RISC-V
+            static_cast<uint32_t>(a % b),
+            false
+        };
+    }
+
+    /***** traced wrappers *****
+     *   The three-argument versions keep the trace in the result
+     ******************************/
+    MulResult mdu_mul(MulOp op, const Bits& rs1, const Bits& rs2) {
+        std::vector<std::string> trace;
+        MulResult res = mdu_mul(op, rs1, rs2, TraceSink(trace));
+        res.trace = std::move(trace);
+        return res;
+    }
+
+    DivResult mdu_div(DivOp op, const Bits& rs1, const Bits& rs2) {
+        std::vector<std::string> trace;
+        DivResult res = mdu_div(op, rs1, rs2, TraceSink(trace));
+        res.trace = std::move(trace);
+        return res;
+    }
 } // namespace rv::core
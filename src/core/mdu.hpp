@@ -1,6 +1,7 @@
 #pragma once
 
 #include "core/bitvec.hpp"
+#include "core/trace.hpp"
 #include <string>
 #include <vector>
 #include <cstdint>
@@ -38,6 +39,26 @@ namespace rv::core {
         Remu
     };
 
+    /***** MduEngine *****
+     *   How mdu_mul / mdu_div do the work
+     *
+     * Values:
+     *   BitSerial - the reference: one bit per step on bit vectors
+     *   Radix4    - packed words, two bits per step (radix-4 Booth
+     *               multiply, radix-4 divide against d, 2d, 3d)
+     *   Radix16   - packed words, four bits per step, with the
+     *               multiples of the operand in a 16-entry table
+     *
+     *   Every engine gives the same MulResult / DivResult, trace
+     *   included: with a live sink the packed engines emit the same
+     *   per-bit step lines as BitSerial.
+     ******************************/
+    enum class MduEngine {
+        BitSerial,
+        Radix4,
+        Radix16
+    };
+
     /***** MulResult *****
      *   The result of a multiply
      *
@@ -80,6 +101,15 @@ namespace rv::core {
      ******************************/
     MulResult mdu_mul(MulOp op, const Bits& rs1, const Bits& rs2);
 
+    /***** mdu_mul (sink) *****
+     *   Same as mdu_mul, but the step trace goes to a TraceSink
+     *   - TraceSink{} (null sink) skips all string formatting
+     *   - MulResult::trace is left empty
+     *   - engine picks the algorithm (see MduEngine)
+     ******************************/
+    MulResult mdu_mul(MulOp op, const Bits& rs1, const Bits& rs2, TraceSink trace,
+                      MduEngine engine = MduEngine::BitSerial);
+
     /***** mdu_div *****
      *   Divides one 32-bit value
      ******************************
@@ -92,4 +122,63 @@ namespace rv::core {
      ******************************/
     DivResult mdu_div(DivOp op, const Bits& rs1, const Bits& rs2);
 
+    /***** mdu_div (sink) *****
+     *   Same as mdu_div, but the step trace goes to a TraceSink
+     *   - TraceSink{} (null sink) skips all string formatting
+     *   - DivResult::trace is left empty
+     *   - engine picks the algorithm (see MduEngine)
+     ******************************/
+    DivResult mdu_div(DivOp op, const Bits& rs1, const Bits& rs2, TraceSink trace,
+                      MduEngine engine = MduEngine::BitSerial);
+
+    /***** MulResult32 / DivResult32 *****
+     *   Packed-word versions of MulResult and DivResult (no trace)
+     ******************************/
+    struct MulResult32 {
+        uint32_t lo;
+        uint32_t hi;
+        bool     overflow;
+    };
+
+    struct DivResult32 {
+        uint32_t q;
+        uint32_t r;
+        bool     overflow;
+    };
+
+    /***** mdu_mul_u32 *****
+     *   Word-level multiply with the RISC-V M semantics
+     *   - lo is the low 32 bits of the product for every op
+     *   - hi is the high 32 bits of signed*signed (Mul, Mulh),
+     *     unsigned*unsigned (Mulhu) or signed*unsigned (Mulhsu)
+     *   - overflow is true if the full product does not fit in 32 bits
+     *     (signed range, or unsigned range for Mulhu)
+     *   - For Mul and Mulh this gives the same values as mdu_mul
+     ******************************
+     * Inputs:
+     *   op  - which multiply mode to use
+     *   rs1 - first operand
+     *   rs2 - second operand
+     * Returns:
+     *   MulResult32
+     ******************************/
+    MulResult32 mdu_mul_u32(MulOp op, uint32_t rs1, uint32_t rs2);
+
+    /***** mdu_div_u32 *****
+     *   Word-level divide with the RISC-V M semantics
+     *   - Div/Rem are signed, Divu/Remu are unsigned; q and r are
+     *     filled either way
+     *   - Divide by zero: q = all ones, r = dividend
+     *   - INT_MIN / -1 (signed): q = INT_MIN, r = 0, overflow = true
+     *   - For Div this gives the same values as mdu_div
+     ******************************
+     * Inputs:
+     *   op  - which divide mode to use
+     *   rs1 - dividend
+     *   rs2 - divisor
+     * Returns:
+     *   DivResult32
+     ******************************/
+    DivResult32 mdu_div_u32(DivOp op, uint32_t rs1, uint32_t rs2);
+
 } // namespace rv::core
@@ -0,0 +1,228 @@
+#include "core/rv32_block.hpp"
+#include <algorithm>
+
+namespace rv::cpu {
+
+    namespace {
+
+        /***** ends_block *****
+         *   True for the instructions that can move pc somewhere other
+         *   than pc + 4
+         ******************************/
+        bool ends_block(const DecodedInstr& d) {
+            return d.format == InstrFormat::B      // conditional branches
+                || d.opcode == 0x6F                // JAL
+                || d.opcode == 0x67                // JALR
+                || d.opcode == 0x73;               // ECALL / EBREAK
+        }
+
+        /***** access_width *****
+         *   Bytes a load/store kind touches, 0 for anything else
+         ******************************/
+        uint32_t access_width(InstrKind k) {
+            switch (k) {
+                case InstrKind::Lb: case InstrKind::Lbu: case InstrKind::Sb:
+                    return 1;
+                case InstrKind::Lh: case InstrKind::Lhu: case InstrKind::Sh:
+                    return 2;
+                case InstrKind::Lw: case InstrKind::Sw:
+                case InstrKind::Flw: case InstrKind::Fsw:
+                    return 4;
+                default:
+                    return 0;
+            }
+        }
+
+        /***** writes_rd *****
+         *   True if d may write the integer register d.rd
+         *   - Over-approximates (FLW counts): it only has to be safe
+         ******************************/
+        bool writes_rd(const DecodedInstr& d) {
+            return d.rd != 0 && d.format != InstrFormat::S && d.format != InstrFormat::B;
+        }
+
+        /***** hoist_guards *****
+         *   Fills b.guards and b.fast_ops
+         *   - A load/store is guarded when its base register has not
+         *     been written by an earlier op, so its value on block
+         *     entry is the one the access uses
+         *   - A guard costs about what one access's own check does, so
+         *     nothing is hoisted unless the guards cover more accesses
+         *     than there are guards
+         ******************************/
+        void hoist_guards(Block& b) {
+            uint32_t written = 0; // bit per integer register
+            std::vector<std::size_t> guarded;
+
+            for (std::size_t i = 0; i < b.ops.size(); ++i) {
+                const DecodedInstr& d = b.ops[i];
+                uint32_t w = access_width(d.kind);
+                if (w != 0 && !(written & (1u << d.rs1))) {
+                    auto g = std::find_if(b.guards.begin(), b.guards.end(),
+                                          [&](const MemGuard& m) { return m.reg == d.rs1; });
+                    if (g == b.guards.end() && b.guards.size() < kMaxBlockGuards) {
+                        g = b.guards.insert(b.guards.end(), MemGuard{ d.rs1, d.imm, d.imm });
+                        g->hi = d.imm + int32_t(w);
+                    } else if (g != b.guards.end()) {
+                        g->lo = std::min(g->lo, d.imm);
+                        g->hi = std::max(g->hi, d.imm + int32_t(w));
+                    }
+                    if (g != b.guards.end()) guarded.push_back(i);
+                }
+                if (writes_rd(d)) written |= 1u << d.rd;
+            }
+
+            if (guarded.size() <= b.guards.size()) {
+                b.guards.clear();
+                return;
+            }
+            b.fast_ops = b.ops;
+            for (std::size_t i : guarded) {
+                b.fast_ops[i].exec = block_handler(b.fast_ops[i], false);
+            }
+        }
+
+        /***** guards_pass *****
+         *   True if every hoisted range is inside memory right now
+         ******************************/
+        bool guards_pass(const CpuState& s, const Block& b) {
+            for (const MemGuard& g : b.guards) {
+                int64_t base = s.regs[g.reg];
+                if (base + g.lo < 0 || uint64_t(base + g.hi) > s.mem.size()) return false;
+            }
+            return true;
+        }
+
+        /***** lookup_block *****
+         *   Finds the block that starts at pc, building it on a miss
+         ******************************/
+        Block* lookup_block(CpuState& s, BlockCache& cache, uint32_t pc) {
+            auto it = cache.blocks.find(pc);
+            if (it != cache.blocks.end()) return it->second.get();
+
+            std::unique_ptr<Block> b = build_block(s, pc);
+            Block* raw = b.get();
+            cache.blocks.emplace(pc, std::move(b));
+            return raw;
+        }
+
+        /***** chained *****
+         *   prev's successor slot for the block at pc, or nullptr
+         ******************************/
+        inline Block* chained(const Block* prev, uint32_t pc) {
+            if (prev->succ[0] && prev->succ[0]->start_pc == pc) return prev->succ[0];
+            if (prev->succ[1] && prev->succ[1]->start_pc == pc) return prev->succ[1];
+            return nullptr;
+        }
+
+        /***** link *****
+         *   Remembers b as a successor of prev
+         ******************************/
+        void link(Block* prev, Block* b) {
+            if (!prev->succ[0]) {
+                prev->succ[0] = b;
+            } else {
+                prev->succ[1] = b;
+            }
+        }
+
+        /***** drop_blocks *****
+         *   Throws the cached blocks away once code_epoch has moved
+         ******************************/
+        void drop_blocks(const CpuState& s, BlockCache& cache) {
+            cache.blocks.clear();
+            cache.epoch = s.code_epoch;
+        }
+
+    } // anonymous namespace
+
+    /***** BlockCacheSlot *****
+     *   Out of line, where BlockCache is a complete type
+     ******************************/
+    BlockCacheSlot::BlockCacheSlot(const BlockCacheSlot&) {}
+    BlockCacheSlot::BlockCacheSlot(BlockCacheSlot&&) noexcept = default;
+    BlockCacheSlot& BlockCacheSlot::operator=(BlockCacheSlot&&) noexcept = default;
+    BlockCacheSlot::~BlockCacheSlot() = default;
+
+    BlockCacheSlot& BlockCacheSlot::operator=(const BlockCacheSlot&) {
+        cache.reset(); // the blocks belong to the code this CPU ran before
+        return *this;
+    }
+
+    /***** build_block *****
+     *   Decodes forward from pc until the block has to end
+     ******************************/
+    std::unique_ptr<Block> build_block(CpuState& s, uint32_t pc) {
+        auto b = std::make_unique<Block>();
+        b->start_pc = pc;
+        b->succ[0] = nullptr;
+        b->succ[1] = nullptr;
+
+        uint32_t p = pc;
+        while (b->ops.size() < kMaxBlockLen) {
+            const DecodedInstr& d = fetch_decoded(s, p);
+            b->ops.push_back(d);
+            b->ops.back().exec = block_handler(d, true);
+            if (ends_block(d)) break;
+
+            p += 4;
+            if (static_cast<std::size_t>(p) + 4 > s.mem.size()) break; // end of memory
+        }
+        hoist_guards(*b);
+        return b;
+    }
+
+    /***** run_blocks *****
+     *   Block-at-a-time version of run()
+     ******************************/
+    RunResult run_blocks(CpuState& s, std::size_t max_steps) {
+        if (!s.blocks.cache) s.blocks.cache = std::make_unique<BlockCache>(BlockCache{ {}, s.code_epoch });
+        BlockCache& cache = *s.blocks.cache;
+        if (cache.epoch != s.code_epoch) drop_blocks(s, cache);
+
+        std::size_t steps = 0;
+        Block* b = nullptr;
+
+        while (steps < max_steps) {
+            // A chained block's pc passed check_fetch when it was linked,
+            // and blocks never cross the end of memory, so only a new
+            // edge has to check the fetch
+            Block* next = b ? chained(b, s.pc) : nullptr;
+            if (!next) {
+                if (StopReason r = check_fetch(s); r != StopReason::None) return {r, steps};
+                next = lookup_block(s, cache, s.pc);
+                if (b) link(b, next);
+            }
+            b = next;
+
+            const std::size_t n = b->ops.size();
+            if (n > max_steps - steps) {
+                // not enough budget left for the whole block
+                if (StopReason r = step(s); r != StopReason::None) return {r, steps};
+                ++steps;
+                if (cache.epoch != s.code_epoch) drop_blocks(s, cache);
+                b = nullptr;
+                continue;
+            }
+
+            const DecodedInstr* ops =
+                (!b->fast_ops.empty() && guards_pass(s, *b)) ? b->fast_ops.data() : b->ops.data();
+            std::size_t i = 0;
+            StopReason r = StopReason::None;
+            while (i < n && (r = ops[i].exec(s, ops[i])) == StopReason::None) ++i;
+            if (r == StopReason::None) {
+                steps += n;
+                continue;
+            }
+            if (r != StopReason::CodeWritten) return {r, steps + i};
+
+            // the store at ops[i] retired but overwrote decoded code, so
+            // every block (the rest of this one too) may be stale
+            steps += i + 1;
+            drop_blocks(s, cache);
+            b = nullptr;
+        }
+        return {StopReason::StepLimit, steps};
+    }
+
+} // namespace rv::cpu
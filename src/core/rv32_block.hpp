@@ -0,0 +1,101 @@
+#pragma once
+
+#include "core/rv32_cpu.hpp"
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace rv::cpu {
+
+    /***** MemGuard *****
+     *   A bounds check hoisted to the top of a block: every load/store
+     *   through base register reg (not written earlier in the block)
+     *   touches bytes reg + lo .. reg + hi - 1
+     ******************************/
+    struct MemGuard {
+        uint8_t reg;
+        int32_t lo;
+        int32_t hi;
+    };
+
+    /***** Block *****
+     *   A straight-line run of instructions that ends at a
+     *   branch, jump or trap (Bxx/JAL/JALR/ECALL/EBREAK)
+     *
+     *   start_pc - address of the first instruction
+     *   ops      - decoded instructions, each carrying its block_handler
+     *   guards   - hoisted bounds checks for the loads/stores in ops
+     *   fast_ops - ops with unchecked handlers for the guarded
+     *              accesses, run when every guard passes on entry;
+     *              empty if hoisting would not save a check
+     *   succ     - the last two blocks we jumped to from here, so hot
+     *              loops can go block to block without a map lookup
+     ******************************/
+    struct Block {
+        uint32_t                  start_pc;
+        std::vector<DecodedInstr> ops;
+        std::vector<MemGuard>     guards;
+        std::vector<DecodedInstr> fast_ops;
+        Block*                    succ[2];
+    };
+
+    /***** BlockCache *****
+     *   All blocks built for one CPU (kept in CpuState::blocks, so a
+     *   later run_blocks call on the same CPU reuses them)
+     *
+     *   blocks - blocks keyed by start_pc
+     *   epoch  - s.code_epoch when the blocks were built; if it moves,
+     *            some cached code was overwritten and every block is dropped
+     ******************************/
+    struct BlockCache {
+        std::unordered_map<uint32_t, std::unique_ptr<Block>> blocks;
+        uint64_t epoch;
+    };
+
+    /***** kMaxBlockLen *****
+     *   Longest block we build before cutting it off
+     ******************************/
+    constexpr std::size_t kMaxBlockLen = 64;
+
+    /***** kMaxBlockGuards *****
+     *   Most base registers a block hoists bounds checks for; accesses
+     *   through any others keep their own check
+     ******************************/
+    constexpr std::size_t kMaxBlockGuards = 4;
+
+    /***** build_block *****
+     *   Decodes instructions from pc until a branch/jump, the end of
+     *   memory, or kMaxBlockLen instructions
+     ******************************
+     * Inputs:
+     *   s  - the CPU state (its icache gets filled along the way)
+     *   pc - word-aligned start address inside memory
+     * Returns:
+     *   std::unique_ptr<Block> - the new block (never empty)
+     ******************************/
+    std::unique_ptr<Block> build_block(CpuState& s, uint32_t pc);
+
+    /***** run_blocks *****
+     *   Runs up to max_steps instructions one basic block at a time
+     *   - Each block is a pre-built array of handlers, so there is
+     *     no opcode switch on the hot path
+     *   - Blocks remember their successors and chain straight to them
+     *   - Blocks stay in s.blocks after the call, so the next call
+     *     starts warm; any s.code_epoch change drops them all
+     *   - A store that overwrites decoded code ends its block through
+     *     its handler's StopReason::CodeWritten (see block_handler)
+     *   - A block whose guards all pass runs its loads/stores without
+     *     a bounds check each; otherwise every access checks its own
+     *   - Same results as run() in Interpret mode, including where
+     *     and why it stops
+     ******************************
+     * Inputs:
+     *   s         - the CPU state to run
+     *   max_steps - limit to stop looping
+     * Returns:
+     *   RunResult - stop reason and number of steps retired
+     ******************************/
+    RunResult run_blocks(CpuState& s, std::size_t max_steps);
+
+} // namespace rv::cpu
@@ -0,0 +1,158 @@
+#include "core/rv32_checkpoint.hpp"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+
+namespace rv::cpu {
+
+    namespace {
+
+        /***** make_checkpoint *****
+         *   Registers of s plus the pages it wrote since the last call
+         ******************************/
+        Checkpoint make_checkpoint(CpuState& s, std::size_t step) {
+            Checkpoint cp{};
+            cp.step = step;
+            std::copy(std::begin(s.regs), std::end(s.regs), cp.regs);
+            std::copy(std::begin(s.fregs), std::end(s.fregs), cp.fregs);
+            cp.fcsr = s.fcsr;
+            cp.pc   = s.pc;
+
+            for (uint32_t pn : s.mem.take_dirty_pages()) {
+                uint32_t addr = pn << Memory::kPageBits;
+                std::size_t n = static_cast<std::size_t>(
+                    std::min<uint64_t>(Memory::kPageSize, s.mem.size() - addr));
+                PageImage img{ pn, std::vector<uint8_t>(n) };
+                s.mem.read_bytes(addr, img.bytes.data(), n);
+                cp.pages.push_back(std::move(img));
+            }
+            return cp;
+        }
+
+        /***** apply_checkpoint *****
+         *   Writes cp's pages into s and takes its registers
+         ******************************/
+        void apply_checkpoint(CpuState& s, const Checkpoint& cp) {
+            for (const PageImage& img : cp.pages) {
+                if (s.mem.write_bytes(img.page << Memory::kPageBits, img.bytes.data(), img.bytes.size())) {
+                    ++s.code_epoch;
+                }
+            }
+            std::copy(std::begin(cp.regs), std::end(cp.regs), s.regs);
+            std::copy(std::begin(cp.fregs), std::end(cp.fregs), s.fregs);
+            s.fcsr = cp.fcsr;
+            s.pc   = cp.pc;
+        }
+
+        /***** base_state *****
+         *   A new CPU holding the log's base snapshot
+         ******************************/
+        CpuState base_state(const CheckpointLog& log) {
+            CpuState s(static_cast<std::size_t>(log.base.mem.size()));
+            restore(s, log.base);
+            return s;
+        }
+
+        /***** nearest_checkpoint *****
+         *   Index of the last checkpoint at or before step
+         ******************************/
+        std::size_t nearest_checkpoint(const CheckpointLog& log, std::size_t step) {
+            return std::min(step / log.interval, log.checkpoints.size() - 1);
+        }
+
+    } // anonymous namespace
+
+    /***** run_checkpointed *****
+     *   run() in interval-sized pieces, one checkpoint between pieces
+     ******************************/
+    CheckpointLog run_checkpointed(CpuState& s, std::size_t max_steps, std::size_t interval,
+                                   ExecMode mode) {
+        if (interval == 0) throw std::invalid_argument("run_checkpointed: interval must be > 0");
+
+        CheckpointLog log{ snapshot(s), interval, mode, {}, { StopReason::StepLimit, 0 } };
+        s.mem.track_dirty(true);
+        log.checkpoints.push_back(make_checkpoint(s, 0)); // nothing dirty yet
+
+        std::size_t steps = 0;
+        while (steps < max_steps) {
+            RunResult r = run(s, std::min(interval, max_steps - steps), mode);
+            steps += r.steps;
+            if (r.reason != StopReason::StepLimit) {
+                log.result = { r.reason, steps };
+                break;
+            }
+            log.result.steps = steps;
+            if (steps < max_steps) log.checkpoints.push_back(make_checkpoint(s, steps));
+        }
+
+        s.mem.track_dirty(false);
+        return log;
+    }
+
+    /***** state_at_checkpoint *****/
+    CpuState state_at_checkpoint(const CheckpointLog& log, std::size_t k) {
+        if (k >= log.checkpoints.size()) throw std::out_of_range("state_at_checkpoint: no such checkpoint");
+        CpuState s = base_state(log);
+        for (std::size_t i = 0; i <= k; ++i) apply_checkpoint(s, log.checkpoints[i]);
+        return s;
+    }
+
+    /***** replay_slices *****
+     *   Builds the starting CPUs in checkpoint order (each one a COW
+     *   copy of a running state), then fans the slices out
+     ******************************/
+    void replay_slices(const CheckpointLog& log, std::span<const ReplaySlice> slices,
+                       const ReplayFn& fn, unsigned threads) {
+        if (slices.empty()) return;
+
+        std::vector<std::size_t> order(slices.size());
+        std::iota(order.begin(), order.end(), std::size_t(0));
+        std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+            return slices[a].begin < slices[b].begin;
+        });
+
+        std::vector<CpuState> starts;
+        starts.reserve(slices.size());
+        std::vector<std::size_t> start_of(slices.size());
+        CpuState cur = base_state(log);
+        std::size_t applied = 0; // checkpoints [0, applied) are in cur
+        for (std::size_t i : order) {
+            std::size_t k = nearest_checkpoint(log, slices[i].begin);
+            for (; applied <= k; ++applied) apply_checkpoint(cur, log.checkpoints[applied]);
+            start_of[i] = starts.size();
+            starts.push_back(fork(cur));
+        }
+
+        unsigned workers = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+        workers = static_cast<unsigned>(std::min<std::size_t>(workers, slices.size()));
+
+        std::atomic<std::size_t> next{0};
+        std::exception_ptr       error;
+        std::mutex               error_m;
+
+        auto worker = [&] {
+            for (std::size_t i; (i = next.fetch_add(1)) < slices.size();) {
+                try {
+                    CpuState& s = starts[start_of[i]];
+                    const Checkpoint& cp = log.checkpoints[nearest_checkpoint(log, slices[i].begin)];
+                    if (slices[i].begin > cp.step) run(s, slices[i].begin - cp.step, log.mode);
+                    fn(i, s, slices[i]);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(error_m);
+                    if (!error) error = std::current_exception();
+                }
+            }
+        };
+
+        std::vector<std::thread> pool;
+        for (unsigned t = 1; t < workers; ++t) pool.emplace_back(worker);
+        worker();
+        for (std::thread& t : pool) t.join();
+        if (error) std::rethrow_exception(error);
+    }
+
+} // namespace rv::cpu
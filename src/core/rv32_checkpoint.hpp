@@ -0,0 +1,108 @@
+#pragma once
+
+#include "core/rv32_cpu.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace rv::cpu {
+
+    /***** PageImage *****
+     *   The bytes of one guest page at checkpoint time
+     ******************************/
+    struct PageImage {
+        uint32_t             page;  // page number (address >> Memory::kPageBits)
+        std::vector<uint8_t> bytes; // Memory::kPageSize bytes
+    };
+
+    /***** Checkpoint *****
+     *   The CPU after step instructions of a checkpointed run
+     *
+     *   step  - instructions retired before this point
+     *   regs, fregs, fcsr, pc - the registers
+     *   pages - pages written since the checkpoint before this one
+     *           (empty for the first checkpoint, which is the start)
+     ******************************/
+    struct Checkpoint {
+        std::size_t            step;
+        uint32_t               regs[32];
+        uint32_t               fregs[32];
+        uint32_t               fcsr;
+        uint32_t               pc;
+        std::vector<PageImage> pages;
+    };
+
+    /***** CheckpointLog *****
+     *   Everything needed to rebuild the CPU at any checkpoint
+     *
+     *   base        - snapshot of the CPU when the run started (O(1),
+     *                 shares its pages copy-on-write)
+     *   interval    - instructions between checkpoints
+     *   mode        - how the run was executed (replays use it too)
+     *   checkpoints - checkpoints[k] is at step k * interval
+     *   result      - how the whole run ended
+     ******************************/
+    struct CheckpointLog {
+        CpuSnapshot             base;
+        std::size_t             interval;
+        ExecMode                mode;
+        std::vector<Checkpoint> checkpoints;
+        RunResult               result;
+    };
+
+    /***** run_checkpointed *****
+     *   run() that also writes a checkpoint every interval instructions
+     *   - Each checkpoint stores the registers and only the pages
+     *     written since the previous one (Memory dirty-page tracking)
+     *   - Ends in the same state as run(s, max_steps, mode); stopping
+     *     early (ECALL, fault, ...) ends the log at the last full interval
+     ******************************
+     * Inputs:
+     *   s         - the CPU to run
+     *   max_steps - instruction budget
+     *   interval  - instructions between checkpoints (> 0)
+     *   mode      - interpreter or block engine
+     * Returns:
+     *   CheckpointLog - base snapshot, checkpoints and the RunResult
+     ******************************/
+    CheckpointLog run_checkpointed(CpuState& s, std::size_t max_steps, std::size_t interval,
+                                   ExecMode mode = ExecMode::Interpret);
+
+    /***** state_at_checkpoint *****
+     *   A new CPU in the state of log.checkpoints[k]
+     *   - Starts from the base snapshot and writes the page images of
+     *     checkpoints 1..k over it
+     ******************************/
+    CpuState state_at_checkpoint(const CheckpointLog& log, std::size_t k);
+
+    /***** ReplaySlice / ReplayFn *****
+     *   ReplaySlice - instructions [begin, begin + count) of the run
+     *   ReplayFn    - called once per slice, on a worker thread, with a
+     *                 CPU standing right before instruction begin; it
+     *                 runs the slice however it wants (run_traced,
+     *                 run_with a ProfileProbe, ...)
+     ******************************/
+    struct ReplaySlice {
+        std::size_t begin;
+        std::size_t count;
+    };
+
+    using ReplayFn = std::function<void(std::size_t slice, CpuState& s, const ReplaySlice& range)>;
+
+    /***** replay_slices *****
+     *   Re-runs slices of a checkpointed run in parallel
+     *   - Each slice starts from the nearest checkpoint at or before
+     *     its begin and runs forward to begin without any hooks
+     *   - The starting CPUs are built one after another on the calling
+     *     thread (so page sharing stays safe), then the slices run on
+     *     up to threads workers (0 = one per hardware thread)
+     *   - A slice whose begin is past the end of the run is handed
+     *     over where the run stopped
+     *   - An exception from fn is rethrown after all workers stop
+     ******************************/
+    void replay_slices(const CheckpointLog& log, std::span<const ReplaySlice> slices,
+                       const ReplayFn& fn, unsigned threads = 0);
+
+} // namespace rv::cpu
@@ -1,5 +1,12 @@
 #include "core/rv32_cpu.hpp"
+#include "core/rv32_block.hpp"
+#include "core/alu.hpp"
+#include "core/mdu.hpp"
+#include "core/f32.hpp"
+#include <algorithm>
 #include <cassert>
+#include <iterator>
+#include <stdexcept>
 
 namespace rv::cpu {
 
@@ -7,7 +14,15 @@ namespace rv::cpu {
      *   Creates a CPU with a given amount of memory
      ******************************/
     CpuState::CpuState(std::size_t mem_size)
-        : regs{0}, pc(0), mem(mem_size, 0) {}
+        : regs{0}, fregs{0}, fcsr(0), pc(0), mem(mem_size), code_epoch(0), fault_addr(0) {}
+
+    /***** invalidate_icache *****
+     *   Drops every decoded instruction
+     ******************************/
+    void invalidate_icache(CpuState& s) {
+        s.mem.clear_decoded();
+        ++s.code_epoch;
+    }
 
     /***** reset *****
      *   Puts the CPU back into a clean starting state
@@ -15,59 +30,73 @@ namespace rv::cpu {
     void reset(CpuState& s) {
         for (int i = 0; i < 32; ++i) {
             s.regs[i] = 0;
+            s.fregs[i] = 0;
         }
+        s.fcsr = 0;
         s.pc = 0;
-        std::fill(s.mem.begin(), s.mem.end(), 0);
+        s.mem.clear(); // decoded instructions go with their pages
+        ++s.code_epoch;
+        s.fault_addr = 0;
+    }
+
+    /***** snapshot / restore / fork *****
+     *   Memory copies share pages, so all three are O(1)
+     ******************************/
+    CpuSnapshot snapshot(const CpuState& s) {
+        CpuSnapshot snap{{}, {}, s.fcsr, s.pc, s.mem};
+        std::copy(std::begin(s.regs), std::end(s.regs), snap.regs);
+        std::copy(std::begin(s.fregs), std::end(s.fregs), snap.fregs);
+        return snap;
+    }
+
+    void restore(CpuState& s, const CpuSnapshot& snap) {
+        std::copy(std::begin(snap.regs), std::end(snap.regs), s.regs);
+        std::copy(std::begin(snap.fregs), std::end(snap.fregs), s.fregs);
+        s.fcsr = snap.fcsr;
+        s.pc = snap.pc;
+        s.mem = snap.mem;
+        ++s.code_epoch; // decoded instructions were not part of the snapshot
+    }
+
+    CpuState fork(const CpuState& s) {
+        return CpuState(s);
+    }
+
+    /***** load_u32 / store_u32 (helpers) *****
+     *   Word access for the fetch path and load_program
+     *   - load_u32 only runs on a decode miss, so it checks for real
+     *     and throws std::out_of_range; store_u32's range was checked
+     *     by load_program
+     *   - A store that drops a decoded instruction bumps code_epoch
+     ******************************/
+    static uint32_t load_u32(const CpuState& s, uint32_t addr) {
+        if (!s.mem.in_range(addr, 4)) throw std::out_of_range("Fetch outside guest memory");
+        return s.mem.load_u32(addr);
+    }
+
+    static void store_u32(CpuState& s, uint32_t addr, uint32_t value) {
+        assert(s.mem.in_range(addr, 4));
+        if (s.mem.store_u32(addr, value)) {
+            ++s.code_epoch;
+        }
     }
 
     /***** load_program *****
      *   Loads a list of 32 bit instructions into memory
+     *   - One range check for the whole program, before any write
      ******************************/
     void load_program(CpuState& s, const std::vector<uint32_t>& words, uint32_t base_addr) {
+        if (uint64_t(base_addr) + uint64_t(words.size()) * 4 > s.mem.size()) {
+            throw std::out_of_range("Program does not fit in guest memory");
+        }
         uint32_t addr = base_addr;
         for (uint32_t w : words) {
-            assert(addr + 3 < s.mem.size());
-            s.mem[addr + 0] = static_cast<uint8_t>(w & 0xFF);
-            s.mem[addr + 1] = static_cast<uint8_t>((w >> 8) & 0xFF);
-            s.mem[addr + 2] = static_cast<uint8_t>((w >> 16) & 0xFF);
-            s.mem[addr + 3] = static_cast<uint8_t>((w >> 24) & 0xFF);
+            store_u32(s, addr, w);
             addr += 4;
         }
         s.pc = base_addr;
     }
 
-    /***** load_u32 (helper) *****
-     *   Reads a 32-bit little-endian word from memory
-     *******************************
-     * Input:
-     *   addr - byte address in memory
-     * Returns:
-     *   32-bit value made from mem
-     ******************************/
-    static uint32_t load_u32(const CpuState& s, uint32_t addr) {
-        assert(addr + 3 < s.mem.size());
-        uint32_t b0 = s.mem[addr + 0];
-        uint32_t b1 = s.mem[addr + 1];
-        uint32_t b2 = s.mem[addr + 2];
-        uint32_t b3 = s.mem[addr + 3];
-        return b0 | (b1 << 8) | (b2 << 16) | (b3 << 24);
-    }
-
-    /***** store_u32 (helper) *****
-     *   Writes a 32-bit value into memory in little endian format
-     *******************************
-     * Input:
-     *   addr  - where to store it
-     *   value - the 32 bit value to write
-     ******************************/
-    static void store_u32(CpuState& s, uint32_t addr, uint32_t value) {
-        assert(addr + 3 < s.mem.size());
-        s.mem[addr + 0] = static_cast<uint8_t>(value & 0xFF);
-        s.mem[addr + 1] = static_cast<uint8_t>((value >> 8) & 0xFF);
-        s.mem[addr + 2] = static_cast<uint8_t>((value >> 16) & 0xFF);
-        s.mem[addr + 3] = static_cast<uint8_t>((value >> 24) & 0xFF);
-    }
-
     /***** sign_extend_imm (helper) *****
      *   Sign-extends an imm
      ******************************/
@@ -76,183 +105,667 @@ namespace rv::cpu {
         return (static_cast<int32_t>(x) << shift) >> shift;
     }
 
-    /***** step *****
-     *   Runs a single instruction at s.pc
-     ******************************/
-    void step(CpuState& s) {
-        assert((s.pc % 4) == 0);
-        uint32_t instr = load_u32(s, s.pc);
+    namespace {
+
+        using K = InstrKind;
 
-        uint32_t opcode = instr & 0x7F;
-        uint32_t rd     = (instr >> 7) & 0x1F;
-        uint32_t funct3 = (instr >> 12) & 0x07;
-        uint32_t rs1    = (instr >> 15) & 0x1F;
-        uint32_t rs2    = (instr >> 20) & 0x1F;
-        uint32_t funct7 = (instr >> 25) & 0x7F;
+        /***** kind groups *****
+         *   InstrKind ranges that share a handler template
+         ******************************/
+        constexpr bool kind_in(K k, K first, K last) {
+            return k >= first && k <= last;
+        }
+
+        constexpr bool is_alu_imm(K k) { return kind_in(k, K::Addi, K::Srai); }
+        constexpr bool is_alu_reg(K k) { return kind_in(k, K::Add, K::And) || kind_in(k, K::Mul, K::Remu); }
+        constexpr bool is_branch(K k)  { return kind_in(k, K::Beq, K::Bgeu); }
+        constexpr bool is_load(K k)    { return kind_in(k, K::Lb, K::Lhu); }
+        constexpr bool is_store(K k)   { return kind_in(k, K::Sb, K::Sw); }
 
-        uint32_t next_pc = s.pc + 4;
+        constexpr uint32_t access_bytes(K k) {
+            if (k == K::Lb || k == K::Lbu || k == K::Sb) return 1;
+            if (k == K::Lh || k == K::Lhu || k == K::Sh) return 2;
+            return 4;
+        }
 
-        auto read_reg = [&](uint32_t idx) -> uint32_t {
-            if (idx == 0) return 0;
+        /***** read_reg / write_rd (helpers) *****
+         *   Register file access
+         *   - regs[0] is never written, so x0 reads as 0 without a check
+         *   - write_rd<true> is the handler the decoder picked for
+         *     rd == x0, so the write is gone at compile time
+         ******************************/
+        inline uint32_t read_reg(const CpuState& s, uint32_t idx) {
             assert(idx < 32);
             return s.regs[idx];
-        };
+        }
 
-        auto write_reg = [&](uint32_t idx, uint32_t value) {
-            if (idx == 0) return; // x0 stays 0
-            assert(idx < 32);
-            s.regs[idx] = value;
-        };
+        template <bool RdZero>
+        inline void write_rd(CpuState& s, const DecodedInstr& d, uint32_t value) {
+            if constexpr (!RdZero) {
+                assert(d.rd != 0 && d.rd < 32);
+                s.regs[d.rd] = value;
+            } else {
+                (void)s; (void)d; (void)value;
+            }
+        }
 
-        switch (opcode) {
+        inline uint32_t uimm(const DecodedInstr& d) {
+            return static_cast<uint32_t>(d.imm);
+        }
 
-            case 0x13: { // OP-IMM
-                int32_t imm = sign_extend_imm(instr >> 20, 12);
-                uint32_t val1 = read_reg(rs1);
+        // ---------------- OP-IMM / OP / M extension ----------------
+        // ADD/SUB go through the ALU model in lazy-flags mode
+        // (alu_lazy_u32), so no flag is computed. The M ops go through
+        // the word-level MDU (mdu_mul_u32 / mdu_div_u32), same
+        // semantics as the bit-level mdu_mul / mdu_div
+
+        /***** alu<Kind> *****
+         *   The result of an integer compute instruction on a and b
+         *   (b is the immediate for the OP-IMM kinds)
+         ******************************/
+        template <K Kind>
+        inline uint32_t alu(uint32_t a, uint32_t b) {
+            using rv::core::MulOp;
+            using rv::core::DivOp;
+            using rv::core::mdu_mul_u32;
+            using rv::core::mdu_div_u32;
+            using rv::core::AluOp;
+            using rv::core::alu_lazy_u32;
+
+            if constexpr (Kind == K::Add || Kind == K::Addi)        return alu_lazy_u32(a, b, AluOp::Add).result;
+            else if constexpr (Kind == K::Sub)                      return alu_lazy_u32(a, b, AluOp::Sub).result;
+            else if constexpr (Kind == K::And || Kind == K::Andi)   return a & b;
+            else if constexpr (Kind == K::Or  || Kind == K::Ori)    return a | b;
+            else if constexpr (Kind == K::Xor || Kind == K::Xori)   return a ^ b;
+            else if constexpr (Kind == K::Slt || Kind == K::Slti)
+                return static_cast<int32_t>(a) < static_cast<int32_t>(b) ? 1u : 0u;
+            else if constexpr (Kind == K::Sltu || Kind == K::Sltiu) return a < b ? 1u : 0u;
+            else if constexpr (Kind == K::Sll || Kind == K::Slli)   return a << (b & 0x1F);
+            else if constexpr (Kind == K::Srl || Kind == K::Srli)   return a >> (b & 0x1F);
+            else if constexpr (Kind == K::Sra || Kind == K::Srai)
+                return static_cast<uint32_t>(static_cast<int32_t>(a) >> (b & 0x1F));
+            else if constexpr (Kind == K::Mul)    return mdu_mul_u32(MulOp::Mul, a, b).lo;
+            else if constexpr (Kind == K::Mulh)   return mdu_mul_u32(MulOp::Mulh, a, b).hi;
+            else if constexpr (Kind == K::Mulhsu) return mdu_mul_u32(MulOp::Mulhsu, a, b).hi;
+            else if constexpr (Kind == K::Mulhu)  return mdu_mul_u32(MulOp::Mulhu, a, b).hi;
+            else if constexpr (Kind == K::Div)    return mdu_div_u32(DivOp::Div, a, b).q;
+            else if constexpr (Kind == K::Divu)   return mdu_div_u32(DivOp::Divu, a, b).q;
+            else if constexpr (Kind == K::Rem)    return mdu_div_u32(DivOp::Rem, a, b).r;
+            else {
+                static_assert(Kind == K::Remu, "not an ALU kind");
+                return mdu_div_u32(DivOp::Remu, a, b).r;
+            }
+        }
 
-                switch (funct3) {
-                    case 0x0: { // ADDI
-                        uint32_t res = val1 + static_cast<uint32_t>(imm);
-                        write_reg(rd, res);
-                        break;
-                    }
-                    case 0x7: { // ANDI
-                        uint32_t res = val1 & static_cast<uint32_t>(imm);
-                        write_reg(rd, res);
-                        break;
-                    }
-                    case 0x6: { // ORI
-                        uint32_t res = val1 | static_cast<uint32_t>(imm);
-                        write_reg(rd, res);
-                        break;
-                    }
-                    case 0x4: { // XORI
-                        uint32_t res = val1 ^ static_cast<uint32_t>(imm);
-                        write_reg(rd, res);
-                        break;
-                    }
-                    case 0x1: { // SLLI
-                        uint32_t shamt = (instr >> 20) & 0x1F;
-                        uint32_t res   = val1 << shamt;
-                        write_reg(rd, res);
-                        break;
-                    }
-                    case 0x5: { // SRLI / SRAI
-                        uint32_t shamt = (instr >> 20) & 0x1F;
-                        if (funct7 == 0x00) {
-                            // SRLI
-                            uint32_t res = val1 >> shamt;
-                            write_reg(rd, res);
-                        } else if (funct7 == 0x20) {
-                            // SRAI
-                            int32_t sval = static_cast<int32_t>(val1);
-                            int32_t sres = sval >> static_cast<int32_t>(shamt);
-                            write_reg(rd, static_cast<uint32_t>(sres));
-                        }
-                        break;
-                    }
-                    default:
-                        // other op-imm but are not implemented yet
-                        break;
-                }
-                break;
+        template <K Kind, bool RdZero>
+        StopReason exec_alu(CpuState& s, const DecodedInstr& d) {
+            if constexpr (!RdZero) {
+                uint32_t b = is_alu_imm(Kind) ? uimm(d) : read_reg(s, d.rs2);
+                write_rd<false>(s, d, alu<Kind>(read_reg(s, d.rs1), b));
+            }
+            s.pc += 4;
+            return StopReason::None;
+        }
+
+        // ---------------- memory ----------------
+        // Each access makes one bounds check (Memory::in_range) before
+        // it touches anything, so a fault leaves the CPU as it was.
+        // The Checked = false handlers leave it out; the block engine
+        // uses them once it has checked a whole block's accesses
+        // (see unchecked_handler)
+
+        inline uint32_t mem_addr(const CpuState& s, const DecodedInstr& d) {
+            return read_reg(s, d.rs1) + uimm(d);
+        }
+
+        inline StopReason access_fault(CpuState& s, uint32_t addr) {
+            s.fault_addr = addr;
+            return StopReason::AccessFault;
+        }
+
+        /***** note_store *****
+         *   Bumps code_epoch if a store dropped a decoded instruction;
+         *   the block engine's variants (InBlock) also end the block
+         ******************************/
+        template <bool InBlock>
+        inline StopReason note_store(CpuState& s, bool dropped) {
+            s.pc += 4;
+            if (!dropped) return StopReason::None;
+            ++s.code_epoch;
+            return InBlock ? StopReason::CodeWritten : StopReason::None;
+        }
+
+        /***** exec_load *****
+         *   LB/LH/LW/LBU/LHU; with rd == x0 the access still happens
+         ******************************/
+        template <K Kind, bool RdZero, bool Checked>
+        StopReason exec_load(CpuState& s, const DecodedInstr& d) {
+            uint32_t addr = mem_addr(s, d);
+            if constexpr (Checked) {
+                if (!s.mem.in_range(addr, access_bytes(Kind))) return access_fault(s, addr);
+            }
+            uint32_t v;
+            if constexpr (Kind == K::Lb)       v = static_cast<uint32_t>(sign_extend_imm(s.mem.load_u8(addr), 8));
+            else if constexpr (Kind == K::Lh)  v = static_cast<uint32_t>(sign_extend_imm(s.mem.load_u16(addr), 16));
+            else if constexpr (Kind == K::Lw)  v = s.mem.load_u32(addr);
+            else if constexpr (Kind == K::Lbu) v = s.mem.load_u8(addr);
+            else                               v = s.mem.load_u16(addr);
+            write_rd<RdZero>(s, d, v);
+            s.pc += 4;
+            return StopReason::None;
+        }
+
+        /***** exec_store *****
+         *   SB/SH/SW
+         *   - d may be the slot this store overwrites, so read it first
+         ******************************/
+        template <K Kind, bool Checked, bool InBlock = false>
+        StopReason exec_store(CpuState& s, const DecodedInstr& d) {
+            uint32_t addr = mem_addr(s, d);
+            uint32_t val  = read_reg(s, d.rs2);
+            if constexpr (Checked) {
+                if (!s.mem.in_range(addr, access_bytes(Kind))) return access_fault(s, addr);
+            }
+            if constexpr (Kind == K::Sb)      return note_store<InBlock>(s, s.mem.store_u8(addr, val));
+            else if constexpr (Kind == K::Sh) return note_store<InBlock>(s, s.mem.store_u16(addr, val));
+            else                              return note_store<InBlock>(s, s.mem.store_u32(addr, val));
+        }
+
+        // ---------------- control flow ----------------
+
+        template <K Kind>
+        inline bool taken(uint32_t a, uint32_t b) {
+            if constexpr (Kind == K::Beq)       return a == b;
+            else if constexpr (Kind == K::Bne)  return a != b;
+            else if constexpr (Kind == K::Blt)  return static_cast<int32_t>(a) < static_cast<int32_t>(b);
+            else if constexpr (Kind == K::Bge)  return static_cast<int32_t>(a) >= static_cast<int32_t>(b);
+            else if constexpr (Kind == K::Bltu) return a < b;
+            else                                return a >= b;
+        }
+
+        template <K Kind>
+        StopReason exec_branch(CpuState& s, const DecodedInstr& d) {
+            bool take = taken<Kind>(read_reg(s, d.rs1), read_reg(s, d.rs2));
+            s.pc += take ? uimm(d) : 4u;
+            return StopReason::None;
+        }
+
+        template <bool RdZero>
+        StopReason exec_jal(CpuState& s, const DecodedInstr& d) {
+            uint32_t pc0 = s.pc;
+            write_rd<RdZero>(s, d, pc0 + 4);
+            s.pc = pc0 + uimm(d);
+            return StopReason::None;
+        }
+
+        template <bool RdZero>
+        StopReason exec_jalr(CpuState& s, const DecodedInstr& d) {
+            uint32_t pc0 = s.pc;
+            uint32_t target = read_reg(s, d.rs1) + uimm(d);
+            target &= ~1u; // LSB
+
+            write_rd<RdZero>(s, d, pc0 + 4);
+            s.pc = target;
+            return StopReason::None;
+        }
+
+        // ---------------- upper immediates ----------------
+
+        template <bool RdZero>
+        StopReason exec_auipc(CpuState& s, const DecodedInstr& d) {
+            write_rd<RdZero>(s, d, s.pc + uimm(d));
+            s.pc += 4;
+            return StopReason::None;
+        }
+
+        template <bool RdZero>
+        StopReason exec_lui(CpuState& s, const DecodedInstr& d) {
+            write_rd<RdZero>(s, d, uimm(d));
+            s.pc += 4;
+            return StopReason::None;
+        }
+
+        // ---------------- F extension ----------------
+        // FADD/FSUB/FMUL use the word-level f32 kernels (no trace, no
+        // allocation); results and flags match fadd_f32 / fmul_f32.
+        // The f32 engine doesn't round, so the rounding mode is ignored.
+
+        /***** fflags_of (helper) *****
+         *   FpuFlags as fcsr accrued-flag bits
+         ******************************/
+        inline uint32_t fflags_of(const rv::core::FpuFlags& f) {
+            return (f.invalid   ? kFflagNV : 0u)
+                 | (f.overflow  ? kFflagOF : 0u)
+                 | (f.underflow ? kFflagUF : 0u)
+                 | (f.inexact   ? kFflagNX : 0u);
+        }
+
+        template <rv::core::FpuResult32 (*Op)(uint32_t, uint32_t)>
+        StopReason exec_fop(CpuState& s, const DecodedInstr& d) {
+            rv::core::FpuResult32 r = Op(s.fregs[d.rs1], s.fregs[d.rs2]);
+            s.fregs[d.rd] = r.bits;
+            s.fcsr |= fflags_of(r.flags);
+            s.pc += 4;
+            return StopReason::None;
+        }
+
+        template <bool Checked>
+        StopReason exec_flw(CpuState& s, const DecodedInstr& d) {
+            uint32_t addr = mem_addr(s, d);
+            if constexpr (Checked) {
+                if (!s.mem.in_range(addr, 4)) return access_fault(s, addr);
+            }
+            s.fregs[d.rd] = s.mem.load_u32(addr);
+            s.pc += 4;
+            return StopReason::None;
+        }
+
+        template <bool Checked, bool InBlock = false>
+        StopReason exec_fsw(CpuState& s, const DecodedInstr& d) {
+            uint32_t addr = mem_addr(s, d);
+            if constexpr (Checked) {
+                if (!s.mem.in_range(addr, 4)) return access_fault(s, addr);
+            }
+            return note_store<InBlock>(s, s.mem.store_u32(addr, s.fregs[d.rs2]));
+        }
+
+        /***** exec_fsgnj / exec_fsgnjn / exec_fsgnjx *****
+         *   Sign injection; FMV.S, FNEG.S and FABS.S are these with rs1 == rs2
+         ******************************/
+        StopReason exec_fsgnj(CpuState& s, const DecodedInstr& d) {
+            s.fregs[d.rd] = (s.fregs[d.rs1] & 0x7FFFFFFFu) | (s.fregs[d.rs2] & 0x80000000u);
+            s.pc += 4;
+            return StopReason::None;
+        }
+
+        StopReason exec_fsgnjn(CpuState& s, const DecodedInstr& d) {
+            s.fregs[d.rd] = (s.fregs[d.rs1] & 0x7FFFFFFFu) | (~s.fregs[d.rs2] & 0x80000000u);
+            s.pc += 4;
+            return StopReason::None;
+        }
+
+        StopReason exec_fsgnjx(CpuState& s, const DecodedInstr& d) {
+            s.fregs[d.rd] = s.fregs[d.rs1] ^ (s.fregs[d.rs2] & 0x80000000u);
+            s.pc += 4;
+            return StopReason::None;
+        }
+
+        template <bool RdZero>
+        StopReason exec_fmv_x_w(CpuState& s, const DecodedInstr& d) {
+            write_rd<RdZero>(s, d, s.fregs[d.rs1]);
+            s.pc += 4;
+            return StopReason::None;
+        }
+
+        StopReason exec_fmv_w_x(CpuState& s, const DecodedInstr& d) {
+            s.fregs[d.rd] = read_reg(s, d.rs1);
+            s.pc += 4;
+            return StopReason::None;
+        }
+
+        /***** exec_fcsr *****
+         *   CSRRW/CSRRS/CSRRC (and the immediate forms) on the float
+         *   CSRs: fflags (0x001), frm (0x002) and fcsr (0x003)
+         ******************************/
+        template <bool RdZero>
+        StopReason exec_fcsr(CpuState& s, const DecodedInstr& d) {
+            uint32_t csr = d.raw >> 20;
+            uint32_t mask  = (csr == 0x001) ? 0x1Fu : (csr == 0x002) ? 0x7u : 0xFFu;
+            uint32_t shift = (csr == 0x002) ? kFrmShift : 0u;
+
+            uint32_t old = (s.fcsr >> shift) & mask;
+            uint32_t src = (d.funct3 & 0x4) ? d.rs1 : read_reg(s, d.rs1); // zimm = rs1 field
+
+            uint32_t val = old;
+            switch (d.funct3 & 0x3) {
+                case 0x1: val = src; break;           // CSRRW(I)
+                case 0x2: val = old | src; break;     // CSRRS(I)
+                case 0x3: val = old & ~src; break;    // CSRRC(I)
             }
-            case 0x33: { // OP
-                uint32_t val1 = read_reg(rs1);
-                uint32_t val2 = read_reg(rs2);
-
-                switch (funct3) {
-                    case 0x0: { // ADD/SUB
-                        if (funct7 == 0x00) {
-                            // ADD
-                            write_reg(rd, val1 + val2);
-                        } else if (funct7 == 0x20) {
-                            // SUB
-                            write_reg(rd, val1 - val2);
+            s.fcsr = (s.fcsr & ~(mask << shift)) | ((val & mask) << shift);
+            write_rd<RdZero>(s, d, old);
+            s.pc += 4;
+            return StopReason::None;
+        }
+
+        // ---------------- system ----------------
+
+        /***** exec_fence *****
+         *   FENCE: one hart and no caches, so there is nothing to order
+         ******************************/
+        StopReason exec_fence(CpuState& s, const DecodedInstr&) {
+            s.pc += 4;
+            return StopReason::None;
+        }
+
+        /***** exec_ecall / exec_ebreak *****
+         *   Trap to the host; pc stays on the instruction so the host
+         *   can look at it and move on with pc += 4
+         ******************************/
+        StopReason exec_ecall(CpuState&, const DecodedInstr&) {
+            return StopReason::Ecall;
+        }
+
+        StopReason exec_ebreak(CpuState&, const DecodedInstr&) {
+            return StopReason::Ebreak;
+        }
+
+        /***** exec_illegal *****
+         *   Used for encodings that are not implemented, stops the run
+         ******************************/
+        StopReason exec_illegal(CpuState&, const DecodedInstr&) {
+            return StopReason::IllegalInstruction;
+        }
+
+        /***** classify_fp *****
+         *   Kind of an OP-FP (0x53) instruction
+         *   - Rounding modes 5 and 6 are reserved, so illegal
+         ******************************/
+        InstrKind classify_fp(const DecodedInstr& d) {
+            bool rm_ok = d.funct3 != 5 && d.funct3 != 6;
+            switch (d.funct7) {
+                case 0x00: return rm_ok ? K::FaddS : K::Illegal;
+                case 0x04: return rm_ok ? K::FsubS : K::Illegal;
+                case 0x08: return rm_ok ? K::FmulS : K::Illegal;
+                case 0x10:
+                    if (d.funct3 == 0x0) return K::FsgnjS;
+                    if (d.funct3 == 0x1) return K::FsgnjnS;
+                    if (d.funct3 == 0x2) return K::FsgnjxS;
+                    return K::Illegal;
+                case 0x70:
+                    return (d.rs2 == 0 && d.funct3 == 0x0) ? K::FmvXW : K::Illegal;
+                case 0x78:
+                    return (d.rs2 == 0 && d.funct3 == 0x0) ? K::FmvWX : K::Illegal;
+                default:
+                    return K::Illegal;
+            }
+        }
+
+        /***** classify *****
+         *   Which instruction a decoded word is
+         *   - This is the only place that switches on opcode/funct3/funct7
+         ******************************/
+        InstrKind classify(const DecodedInstr& d) {
+            switch (d.opcode) {
+                case 0x13: // OP-IMM
+                    switch (d.funct3) {
+                        case 0x0: return K::Addi;
+                        case 0x2: return K::Slti;
+                        case 0x3: return K::Sltiu;
+                        case 0x7: return K::Andi;
+                        case 0x6: return K::Ori;
+                        case 0x4: return K::Xori;
+                        case 0x1:
+                            return (d.funct7 == 0x00) ? K::Slli : K::Illegal;
+                        case 0x5:
+                            if (d.funct7 == 0x00) return K::Srli;
+                            if (d.funct7 == 0x20) return K::Srai;
+                            return K::Illegal;
+                        default:  return K::Illegal;
+                    }
+
+                case 0x33: // OP
+                    if (d.funct7 == 0x01) { // M extension
+                        switch (d.funct3) {
+                            case 0x0: return K::Mul;
+                            case 0x1: return K::Mulh;
+                            case 0x2: return K::Mulhsu;
+                            case 0x3: return K::Mulhu;
+                            case 0x4: return K::Div;
+                            case 0x5: return K::Divu;
+                            case 0x6: return K::Rem;
+                            case 0x7: return K::Remu;
                         }
-                        break;
                     }
-                    case 0x7: { // AND
-                        write_reg(rd, val1 & val2);
-                        break;
+                    if (d.funct7 == 0x20) {
+                        if (d.funct3 == 0x0) return K::Sub;
+                        if (d.funct3 == 0x5) return K::Sra;
+                        return K::Illegal;
                     }
-                    case 0x6: { // OR
-                        write_reg(rd, val1 | val2);
-                        break;
+                    if (d.funct7 != 0x00) return K::Illegal;
+                    switch (d.funct3) {
+                        case 0x0: return K::Add;
+                        case 0x1: return K::Sll;
+                        case 0x2: return K::Slt;
+                        case 0x3: return K::Sltu;
+                        case 0x4: return K::Xor;
+                        case 0x5: return K::Srl;
+                        case 0x6: return K::Or;
+                        case 0x7: return K::And;
                     }
-                    case 0x4: { // XOR
-                        write_reg(rd, val1 ^ val2);
-                        break;
+                    return K::Illegal;
+
+                case 0x03: // LOAD
+                    switch (d.funct3) {
+                        case 0x0: return K::Lb;
+                        case 0x1: return K::Lh;
+                        case 0x2: return K::Lw;
+                        case 0x4: return K::Lbu;
+                        case 0x5: return K::Lhu;
+                        default:  return K::Illegal;
                     }
-                    case 0x1: { // SLL
-                        uint32_t shamt = val2 & 0x1F;
-                        write_reg(rd, val1 << shamt);
-                        break;
+
+                case 0x23: // STORE
+                    switch (d.funct3) {
+                        case 0x0: return K::Sb;
+                        case 0x1: return K::Sh;
+                        case 0x2: return K::Sw;
+                        default:  return K::Illegal;
                     }
-                    case 0x5: { // SRL / SRA
-                        uint32_t shamt = val2 & 0x1F;
-                        if (funct7 == 0x00) {
-                            // SRL
-                            write_reg(rd, val1 >> shamt);
-                        } else if (funct7 == 0x20) {
-                            // SRA
-                            int32_t sval = static_cast<int32_t>(val1);
-                            int32_t sres = sval >> static_cast<int32_t>(shamt);
-                            write_reg(rd, static_cast<uint32_t>(sres));
-                        }
-                        break;
+
+                case 0x63: // BRANCH
+                    switch (d.funct3) {
+                        case 0x0: return K::Beq;
+                        case 0x1: return K::Bne;
+                        case 0x4: return K::Blt;
+                        case 0x5: return K::Bge;
+                        case 0x6: return K::Bltu;
+                        case 0x7: return K::Bgeu;
+                        default:  return K::Illegal;
                     }
-                    default:
-                        // Other OP not implemented yet
-                        break;
+
+                case 0x6F: return K::Jal;
+                case 0x67:
+                    return (d.funct3 == 0x0) ? K::Jalr : K::Illegal;
+                case 0x17: return K::Auipc;
+                case 0x37: return K::Lui;
+
+                case 0x0F: // MISC-MEM
+                    return (d.funct3 == 0x0) ? K::Fence : K::Illegal;
+
+                case 0x07: // LOAD-FP
+                    return (d.funct3 == 0x2) ? K::Flw : K::Illegal;
+
+                case 0x27: // STORE-FP
+                    return (d.funct3 == 0x2) ? K::Fsw : K::Illegal;
+
+                case 0x53: // OP-FP
+                    return classify_fp(d);
+
+                case 0x73: { // SYSTEM
+                    if (d.raw == 0x00000073u) return K::Ecall;
+                    if (d.raw == 0x00100073u) return K::Ebreak;
+                    uint32_t csr = d.raw >> 20;
+                    bool fp_csr = csr >= 0x001 && csr <= 0x003;
+                    if (fp_csr && d.funct3 != 0x0 && d.funct3 != 0x4) return K::FpCsr;
+                    return K::Illegal; // only the float CSRs exist
                 }
-                break;
+
+                default:
+                    // opcodes not handled yet
+                    return K::Illegal;
             }
+        }
 
-            // lw
-            case 0x03: { // LOAD
-                int32_t imm = sign_extend_imm(instr >> 20, 12);
-                uint32_t base = read_reg(rs1);
-                uint32_t addr = base + static_cast<uint32_t>(imm);
-
-                switch (funct3) {
-                    case 0x2: { // load word
-                        uint32_t val = load_u32(s, addr);
-                        write_reg(rd, val);
-                        break;
-                    }
-                    default:
-                        // Other loads not implemented yet
-                        break;
-                }
-                break;
+        /***** handler_for<Kind, RdZero, Checked> *****
+         *   The handler template for a kind, specialized for rd == x0
+         *   when RdZero is set (kinds that do not write an integer rd
+         *   ignore it) and without the bounds check when Checked is
+         *   clear (only loads and stores have one)
+         ******************************/
+        template <K Kind, bool RdZero, bool Checked = true>
+        constexpr ExecFn handler_for() {
+            using rv::core::fadd_f32_u32;
+            using rv::core::fsub_f32_u32;
+            using rv::core::fmul_f32_u32;
+
+            if constexpr (is_alu_imm(Kind) || is_alu_reg(Kind)) return exec_alu<Kind, RdZero>;
+            else if constexpr (is_branch(Kind)) return exec_branch<Kind>;
+            else if constexpr (is_load(Kind))   return exec_load<Kind, RdZero, Checked>;
+            else if constexpr (is_store(Kind))  return exec_store<Kind, Checked>;
+            else if constexpr (Kind == K::Lui)     return exec_lui<RdZero>;
+            else if constexpr (Kind == K::Auipc)   return exec_auipc<RdZero>;
+            else if constexpr (Kind == K::Jal)     return exec_jal<RdZero>;
+            else if constexpr (Kind == K::Jalr)    return exec_jalr<RdZero>;
+            else if constexpr (Kind == K::Fence)   return exec_fence;
+            else if constexpr (Kind == K::Ecall)   return exec_ecall;
+            else if constexpr (Kind == K::Ebreak)  return exec_ebreak;
+            else if constexpr (Kind == K::Flw)     return exec_flw<Checked>;
+            else if constexpr (Kind == K::Fsw)     return exec_fsw<Checked>;
+            else if constexpr (Kind == K::FaddS)   return exec_fop<fadd_f32_u32>;
+            else if constexpr (Kind == K::FsubS)   return exec_fop<fsub_f32_u32>;
+            else if constexpr (Kind == K::FmulS)   return exec_fop<fmul_f32_u32>;
+            else if constexpr (Kind == K::FsgnjS)  return exec_fsgnj;
+            else if constexpr (Kind == K::FsgnjnS) return exec_fsgnjn;
+            else if constexpr (Kind == K::FsgnjxS) return exec_fsgnjx;
+            else if constexpr (Kind == K::FmvXW)   return exec_fmv_x_w<RdZero>;
+            else if constexpr (Kind == K::FmvWX)   return exec_fmv_w_x;
+            else if constexpr (Kind == K::FpCsr)   return exec_fcsr<RdZero>;
+            else {
+                static_assert(Kind == K::Illegal, "InstrKind without a handler");
+                return exec_illegal;
+            }
+        }
+
+        /***** InstrDesc *****
+         *   One row of the instruction table
+         *
+         *   kind     - the instruction
+         *   name     - its mnemonic
+         *   exec     - handler for rd != x0
+         *   exec_rd0 - handler for rd == x0 (result writes compiled out)
+         *   unchecked, unchecked_rd0 - the same two without the memory
+         *              bounds check (the same as exec / exec_rd0 for
+         *              kinds that do not access memory)
+         *   block_store, block_store_unchecked - for stores, exec and
+         *              unchecked returning CodeWritten when they drop
+         *              decoded code; nullptr for every other kind
+         ******************************/
+        struct InstrDesc {
+            InstrKind   kind;
+            const char* name;
+            ExecFn      exec;
+            ExecFn      exec_rd0;
+            ExecFn      unchecked;
+            ExecFn      unchecked_rd0;
+            ExecFn      block_store;
+            ExecFn      block_store_unchecked;
+        };
+
+        template <K Kind, bool Checked>
+        constexpr ExecFn block_store_for() {
+            if constexpr (is_store(Kind))     return exec_store<Kind, Checked, true>;
+            else if constexpr (Kind == K::Fsw) return exec_fsw<Checked, true>;
+            else                               return nullptr;
+        }
+
+        template <K Kind>
+        constexpr InstrDesc row(const char* name) {
+            return InstrDesc{ Kind, name,
+                              handler_for<Kind, false>(), handler_for<Kind, true>(),
+                              handler_for<Kind, false, false>(), handler_for<Kind, true, false>(),
+                              block_store_for<Kind, true>(), block_store_for<Kind, false>() };
+        }
+
+        /***** kInstrTable *****
+         *   Every InstrKind, in enum order; the decoder picks exec or
+         *   exec_rd0 from here once per decoded word
+         ******************************/
+        constexpr InstrDesc kInstrTable[] = {
+            row<K::Illegal>("illegal"),
+            row<K::Lui>("lui"),     row<K::Auipc>("auipc"),
+            row<K::Jal>("jal"),     row<K::Jalr>("jalr"),
+            row<K::Beq>("beq"),     row<K::Bne>("bne"),
+            row<K::Blt>("blt"),     row<K::Bge>("bge"),
+            row<K::Bltu>("bltu"),   row<K::Bgeu>("bgeu"),
+            row<K::Lb>("lb"),       row<K::Lh>("lh"),       row<K::Lw>("lw"),
+            row<K::Lbu>("lbu"),     row<K::Lhu>("lhu"),
+            row<K::Sb>("sb"),       row<K::Sh>("sh"),       row<K::Sw>("sw"),
+            row<K::Addi>("addi"),   row<K::Slti>("slti"),   row<K::Sltiu>("sltiu"),
+            row<K::Xori>("xori"),   row<K::Ori>("ori"),     row<K::Andi>("andi"),
+            row<K::Slli>("slli"),   row<K::Srli>("srli"),   row<K::Srai>("srai"),
+            row<K::Add>("add"),     row<K::Sub>("sub"),     row<K::Sll>("sll"),
+            row<K::Slt>("slt"),     row<K::Sltu>("sltu"),   row<K::Xor>("xor"),
+            row<K::Srl>("srl"),     row<K::Sra>("sra"),     row<K::Or>("or"),
+            row<K::And>("and"),
+            row<K::Fence>("fence"), row<K::Ecall>("ecall"), row<K::Ebreak>("ebreak"),
+            row<K::Mul>("mul"),     row<K::Mulh>("mulh"),
+            row<K::Mulhsu>("mulhsu"), row<K::Mulhu>("mulhu"),
+            row<K::Div>("div"),     row<K::Divu>("divu"),
+            row<K::Rem>("rem"),     row<K::Remu>("remu"),
+            row<K::Flw>("flw"),     row<K::Fsw>("fsw"),
+            row<K::FaddS>("fadd.s"), row<K::FsubS>("fsub.s"), row<K::FmulS>("fmul.s"),
+            row<K::FsgnjS>("fsgnj.s"), row<K::FsgnjnS>("fsgnjn.s"), row<K::FsgnjxS>("fsgnjx.s"),
+            row<K::FmvXW>("fmv.x.w"), row<K::FmvWX>("fmv.w.x"),
+            row<K::FpCsr>("csr"),
+        };
+        static_assert(std::size(kInstrTable) == kInstrKindCount, "one row per InstrKind");
+
+        constexpr bool table_in_kind_order() {
+            for (std::size_t i = 0; i < std::size(kInstrTable); ++i) {
+                if (static_cast<std::size_t>(kInstrTable[i].kind) != i) return false;
             }
+            return true;
+        }
+        static_assert(table_in_kind_order(), "kInstrTable rows must follow InstrKind");
+
+    } // anonymous namespace
 
-            // STORE
-            case 0x23: { // STORE
+    /***** decode *****
+     *   Pulls the fields out of an instruction word and puts the
+     *   immediate together for its format
+     *   - Also classifies it and picks the handler that step() will call,
+     *     the rd == x0 one when rd is x0
+     ******************************/
+    DecodedInstr decode(uint32_t instr) {
+        DecodedInstr d{};
+        d.raw    = instr;
+        d.opcode = static_cast<uint8_t>(instr & 0x7F);
+        d.rd     = static_cast<uint8_t>((instr >> 7) & 0x1F);
+        d.funct3 = static_cast<uint8_t>((instr >> 12) & 0x07);
+        d.rs1    = static_cast<uint8_t>((instr >> 15) & 0x1F);
+        d.rs2    = static_cast<uint8_t>((instr >> 20) & 0x1F);
+        d.funct7 = static_cast<uint8_t>((instr >> 25) & 0x7F);
+        d.valid  = true;
+
+        switch (d.opcode) {
+            case 0x13: // OP-IMM
+            case 0x03: // LOAD
+            case 0x67: // JALR
+            case 0x0F: // MISC-MEM
+            case 0x73: // SYSTEM
+            case 0x07: // LOAD-FP
+                d.format = InstrFormat::I;
+                d.imm    = sign_extend_imm(instr >> 20, 12);
+                break;
+
+            case 0x33: // OP
+            case 0x53: // OP-FP
+                d.format = InstrFormat::R;
+                d.imm    = 0;
+                break;
+
+            case 0x23:   // STORE
+            case 0x27: { // STORE-FP
                 uint32_t imm_11_5 = instr >> 25;
                 uint32_t imm_4_0  = (instr >> 7) & 0x1F;
                 uint32_t imm_u    = (imm_11_5 << 5) | imm_4_0;
-                int32_t imm       = sign_extend_imm(imm_u, 12);
-
-                uint32_t base = read_reg(rs1);
-                uint32_t addr = base + static_cast<uint32_t>(imm);
-                uint32_t val  = read_reg(rs2);
-
-                switch (funct3) {
-                    case 0x2: { // sw
-                        store_u32(s, addr, val);
-                        break;
-                    }
-                    default:
-                        // Other stores not implemented yet
-                        break;
-                }
+                d.format = InstrFormat::S;
+                d.imm    = sign_extend_imm(imm_u, 12);
                 break;
             }
 
-            // Branch
-            case 0x63: { // branch
+            case 0x63: { // BRANCH
                 uint32_t imm_12   = (instr >> 31) & 0x1;
                 uint32_t imm_10_5 = (instr >> 25) & 0x3F;
                 uint32_t imm_4_1  = (instr >> 8) & 0xF;
@@ -262,34 +775,12 @@ namespace rv::cpu {
                                | (imm_11 << 11)
                                | (imm_10_5 << 5)
                                | (imm_4_1 << 1);
-
-                int32_t offset = sign_extend_imm(imm_u, 13);
-
-                uint32_t val1 = read_reg(rs1);
-                uint32_t val2 = read_reg(rs2);
-
-                bool take = false;
-                switch (funct3) {
-                    case 0x0: // BEQ
-                        take = (val1 == val2);
-                        break;
-                    case 0x1: // BNE
-                        take = (val1 != val2);
-                        break;
-                    default:
-                        // Other branches not implemented yet
-                        break;
-                }
-
-                if (take) {
-                    next_pc = s.pc + static_cast<uint32_t>(offset);
-                }
+                d.format = InstrFormat::B;
+                d.imm    = sign_extend_imm(imm_u, 13);
                 break;
             }
 
-            // JAL
-            case 0x6F: {
-                uint32_t pc0 = s.pc;
+            case 0x6F: { // JAL
                 uint32_t imm_20    = (instr >> 31) & 0x1;
                 uint32_t imm_10_1  = (instr >> 21) & 0x3FF;
                 uint32_t imm_11    = (instr >> 20) & 0x1;
@@ -299,63 +790,118 @@ namespace rv::cpu {
                                | (imm_19_12 << 12)
                                | (imm_11 << 11)
                                | (imm_10_1 << 1);
-
-                int32_t offset = sign_extend_imm(imm_u, 21);
-
-                write_reg(rd, pc0 + 4);
-
-                next_pc = pc0 + static_cast<uint32_t>(offset);
+                d.format = InstrFormat::J;
+                d.imm    = sign_extend_imm(imm_u, 21);
                 break;
             }
 
-            // JALR
-            case 0x67: {
-                uint32_t pc0 = s.pc;
+            case 0x17: // AUIPC
+            case 0x37: // LUI
+                d.format = InstrFormat::U;
+                d.imm    = static_cast<int32_t>(instr & 0xFFFFF000u);
+                break;
 
-                int32_t imm = sign_extend_imm(instr >> 20, 12);
-                uint32_t base = read_reg(rs1);
+            default:
+                d.format = InstrFormat::Unknown;
+                d.imm    = 0;
+                break;
+        }
+        d.kind = classify(d);
+        d.exec = instr_handler(d);
+        return d;
+    }
 
-                uint32_t target = base + static_cast<uint32_t>(imm);
-                target &= ~1u; // LSB
+    /***** instr_handler *****
+     *   d's handler, straight from the table
+     ******************************/
+    ExecFn instr_handler(const DecodedInstr& d) {
+        const InstrDesc& desc = kInstrTable[static_cast<std::size_t>(d.kind)];
+        return (d.rd == 0) ? desc.exec_rd0 : desc.exec;
+    }
 
-                write_reg(rd, pc0 + 4);
+    /***** unchecked_handler *****
+     *   d's handler without the bounds check
+     ******************************/
+    ExecFn unchecked_handler(const DecodedInstr& d) {
+        const InstrDesc& desc = kInstrTable[static_cast<std::size_t>(d.kind)];
+        return (d.rd == 0) ? desc.unchecked_rd0 : desc.unchecked;
+    }
 
-                next_pc = target;
-                break;
-            }
+    /***** block_handler *****
+     *   The block engine's handler for d
+     ******************************/
+    ExecFn block_handler(const DecodedInstr& d, bool checked) {
+        const InstrDesc& desc = kInstrTable[static_cast<std::size_t>(d.kind)];
+        if (desc.block_store) return checked ? desc.block_store : desc.block_store_unchecked;
+        return checked ? instr_handler(d) : unchecked_handler(d);
+    }
 
-            case 0x17: {
-                uint32_t pc0 = s.pc;
-                uint32_t imm20 = instr & 0xFFFFF000u;
+    /***** fetch_decoded *****
+     *   Returns the decoded instruction at pc
+     *   - Decodes and fills the cache slot on a miss
+     ******************************/
+    const DecodedInstr& fetch_decoded(CpuState& s, uint32_t pc) {
+        DecodedInstr& slot = s.mem.decoded(pc);
+        if (!slot.valid) {
+            slot = decode(load_u32(s, pc));
+        }
+        return slot;
+    }
 
-                uint32_t offset = imm20;
-                write_reg(rd, pc0 + offset);
-                break;
-            }
+    /***** check_fetch *****
+     *   Checks that pc can be fetched from
+     ******************************/
+    StopReason check_fetch(const CpuState& s) {
+        if ((s.pc & 3u) != 0) return StopReason::MisalignedFetch;
+        if (uint64_t(s.pc) + 4 > s.mem.size()) return StopReason::PcOutOfRange;
+        return StopReason::None;
+    }
 
-            // LUI
-            case 0x37: {
-                uint32_t imm20 = instr & 0xFFFFF000u;
-                write_reg(rd, imm20);
-                break;
-            }
+    /***** step *****
+     *   Runs a single instruction at s.pc
+     *   - The handler was picked once at decode, so there is no
+     *     opcode switch here
+     ******************************/
+    StopReason step(CpuState& s) {
+        NullProbe none;
+        return step_with(s, none);
+    }
 
-            default:
-                // opcodes not handled yet
-                break;
+    /***** run *****
+     *   Repeatedly calls step up to max_steps, or until one stops
+     ******************************/
+    RunResult run(CpuState& s, std::size_t max_steps, ExecMode mode) {
+        if (mode == ExecMode::Blocks) {
+            return run_blocks(s, max_steps);
         }
+        NullProbe none;
+        return run_with(s, max_steps, none);
+    }
 
-        // move PC to the next instruction
-        s.pc = next_pc;
+    /***** instr_kind_name *****
+     *   Mnemonic of an InstrKind
+     ******************************/
+    const char* instr_kind_name(InstrKind k) {
+        std::size_t i = static_cast<std::size_t>(k);
+        return i < kInstrKindCount ? kInstrTable[i].name : "unknown";
     }
 
-    /***** run *****
-     *   Repeatedly calls steps up to max_steps
+    /***** stop_reason_name *****
+     *   Printable name of a StopReason
      ******************************/
-    void run(CpuState& s, std::size_t max_steps) {
-        for (std::size_t i = 0; i < max_steps; ++i) {
-            step(s);
+    const char* stop_reason_name(StopReason r) {
+        switch (r) {
+            case StopReason::None:               return "none";
+            case StopReason::StepLimit:          return "step-limit";
+            case StopReason::Ecall:              return "ecall";
+            case StopReason::Ebreak:             return "ebreak";
+            case StopReason::PcOutOfRange:       return "pc-out-of-range";
+            case StopReason::MisalignedFetch:    return "misaligned-fetch";
+            case StopReason::IllegalInstruction: return "illegal-instruction";
+            case StopReason::AccessFault:        return "access-fault";
+            case StopReason::CodeWritten:        return "code-written";
         }
+        return "unknown";
     }
 
 } // namespace rv::cpu
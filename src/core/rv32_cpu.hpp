@@ -1,35 +1,185 @@
 #pragma once
 
+#include "core/rv32_instr.hpp"
+#include "core/rv32_mem.hpp"
 #include <cstdint>
+#include <memory>
 #include <vector>
 #include <string>
 
 namespace rv::cpu {
 
+    struct BlockCache; // rv32_block.hpp
+
+    /***** BlockCacheSlot *****
+     *   Where run_blocks keeps a CPU's basic blocks between calls
+     *   - A copy starts empty: blocks are linked to each other and
+     *     patched while they run, so two CPUs never share them
+     *   - A move takes the blocks along
+     ******************************/
+    struct BlockCacheSlot {
+        std::unique_ptr<BlockCache> cache;
+
+        BlockCacheSlot() = default;
+        BlockCacheSlot(const BlockCacheSlot&);
+        BlockCacheSlot(BlockCacheSlot&&) noexcept;
+        BlockCacheSlot& operator=(const BlockCacheSlot& other);
+        BlockCacheSlot& operator=(BlockCacheSlot&& other) noexcept;
+        ~BlockCacheSlot();
+    };
+
     /***** CpuState *****
      *   The snapshot of the CPU at a moment in time
      *
      *   regs[32] - 32 general purpose registers
+     *   fregs[32] - 32 float registers (F extension), raw float32 bits
+     *   fcsr     - float control/status: accrued flags in bits 4:0
+     *              (NV DZ OF UF NX), rounding mode in bits 7:5
      *   pc       - program counter
-     *   mem      - memory
+     *   mem      - paged memory; also holds the decoded instruction for
+     *              each word that has been fetched (see rv32_mem.hpp)
+     *   code_epoch - bumped whenever a decoded instruction is dropped,
+     *                so anything built from them knows to rebuild
+     *   fault_addr - first byte address of the access that last stopped
+     *                a run with StopReason::AccessFault
+     *   blocks     - run_blocks' basic blocks, reused by the next
+     *                ExecMode::Blocks run until code_epoch moves
+     *
+     *   Writes through store_u32 and load_program keep the decoded
+     *   instructions up to date. If you write to mem by hand (operator[]),
+     *   call invalidate_icache afterwards.
      *
      * Constructor: CpuState(mem_size)
-     *     - Creates a CPU with mem_size bytes of memory
-     *     - Memory starts out zero-initialized
+     *     - Creates a CPU with mem_size bytes of memory (up to 4 GiB)
+     *     - Memory reads as zero; pages are only allocated when touched
      ******************************/
     struct CpuState {
         uint32_t regs[32];
+        uint32_t fregs[32];
+        uint32_t fcsr;
         uint32_t pc;
-        std::vector<uint8_t> mem;
+        Memory   mem;
+        uint64_t code_epoch;
+        uint32_t fault_addr;
+        BlockCacheSlot blocks;
 
         CpuState(std::size_t mem_size = 1024);
     };
 
+    /***** fcsr bits *****
+     *   Accrued exception flags in fcsr (the fflags CSR), and where
+     *   the rounding mode (frm) sits
+     ******************************/
+    constexpr uint32_t kFflagNX = 1u << 0; // inexact
+    constexpr uint32_t kFflagUF = 1u << 1; // underflow
+    constexpr uint32_t kFflagOF = 1u << 2; // overflow
+    constexpr uint32_t kFflagDZ = 1u << 3; // divide by zero
+    constexpr uint32_t kFflagNV = 1u << 4; // invalid
+    constexpr uint32_t kFrmShift = 5;
+
+    /***** CpuSnapshot *****
+     *   Saved registers, pc and memory of a CpuState
+     *   - mem shares every page with the CPU it came from; pages are
+     *     only copied when one side writes them (copy-on-write)
+     ******************************/
+    struct CpuSnapshot {
+        uint32_t regs[32];
+        uint32_t fregs[32];
+        uint32_t fcsr;
+        uint32_t pc;
+        Memory   mem;
+    };
+
+    /***** snapshot / restore *****
+     *   snapshot - saves the CPU in O(1), no page is copied
+     *   restore  - puts a saved state back, also O(1); the snapshot
+     *              can be restored again later
+     *   Decoded instructions are not saved; they are rebuilt on demand.
+     ******************************
+     * Inputs:
+     *   s    - the CPU to save / overwrite
+     *   snap - the saved state
+     ******************************/
+    CpuSnapshot snapshot(const CpuState& s);
+    void restore(CpuState& s, const CpuSnapshot& snap);
+
+    /***** fork *****
+     *   A new CPU in the same state as s, sharing its memory pages
+     *   copy-on-write
+     *   - O(1); each side only copies the pages it writes afterwards
+     *   - The two CPUs can then run on different threads
+     ******************************
+     * Input:
+     *   s - the CPU to fork (must not be running on another thread)
+     * Returns:
+     *   CpuState - the child
+     ******************************/
+    CpuState fork(const CpuState& s);
+
+    /***** decode *****
+     *   Splits a 32-bit instruction word into its fields and builds
+     *   the immediate for its format
+     ******************************
+     * Input:
+     *   instr - raw instruction word
+     * Returns:
+     *   DecodedInstr - fields, immediate and format (valid is set)
+     ******************************/
+    DecodedInstr decode(uint32_t instr);
+
+    /***** instr_handler *****
+     *   The handler decode would pick for d.kind and d.rd
+     *   - For rebuilding decoded instructions that were stored without
+     *     their handler (see rv32_dcache.hpp)
+     ******************************/
+    ExecFn instr_handler(const DecodedInstr& d);
+
+    /***** unchecked_handler *****
+     *   The handler for d with the guest memory bounds check left out
+     *   - Only safe when d's access is known to be inside memory; the
+     *     block engine uses it after checking a whole block up front
+     *   - Kinds that do not access memory get their usual handler
+     ******************************/
+    ExecFn unchecked_handler(const DecodedInstr& d);
+
+    /***** block_handler *****
+     *   The handler the block engine runs for d
+     *   - Stores return StopReason::CodeWritten (after they retire)
+     *     when they drop a decoded instruction, so a block ends there
+     *     without checking code_epoch after every op
+     *   - checked = false is unchecked_handler's bounds-check-free
+     *     variant; every other kind gets instr_handler / unchecked_handler
+     ******************************/
+    ExecFn block_handler(const DecodedInstr& d, bool checked);
+
+    /***** fetch_decoded *****
+     *   Returns the decoded instruction at pc
+     *   - Decodes the word and fills the cache slot on a miss
+     ******************************
+     * Inputs:
+     *   s  - the CPU state
+     *   pc - word-aligned address inside memory
+     * Returns:
+     *   const DecodedInstr& - the cache slot for pc
+     ******************************/
+    const DecodedInstr& fetch_decoded(CpuState& s, uint32_t pc);
+
+    /***** invalidate_icache *****
+     *   Throws away every decoded instruction in the cache
+     *   - Needed after writing to s.mem by hand through operator[]
+     ******************************
+     * Input:
+     *   s - the CpuState whose cache should be cleared
+     ******************************/
+    void invalidate_icache(CpuState& s);
+
     /***** reset *****
      *   Resets the CPU to a clean state
-     *   - Sets all registers to 0
+     *   - Sets all integer and float registers and fcsr to 0
      *   - Sets the pc to 0
-     *   - Fills memory with zeros
+     *   - Frees every memory page, so memory reads as zero again
+     *     (cost is the number of pages touched, not the memory size)
+     *   - Clears the decoded instruction cache
      ******************************
      * Input:
      *   s - the CpuState to reset
@@ -38,6 +188,8 @@ namespace rv::cpu {
 
     /***** load_program *****
      *   Loads a program into memory
+     *   - Throws std::out_of_range, before writing anything, if the
+     *     words don't fit in s.mem
      ******************************
      * Inputs:
      *   s         - the CpuState whose memory we are writing to
@@ -46,24 +198,112 @@ namespace rv::cpu {
      ******************************/
     void load_program(CpuState& s, const std::vector<uint32_t>& words, uint32_t base_addr = 0);
 
+    /***** check_fetch *****
+     *   Checks that an instruction can be fetched at s.pc
+     ******************************
+     * Input:
+     *   s - the CPU state
+     * Returns:
+     *   StopReason - None, MisalignedFetch or PcOutOfRange
+     ******************************/
+    StopReason check_fetch(const CpuState& s);
+
     /***** step *****
      *   Runs a single instruction at s.pc
      ******************************
      * Input:
      *   s - the current CPU state
+     * Returns:
+     *   StopReason - None if the instruction ran, otherwise why it
+     *                did not (the state is left untouched)
+     ******************************/
+    StopReason step(CpuState& s);
+
+    /***** ExecMode *****
+     *   How run() drives the CPU
+     *   Interpret - one step() per instruction
+     *   Blocks    - runs cached basic blocks (see rv32_block.hpp)
      ******************************/
-    void step(CpuState& s);
+    enum class ExecMode {
+        Interpret,
+        Blocks
+    };
+
+    /***** RunResult *****
+     *   How a run() ended
+     *
+     *   reason - StepLimit if the budget ran out, otherwise what stopped it
+     *   steps  - instructions retired (the one that stopped it not counted)
+     ******************************/
+    struct RunResult {
+        StopReason  reason;
+        std::size_t steps;
+    };
 
     /***** run *****
      *   Keeps calling steps in a loop
      *
      *   - Runs up to max_steps instructions.
-     *   - Stops early if pc moves to an address that is outside memory
+     *   - Stops as soon as an instruction traps (ECALL, EBREAK, illegal
+     *     encoding) or pc can't be fetched from (outside memory or not
+     *     word-aligned); s.pc is left on that instruction
+     *   - Both modes give the same result for the same program
      ******************************
      * Inputs:
      *   s         - the CPU state to run
      *   max_steps - limit to stop looping
+     *   mode      - interpreter or basic-block engine
+     * Returns:
+     *   RunResult - stop reason and number of steps retired
+     ******************************/
+    RunResult run(CpuState& s, std::size_t max_steps = 1000, ExecMode mode = ExecMode::Interpret);
+
+    /***** stop_reason_name *****
+     *   Short printable name of a StopReason ("ecall", "step-limit", ...)
+     ******************************/
+    const char* stop_reason_name(StopReason r);
+
+    /***** NullProbe *****
+     *   Probe policy for step_with / run_with that records nothing
+     *
+     *   A probe has two hooks; keep them inline so an empty one
+     *   compiles away:
+     *     before(s, d) - d is about to run at s.pc (it may still trap)
+     *     after(s, pc) - the instruction at pc retired; s is the state
+     *                    after it (d may be gone, a store can drop it)
+     ******************************/
+    struct NullProbe {
+        void before(const CpuState&, const DecodedInstr&) {}
+        void after(const CpuState&, uint32_t) {}
+    };
+
+    /***** step_with *****
+     *   step() with a probe policy (see NullProbe)
+     *   - step(s) is step_with(s, NullProbe)
+     ******************************/
+    template <class Probe>
+    inline StopReason step_with(CpuState& s, Probe& probe) {
+        if (StopReason r = check_fetch(s); r != StopReason::None) return r;
+        const uint32_t pc = s.pc;
+        const DecodedInstr& d = fetch_decoded(s, pc);
+        probe.before(s, d);
+        if (StopReason r = d.exec(s, d); r != StopReason::None) return r;
+        probe.after(s, pc);
+        return StopReason::None;
+    }
+
+    /***** run_with *****
+     *   run() in Interpret mode with a probe policy
+     *   - run(s, n, ExecMode::Interpret) is run_with(s, n, NullProbe)
+     *   - The block engine has no probe hooks; probed runs always
+     *     interpret
      ******************************/
-    void run(CpuState& s, std::size_t max_steps = 1000);
+    template <class Probe>
+    RunResult run_with(CpuState& s, std::size_t max_steps, Probe& probe) {
+        for (std::size_t i = 0; i < max_steps; ++i) {
+            if (StopReason r = step_with(s, probe); r != StopReason::None) return {r, i};
+        }
+        return {StopReason::StepLimit, max_steps};
+    }
 
 } // namespace rv::cpu
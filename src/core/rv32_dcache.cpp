@@ -0,0 +1,264 @@
+#include "core/rv32_dcache.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+namespace rv::cpu {
+
+    namespace {
+
+        constexpr char        kMagic[4]    = {'R', 'V', 'D', 'C'};
+        constexpr uint32_t    kVersion     = 2;
+        constexpr std::size_t kHeaderSize  = 48;
+        constexpr std::size_t kRecordSize  = 20;
+
+        constexpr uint64_t kFnvOffset = 0xcbf29ce484222325ull;
+        constexpr uint64_t kFnvPrime  = 0x100000001b3ull;
+
+        void put32(uint8_t* p, uint32_t v) {
+            for (int i = 0; i < 4; ++i) p[i] = static_cast<uint8_t>(v >> (8 * i));
+        }
+
+        void put64(uint8_t* p, uint64_t v) {
+            put32(p, static_cast<uint32_t>(v));
+            put32(p + 4, static_cast<uint32_t>(v >> 32));
+        }
+
+        uint32_t get32(const uint8_t* p) {
+            return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+        }
+
+        uint64_t get64(const uint8_t* p) {
+            return uint64_t(get32(p)) | (uint64_t(get32(p + 4)) << 32);
+        }
+
+        uint64_t fnv1a(uint64_t h, const uint8_t* p, std::size_t n) {
+            for (std::size_t i = 0; i < n; ++i) {
+                h ^= p[i];
+                h *= kFnvPrime;
+            }
+            return h;
+        }
+
+        /***** header fields *****
+         *   byte offsets inside the 48-byte header
+         ******************************/
+        constexpr std::size_t kOffVersion     = 4;
+        constexpr std::size_t kOffBase        = 8;
+        constexpr std::size_t kOffSize        = 12;
+        constexpr std::size_t kOffTextHash    = 16;
+        constexpr std::size_t kOffCount       = 24;
+        constexpr std::size_t kOffRecordsHash = 32;
+        constexpr std::size_t kOffBuild       = 40;
+
+        /***** build_fingerprint *****
+         *   Hash of what the records' kind and format bytes mean in this
+         *   build: the InstrKind names in order and the format count
+         *   - A build that adds, drops or reorders an instruction reads
+         *     every older file as a miss
+         ******************************/
+        uint64_t build_fingerprint() {
+            static const uint64_t fp = [] {
+                uint8_t counts[8];
+                put32(counts, static_cast<uint32_t>(kInstrKindCount));
+                put32(counts + 4, static_cast<uint32_t>(InstrFormat::Unknown) + 1);
+                uint64_t h = fnv1a(kFnvOffset, counts, sizeof counts);
+                for (std::size_t k = 0; k < kInstrKindCount; ++k) {
+                    const char* name = instr_kind_name(static_cast<InstrKind>(k));
+                    h = fnv1a(h, reinterpret_cast<const uint8_t*>(name), std::strlen(name) + 1);
+                }
+                return h;
+            }();
+            return fp;
+        }
+
+        /***** put_record / get_record *****
+         *   One decoded word <-> 20 record bytes
+         *   offset(4) raw(4) imm(4) kind format opcode rd rs1 rs2 funct3 funct7
+         ******************************/
+        void put_record(uint8_t* p, uint32_t offset, const DecodedInstr& d) {
+            put32(p, offset);
+            put32(p + 4, d.raw);
+            put32(p + 8, static_cast<uint32_t>(d.imm));
+            p[12] = static_cast<uint8_t>(d.kind);
+            p[13] = static_cast<uint8_t>(d.format);
+            p[14] = d.opcode;
+            p[15] = d.rd;
+            p[16] = d.rs1;
+            p[17] = d.rs2;
+            p[18] = d.funct3;
+            p[19] = d.funct7;
+        }
+
+        bool get_record(const uint8_t* p, uint32_t& offset, DecodedInstr& d) {
+            if (p[12] >= kInstrKindCount) return false;
+            if (p[13] > static_cast<uint8_t>(InstrFormat::Unknown)) return false;
+            if (p[15] >= 32 || p[16] >= 32 || p[17] >= 32) return false;
+
+            offset   = get32(p);
+            d        = DecodedInstr{};
+            d.raw    = get32(p + 4);
+            d.imm    = static_cast<int32_t>(get32(p + 8));
+            d.kind   = static_cast<InstrKind>(p[12]);
+            d.format = static_cast<InstrFormat>(p[13]);
+            d.opcode = p[14];
+            d.rd     = p[15];
+            d.rs1    = p[16];
+            d.rs2    = p[17];
+            d.funct3 = p[18];
+            d.funct7 = p[19];
+            d.valid  = true;
+            d.exec   = instr_handler(d);
+            return true;
+        }
+
+        /***** MappedCache *****
+         *   A cache file mmap'd read-only for the length of one load
+         ******************************/
+        struct MappedCache {
+            const uint8_t* data = nullptr;
+            std::size_t    size = 0;
+
+            explicit MappedCache(const std::string& path) {
+                int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+                if (fd < 0) return;
+                struct stat st {};
+                if (fstat(fd, &st) == 0 && st.st_size > 0) {
+                    void* p = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+                    if (p != MAP_FAILED) {
+                        data = static_cast<const uint8_t*>(p);
+                        size = static_cast<std::size_t>(st.st_size);
+                    }
+                }
+                ::close(fd); // the mapping stays valid
+            }
+
+            ~MappedCache() {
+                if (data) munmap(const_cast<uint8_t*>(data), size);
+            }
+
+            MappedCache(const MappedCache&) = delete;
+            MappedCache& operator=(const MappedCache&) = delete;
+        };
+
+    } // anonymous namespace
+
+    /***** text_hash *****
+     *   Hashes the text a page-sized piece at a time
+     ******************************/
+    uint64_t text_hash(const Memory& mem, uint32_t base, uint32_t size) {
+        uint8_t buf[Memory::kPageSize];
+        uint64_t h = kFnvOffset;
+        uint32_t done = 0;
+        while (done < size) {
+            uint32_t n = std::min<uint32_t>(size - done, Memory::kPageSize);
+            mem.read_bytes(base + done, buf, n);
+            h = fnv1a(h, buf, n);
+            done += n;
+        }
+        return h;
+    }
+
+    /***** decode_cache_path *****/
+    std::string decode_cache_path(const std::string& dir, uint64_t hash) {
+        char name[24];
+        std::snprintf(name, sizeof name, "%016llx.rvdc", static_cast<unsigned long long>(hash));
+        return dir + "/" + name;
+    }
+
+    /***** save_decode_cache *****
+     *   Header first, then one record per valid slot in address order
+     ******************************/
+    std::size_t save_decode_cache(const CpuState& s, uint32_t base, uint32_t size,
+                                  const std::string& path) {
+        if ((base & 3u) != 0 || !s.mem.in_range(base, size)) {
+            throw std::runtime_error("Decode cache text range must be word-aligned and inside guest memory");
+        }
+
+        std::vector<uint8_t> out(kHeaderSize);
+        for (uint32_t off = 0; off + 4 <= size; off += 4) {
+            const DecodedInstr* d = s.mem.peek_decoded(base + off);
+            if (!d || !d->valid) continue;
+            std::size_t at = out.size();
+            out.resize(at + kRecordSize);
+            put_record(out.data() + at, off, *d);
+        }
+        std::size_t count = (out.size() - kHeaderSize) / kRecordSize;
+
+        uint8_t* h = out.data();
+        std::memcpy(h, kMagic, sizeof kMagic);
+        put32(h + kOffVersion, kVersion);
+        put32(h + kOffBase, base);
+        put32(h + kOffSize, size);
+        put64(h + kOffTextHash, text_hash(s.mem, base, size));
+        put64(h + kOffCount, count);
+        put64(h + kOffRecordsHash, fnv1a(kFnvOffset, h + kHeaderSize, out.size() - kHeaderSize));
+        put64(h + kOffBuild, build_fingerprint());
+
+        // a unique temporary next to path, so concurrent saves (other
+        // threads or processes) never share one
+        std::string tmp = path + ".XXXXXX";
+        int fd = ::mkstemp(tmp.data());
+        if (fd < 0) throw std::runtime_error("Cannot create a temporary file for " + path);
+        ::fchmod(fd, 0644);
+        std::FILE* f = ::fdopen(fd, "wb");
+        if (!f) {
+            ::close(fd);
+            std::remove(tmp.c_str());
+            throw std::runtime_error("Cannot open " + tmp);
+        }
+        bool ok = std::fwrite(out.data(), 1, out.size(), f) == out.size();
+        ok &= std::fclose(f) == 0;
+        if (!ok || std::rename(tmp.c_str(), path.c_str()) != 0) {
+            std::remove(tmp.c_str());
+            throw std::runtime_error("Cannot write " + path);
+        }
+        return count;
+    }
+
+    /***** load_decode_cache *****
+     *   Checks the whole file before it fills a single slot
+     ******************************/
+    DecodeCacheLoad load_decode_cache(CpuState& s, uint32_t base, uint32_t size,
+                                      const std::string& path) {
+        const DecodeCacheLoad miss{false, 0};
+        if ((base & 3u) != 0 || !s.mem.in_range(base, size)) return miss;
+
+        MappedCache file(path);
+        if (file.size < kHeaderSize) return miss;
+        const uint8_t* h = file.data;
+
+        if (std::memcmp(h, kMagic, sizeof kMagic) != 0) return miss;
+        if (get32(h + kOffVersion) != kVersion) return miss;
+        if (get64(h + kOffBuild) != build_fingerprint()) return miss;
+        if (get32(h + kOffBase) != base || get32(h + kOffSize) != size) return miss;
+
+        uint64_t count = get64(h + kOffCount);
+        if (count > (file.size - kHeaderSize) / kRecordSize) return miss;
+        const uint8_t* recs = h + kHeaderSize;
+        std::size_t rec_bytes = static_cast<std::size_t>(count) * kRecordSize;
+        if (fnv1a(kFnvOffset, recs, rec_bytes) != get64(h + kOffRecordsHash)) return miss;
+        if (text_hash(s.mem, base, size) != get64(h + kOffTextHash)) return miss;
+
+        std::vector<std::pair<uint32_t, DecodedInstr>> slots(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            uint32_t off = 0;
+            DecodedInstr d;
+            if (!get_record(recs + i * kRecordSize, off, d)) return miss;
+            if ((off & 3u) != 0 || uint64_t(off) + 4 > size) return miss;
+            if (s.mem.load_u32(base + off) != d.raw) return miss; // stale
+            slots[i] = {base + off, d};
+        }
+
+        for (const auto& [pc, d] : slots) s.mem.decoded(pc) = d;
+        return DecodeCacheLoad{true, slots.size()};
+    }
+
+} // namespace rv::cpu
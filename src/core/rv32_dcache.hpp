@@ -0,0 +1,90 @@
+#pragma once
+
+#include "core/rv32_cpu.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace rv::cpu {
+
+    /***** decode cache files *****
+     *   The decoded instructions of a program's text, saved so a later
+     *   run of the same program can skip decode
+     *
+     *   File layout (little endian):
+     *     header  - "RVDC", version, text base and size, FNV-1a 64
+     *               hash of the text bytes, record count, hash of the
+     *               records, build fingerprint (hash of the InstrKind
+     *               names in order, so the kind bytes mean the same)
+     *     records - one per decoded word: offset into the text, the
+     *               raw word, imm, InstrKind index, format and fields
+     *
+     *   Handlers are not stored (their addresses change from build to
+     *   build); they come back from the InstrKind through the
+     *   instruction table.
+     ******************************/
+
+    /***** DecodeCacheLoad *****
+     *   What load_decode_cache did
+     *
+     *   hit   - the file matched the text in memory and was used
+     *   words - decode slots filled from it
+     ******************************/
+    struct DecodeCacheLoad {
+        bool        hit;
+        std::size_t words;
+    };
+
+    /***** text_hash *****
+     *   FNV-1a 64 hash of guest bytes [base, base + size)
+     *   - The key for a program's decode cache
+     ******************************/
+    uint64_t text_hash(const Memory& mem, uint32_t base, uint32_t size);
+
+    /***** decode_cache_path *****
+     *   "<dir>/<hash as 16 hex digits>.rvdc"
+     ******************************/
+    std::string decode_cache_path(const std::string& dir, uint64_t hash);
+
+    /***** save_decode_cache *****
+     *   Writes every decoded slot in [base, base + size) to path
+     *   - Only words that were fetched (run the program first, or
+     *     call fetch_decoded on the words you want) are saved
+     *   - Writes to a unique temporary file (mkstemp) next to path and
+     *     renames it, so readers never see half a file and concurrent
+     *     saves never clash
+     *   - Throws std::runtime_error if the file can't be written
+     ******************************
+     * Inputs:
+     *   s    - CPU whose decode slots to save
+     *   base - first byte of the text (word-aligned)
+     *   size - text size in bytes
+     *   path - file to write
+     * Returns:
+     *   std::size_t - records written
+     ******************************/
+    std::size_t save_decode_cache(const CpuState& s, uint32_t base, uint32_t size,
+                                  const std::string& path);
+
+    /***** load_decode_cache *****
+     *   Fills s's decode slots from a file written by save_decode_cache
+     *   - The file is mmap'd read-only
+     *   - Used only if it was written by a build with the same
+     *     instruction table, its base, size and text hash match the
+     *     bytes in s.mem now, its records hash checks out, and every
+     *     record's raw word is still the word at its address;
+     *     otherwise nothing is touched and hit is false
+     *   - A missing or unreadable file is a miss, not an error
+     ******************************
+     * Inputs:
+     *   s    - CPU with the program already loaded
+     *   base - first byte of the text (word-aligned)
+     *   size - text size in bytes
+     *   path - file to read
+     * Returns:
+     *   DecodeCacheLoad
+     ******************************/
+    DecodeCacheLoad load_decode_cache(CpuState& s, uint32_t base, uint32_t size,
+                                      const std::string& path);
+
+} // namespace rv::cpu
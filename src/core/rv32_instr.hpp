@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace rv::cpu {
+
+    /***** InstrFormat *****
+     *   The RV32 encoding formats the decoder knows about
+     *   R, I, S, B, U, J - the standard formats
+     *   Unknown          - opcode the CPU does not handle
+     ******************************/
+    enum class InstrFormat : uint8_t {
+        R,
+        I,
+        S,
+        B,
+        U,
+        J,
+        Unknown
+    };
+
+    /***** StopReason *****
+     *   Why run() / step() stopped
+     *
+     *   None               - nothing happened, keep going (handlers only)
+     *   StepLimit          - the step budget ran out
+     *   Ecall / Ebreak     - the program asked the host for something
+     *   PcOutOfRange       - pc points past the end of memory
+     *   MisalignedFetch    - pc is not a multiple of 4
+     *   IllegalInstruction - an encoding the CPU does not implement
+     *   AccessFault        - a load or store reached past the end of
+     *                        memory (CpuState::fault_addr has the address)
+     *   CodeWritten        - a store overwrote decoded code (block
+     *                        engine handlers only, never returned by run())
+     *
+     *   For every reason except StepLimit and CodeWritten the instruction
+     *   at pc did not run: registers, memory and pc are as they were
+     *   before it. A CodeWritten store has retired.
+     ******************************/
+    enum class StopReason : uint8_t {
+        None,
+        StepLimit,
+        Ecall,
+        Ebreak,
+        PcOutOfRange,
+        MisalignedFetch,
+        IllegalInstruction,
+        AccessFault,
+        CodeWritten
+    };
+
+    /***** InstrKind *****
+     *   Every instruction the CPU implements, one entry per handler
+     *   - Illegal is anything else
+     *   - FpCsr is CSRRW/S/C(I) on fflags, frm or fcsr
+     ******************************/
+    enum class InstrKind : uint8_t {
+        Illegal,
+        Lui, Auipc, Jal, Jalr,
+        Beq, Bne, Blt, Bge, Bltu, Bgeu,
+        Lb, Lh, Lw, Lbu, Lhu,
+        Sb, Sh, Sw,
+        Addi, Slti, Sltiu, Xori, Ori, Andi,
+        Slli, Srli, Srai,
+        Add, Sub, Sll, Slt, Sltu,
+        Xor, Srl, Sra, Or, And,
+        Fence, Ecall, Ebreak,
+        Mul, Mulh, Mulhsu, Mulhu,
+        Div, Divu, Rem, Remu,
+        Flw, Fsw,
+        FaddS, FsubS, FmulS,
+        FsgnjS, FsgnjnS, FsgnjxS,
+        FmvXW, FmvWX,
+        FpCsr,
+        Count
+    };
+
+    constexpr std::size_t kInstrKindCount = static_cast<std::size_t>(InstrKind::Count);
+
+    /***** instr_kind_name *****
+     *   Mnemonic of an InstrKind ("addi", "fadd.s", ...)
+     ******************************/
+    const char* instr_kind_name(InstrKind k);
+
+    struct CpuState;
+    struct DecodedInstr;
+
+    /***** ExecFn *****
+     *   Handler that runs one decoded instruction
+     *   - Updates registers/memory and moves s.pc on
+     *   - Returns StopReason::None, or why the instruction trapped
+     *     (then it must leave the state untouched)
+     ******************************/
+    using ExecFn = StopReason (*)(CpuState& s, const DecodedInstr& d);
+
+    /***** DecodedInstr *****
+     *   One instruction after decode, so step() does not have to
+     *   pull the fields out of the word again
+     *
+     *   raw      - the original 32-bit instruction word
+     *   imm      - the immediate, already put together and sign-extended
+     *   opcode, rd, rs1, rs2, funct3, funct7 - the instruction fields
+     *   kind     - which instruction it is (picks exec)
+     *   format   - which encoding format the opcode uses
+     *   valid    - false if this cache slot has not been decoded yet
+     *   exec     - handler picked at decode time for this instruction
+     ******************************/
+    struct DecodedInstr {
+        ExecFn      exec;
+        uint32_t    raw;
+        int32_t     imm;
+        uint8_t     opcode;
+        uint8_t     rd;
+        uint8_t     rs1;
+        uint8_t     rs2;
+        uint8_t     funct3;
+        uint8_t     funct7;
+        InstrKind   kind;
+        InstrFormat format : 4;
+        bool        valid  : 1;
+    };
+
+    // format and valid share a byte so a slot stays 24 bytes
+    static_assert(sizeof(DecodedInstr) <= 24, "decode slots should stay small");
+
+} // namespace rv::cpu
@@ -0,0 +1,452 @@
+#include "core/rv32_jobs.hpp"
+#include "core/rv32_parallel.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <fcntl.h>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <poll.h>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+
+namespace rv::cpu {
+
+    namespace {
+
+        /***** Writer / Reader *****
+         *   Little-endian fields in and out of a payload
+         *   - Reader throws when the payload runs out
+         ******************************/
+        struct Writer {
+            std::vector<uint8_t>& out;
+
+            void u8(uint8_t v) { out.push_back(v); }
+            void u32(uint32_t v) {
+                for (int i = 0; i < 4; ++i) out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+            }
+            void u64(uint64_t v) {
+                u32(static_cast<uint32_t>(v));
+                u32(static_cast<uint32_t>(v >> 32));
+            }
+        };
+
+        struct Reader {
+            std::span<const uint8_t> in;
+            std::size_t              at = 0;
+
+            void need(std::size_t n) const {
+                if (in.size() - at < n) throw std::runtime_error("Truncated job frame");
+            }
+            uint8_t u8() {
+                need(1);
+                return in[at++];
+            }
+            uint32_t u32() {
+                need(4);
+                uint32_t v = uint32_t(in[at]) | (uint32_t(in[at + 1]) << 8) |
+                             (uint32_t(in[at + 2]) << 16) | (uint32_t(in[at + 3]) << 24);
+                at += 4;
+                return v;
+            }
+            uint64_t u64() {
+                uint64_t lo = u32();
+                return lo | (uint64_t(u32()) << 32);
+            }
+        };
+
+        /***** Stopped *****
+         *   Thrown by read_all when its stop_fd becomes readable
+         ******************************/
+        struct Stopped {};
+
+        /***** read_all / write_all *****
+         *   Loops over short reads/writes and EINTR
+         *   - If stop_fd is not -1, read_all waits in poll() on fd and
+         *     stop_fd together and throws Stopped once stop_fd is
+         *     readable, so another thread can end a blocked read
+         * Returns:
+         *   read_all - bytes read; less than n only at end of stream
+         ******************************/
+        std::size_t read_all(int fd, uint8_t* p, std::size_t n, int stop_fd = -1) {
+            std::size_t got = 0;
+            while (got < n) {
+                if (stop_fd >= 0) {
+                    pollfd fds[2] = { { fd, POLLIN, 0 }, { stop_fd, POLLIN, 0 } };
+                    if (::poll(fds, 2, -1) < 0) {
+                        if (errno == EINTR) continue;
+                        throw std::runtime_error(std::string("Job stream poll failed: ") + std::strerror(errno));
+                    }
+                    if (fds[1].revents) throw Stopped{};
+                }
+                ssize_t r = ::read(fd, p + got, n - got);
+                if (r == 0) break;
+                if (r < 0) {
+                    if (errno == EINTR) continue;
+                    throw std::runtime_error(std::string("Job stream read failed: ") + std::strerror(errno));
+                }
+                got += static_cast<std::size_t>(r);
+            }
+            return got;
+        }
+
+        void write_all(int fd, const uint8_t* p, std::size_t n) {
+            while (n > 0) {
+                ssize_t w = ::write(fd, p, n);
+                if (w < 0) {
+                    if (errno == EINTR) continue;
+                    throw std::runtime_error(std::string("Job stream write failed: ") + std::strerror(errno));
+                }
+                p += w;
+                n -= static_cast<std::size_t>(w);
+            }
+        }
+
+        /***** read_frame_from *****
+         *   read_frame, stoppable through stop_fd (see read_all)
+         ******************************/
+        bool read_frame_from(int fd, std::vector<uint8_t>& payload, int stop_fd) {
+            uint8_t len_bytes[4];
+            std::size_t got = read_all(fd, len_bytes, sizeof len_bytes, stop_fd);
+            if (got == 0) return false;
+            if (got != sizeof len_bytes) throw std::runtime_error("Truncated frame length");
+
+            uint32_t len = uint32_t(len_bytes[0]) | (uint32_t(len_bytes[1]) << 8) |
+                           (uint32_t(len_bytes[2]) << 16) | (uint32_t(len_bytes[3]) << 24);
+            if (len > kMaxFrameSize) throw std::runtime_error("Frame too large");
+
+            payload.resize(len);
+            if (read_all(fd, payload.data(), len, stop_fd) != len) throw std::runtime_error("Truncated frame");
+            return true;
+        }
+
+        /***** JobFeed *****
+         *   Jobs decoded by the reader thread, waiting for a batch
+         *   - Holds at most cap jobs: the reader waits for room before it
+         *     reads the next frame, so a fast client can't grow it
+         *     without bound
+         *   - close() tells the reader to stop: it wakes it from a full
+         *     feed or, through the stop pipe, from a blocked read, so
+         *     the reader can always be joined
+         ******************************/
+        struct JobFeed {
+            std::mutex              m;
+            std::condition_variable ready; // jobs arrived, or done
+            std::condition_variable room;  // a batch took jobs, or closed
+            std::deque<Job>         jobs;
+            std::size_t             cap;
+            bool                    done = false;
+            bool                    closed = false;
+            std::exception_ptr      error;
+            int                     stop[2] = { -1, -1 };
+
+            explicit JobFeed(std::size_t c) : cap(std::max<std::size_t>(c, 1)) {
+                if (::pipe2(stop, O_CLOEXEC) != 0) throw std::runtime_error("Cannot create the job reader's stop pipe");
+            }
+
+            ~JobFeed() {
+                ::close(stop[0]);
+                ::close(stop[1]);
+            }
+
+            JobFeed(const JobFeed&) = delete;
+            JobFeed& operator=(const JobFeed&) = delete;
+
+            void close() {
+                {
+                    std::lock_guard<std::mutex> lock(m);
+                    closed = true;
+                }
+                room.notify_one();
+                uint8_t b = 0;
+                while (::write(stop[1], &b, 1) < 0 && errno == EINTR) {}
+            }
+        };
+
+        void reader_loop(int fd, JobFeed& feed) {
+            try {
+                std::vector<uint8_t> payload;
+                for (;;) {
+                    {
+                        std::unique_lock<std::mutex> lock(feed.m);
+                        feed.room.wait(lock, [&] { return feed.jobs.size() < feed.cap || feed.closed; });
+                        if (feed.closed) break;
+                    }
+                    if (!read_frame_from(fd, payload, feed.stop[0])) break;
+                    Job job = decode_job(payload);
+                    std::lock_guard<std::mutex> lock(feed.m);
+                    feed.jobs.push_back(std::move(job));
+                    feed.ready.notify_one();
+                }
+            } catch (const Stopped&) {
+                // the serving side gave up; nobody reads the feed now
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(feed.m);
+                feed.error = std::current_exception();
+            }
+            std::lock_guard<std::mutex> lock(feed.m);
+            feed.done = true;
+            feed.ready.notify_one();
+        }
+
+        /***** job_fits / prepare_cpu *****
+         *   job_fits    - the image fits in the job's memory
+         *   prepare_cpu - loads a job into a fresh CPU
+         ******************************/
+        bool job_fits(const Job& job) {
+            return job.mem_size >= 4 && uint64_t(job.base) + job.image.size() <= job.mem_size;
+        }
+
+        void prepare_cpu(CpuState& s, const Job& job) {
+            std::copy(std::begin(job.regs), std::end(job.regs), s.regs);
+            s.regs[0] = 0;
+            std::copy(std::begin(job.fregs), std::end(job.fregs), s.fregs);
+            s.fcsr = job.fcsr & 0xFFu;
+            if (!job.image.empty()) s.mem.write_bytes(job.base, job.image.data(), job.image.size());
+            s.pc = job.entry;
+        }
+
+        JobResult finish(const Job& job, const CpuState& s, StopReason reason, std::size_t steps) {
+            JobResult r{ job.id, true, reason, steps, s.pc, s.fault_addr, {}, {}, s.fcsr };
+            std::copy(std::begin(s.regs), std::end(s.regs), r.regs);
+            std::copy(std::begin(s.fregs), std::end(s.fregs), r.fregs);
+            return r;
+        }
+
+        JobResult bad_job(const Job& job) {
+            return JobResult{ job.id, false, StopReason::None, 0, 0, 0, {}, {}, 0 };
+        }
+
+        /***** run_batch *****
+         *   Runs a batch on the server's pool, every job with its own
+         *   budget and mode
+         ******************************/
+        std::vector<JobResult> run_batch(const std::vector<Job>& jobs, RunPool& pool) {
+            std::vector<JobResult> results(jobs.size());
+            std::vector<std::size_t> idx;
+            std::vector<CpuState> states;
+            states.reserve(jobs.size()); // RunTask points into it
+            for (std::size_t i = 0; i < jobs.size(); ++i) {
+                if (!job_fits(jobs[i])) {
+                    results[i] = bad_job(jobs[i]);
+                    continue;
+                }
+                idx.push_back(i);
+                states.emplace_back(jobs[i].mem_size);
+                prepare_cpu(states.back(), jobs[i]);
+            }
+
+            std::vector<RunTask> tasks;
+            tasks.reserve(idx.size());
+            for (std::size_t k = 0; k < idx.size(); ++k) {
+                const Job& job = jobs[idx[k]];
+                tasks.push_back(RunTask{ &states[k], static_cast<std::size_t>(job.max_steps), job.mode });
+            }
+            std::vector<RunManyResult> rr = pool.run(tasks);
+
+            for (std::size_t k = 0; k < idx.size(); ++k) {
+                results[idx[k]] = finish(jobs[idx[k]], states[k], rr[k].reason, rr[k].steps);
+            }
+            return results;
+        }
+
+    } // anonymous namespace
+
+    /***** encode_job / decode_job *****/
+    std::vector<uint8_t> encode_job(const Job& job) {
+        std::vector<uint8_t> out;
+        out.reserve(kJobHeaderSize + job.image.size());
+        Writer w{out};
+        w.u8(kJobFormatVersion);
+        w.u64(job.id);
+        w.u32(job.mem_size);
+        w.u32(job.base);
+        w.u32(job.entry);
+        w.u64(job.max_steps);
+        w.u8(job.mode == ExecMode::Blocks ? 1 : 0);
+        for (uint32_t r : job.regs) w.u32(r);
+        for (uint32_t f : job.fregs) w.u32(f);
+        w.u32(job.fcsr);
+        out.insert(out.end(), job.image.begin(), job.image.end());
+        return out;
+    }
+
+    Job decode_job(std::span<const uint8_t> payload) {
+        Reader rd{payload};
+        Job job{};
+        if (rd.u8() != kJobFormatVersion) throw std::runtime_error("Job frame: unsupported format version");
+        job.id        = rd.u64();
+        job.mem_size  = rd.u32();
+        job.base      = rd.u32();
+        job.entry     = rd.u32();
+        job.max_steps = rd.u64();
+        uint8_t mode  = rd.u8();
+        if (mode > 1) throw std::runtime_error("Job frame: bad exec mode");
+        job.mode = mode ? ExecMode::Blocks : ExecMode::Interpret;
+        for (uint32_t& r : job.regs) r = rd.u32();
+        for (uint32_t& f : job.fregs) f = rd.u32();
+        job.fcsr = rd.u32();
+        job.image.assign(payload.begin() + static_cast<std::ptrdiff_t>(rd.at), payload.end());
+        return job;
+    }
+
+    /***** encode_result / decode_result *****/
+    std::vector<uint8_t> encode_result(const JobResult& r) {
+        std::vector<uint8_t> out;
+        out.reserve(kJobResultSize);
+        Writer w{out};
+        w.u8(kJobFormatVersion);
+        w.u64(r.id);
+        w.u8(r.ok ? 0 : 1);
+        w.u8(static_cast<uint8_t>(r.reason));
+        w.u64(r.steps);
+        w.u32(r.pc);
+        w.u32(r.fault_addr);
+        for (uint32_t x : r.regs) w.u32(x);
+        for (uint32_t f : r.fregs) w.u32(f);
+        w.u32(r.fcsr);
+        return out;
+    }
+
+    JobResult decode_result(std::span<const uint8_t> payload) {
+        if (payload.size() != kJobResultSize) throw std::runtime_error("Result frame has the wrong size");
+        Reader rd{payload};
+        JobResult r{};
+        if (rd.u8() != kJobFormatVersion) throw std::runtime_error("Result frame: unsupported format version");
+        r.id         = rd.u64();
+        r.ok         = rd.u8() == 0;
+        r.reason     = static_cast<StopReason>(rd.u8());
+        r.steps      = rd.u64();
+        r.pc         = rd.u32();
+        r.fault_addr = rd.u32();
+        for (uint32_t& x : r.regs) x = rd.u32();
+        for (uint32_t& f : r.fregs) f = rd.u32();
+        r.fcsr       = rd.u32();
+        return r;
+    }
+
+    /***** read_frame / write_frame *****/
+    bool read_frame(int fd, std::vector<uint8_t>& payload) {
+        return read_frame_from(fd, payload, -1);
+    }
+
+    void write_frame(int fd, std::span<const uint8_t> payload) {
+        if (payload.size() > kMaxFrameSize) throw std::runtime_error("Frame too large");
+        std::vector<uint8_t> buf;
+        buf.reserve(4 + payload.size());
+        Writer{buf}.u32(static_cast<uint32_t>(payload.size()));
+        buf.insert(buf.end(), payload.begin(), payload.end());
+        write_all(fd, buf.data(), buf.size());
+    }
+
+    /***** run_job *****/
+    JobResult run_job(const Job& job) {
+        if (!job_fits(job)) return bad_job(job);
+        CpuState s(job.mem_size);
+        prepare_cpu(s, job);
+        RunResult r = run(s, static_cast<std::size_t>(job.max_steps), job.mode);
+        return finish(job, s, r.reason, r.steps);
+    }
+
+    /***** serve_jobs *****
+     *   Reader thread -> JobFeed -> batches on pool -> out_fd
+     ******************************/
+    std::size_t serve_jobs(int in_fd, int out_fd, RunPool& pool, const JobServerOptions& opts) {
+        const std::size_t batch_max = std::max<std::size_t>(opts.batch, 1);
+        JobFeed feed(opts.queue ? opts.queue : batch_max);
+        std::thread reader(reader_loop, in_fd, std::ref(feed));
+        std::size_t answered = 0;
+
+        try {
+            for (;;) {
+                std::vector<Job> batch;
+                std::exception_ptr error;
+                {
+                    std::unique_lock<std::mutex> lock(feed.m);
+                    feed.ready.wait(lock, [&] { return !feed.jobs.empty() || feed.done; });
+                    while (!feed.jobs.empty() && batch.size() < batch_max) {
+                        batch.push_back(std::move(feed.jobs.front()));
+                        feed.jobs.pop_front();
+                    }
+                    if (batch.empty()) error = feed.error; // done and drained
+                }
+                feed.room.notify_one();
+
+                if (batch.empty()) {
+                    reader.join();
+                    if (error) std::rethrow_exception(error);
+                    return answered;
+                }
+
+                std::vector<JobResult> results = run_batch(batch, pool);
+                std::vector<uint8_t> out;
+                for (const JobResult& r : results) {
+                    std::vector<uint8_t> payload = encode_result(r);
+                    Writer{out}.u32(static_cast<uint32_t>(payload.size()));
+                    out.insert(out.end(), payload.begin(), payload.end());
+                }
+                write_all(out_fd, out.data(), out.size());
+                answered += results.size();
+            }
+        } catch (...) {
+            if (reader.joinable()) {
+                feed.close(); // wakes it from a full feed or a blocked read
+                reader.join();
+            }
+            throw;
+        }
+    }
+
+    std::size_t serve_jobs(int in_fd, int out_fd, const JobServerOptions& opts) {
+        RunPool pool(opts.threads, opts.quantum);
+        return serve_jobs(in_fd, out_fd, pool, opts);
+    }
+
+    /***** serve_unix_socket *****
+     *   One thread per connection over a process-wide RunPool; each
+     *   connection holds a reference, so the pool outlives a failed
+     *   accept loop until the last connection ends
+     ******************************/
+    void serve_unix_socket(const std::string& path, const JobServerOptions& opts) {
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if (path.size() >= sizeof addr.sun_path) throw std::runtime_error("Socket path too long: " + path);
+        std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+        int lfd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (lfd < 0) throw std::runtime_error("Cannot create socket");
+        ::unlink(path.c_str());
+        if (::bind(lfd, reinterpret_cast<const sockaddr*>(&addr), sizeof addr) != 0 || ::listen(lfd, 16) != 0) {
+            ::close(lfd);
+            throw std::runtime_error("Cannot listen on " + path);
+        }
+
+        auto pool = std::make_shared<RunPool>(opts.threads, opts.quantum);
+        for (;;) {
+            int cfd = ::accept4(lfd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (cfd < 0) {
+                if (errno == EINTR || errno == ECONNABORTED) continue;
+                ::close(lfd);
+                throw std::runtime_error(std::string("accept failed: ") + std::strerror(errno));
+            }
+            std::thread([cfd, opts, pool] {
+                try {
+                    serve_jobs(cfd, cfd, *pool, opts);
+                } catch (const std::exception&) {
+                    // a bad client only loses its own connection
+                    ::shutdown(cfd, SHUT_RDWR);
+                }
+                ::close(cfd); // serve_jobs has joined its reader
+            }).detach();
+        }
+    }
+
+} // namespace rv::cpu
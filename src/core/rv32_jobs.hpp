@@ -0,0 +1,162 @@
+#pragma once
+
+#include "core/rv32_cpu.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace rv::cpu {
+
+    class RunPool; // rv32_parallel.hpp
+
+    /***** job frames *****
+     *   The wire format of the job server
+     *   - Every message is a frame: a 4-byte little-endian payload
+     *     length, then the payload
+     *   - Client -> server payloads are jobs, server -> client payloads
+     *     are results, one per job, in the order the jobs arrived
+     *   - All integers are little endian
+     *   - Both payloads start with the format version; a frame of
+     *     any other version is malformed
+     *
+     *   job:    version u8, id u64, mem_size u32, base u32, entry u32,
+     *           max_steps u64, mode u8 (0 interpret, 1 blocks),
+     *           regs[32] u32, fregs[32] u32, fcsr u32,
+     *           image bytes (the rest of the payload, loaded at base)
+     *   result: version u8, id u64, status u8 (0 ran, 1 bad job),
+     *           reason u8 (StopReason), steps u64, pc u32, fault_addr u32,
+     *           regs[32] u32, fregs[32] u32, fcsr u32
+     ******************************/
+    constexpr uint8_t     kJobFormatVersion = 2; // 1: no version byte, no float state
+    constexpr std::size_t kJobHeaderSize  = 1 + 8 + 4 + 4 + 4 + 8 + 1 + 32 * 4 + 32 * 4 + 4;
+    constexpr std::size_t kJobResultSize  = 1 + 8 + 1 + 1 + 8 + 4 + 4 + 32 * 4 + 32 * 4 + 4;
+    constexpr std::size_t kMaxFrameSize   = std::size_t(64) << 20;
+
+    /***** Job *****
+     *   One simulation request
+     *
+     *   id        - echoed back in the result
+     *   mem_size  - guest memory bytes for this job's CPU
+     *   base      - where image goes in guest memory
+     *   entry     - starting pc
+     *   max_steps - instruction budget (same meaning as run())
+     *   mode      - interpreter or block engine
+     *   regs      - initial x0..x31 (x0 is forced to 0)
+     *   fregs     - initial f0..f31, raw float32 bits
+     *   fcsr      - initial fcsr (only bits 7:0 are kept)
+     *   image     - program bytes
+     ******************************/
+    struct Job {
+        uint64_t             id;
+        uint32_t             mem_size;
+        uint32_t             base;
+        uint32_t             entry;
+        uint64_t             max_steps;
+        ExecMode             mode;
+        uint32_t             regs[32];
+        uint32_t             fregs[32];
+        uint32_t             fcsr;
+        std::vector<uint8_t> image;
+    };
+
+    /***** JobResult *****
+     *   What one job ended with
+     *
+     *   id         - the job's id
+     *   ok         - false if the job could not run (image outside
+     *                memory, memory too small); the rest is then zero
+     *   reason     - why the run stopped
+     *   steps      - instructions retired
+     *   pc         - final pc
+     *   fault_addr - CpuState::fault_addr after the run
+     *   regs       - final x0..x31
+     *   fregs      - final f0..f31
+     *   fcsr       - final fcsr
+     ******************************/
+    struct JobResult {
+        uint64_t    id;
+        bool        ok;
+        StopReason  reason;
+        uint64_t    steps;
+        uint32_t    pc;
+        uint32_t    fault_addr;
+        uint32_t    regs[32];
+        uint32_t    fregs[32];
+        uint32_t    fcsr;
+    };
+
+    /***** encode_job / decode_job / encode_result / decode_result *****
+     *   Job and JobResult <-> frame payloads (no length prefix)
+     *   - The decoders throw std::runtime_error on a malformed payload
+     ******************************/
+    std::vector<uint8_t> encode_job(const Job& job);
+    Job                  decode_job(std::span<const uint8_t> payload);
+    std::vector<uint8_t> encode_result(const JobResult& r);
+    JobResult            decode_result(std::span<const uint8_t> payload);
+
+    /***** read_frame / write_frame *****
+     *   One length-prefixed frame on a file descriptor
+     *   - read_frame returns false on a clean end of stream (no bytes
+     *     of a new frame); throws std::runtime_error on a short frame,
+     *     a read error or a length above kMaxFrameSize
+     *   - write_frame throws std::runtime_error if the write fails
+     ******************************/
+    bool read_frame(int fd, std::vector<uint8_t>& payload);
+    void write_frame(int fd, std::span<const uint8_t> payload);
+
+    /***** run_job *****
+     *   Runs one job on a fresh CPU, the same way serve_jobs does
+     ******************************/
+    JobResult run_job(const Job& job);
+
+    /***** JobServerOptions *****
+     *   batch   - most jobs handed to the worker pool at once
+     *   queue   - most decoded jobs waiting for a batch; the reader
+     *             stops reading while it is full (0 means batch)
+     *   threads - RunPool worker count; 0 means one per hardware thread
+     *   quantum - RunPool time slice
+     *   (threads and quantum only size a pool serve_jobs makes itself)
+     ******************************/
+    struct JobServerOptions {
+        std::size_t batch   = 64;
+        std::size_t queue   = 0;
+        unsigned    threads = 0;
+        std::size_t quantum = 10000;
+    };
+
+    /***** serve_jobs *****
+     *   Reads job frames from in_fd until end of stream and writes one
+     *   result frame per job to out_fd
+     *   - A reader thread decodes frames while the previous batch
+     *     runs, so reading, running and writing overlap; it holds at
+     *     most opts.queue jobs ahead of the workers
+     *   - Each batch is whatever has arrived (up to opts.batch jobs);
+     *     it runs on one RunPool kept for the whole stream, each job
+     *     with its own budget and mode, and its results are written
+     *     in job order before the next batch starts
+     *   - A malformed frame ends the stream: jobs before it are still
+     *     answered, then it throws std::runtime_error
+     *   - The pool overload runs the batches on a pool shared with
+     *     other streams (RunPool::run admits them in turn); the other
+     *     makes a RunPool of opts.threads workers for this stream
+     ******************************
+     * Returns:
+     *   std::size_t - jobs answered
+     ******************************/
+    std::size_t serve_jobs(int in_fd, int out_fd, RunPool& pool, const JobServerOptions& opts = {});
+    std::size_t serve_jobs(int in_fd, int out_fd, const JobServerOptions& opts = {});
+
+    /***** serve_unix_socket *****
+     *   Listens on a Unix stream socket at path and runs serve_jobs
+     *   on every connection
+     *   - One RunPool (opts.threads, opts.quantum) runs every
+     *     connection's batches; a connection only adds its own reader
+     *     and writer threads
+     *   - Removes a stale socket file at path first
+     *   - Only returns by throwing std::runtime_error (socket setup)
+     ******************************/
+    [[noreturn]] void serve_unix_socket(const std::string& path, const JobServerOptions& opts = {});
+
+} // namespace rv::cpu
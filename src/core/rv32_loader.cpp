@@ -0,0 +1,160 @@
+#include "core/rv32_loader.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <memory>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace rv::cpu {
+
+    namespace {
+
+        /***** MappedFile *****
+         *   A whole file mmap'd read-only; unmapped when the last
+         *   guest page using it goes away
+         ******************************/
+        struct MappedFile {
+            const uint8_t* data = nullptr;
+            std::size_t    size = 0;
+
+            ~MappedFile() {
+                if (data) munmap(const_cast<uint8_t*>(data), size);
+            }
+        };
+
+        std::shared_ptr<MappedFile> map_file(const std::string& path) {
+            int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) throw std::runtime_error("Cannot open " + path);
+
+            struct stat st {};
+            if (fstat(fd, &st) != 0) {
+                ::close(fd);
+                throw std::runtime_error("Cannot stat " + path);
+            }
+
+            auto file = std::make_shared<MappedFile>();
+            file->size = static_cast<std::size_t>(st.st_size);
+            if (file->size > 0) {
+                void* p = mmap(nullptr, file->size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (p == MAP_FAILED) {
+                    ::close(fd);
+                    throw std::runtime_error("Cannot mmap " + path);
+                }
+                file->data = static_cast<const uint8_t*>(p);
+            }
+            ::close(fd); // the mapping stays valid
+            return file;
+        }
+
+        /***** place_bytes *****
+         *   Puts file bytes [off, off+n) at guest address vaddr
+         *   - Whole guest pages whose file bytes are page-aligned too
+         *     are mapped, the rest is copied
+         ******************************/
+        void place_bytes(CpuState& s, const std::shared_ptr<MappedFile>& file,
+                         std::size_t off, uint32_t vaddr, std::size_t n, LoadedImage& img) {
+            if (uint64_t(vaddr) + n > s.mem.size()) {
+                throw std::runtime_error("Image does not fit in guest memory");
+            }
+            const uint8_t* src = file->data + off;
+            bool dropped = false;
+
+            // mmap offsets are page-aligned, so file and guest page
+            // boundaries line up only if both offsets agree mod a page
+            if ((off & Memory::kPageMask) == (vaddr & Memory::kPageMask)) {
+                std::size_t head = (Memory::kPageSize - (vaddr & Memory::kPageMask)) & Memory::kPageMask;
+                head = std::min(head, n);
+                std::size_t whole = (n - head) & ~std::size_t(Memory::kPageMask);
+
+                dropped |= s.mem.write_bytes(vaddr, src, head);
+                dropped |= s.mem.map_pages(vaddr + static_cast<uint32_t>(head), src + head, whole, file);
+                dropped |= s.mem.write_bytes(vaddr + static_cast<uint32_t>(head + whole),
+                                             src + head + whole, n - head - whole);
+                img.bytes_mapped += whole;
+                img.bytes_copied += n - whole;
+            } else {
+                dropped |= s.mem.write_bytes(vaddr, src, n);
+                img.bytes_copied += n;
+            }
+            if (dropped) ++s.code_epoch;
+        }
+
+        // ELF32 field readers (the file is little endian, like the guest)
+        uint16_t rd16(const uint8_t* p) { return uint16_t(p[0] | (p[1] << 8)); }
+        uint32_t rd32(const uint8_t* p) {
+            return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+        }
+
+        constexpr uint16_t kEtExec   = 2;
+        constexpr uint16_t kEmRiscv  = 243;
+        constexpr uint32_t kPtLoad   = 1;
+        constexpr std::size_t kEhSize = 52;
+        constexpr std::size_t kPhSize = 32;
+
+    } // anonymous namespace
+
+    /***** load_elf *****
+     *   Checks the ELF header, then places every PT_LOAD segment and
+     *   zeroes the rest of it
+     ******************************/
+    LoadedImage load_elf(CpuState& s, const std::string& path) {
+        std::shared_ptr<MappedFile> file = map_file(path);
+        const uint8_t* f = file->data;
+
+        if (file->size < kEhSize || std::memcmp(f, "\x7f" "ELF", 4) != 0) {
+            throw std::runtime_error(path + ": not an ELF file");
+        }
+        if (f[4] != 1 || f[5] != 1) {
+            throw std::runtime_error(path + ": not a little-endian ELF32 file");
+        }
+        if (rd16(f + 16) != kEtExec || rd16(f + 18) != kEmRiscv) {
+            throw std::runtime_error(path + ": not a RISC-V executable");
+        }
+
+        uint32_t entry   = rd32(f + 24);
+        uint32_t phoff   = rd32(f + 28);
+        uint16_t phentsz = rd16(f + 42);
+        uint16_t phnum   = rd16(f + 44);
+        if (phentsz < kPhSize || uint64_t(phoff) + uint64_t(phnum) * phentsz > file->size) {
+            throw std::runtime_error(path + ": bad program header table");
+        }
+
+        LoadedImage img{entry, 0, 0};
+        for (uint16_t i = 0; i < phnum; ++i) {
+            const uint8_t* ph = f + phoff + std::size_t(i) * phentsz;
+            if (rd32(ph) != kPtLoad) continue;
+
+            uint32_t offset = rd32(ph + 4);
+            uint32_t vaddr  = rd32(ph + 8);
+            uint32_t filesz = rd32(ph + 16);
+            uint32_t memsz  = rd32(ph + 20);
+            if (uint64_t(offset) + filesz > file->size || filesz > memsz) {
+                throw std::runtime_error(path + ": segment outside the file");
+            }
+            if (uint64_t(vaddr) + memsz > s.mem.size()) {
+                throw std::runtime_error(path + ": segment does not fit in guest memory");
+            }
+            place_bytes(s, file, offset, vaddr, filesz, img);
+            // .bss: a reused or forked CPU may still hold old bytes there
+            if (s.mem.zero_bytes(vaddr + filesz, memsz - filesz)) ++s.code_epoch;
+        }
+
+        s.pc = entry;
+        return img;
+    }
+
+    /***** load_binary *****
+     *   The whole file is one segment at base_addr
+     ******************************/
+    LoadedImage load_binary(CpuState& s, const std::string& path, uint32_t base_addr) {
+        std::shared_ptr<MappedFile> file = map_file(path);
+        LoadedImage img{base_addr, 0, 0};
+        place_bytes(s, file, 0, base_addr, file->size, img);
+        s.pc = base_addr;
+        return img;
+    }
+
+} // namespace rv::cpu
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "core/rv32_cpu.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace rv::cpu {
+
+    /***** LoadedImage *****
+     *   What a loader put into guest memory
+     *
+     *   entry        - where execution starts (s.pc is set to it)
+     *   bytes_mapped - bytes shared zero-copy with the mapped file
+     *   bytes_copied - bytes copied because they didn't fill a whole page
+     ******************************/
+    struct LoadedImage {
+        uint32_t    entry;
+        std::size_t bytes_mapped;
+        std::size_t bytes_copied;
+    };
+
+    /***** load_elf *****
+     *   Loads a little-endian RISC-V ELF32 executable
+     *   - The file is mmap'd read-only; every whole page of a PT_LOAD
+     *     segment's file bytes goes into guest memory zero-copy
+     *     (Memory::map_pages), only partial head/tail pages are copied
+     *   - Guest writes to a mapped page copy that page first, so the
+     *     file is never changed and writable segments are safe too
+     *   - The part of a segment past its file size (.bss) is zeroed,
+     *     so a reused or forked CPU can be loaded into as well; pages
+     *     that were never touched stay unallocated
+     *   - Sets s.pc to e_entry
+     *   - Throws std::runtime_error if the file can't be read or is not
+     *     an ELF32 RISC-V executable that fits in s.mem
+     ******************************
+     * Inputs:
+     *   s    - the CPU to load into
+     *   path - file to load
+     * Returns:
+     *   LoadedImage - entry pc and how the bytes got there
+     ******************************/
+    LoadedImage load_elf(CpuState& s, const std::string& path);
+
+    /***** load_binary *****
+     *   Loads a flat binary image at base_addr, the same way load_elf
+     *   loads one segment
+     *   - Sets s.pc to base_addr
+     *   - Throws std::runtime_error if the file can't be read or does
+     *     not fit in s.mem
+     ******************************
+     * Inputs:
+     *   s         - the CPU to load into
+     *   path      - file to load
+     *   base_addr - guest address of the first byte
+     * Returns:
+     *   LoadedImage - entry pc and how the bytes got there
+     ******************************/
+    LoadedImage load_binary(CpuState& s, const std::string& path, uint32_t base_addr = 0);
+
+} // namespace rv::cpu
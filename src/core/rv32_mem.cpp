@@ -0,0 +1,546 @@
+#include "core/rv32_mem.hpp"
+#include "core/rv32_cpu.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+
+namespace rv::cpu {
+
+    namespace {
+
+        constexpr uint32_t kL2Bits    = 10;
+        constexpr uint32_t kL2Entries = 1u << kL2Bits;
+
+        // what an untouched page reads as
+        const uint8_t kZeroPage[Memory::kPageSize] = {};
+
+        /***** sole_owner *****
+         *   True if p is the only reference to its object, so it can be
+         *   written in place
+         *   - use_count() alone is a relaxed load and orders nothing; the
+         *     probe's increment reads the last other owner's decrement
+         *     and the fence makes that an acquire, so our writes come
+         *     after everything that owner did with the object (the RMW
+         *     also lets ThreadSanitizer, which ignores fences, see it)
+         ******************************/
+        template <class T>
+        bool sole_owner(const std::shared_ptr<T>& p) {
+            if (p.use_count() != 1) return false;
+            std::shared_ptr<T> probe = p;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return probe.use_count() == 2;
+        }
+
+    } // anonymous namespace
+
+    /***** Page / PageTable / Root *****
+     *   Page      - the bytes of one 4 KiB page
+     *   PageTable - second level of the table: 1024 pages = 4 MiB
+     *   Root      - first level plus the list of touched page numbers
+     *
+     *   All three are shared between copies of a Memory. Anything that
+     *   is not sole_owner() is copied before it is written.
+     *
+     *   Root::copies counts the Memory copies made from this root; a
+     *   source's write cache is stale once it changes.
+     *
+     *   Pages added by map_pages point into host memory (aliasing
+     *   shared_ptrs). Root::mapped holds one more reference to their
+     *   owners, so their use_count() is always > 1 and they are never
+     *   written in place.
+     ******************************/
+    struct Memory::Page {
+        uint8_t bytes[kPageSize] = {};
+    };
+
+    struct Memory::PageTable {
+        std::shared_ptr<Page> pages[kL2Entries];
+    };
+
+    struct Memory::Root {
+        std::vector<std::shared_ptr<PageTable>> l1;
+        std::vector<uint32_t>                   touched;
+        std::vector<std::shared_ptr<const void>> mapped;
+        std::atomic<uint32_t>                   copies{0};
+
+        Root() = default;
+        Root(const Root& o) : l1(o.l1), touched(o.touched), mapped(o.mapped) {}
+    };
+
+    /***** DecodeTable *****
+     *   Decode slots for 1024 pages, owned by one Memory
+     ******************************/
+    struct Memory::DecodeTable {
+        std::unique_ptr<DecodedInstr[]> pages[kL2Entries];
+    };
+
+    /***** Memory constructor *****
+     *   Sizes the first level of the tables, pages come later
+     ******************************/
+    Memory::Memory(uint64_t size) : size_(size), root_(std::make_shared<Root>()) {
+        assert(size <= (uint64_t(1) << 32));
+        uint64_t pages = (size + kPageSize - 1) / kPageSize;
+        std::size_t l1_entries = static_cast<std::size_t>((pages + kL2Entries - 1) / kL2Entries);
+        root_->l1.resize(l1_entries);
+        decode_.resize(l1_entries);
+    }
+
+    /***** copy / move *****
+     *   A copy shares the root (O(1)) and starts with no decode slots
+     *   Moves take everything and leave the source empty
+     ******************************/
+    Memory::Memory(const Memory& other)
+        : size_(other.size_), root_(other.root_), decode_(other.decode_.size()) {
+        // other's pages are now shared; its write cache sees the new count
+        root_->copies.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Memory::Memory(Memory&& other) noexcept
+        : size_(other.size_), root_(std::move(other.root_)), decode_(std::move(other.decode_)),
+          track_dirty_(other.track_dirty_), dirty_bits_(std::move(other.dirty_bits_)),
+          dirty_(std::move(other.dirty_)) {
+        other.track_dirty_ = false;
+        other.root_ = std::make_shared<Root>();
+        other.root_->l1.resize(decode_.size());
+        other.decode_.resize(decode_.size());
+        other.forget_cached_pages();
+    }
+
+    Memory& Memory::operator=(const Memory& other) {
+        if (this != &other) {
+            Memory tmp(other);
+            *this = std::move(tmp);
+        }
+        return *this;
+    }
+
+    Memory& Memory::operator=(Memory&& other) noexcept {
+        if (this != &other) {
+            size_   = other.size_;
+            root_   = std::move(other.root_);
+            decode_ = std::move(other.decode_);
+            track_dirty_ = other.track_dirty_;
+            dirty_bits_  = std::move(other.dirty_bits_);
+            dirty_       = std::move(other.dirty_);
+            other.track_dirty_ = false;
+            forget_cached_pages();
+            other.root_ = std::make_shared<Root>();
+            other.root_->l1.resize(decode_.size());
+            other.decode_.resize(decode_.size());
+            other.forget_cached_pages();
+        }
+        return *this;
+    }
+
+    Memory::~Memory() = default;
+
+    /***** pages_touched / pages_shared *****/
+    std::size_t Memory::pages_touched() const {
+        return root_->touched.size();
+    }
+
+    std::size_t Memory::pages_shared() const {
+        // a page is shared if it, its table or the root has another owner
+        if (root_.use_count() > 1) return root_->touched.size();
+        std::size_t n = 0;
+        for (uint32_t pn : root_->touched) {
+            const auto& table = root_->l1[pn >> kL2Bits];
+            if (table.use_count() > 1 || table->pages[pn & (kL2Entries - 1)].use_count() > 1) ++n;
+        }
+        return n;
+    }
+
+    /***** find_page *****
+     *   The page for page_num, or nullptr if it was never touched
+     ******************************/
+    const Memory::Page* Memory::find_page(uint32_t page_num) const {
+        uint32_t i1 = page_num >> kL2Bits;
+        if (i1 >= root_->l1.size() || !root_->l1[i1]) return nullptr;
+        return root_->l1[i1]->pages[page_num & (kL2Entries - 1)].get();
+    }
+
+    /***** touch_page *****
+     *   The page for page_num, ready to be written
+     *   - Allocates it (zero-filled) on first use
+     *   - Copies the root, the table and the page first if any of them
+     *     is shared with another Memory
+     *   - Throws std::out_of_range for a page past the end of memory;
+     *     every write that misses the page cache comes through here,
+     *     so a bad address can't reach past the page table in a
+     *     release build
+     ******************************/
+    Memory::Page& Memory::touch_page(uint32_t page_num) {
+        if ((uint64_t(page_num) << kPageBits) >= size_) {
+            throw std::out_of_range("Memory: write outside guest memory");
+        }
+        uint32_t i1 = page_num >> kL2Bits;
+        if (track_dirty_) mark_dirty(page_num);
+
+        if (!sole_owner(root_)) root_ = std::make_shared<Root>(*root_);
+
+        std::shared_ptr<PageTable>& table = root_->l1[i1];
+        if (!table) {
+            table = std::make_shared<PageTable>();
+        } else if (!sole_owner(table)) {
+            table = std::make_shared<PageTable>(*table);
+        }
+
+        std::shared_ptr<Page>& page = table->pages[page_num & (kL2Entries - 1)];
+        if (!page) {
+            page = std::make_shared<Page>();
+            root_->touched.push_back(page_num);
+            // the read cache may still point at the shared zero page
+            if (rd_page_ == page_num) rd_page_ = kNoPage;
+        } else if (!sole_owner(page)) {
+            page = std::make_shared<Page>(*page);
+            // the read cache may still point at the shared copy
+            if (rd_page_ == page_num) rd_page_ = kNoPage;
+        }
+        return *page;
+    }
+
+    /***** mark_dirty *****
+     *   Records page_num once per interval
+     ******************************/
+    void Memory::mark_dirty(uint32_t page_num) {
+        uint64_t& word = dirty_bits_[page_num >> 6];
+        uint64_t  bit  = uint64_t(1) << (page_num & 63);
+        if (word & bit) return;
+        word |= bit;
+        dirty_.push_back(page_num);
+    }
+
+    /***** track_dirty / take_dirty_pages *****
+     *   Writes only reach touch_page on a write-cache miss, so taking
+     *   the list also empties the write cache: the next write to any
+     *   page goes through touch_page and marks it again
+     ******************************/
+    void Memory::track_dirty(bool on) {
+        track_dirty_ = on;
+        dirty_.clear();
+        dirty_bits_.assign(on ? static_cast<std::size_t>((size_ / kPageSize + 64) / 64) : 0, 0);
+        forget_write_cache();
+    }
+
+    std::vector<uint32_t> Memory::take_dirty_pages() {
+        std::vector<uint32_t> pages;
+        pages.swap(dirty_);
+        for (uint32_t pn : pages) dirty_bits_[pn >> 6] &= ~(uint64_t(1) << (pn & 63));
+        std::sort(pages.begin(), pages.end());
+        forget_write_cache();
+        return pages;
+    }
+
+    /***** find_decoded *****
+     *   The decode slots for page_num, or nullptr
+     ******************************/
+    DecodedInstr* Memory::find_decoded(uint32_t page_num) const {
+        uint32_t i1 = page_num >> kL2Bits;
+        if (i1 >= decode_.size() || !decode_[i1]) return nullptr;
+        return decode_[i1]->pages[page_num & (kL2Entries - 1)].get();
+    }
+
+    /***** forget_cached_pages / forget_write_cache *****
+     *   Empties the last-page caches
+     ******************************/
+    void Memory::forget_cached_pages() {
+        rd_page_ = kNoPage;
+        rd_data_ = nullptr;
+        forget_write_cache();
+        dc_page_ = kNoPage;
+        dc_data_ = nullptr;
+    }
+
+    void Memory::forget_write_cache() {
+        wr_page_    = kNoPage;
+        wr_data_    = nullptr;
+        wr_decoded_ = nullptr;
+        wr_copies_  = nullptr;
+    }
+
+    /***** drop_decoded *****
+     *   Marks the decode slots for bytes off..off+n-1 of a page as stale
+     ******************************/
+    bool Memory::drop_decoded(DecodedInstr* slots, uint32_t off, uint32_t n) {
+        bool hit = false;
+        for (uint32_t idx = off >> 2; idx <= (off + n - 1) >> 2; ++idx) {
+            if (idx < kWordsPerPage && slots[idx].valid) {
+                slots[idx].valid = false;
+                hit = true;
+            }
+        }
+        return hit;
+    }
+
+    /***** load_slow *****
+     *   Page-cache miss, or a value that crosses into the next page
+     ******************************/
+    uint32_t Memory::load_slow(uint32_t addr, uint32_t n) const {
+        assert(in_range(addr, n));
+        uint32_t off = addr & kPageMask;
+        if (off > kPageSize - n) {
+            uint32_t v = 0;
+            for (uint32_t i = 0; i < n; ++i) v |= uint32_t(read8(addr + i)) << (8 * i);
+            return v;
+        }
+
+        uint32_t pn = addr >> kPageBits;
+        const Page* page = find_page(pn);
+        rd_page_ = pn;
+        rd_data_ = page ? page->bytes : kZeroPage;
+        const uint8_t* p = rd_data_ + off;
+        if (n == 1) return read_le<uint8_t>(p);
+        if (n == 2) return read_le<uint16_t>(p);
+        return read_le<uint32_t>(p);
+    }
+
+    /***** store_slow *****
+     *   Page-cache miss, or a value that crosses into the next page
+     ******************************/
+    bool Memory::store_slow(uint32_t addr, uint32_t value, uint32_t n) {
+        assert(in_range(addr, n));
+        uint32_t off = addr & kPageMask;
+        if (off > kPageSize - n) {
+            bool hit = false;
+            for (uint32_t i = 0; i < n; ++i) {
+                hit |= write8(addr + i, static_cast<uint8_t>((value >> (8 * i)) & 0xFF));
+            }
+            return hit;
+        }
+
+        uint32_t pn = addr >> kPageBits;
+        Page& page = touch_page(pn);
+        wr_page_    = pn;
+        wr_data_    = page.bytes;
+        wr_decoded_ = find_decoded(pn);
+        wr_copies_  = &root_->copies;
+        wr_copies_seen_ = wr_copies_->load(std::memory_order_relaxed);
+        uint8_t* p = wr_data_ + off;
+        if (n == 1)      write_le<uint8_t>(p, value);
+        else if (n == 2) write_le<uint16_t>(p, value);
+        else             write_le<uint32_t>(p, value);
+        return wr_decoded_ ? drop_decoded(wr_decoded_, off, n) : false;
+    }
+
+    /***** refill_decoded *****
+     *   Points the fetch cache at pc's page, allocating decode slots
+     ******************************/
+    void Memory::refill_decoded(uint32_t pc) {
+        if (uint64_t(pc) + 4 > size_) throw std::out_of_range("Memory: fetch outside guest memory");
+        uint32_t pn = pc >> kPageBits;
+        uint32_t i1 = pn >> kL2Bits;
+        if (!decode_[i1]) decode_[i1] = std::make_unique<DecodeTable>();
+
+        std::unique_ptr<DecodedInstr[]>& slots = decode_[i1]->pages[pn & (kL2Entries - 1)];
+        if (!slots) {
+            slots = std::make_unique<DecodedInstr[]>(kWordsPerPage);
+            if (wr_page_ == pn) wr_decoded_ = slots.get();
+        }
+        dc_page_ = pn;
+        dc_data_ = slots.get();
+    }
+
+    /***** peek_decoded *****
+     *   Looks at a decode slot without allocating anything
+     ******************************/
+    const DecodedInstr* Memory::peek_decoded(uint32_t pc) const {
+        DecodedInstr* slots = find_decoded(pc >> kPageBits);
+        return slots ? &slots[(pc & kPageMask) >> 2] : nullptr;
+    }
+
+    /***** read8 / write8 *****/
+    uint8_t Memory::read8(uint32_t addr) const {
+        assert(addr < size_);
+        const Page* page = find_page(addr >> kPageBits);
+        return page ? page->bytes[addr & kPageMask] : 0;
+    }
+
+    bool Memory::write8(uint32_t addr, uint8_t value) {
+        assert(addr < size_);
+        uint32_t pn = addr >> kPageBits;
+        uint32_t off = addr & kPageMask;
+        touch_page(pn).bytes[off] = value;
+
+        DecodedInstr* slots = find_decoded(pn);
+        if (slots && slots[off >> 2].valid) {
+            slots[off >> 2].valid = false;
+            return true;
+        }
+        return false;
+    }
+
+    /***** read_bytes / write_bytes *****
+     *   Copies a page-sized piece at a time
+     ******************************/
+    void Memory::read_bytes(uint32_t addr, void* dst, std::size_t n) const {
+        assert(uint64_t(addr) + n <= size_);
+        uint8_t* out = static_cast<uint8_t*>(dst);
+        while (n > 0) {
+            uint32_t off = addr & kPageMask;
+            std::size_t chunk = std::min<std::size_t>(n, kPageSize - off);
+            const Page* page = find_page(addr >> kPageBits);
+            std::memcpy(out, page ? page->bytes + off : kZeroPage, chunk);
+            out  += chunk;
+            addr += static_cast<uint32_t>(chunk);
+            n    -= chunk;
+        }
+    }
+
+    bool Memory::write_bytes(uint32_t addr, const void* src, std::size_t n) {
+        assert(uint64_t(addr) + n <= size_);
+        const uint8_t* in = static_cast<const uint8_t*>(src);
+        bool hit = false;
+        while (n > 0) {
+            uint32_t pn = addr >> kPageBits;
+            uint32_t off = addr & kPageMask;
+            std::size_t chunk = std::min<std::size_t>(n, kPageSize - off);
+            std::memcpy(touch_page(pn).bytes + off, in, chunk);
+            if (DecodedInstr* slots = find_decoded(pn)) {
+                for (uint32_t w = off >> 2; w <= (off + chunk - 1) >> 2; ++w) {
+                    if (slots[w].valid) {
+                        slots[w].valid = false;
+                        hit = true;
+                    }
+                }
+            }
+            in   += chunk;
+            addr += static_cast<uint32_t>(chunk);
+            n    -= chunk;
+        }
+        return hit;
+    }
+
+    /***** zero_bytes *****
+     *   Page by page, skipping pages that are not there
+     ******************************/
+    bool Memory::zero_bytes(uint32_t addr, std::size_t n) {
+        assert(uint64_t(addr) + n <= size_);
+        bool hit = false;
+        while (n > 0) {
+            uint32_t pn = addr >> kPageBits;
+            uint32_t off = addr & kPageMask;
+            std::size_t chunk = std::min<std::size_t>(n, kPageSize - off);
+            if (find_page(pn)) {
+                std::memset(touch_page(pn).bytes + off, 0, chunk);
+                if (DecodedInstr* slots = find_decoded(pn)) {
+                    hit |= drop_decoded(slots, off, static_cast<uint32_t>(chunk));
+                }
+            }
+            addr += static_cast<uint32_t>(chunk);
+            n    -= chunk;
+        }
+        return hit;
+    }
+
+    /***** operator[] *****/
+    uint8_t& Memory::operator[](uint32_t addr) {
+        assert(addr < size_);
+        return touch_page(addr >> kPageBits).bytes[addr & kPageMask];
+    }
+
+    /***** clear *****
+     *   Drops the pages (other copies keep theirs) and the decode slots
+     ******************************/
+    void Memory::clear() {
+        std::size_t l1_entries = root_->l1.size();
+        if (!sole_owner(root_)) {
+            root_ = std::make_shared<Root>();
+            root_->l1.resize(l1_entries);
+        } else {
+            for (uint32_t pn : root_->touched) {
+                root_->l1[pn >> kL2Bits].reset();
+            }
+            root_->touched.clear();
+            root_->mapped.clear();
+        }
+        clear_decoded();
+        forget_cached_pages();
+    }
+
+    /***** map_pages *****
+     *   Swaps the page pointers for aliases into the host bytes
+     ******************************/
+    bool Memory::map_pages(uint32_t addr, const uint8_t* data, std::size_t n,
+                           std::shared_ptr<const void> keep_alive) {
+        if (n == 0) return false;
+        assert((addr & kPageMask) == 0 && n % kPageSize == 0);
+        assert(reinterpret_cast<uintptr_t>(data) % kPageSize == 0);
+        assert(uint64_t(addr) + n <= size_);
+
+        if (!sole_owner(root_)) root_ = std::make_shared<Root>(*root_);
+        // the page objects are never written (see Root), so casting
+        // the const away only lets them sit in the same tables
+        std::shared_ptr<void> owner = std::const_pointer_cast<void>(keep_alive);
+        root_->mapped.push_back(std::move(keep_alive));
+
+        bool dropped = false;
+        uint32_t first = addr >> kPageBits;
+        uint32_t count = static_cast<uint32_t>(n / kPageSize);
+        for (uint32_t k = 0; k < count; ++k) {
+            uint32_t pn = first + k;
+
+            std::shared_ptr<PageTable>& table = root_->l1[pn >> kL2Bits];
+            if (!table) {
+                table = std::make_shared<PageTable>();
+            } else if (!sole_owner(table)) {
+                table = std::make_shared<PageTable>(*table);
+            }
+
+            std::shared_ptr<Page>& page = table->pages[pn & (kL2Entries - 1)];
+            if (!page) root_->touched.push_back(pn);
+            if (track_dirty_) mark_dirty(pn);
+            Page* host = reinterpret_cast<Page*>(const_cast<uint8_t*>(data) + std::size_t(k) * kPageSize);
+            page = std::shared_ptr<Page>(owner, host);
+
+            if (DecodedInstr* slots = find_decoded(pn)) {
+                for (uint32_t i = 0; i < kWordsPerPage; ++i) {
+                    dropped |= slots[i].valid;
+                    slots[i].valid = false;
+                }
+            }
+        }
+
+        // every cached page pointer may be one we just replaced
+        rd_page_ = kNoPage;
+        forget_write_cache();
+        return dropped;
+    }
+
+    /***** clear_decoded *****
+     *   Frees every decode slot, keeps the bytes
+     ******************************/
+    void Memory::clear_decoded() {
+        for (auto& table : decode_) {
+            table.reset();
+        }
+        wr_decoded_ = nullptr;
+        dc_page_    = kNoPage;
+        dc_data_    = nullptr;
+    }
+
+    /***** operator== *****
+     *   Compares page by page; a page only one side has must be zero
+     ******************************/
+    bool operator==(const Memory& a, const Memory& b) {
+        if (a.size_ != b.size_) return false;
+        if (a.root_ == b.root_) return true;
+
+        auto same_page = [](const Memory::Page* x, const Memory::Page* y) {
+            if (x == y) return true;
+            const uint8_t* px = x ? x->bytes : kZeroPage;
+            const uint8_t* py = y ? y->bytes : kZeroPage;
+            return std::memcmp(px, py, Memory::kPageSize) == 0;
+        };
+
+        for (uint32_t pn : a.root_->touched) {
+            if (!same_page(a.find_page(pn), b.find_page(pn))) return false;
+        }
+        for (uint32_t pn : b.root_->touched) {
+            if (!a.find_page(pn) && !same_page(nullptr, b.find_page(pn))) return false;
+        }
+        return true;
+    }
+
+} // namespace rv::cpu
@@ -0,0 +1,283 @@
+#pragma once
+
+#include "core/rv32_instr.hpp"
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace rv::cpu {
+
+    /***** Memory *****
+     *   Sparse paged guest memory
+     *   - The address space is split into 4 KiB pages, found through a
+     *     two-level table (10 bits + 10 bits of the page number)
+     *   - A page is only allocated the first time it is written;
+     *     reading an untouched page gives zeros
+     *   - Pages are copy-on-write: copying a Memory is O(1) and shares
+     *     every page; the first write to a shared page copies just that
+     *     page (and the table entries above it)
+     *   - Decode slots for fetched words are kept per Memory, not per
+     *     shared page, so forks never touch each other's decode state;
+     *     a copy starts with no decoded instructions
+     *   - Loads, stores and decoded keep the last page they used,
+     *     so repeated accesses to the same page skip the table walk
+     *   - clear() only visits the pages that were touched
+     *
+     *   size() is the number of addressable bytes, up to 4 GiB.
+     *   Different Memory objects can be used from different threads,
+     *   even when they share pages. Copying never writes to the source,
+     *   so several threads can copy one Memory at once; copying one
+     *   while another thread writes to it is not safe.
+     ******************************/
+    class Memory {
+    public:
+        static constexpr uint32_t kPageBits = 12;
+        static constexpr uint32_t kPageSize = 1u << kPageBits;
+        static constexpr uint32_t kPageMask = kPageSize - 1;
+        static constexpr uint32_t kWordsPerPage = kPageSize / 4;
+
+        /***** constructors *****
+         *   Memory(size) - size addressable bytes, nothing allocated yet
+         *   Copies share all pages copy-on-write (O(1)); moves keep the pages
+         ******************************/
+        explicit Memory(uint64_t size);
+        Memory(const Memory& other);
+        Memory(Memory&& other) noexcept;
+        Memory& operator=(const Memory& other);
+        Memory& operator=(Memory&& other) noexcept;
+        ~Memory();
+
+        uint64_t size() const { return size_; }
+
+        /***** pages_touched *****
+         *   How many pages are allocated right now
+         ******************************/
+        std::size_t pages_touched() const;
+
+        /***** pages_shared *****
+         *   How many of those pages are still shared with another Memory
+         *   (or are mapped host pages, see map_pages)
+         ******************************/
+        std::size_t pages_shared() const;
+
+        /***** in_range *****
+         *   True if bytes addr .. addr + n - 1 are all inside memory
+         *   - The one bounds check a guest access needs; the loads and
+         *     stores below leave it to the caller
+         ******************************/
+        bool in_range(uint32_t addr, uint32_t n) const {
+            return uint64_t(addr) + n <= size_;
+        }
+
+        /***** load_u8 / load_u16 / load_u32 *****
+         *   Reads a little-endian value (in_range(addr, width) must hold)
+         *   - Any alignment; a value that crosses a page goes byte by byte
+         ******************************/
+        uint32_t load_u8(uint32_t addr) const  { return load<uint8_t>(addr); }
+        uint32_t load_u16(uint32_t addr) const { return load<uint16_t>(addr); }
+        uint32_t load_u32(uint32_t addr) const { return load<uint32_t>(addr); }
+
+        /***** store_u8 / store_u16 / store_u32 *****
+         *   Writes a little-endian value (in_range(addr, width) must hold)
+         *   - Drops the decoded instruction of every word it touches
+         * Returns:
+         *   true if a decoded instruction was dropped
+         ******************************/
+        bool store_u8(uint32_t addr, uint32_t value)  { return store<uint8_t>(addr, value); }
+        bool store_u16(uint32_t addr, uint32_t value) { return store<uint16_t>(addr, value); }
+        bool store_u32(uint32_t addr, uint32_t value) { return store<uint32_t>(addr, value); }
+
+        /***** decoded *****
+         *   The decode slot for the word at pc (pc must be word-aligned)
+         *   - Allocates the decode slots for pc's page on first use
+         *     (the page itself is not allocated)
+         ******************************/
+        DecodedInstr& decoded(uint32_t pc) {
+            if ((pc >> kPageBits) != dc_page_) refill_decoded(pc);
+            return dc_data_[(pc & kPageMask) >> 2];
+        }
+
+        /***** peek_decoded *****
+         *   The decode slot for pc, or nullptr if it was never allocated
+         *   - Never allocates, for tests and tools
+         ******************************/
+        const DecodedInstr* peek_decoded(uint32_t pc) const;
+
+        /***** read8 / write8 *****
+         *   Single-byte access
+         *   - write8 returns true if it dropped a decoded instruction
+         ******************************/
+        uint8_t read8(uint32_t addr) const;
+        bool    write8(uint32_t addr, uint8_t value);
+
+        /***** read_bytes / write_bytes *****
+         *   Bulk copy out of / into guest memory
+         *   - write_bytes drops decoded instructions it overwrites
+         * Returns:
+         *   write_bytes - true if a decoded instruction was dropped
+         ******************************/
+        void read_bytes(uint32_t addr, void* dst, std::size_t n) const;
+        bool write_bytes(uint32_t addr, const void* src, std::size_t n);
+
+        /***** zero_bytes *****
+         *   Sets n bytes from addr to zero
+         *   - Pages never touched already read as zero and stay
+         *     unallocated, so a large .bss costs nothing on a fresh CPU
+         *   - Drops decoded instructions it overwrites
+         * Returns:
+         *   true if a decoded instruction was dropped
+         ******************************/
+        bool zero_bytes(uint32_t addr, std::size_t n);
+
+        /***** map_pages *****
+         *   Puts whole host pages into guest memory without copying them
+         *   - addr and data must be page-aligned, n a multiple of kPageSize
+         *   - The pages are never written in place: the first guest
+         *     write to one copies it, like any other shared page, so
+         *     data can be a read-only mapping (e.g. an mmap'd file)
+         *   - keep_alive owns the bytes at data and is held until the
+         *     last Memory using those pages lets go of them
+         * Returns:
+         *   true if a decoded instruction was dropped
+         ******************************/
+        bool map_pages(uint32_t addr, const uint8_t* data, std::size_t n,
+                       std::shared_ptr<const void> keep_alive);
+
+        /***** operator[] *****
+         *   Byte access like a flat array
+         *   - The non-const version allocates the page; writing through
+         *     it does not drop decoded instructions (see invalidate_icache)
+         ******************************/
+        uint8_t& operator[](uint32_t addr);
+        uint8_t  operator[](uint32_t addr) const { return read8(addr); }
+
+        /***** clear *****
+         *   Frees every page, so memory reads as zero again
+         *   - Cost is O(pages touched), not O(size)
+         ******************************/
+        void clear();
+
+        /***** clear_decoded *****
+         *   Drops every decoded instruction, keeps the bytes
+         ******************************/
+        void clear_decoded();
+
+        /***** track_dirty / take_dirty_pages *****
+         *   Dirty-page tracking, for checkpoints
+         *   - track_dirty(true) records every page written from then on;
+         *     it is off by default and costs nothing while off
+         *   - take_dirty_pages gives the page numbers written since
+         *     tracking started or since the last call (sorted, each
+         *     once) and starts a new interval
+         *   - Copies start with tracking off; moves keep it
+         ******************************/
+        void                  track_dirty(bool on);
+        std::vector<uint32_t> take_dirty_pages();
+
+        /***** operator== *****
+         *   Same size and same bytes (untouched pages count as zeros)
+         ******************************/
+        friend bool operator==(const Memory& a, const Memory& b);
+
+    private:
+        struct Page;
+        struct PageTable;
+        struct Root;
+        struct DecodeTable;
+
+        static constexpr uint32_t kNoPage = 0xFFFFFFFFu;
+
+        const Page*   find_page(uint32_t page_num) const;
+        Page&         touch_page(uint32_t page_num);
+        DecodedInstr* find_decoded(uint32_t page_num) const;
+        void          forget_cached_pages();
+        void          forget_write_cache();
+        void          mark_dirty(uint32_t page_num);
+
+        uint32_t load_slow(uint32_t addr, uint32_t n) const;
+        bool     store_slow(uint32_t addr, uint32_t value, uint32_t n);
+        void     refill_decoded(uint32_t pc);
+
+        static bool drop_decoded(DecodedInstr* slots, uint32_t off, uint32_t n);
+
+        /***** read_le / write_le *****
+         *   A little-endian T at p; one memcpy on little-endian hosts
+         ******************************/
+        template <typename T>
+        static uint32_t read_le(const uint8_t* p) {
+            if constexpr (std::endian::native == std::endian::little) {
+                T v;
+                std::memcpy(&v, p, sizeof(T));
+                return v;
+            } else {
+                uint32_t v = 0;
+                for (std::size_t i = 0; i < sizeof(T); ++i) v |= uint32_t(p[i]) << (8 * i);
+                return v;
+            }
+        }
+
+        template <typename T>
+        static void write_le(uint8_t* p, uint32_t value) {
+            if constexpr (std::endian::native == std::endian::little) {
+                T v = static_cast<T>(value);
+                std::memcpy(p, &v, sizeof(T));
+            } else {
+                for (std::size_t i = 0; i < sizeof(T); ++i) p[i] = static_cast<uint8_t>(value >> (8 * i));
+            }
+        }
+
+        /***** load / store *****
+         *   The last-page cache fast paths behind load_uN / store_uN
+         ******************************/
+        template <typename T>
+        uint32_t load(uint32_t addr) const {
+            uint32_t off = addr & kPageMask;
+            if ((addr >> kPageBits) == rd_page_ && off <= kPageSize - sizeof(T)) {
+                return read_le<T>(rd_data_ + off);
+            }
+            return load_slow(addr, sizeof(T));
+        }
+
+        template <typename T>
+        bool store(uint32_t addr, uint32_t value) {
+            uint32_t off = addr & kPageMask;
+            if ((addr >> kPageBits) == wr_page_ && off <= kPageSize - sizeof(T) &&
+                wr_copies_->load(std::memory_order_relaxed) == wr_copies_seen_) {
+                write_le<T>(wr_data_ + off, value);
+                if (!wr_decoded_) return false;
+                return drop_decoded(wr_decoded_, off, sizeof(T));
+            }
+            return store_slow(addr, value, sizeof(T));
+        }
+
+        uint64_t                                  size_;
+        std::shared_ptr<Root>                     root_;   // pages, shared copy-on-write
+        std::vector<std::unique_ptr<DecodeTable>> decode_; // decode slots, never shared
+
+        // dirty-page tracking: one bit per page plus the pages set since
+        // the last take_dirty_pages
+        bool                  track_dirty_ = false;
+        std::vector<uint64_t> dirty_bits_;
+        std::vector<uint32_t> dirty_;
+
+        // last-page caches (page number + where its data lives); the
+        // write cache only ever points at a page this Memory owns alone.
+        // A copy bumps the root's copy count instead of touching the
+        // source, and the write cache is only used while that count is
+        // still the one it saw (wr_copies_seen_)
+        mutable uint32_t       rd_page_ = kNoPage;
+        mutable const uint8_t* rd_data_ = nullptr;
+        uint32_t               wr_page_ = kNoPage;
+        uint8_t*               wr_data_ = nullptr;
+        DecodedInstr*          wr_decoded_ = nullptr;
+        const std::atomic<uint32_t>* wr_copies_ = nullptr;
+        uint32_t               wr_copies_seen_ = 0;
+        uint32_t               dc_page_ = kNoPage;
+        DecodedInstr*          dc_data_ = nullptr;
+    };
+
+} // namespace rv::cpu
@@ -0,0 +1,300 @@
+#include "core/rv32_parallel.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace rv::cpu {
+
+    namespace {
+
+        /***** WorkQueue *****
+         *   One worker's queue of CPU indices
+         *   - The owner pushes and pops at the back
+         *   - Thieves and requeued CPUs use the front
+         ******************************/
+        struct WorkQueue {
+            std::mutex              m;
+            std::deque<std::size_t> q;
+
+            bool pop_back(std::size_t& out) {
+                std::lock_guard<std::mutex> lock(m);
+                if (q.empty()) return false;
+                out = q.back();
+                q.pop_back();
+                return true;
+            }
+
+            bool steal_front(std::size_t& out) {
+                std::lock_guard<std::mutex> lock(m);
+                if (q.empty()) return false;
+                out = q.front();
+                q.pop_front();
+                return true;
+            }
+
+            // returns how many CPUs the queue holds now
+            std::size_t push_front(std::size_t idx) {
+                std::lock_guard<std::mutex> lock(m);
+                q.push_front(idx);
+                return q.size();
+            }
+        };
+
+        /***** Scheduler *****
+         *   Shared state of one batch
+         *   - A worker with nothing to run or steal parks on idle_cv;
+         *     wakeups counts the notifications, so one sent between its
+         *     last look at the queues and the wait is not lost
+         ******************************/
+        struct Scheduler {
+            std::span<const RunTask>    tasks;
+            std::size_t                 quantum;
+            std::vector<RunManyResult>& results;
+            std::deque<WorkQueue>       queues;    // deque: WorkQueue can't move
+            std::atomic<std::size_t>    remaining; // CPUs not finished yet
+            std::atomic<bool>           failed{false};
+            std::exception_ptr          error;
+            std::mutex                  error_m;
+            std::mutex                  idle_m;
+            std::condition_variable     idle_cv;
+            std::atomic<uint64_t>       wakeups{0};
+
+            Scheduler(std::span<const RunTask> t, std::size_t q,
+                      std::vector<RunManyResult>& r, unsigned workers)
+                : tasks(t), quantum(q), results(r), queues(workers), remaining(t.size()) {}
+
+            /***** next_task *****
+             *   Own queue first, then steal from the others in turn
+             ******************************/
+            bool next_task(unsigned self, std::size_t& idx) {
+                if (queues[self].pop_back(idx)) return true;
+                for (std::size_t k = 1; k < queues.size(); ++k) {
+                    if (queues[(self + k) % queues.size()].steal_front(idx)) return true;
+                }
+                return false;
+            }
+
+            /***** run_quantum *****
+             *   One time slice of CPU idx; true if it should run again
+             ******************************/
+            bool run_quantum(std::size_t idx) {
+                const RunTask& task = tasks[idx];
+                RunManyResult& r = results[idx];
+                std::size_t left  = task.max_steps - r.steps;
+                std::size_t slice = std::min(left, quantum);
+                RunResult rr = run(*task.state, slice, task.mode);
+                r.steps += rr.steps;
+                r.reason = rr.reason;
+                ++r.quanta;
+                return rr.reason == StopReason::StepLimit && r.steps < task.max_steps;
+            }
+
+            /***** wake / park *****
+             *   wake - one parked worker (all of them once the batch is done)
+             *   park - waits until a wake after seen, or the batch is done
+             ******************************/
+            void wake(bool all) {
+                {
+                    std::lock_guard<std::mutex> lock(idle_m);
+                    wakeups.fetch_add(1, std::memory_order_release);
+                }
+                if (all) idle_cv.notify_all();
+                else     idle_cv.notify_one();
+            }
+
+            void park(uint64_t seen) {
+                std::unique_lock<std::mutex> lock(idle_m);
+                idle_cv.wait(lock, [&] {
+                    return wakeups.load(std::memory_order_acquire) != seen ||
+                           remaining.load(std::memory_order_acquire) == 0;
+                });
+            }
+
+            void worker(unsigned self) {
+                std::size_t idx;
+                while (remaining.load(std::memory_order_acquire) > 0) {
+                    const uint64_t seen = wakeups.load(std::memory_order_acquire);
+                    if (!next_task(self, idx)) {
+                        // everything left is in flight on other workers
+                        park(seen);
+                        continue;
+                    }
+                    bool more = false;
+                    if (!failed.load(std::memory_order_relaxed)) {
+                        try {
+                            more = run_quantum(idx);
+                        } catch (...) {
+                            std::lock_guard<std::mutex> lock(error_m);
+                            if (!error) error = std::current_exception();
+                            failed.store(true, std::memory_order_relaxed);
+                        }
+                    }
+                    if (more) {
+                        // back of the line: the other CPUs in this queue go
+                        // first. Alone in it, it runs again right here, so
+                        // there is nothing to wake a thief for
+                        if (queues[self].push_front(idx) > 1) wake(false);
+                    } else if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                        wake(true);
+                    }
+                }
+            }
+        };
+
+    } // anonymous namespace
+
+    /***** RunPool::Impl *****
+     *   batch      - the Scheduler of the running batch, or nullptr
+     *   generation - bumped once per batch; a thread runs each one once
+     *   busy       - helper threads still inside the current batch
+     *   next_ticket / serving - run()'s admission queue: each call
+     *                takes a ticket and waits until it is being served
+     ******************************/
+    struct RunPool::Impl {
+        unsigned                 workers;
+        std::size_t              quantum;
+        std::mutex               m;
+        std::condition_variable  start_cv;
+        std::condition_variable  done_cv;
+        std::condition_variable  turn_cv;
+        Scheduler*               batch = nullptr;
+        uint64_t                 generation = 0;
+        unsigned                 busy = 0;
+        bool                     stop = false;
+        uint64_t                 next_ticket = 0;
+        uint64_t                 serving = 0;
+        std::vector<std::thread> threads;
+
+        /***** admit / leave *****
+         *   admit blocks until this call's batch may use the workers;
+         *   leave lets the next waiting call in
+         ******************************/
+        void admit() {
+            std::unique_lock<std::mutex> lock(m);
+            const uint64_t ticket = next_ticket++;
+            turn_cv.wait(lock, [&] { return serving == ticket; });
+        }
+
+        void leave() {
+            {
+                std::lock_guard<std::mutex> lock(m);
+                ++serving;
+            }
+            turn_cv.notify_all();
+        }
+
+        /***** Admission *****
+         *   admit() for a scope; leave() on every way out of it
+         ******************************/
+        struct Admission {
+            Impl& p;
+            explicit Admission(Impl& impl) : p(impl) { p.admit(); }
+            ~Admission() { p.leave(); }
+            Admission(const Admission&) = delete;
+            Admission& operator=(const Admission&) = delete;
+        };
+
+        void helper(unsigned self) {
+            uint64_t seen = 0;
+            for (;;) {
+                Scheduler* sched;
+                {
+                    std::unique_lock<std::mutex> lock(m);
+                    start_cv.wait(lock, [&] { return stop || generation != seen; });
+                    if (stop) return;
+                    seen  = generation;
+                    sched = batch;
+                }
+                sched->worker(self);
+                std::lock_guard<std::mutex> lock(m);
+                if (--busy == 0) done_cv.notify_one();
+            }
+        }
+    };
+
+    /***** RunPool constructor / destructor *****
+     *   Starts workers - 1 helper threads; the destructor stops them
+     ******************************/
+    RunPool::RunPool(unsigned threads, std::size_t quantum) : impl_(std::make_unique<Impl>()) {
+        unsigned workers = threads ? threads : std::thread::hardware_concurrency();
+        impl_->workers = workers ? workers : 1;
+        impl_->quantum = quantum ? quantum : 1;
+        impl_->threads.reserve(impl_->workers - 1);
+        for (unsigned w = 1; w < impl_->workers; ++w) {
+            impl_->threads.emplace_back([impl = impl_.get(), w] { impl->helper(w); });
+        }
+    }
+
+    RunPool::~RunPool() {
+        {
+            std::lock_guard<std::mutex> lock(impl_->m);
+            impl_->stop = true;
+        }
+        impl_->start_cv.notify_all();
+        for (auto& t : impl_->threads) t.join();
+    }
+
+    unsigned RunPool::workers() const {
+        return impl_->workers;
+    }
+
+    /***** RunPool::run *****
+     *   Waits for its turn, spreads the tasks round-robin over the
+     *   worker queues, wakes the helpers and works as worker 0 until
+     *   every task is done
+     ******************************/
+    std::vector<RunManyResult> RunPool::run(std::span<const RunTask> tasks) {
+        std::vector<RunManyResult> results(tasks.size(), RunManyResult{StopReason::StepLimit, 0, 0});
+        if (tasks.empty()) return results;
+
+        Impl& p = *impl_;
+        Impl::Admission turn(p);
+        Scheduler sched(tasks, p.quantum, results, p.workers);
+        for (std::size_t i = 0; i < tasks.size(); ++i) {
+            sched.queues[i % p.workers].q.push_back(i);
+        }
+
+        if (p.workers > 1) {
+            {
+                std::lock_guard<std::mutex> lock(p.m);
+                p.batch = &sched;
+                p.busy  = p.workers - 1;
+                ++p.generation;
+            }
+            p.start_cv.notify_all();
+        }
+        sched.worker(0);
+        if (p.workers > 1) {
+            // sched lives on this stack: wait until no helper can touch it
+            std::unique_lock<std::mutex> lock(p.m);
+            p.done_cv.wait(lock, [&] { return p.busy == 0; });
+            p.batch = nullptr;
+        }
+
+        if (sched.error) std::rethrow_exception(sched.error);
+        return results;
+    }
+
+    /***** run_many *****
+     *   One batch on a RunPool sized for it
+     ******************************/
+    std::vector<RunManyResult> run_many(std::span<CpuState> states, const RunManyOptions& opts) {
+        if (states.empty()) return {};
+
+        unsigned workers = opts.threads ? opts.threads : std::thread::hardware_concurrency();
+        if (workers == 0) workers = 1;
+        workers = static_cast<unsigned>(std::min<std::size_t>(workers, states.size()));
+
+        std::vector<RunTask> tasks;
+        tasks.reserve(states.size());
+        for (CpuState& s : states) tasks.push_back(RunTask{ &s, opts.max_steps, opts.mode });
+
+        RunPool pool(workers, opts.quantum);
+        return pool.run(tasks);
+    }
+
+} // namespace rv::cpu
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "core/rv32_cpu.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace rv::cpu {
+
+    /***** RunManyOptions *****
+     *   How run_many drives the batch
+     *
+     *   max_steps - instruction budget for each CPU (same meaning as run())
+     *   quantum   - instructions a worker runs on one CPU before it puts
+     *               the CPU back in the queue and picks the next one
+     *   mode      - interpreter or basic-block engine
+     *   threads   - worker count; 0 means one per hardware thread
+     ******************************/
+    struct RunManyOptions {
+        std::size_t max_steps = 1000;
+        std::size_t quantum   = 10000;
+        ExecMode    mode      = ExecMode::Interpret;
+        unsigned    threads   = 0;
+    };
+
+    /***** RunManyResult *****
+     *   What happened to one CPU of the batch
+     *
+     *   reason  - why it stopped (StepLimit if it used its whole budget)
+     *   steps   - instructions it retired
+     *   quanta  - how many time slices it took
+     ******************************/
+    struct RunManyResult {
+        StopReason  reason;
+        std::size_t steps;
+        std::size_t quanta;
+    };
+
+    /***** run_many *****
+     *   Runs a batch of independent CPUs across all cores
+     *   - Work-stealing pool: each worker has its own queue and takes
+     *     from the other end of another worker's queue when it runs dry
+     *   - A worker with nothing to take sleeps until a queue has a CPU
+     *     waiting behind the one its owner runs, or the batch ends
+     *   - Every CPU runs at most opts.quantum instructions at a time,
+     *     then goes back to the queue, so one long program can't hold
+     *     a worker while the rest of the batch waits
+     *   - A CPU that stops early (ECALL, illegal instruction, ...) leaves
+     *     the queue straight away
+     *   - Each CPU ends in the same state as run(s, max_steps, mode)
+     *     (the CPUs must not share anything except COW memory pages)
+     *   - An exception from any CPU is rethrown after all workers stop
+     ******************************
+     * Inputs:
+     *   states - the CPUs to run; they are updated in place
+     *   opts   - budget, quantum, mode and thread count
+     * Returns:
+     *   std::vector<RunManyResult> - one per CPU, same order as states
+     ******************************/
+    std::vector<RunManyResult> run_many(std::span<CpuState> states, const RunManyOptions& opts = {});
+
+    /***** RunTask *****
+     *   One CPU for RunPool, with its own budget and mode
+     *
+     *   state     - the CPU; updated in place
+     *   max_steps - instruction budget (same meaning as run())
+     *   mode      - interpreter or basic-block engine
+     ******************************/
+    struct RunTask {
+        CpuState*   state;
+        std::size_t max_steps;
+        ExecMode    mode;
+    };
+
+    /***** RunPool *****
+     *   run_many's work-stealing workers, kept alive between batches
+     *   - run() schedules a batch exactly like run_many, except every
+     *     task has its own budget and mode, so mixed batches run
+     *     together
+     *   - The calling thread is worker 0; the other threads wait for
+     *     the next batch instead of being started and joined per call
+     *   - run() may be called from several threads: batches are
+     *     admitted one at a time, in the order the calls arrived, so
+     *     one pool can serve many clients without more threads
+     ******************************
+     * Inputs:
+     *   threads - worker count; 0 means one per hardware thread
+     *   quantum - instructions per time slice (as in RunManyOptions)
+     ******************************/
+    class RunPool {
+    public:
+        explicit RunPool(unsigned threads = 0, std::size_t quantum = 10000);
+        ~RunPool();
+
+        RunPool(const RunPool&) = delete;
+        RunPool& operator=(const RunPool&) = delete;
+
+        std::vector<RunManyResult> run(std::span<const RunTask> tasks);
+        unsigned workers() const;
+
+    private:
+        struct Impl;
+        std::unique_ptr<Impl> impl_;
+    };
+
+} // namespace rv::cpu
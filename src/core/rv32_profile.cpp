@@ -0,0 +1,177 @@
+#include "core/rv32_profile.hpp"
+#include <algorithm>
+#include <cstdio>
+
+namespace rv::cpu {
+
+    namespace {
+
+        /***** hex32 (helper) *****/
+        std::string hex32(uint32_t v) {
+            char buf[11];
+            std::snprintf(buf, sizeof buf, "0x%08x", v);
+            return buf;
+        }
+
+    } // anonymous namespace
+
+    // ---------------- Profile ----------------
+
+    uint64_t Profile::pc_count(uint32_t pc) const {
+        auto it = pc_pages.find(pc >> Memory::kPageBits);
+        if (it == pc_pages.end()) return 0;
+        return (*it->second)[(pc & Memory::kPageMask) >> 2];
+    }
+
+    std::vector<PcCount> Profile::hot_pcs(std::size_t n) const {
+        std::vector<PcCount> all;
+        for (const auto& [page, counts] : pc_pages) {
+            for (uint32_t i = 0; i < Memory::kWordsPerPage; ++i) {
+                if ((*counts)[i]) all.push_back({(page << Memory::kPageBits) | (i << 2), (*counts)[i]});
+            }
+        }
+        auto hotter = [](const PcCount& a, const PcCount& b) {
+            return a.count != b.count ? a.count > b.count : a.pc < b.pc;
+        };
+        n = std::min(n, all.size());
+        std::partial_sort(all.begin(), all.begin() + static_cast<std::ptrdiff_t>(n), all.end(), hotter);
+        all.resize(n);
+        return all;
+    }
+
+    // ---------------- ProfileProbe ----------------
+
+    /***** ProfileProbe constructor *****
+     *   Turns the cycle model into per-kind tables so after() only
+     *   does array lookups
+     ******************************/
+    ProfileProbe::ProfileProbe(Profile& out, uint32_t entry_pc, const CycleModel& model)
+        : p_(out), taken_penalty_(model.taken_penalty) {
+        using K = InstrKind;
+        for (std::size_t k = 0; k < kInstrKindCount; ++k) {
+            cost_[k]  = model.alu;
+            klass_[k] = Class::Other;
+        }
+        auto set = [&](std::initializer_list<K> kinds, uint32_t cost, Class c) {
+            for (K k : kinds) {
+                cost_[static_cast<std::size_t>(k)]  = cost;
+                klass_[static_cast<std::size_t>(k)] = c;
+            }
+        };
+        set({K::Beq, K::Bne, K::Blt, K::Bge, K::Bltu, K::Bgeu}, model.branch, Class::Branch);
+        set({K::Lb, K::Lh, K::Lw, K::Lbu, K::Lhu, K::Flw}, model.load, Class::Load);
+        set({K::Sb, K::Sh, K::Sw, K::Fsw}, model.store, Class::Store);
+        set({K::Jal, K::Jalr}, model.jump, Class::Jump);
+        set({K::Mul, K::Mulh, K::Mulhsu, K::Mulhu}, model.mul, Class::Other);
+        set({K::Div, K::Divu, K::Rem, K::Remu}, model.div, Class::Other);
+        set({K::FaddS, K::FsubS, K::FmulS}, model.fp, Class::Other);
+        set({K::Fence, K::Ecall, K::Ebreak, K::FpCsr}, model.system, Class::Other);
+
+        if (p_.stacks.empty()) p_.stacks.push_back(StackNode{entry_pc, 0, 0});
+    }
+
+    /***** find_pc_page *****
+     *   Histogram page for pc, allocated on first use
+     ******************************/
+    void ProfileProbe::find_pc_page(uint32_t pc) {
+        page_num_ = pc >> Memory::kPageBits;
+        auto& slot = p_.pc_pages[page_num_];
+        if (!slot) slot = std::make_unique<std::array<uint64_t, Memory::kWordsPerPage>>();
+        page_ = slot->data();
+    }
+
+    /***** on_jump *****
+     *   Follows calls and returns through the call tree
+     *   - Linking through ra or t0 is a call, JALR x0 through them a
+     *     return (the standard calling convention hints)
+     ******************************/
+    void ProfileProbe::on_jump(uint32_t target) {
+        bool link_reg = rd_ == 1 || rd_ == 5;
+        if (link_reg) {
+            ++p_.calls;
+            uint64_t key = (uint64_t(node_) << 32) | target;
+            auto it = p_.children.find(key);
+            if (it == p_.children.end()) {
+                uint32_t idx = static_cast<uint32_t>(p_.stacks.size());
+                p_.stacks.push_back(StackNode{target, node_, 0});
+                it = p_.children.emplace(key, idx).first;
+            }
+            node_ = it->second;
+        } else if (kind_ == InstrKind::Jalr && rd_ == 0 && (rs1_ == 1 || rs1_ == 5)) {
+            ++p_.returns;
+            node_ = p_.stacks[node_].parent;
+        }
+    }
+
+    // ---------------- export ----------------
+
+    /***** profile_to_json *****
+     *   Hand-written JSON: only numbers and fixed key names, so no
+     *   escaping is needed
+     ******************************/
+    std::string profile_to_json(const Profile& p, std::size_t top_pcs) {
+        std::string j = "{\n";
+        auto num = [&](const char* key, uint64_t v, bool comma = true) {
+            j += "  \"";
+            j += key;
+            j += "\": " + std::to_string(v) + (comma ? ",\n" : "\n");
+        };
+        num("retired", p.retired);
+        num("cycles", p.cycles);
+
+        char cpi[32];
+        std::snprintf(cpi, sizeof cpi, "%.3f", p.retired ? double(p.cycles) / double(p.retired) : 0.0);
+        j += "  \"cpi\": " + std::string(cpi) + ",\n";
+
+        num("branches", p.branches);
+        num("branches_taken", p.taken);
+        num("loads", p.loads);
+        num("stores", p.stores);
+        num("calls", p.calls);
+        num("returns", p.returns);
+
+        j += "  \"mix\": {";
+        bool first = true;
+        for (std::size_t k = 0; k < kInstrKindCount; ++k) {
+            if (!p.by_kind[k]) continue;
+            j += first ? "\n" : ",\n";
+            j += "    \"" + std::string(instr_kind_name(static_cast<InstrKind>(k))) + "\": " +
+                 std::to_string(p.by_kind[k]);
+            first = false;
+        }
+        j += first ? "},\n" : "\n  },\n";
+
+        j += "  \"hot_pcs\": [";
+        std::vector<PcCount> hot = p.hot_pcs(top_pcs);
+        for (std::size_t i = 0; i < hot.size(); ++i) {
+            j += (i ? ",\n" : "\n");
+            j += "    {\"pc\": \"" + hex32(hot[i].pc) + "\", \"count\": " + std::to_string(hot[i].count) + "}";
+        }
+        j += hot.empty() ? "]\n" : "\n  ]\n";
+        j += "}\n";
+        return j;
+    }
+
+    /***** profile_to_folded *****
+     *   Walks each node back to the root to build its stack string
+     ******************************/
+    std::string profile_to_folded(const Profile& p, const std::function<std::string(uint32_t)>& name) {
+        std::string out;
+        std::vector<uint32_t> path;
+        for (uint32_t i = 0; i < p.stacks.size(); ++i) {
+            if (!p.stacks[i].self) continue;
+            path.clear();
+            for (uint32_t n = i;; n = p.stacks[n].parent) {
+                path.push_back(p.stacks[n].func);
+                if (n == 0) break;
+            }
+            for (std::size_t k = path.size(); k-- > 0;) {
+                out += name ? name(path[k]) : hex32(path[k]);
+                out += k ? ";" : " ";
+            }
+            out += std::to_string(p.stacks[i].self) + "\n";
+        }
+        return out;
+    }
+
+} // namespace rv::cpu
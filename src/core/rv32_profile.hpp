@@ -0,0 +1,174 @@
+#pragma once
+
+#include "core/rv32_cpu.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace rv::cpu {
+
+    /***** CycleModel *****
+     *   Rough cycle cost per instruction class, for CPI estimates
+     *   - Defaults are a simple in-order 5-stage pipeline
+     *   - taken_penalty is added on top of branch for a taken branch
+     ******************************/
+    struct CycleModel {
+        uint32_t alu           = 1;
+        uint32_t load          = 2;
+        uint32_t store         = 1;
+        uint32_t branch        = 1;
+        uint32_t taken_penalty = 2;
+        uint32_t jump          = 3;
+        uint32_t mul           = 3;
+        uint32_t div           = 34;
+        uint32_t fp            = 4;
+        uint32_t system        = 1;
+    };
+
+    /***** StackNode *****
+     *   One node of the call tree (used for folded-stack output)
+     *
+     *   func   - entry pc of the function
+     *   parent - index of the caller's node (the root is its own parent)
+     *   self   - instructions retired while this was the innermost frame
+     ******************************/
+    struct StackNode {
+        uint32_t func;
+        uint32_t parent;
+        uint64_t self;
+    };
+
+    /***** PcCount *****
+     *   How often the instruction at pc retired
+     ******************************/
+    struct PcCount {
+        uint32_t pc;
+        uint64_t count;
+    };
+
+    /***** Profile *****
+     *   What a ProfileProbe counted
+     *
+     *   retired   - instructions retired
+     *   cycles    - estimated cycles (see CycleModel)
+     *   by_kind   - retired count per InstrKind (index with InstrKind)
+     *   branches / taken - conditional branches, and how many were taken
+     *   loads / stores   - memory instructions (integer and float)
+     *   calls / returns  - JAL/JALR that link through ra/t0, and JALR
+     *                      x0 through ra/t0
+     *   stacks    - call tree; a call is a jump that writes ra (x1) or
+     *               t0 (x5), a return a JALR x0 through one of them
+     ******************************/
+    struct Profile {
+        uint64_t retired  = 0;
+        uint64_t cycles   = 0;
+        uint64_t branches = 0;
+        uint64_t taken    = 0;
+        uint64_t loads    = 0;
+        uint64_t stores   = 0;
+        uint64_t calls    = 0;
+        uint64_t returns  = 0;
+        std::array<uint64_t, kInstrKindCount> by_kind{};
+
+        std::vector<StackNode> stacks;
+        std::unordered_map<uint64_t, uint32_t> children; // (parent << 32 | func) -> node
+
+        // per-pc counts, one array per 4 KiB code page
+        std::unordered_map<uint32_t, std::unique_ptr<std::array<uint64_t, Memory::kWordsPerPage>>> pc_pages;
+
+        /***** pc_count *****
+         *   Retired count of the instruction at pc
+         ******************************/
+        uint64_t pc_count(uint32_t pc) const;
+
+        /***** hot_pcs *****
+         *   The n most-executed pcs, most executed first
+         ******************************/
+        std::vector<PcCount> hot_pcs(std::size_t n) const;
+
+        uint64_t count(InstrKind k) const { return by_kind[static_cast<std::size_t>(k)]; }
+    };
+
+    /***** ProfileProbe *****
+     *   run_with / step_with policy that fills a Profile
+     *   - One probe per CPU; the Profile can span several runs
+     *
+     * Constructor: ProfileProbe(profile, entry_pc, model)
+     *     - entry_pc names the root of the call tree (usually s.pc);
+     *       ignored if the profile already has one
+     ******************************/
+    class ProfileProbe {
+    public:
+        ProfileProbe(Profile& out, uint32_t entry_pc, const CycleModel& model = {});
+
+        void before(const CpuState&, const DecodedInstr& d) {
+            kind_ = d.kind;
+            rd_   = d.rd;
+            rs1_  = d.rs1;
+        }
+
+        void after(const CpuState& s, uint32_t pc) {
+            std::size_t k = static_cast<std::size_t>(kind_);
+            ++p_.retired;
+            ++p_.by_kind[k];
+            p_.cycles += cost_[k];
+
+            if ((pc >> Memory::kPageBits) != page_num_) find_pc_page(pc);
+            ++page_[(pc & Memory::kPageMask) >> 2];
+            ++p_.stacks[node_].self; // calls count in the caller, returns in the callee
+
+            switch (klass_[k]) {
+                case Class::Branch:
+                    ++p_.branches;
+                    if (s.pc != pc + 4) {
+                        ++p_.taken;
+                        p_.cycles += taken_penalty_;
+                    }
+                    break;
+                case Class::Load:  ++p_.loads; break;
+                case Class::Store: ++p_.stores; break;
+                case Class::Jump:  on_jump(s.pc); break;
+                case Class::Other: break;
+            }
+        }
+
+    private:
+        enum class Class : uint8_t { Other, Branch, Load, Store, Jump };
+
+        void find_pc_page(uint32_t pc);
+        void on_jump(uint32_t target);
+
+        Profile&  p_;
+        std::array<uint32_t, kInstrKindCount> cost_{};
+        std::array<Class, kInstrKindCount>    klass_{};
+        uint32_t  taken_penalty_;
+
+        InstrKind kind_ = InstrKind::Illegal;
+        uint8_t   rd_ = 0;
+        uint8_t   rs1_ = 0;
+        uint32_t  node_ = 0;
+        uint32_t  page_num_ = 0xFFFFFFFFu;
+        uint64_t* page_ = nullptr;
+    };
+
+    /***** profile_to_json *****
+     *   Counters, instruction mix and the top_pcs hottest pcs as JSON
+     ******************************/
+    std::string profile_to_json(const Profile& p, std::size_t top_pcs = 32);
+
+    /***** profile_to_folded *****
+     *   Call stacks in the "folded" format flamegraph.pl and speedscope
+     *   read: one "outer;inner count" line per stack, weighted by
+     *   retired instructions
+     *   - name turns a function's entry pc into a frame name
+     *     (default: 0x%08x)
+     ******************************/
+    std::string profile_to_folded(const Profile& p,
+                                  const std::function<std::string(uint32_t)>& name = {});
+
+} // namespace rv::cpu
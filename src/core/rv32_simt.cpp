@@ -0,0 +1,591 @@
+#include "core/rv32_simt.hpp"
+#include "core/mdu.hpp"
+#include "core/f32.hpp"
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+
+namespace rv::cpu {
+
+    namespace {
+
+        using K = InstrKind;
+
+        constexpr uint32_t kOn = ~0u; // mask word of a lane that takes part
+
+        constexpr bool kind_in(K k, K first, K last) {
+            return k >= first && k <= last;
+        }
+
+        constexpr bool is_alu_imm(K k) { return kind_in(k, K::Addi, K::Srai); }
+        constexpr bool is_alu_reg(K k) { return kind_in(k, K::Add, K::And) || kind_in(k, K::Mul, K::Remu); }
+        constexpr bool is_branch(K k)  { return kind_in(k, K::Beq, K::Bgeu); }
+        constexpr bool is_load(K k)    { return kind_in(k, K::Lb, K::Lhu); }
+        constexpr bool is_store(K k)   { return kind_in(k, K::Sb, K::Sw); }
+
+        constexpr uint32_t access_bytes(K k) {
+            if (k == K::Lb || k == K::Lbu || k == K::Sb) return 1;
+            if (k == K::Lh || k == K::Lhu || k == K::Sh) return 2;
+            return 4;
+        }
+
+        /***** lane_alu<Kind> / lane_taken<Kind> *****
+         *   The same results as the interpreter's alu<Kind> and
+         *   taken<Kind> (rv32_cpu.cpp), on one lane's operands
+         ******************************/
+        template <K Kind>
+        inline uint32_t lane_alu(uint32_t a, uint32_t b) {
+            using rv::core::MulOp;
+            using rv::core::DivOp;
+            using rv::core::mdu_mul_u32;
+            using rv::core::mdu_div_u32;
+
+            if constexpr (Kind == K::Add || Kind == K::Addi)        return a + b;
+            else if constexpr (Kind == K::Sub)                      return a - b;
+            else if constexpr (Kind == K::And || Kind == K::Andi)   return a & b;
+            else if constexpr (Kind == K::Or  || Kind == K::Ori)    return a | b;
+            else if constexpr (Kind == K::Xor || Kind == K::Xori)   return a ^ b;
+            else if constexpr (Kind == K::Slt || Kind == K::Slti)
+                return static_cast<int32_t>(a) < static_cast<int32_t>(b) ? 1u : 0u;
+            else if constexpr (Kind == K::Sltu || Kind == K::Sltiu) return a < b ? 1u : 0u;
+            else if constexpr (Kind == K::Sll || Kind == K::Slli)   return a << (b & 0x1F);
+            else if constexpr (Kind == K::Srl || Kind == K::Srli)   return a >> (b & 0x1F);
+            else if constexpr (Kind == K::Sra || Kind == K::Srai)
+                return static_cast<uint32_t>(static_cast<int32_t>(a) >> (b & 0x1F));
+            else if constexpr (Kind == K::Mul)    return a * b;
+            else if constexpr (Kind == K::Mulh)   return mdu_mul_u32(MulOp::Mulh, a, b).hi;
+            else if constexpr (Kind == K::Mulhsu) return mdu_mul_u32(MulOp::Mulhsu, a, b).hi;
+            else if constexpr (Kind == K::Mulhu)  return mdu_mul_u32(MulOp::Mulhu, a, b).hi;
+            else if constexpr (Kind == K::Div)    return mdu_div_u32(DivOp::Div, a, b).q;
+            else if constexpr (Kind == K::Divu)   return mdu_div_u32(DivOp::Divu, a, b).q;
+            else if constexpr (Kind == K::Rem)    return mdu_div_u32(DivOp::Rem, a, b).r;
+            else {
+                static_assert(Kind == K::Remu, "not an ALU kind");
+                return mdu_div_u32(DivOp::Remu, a, b).r;
+            }
+        }
+
+        template <K Kind>
+        inline bool lane_taken(uint32_t a, uint32_t b) {
+            if constexpr (Kind == K::Beq)       return a == b;
+            else if constexpr (Kind == K::Bne)  return a != b;
+            else if constexpr (Kind == K::Blt)  return static_cast<int32_t>(a) < static_cast<int32_t>(b);
+            else if constexpr (Kind == K::Bge)  return static_cast<int32_t>(a) >= static_cast<int32_t>(b);
+            else if constexpr (Kind == K::Bltu) return a < b;
+            else                                return a >= b;
+        }
+
+        inline uint32_t blend(uint32_t m, uint32_t on, uint32_t off) {
+            return (on & m) | (off & ~m);
+        }
+
+        /***** LockstepRun *****
+         *   Working state of one run_lockstep call
+         *
+         *   live    - kOn for every lane that can still run
+         *   mask    - kOn for the lanes on the pc being issued (a lane
+         *             that stops leaves both)
+         *   scratch - CpuState a lane is copied into when it needs the
+         *             interpreter (its Memory is swapped in, not copied)
+         ******************************/
+        struct LockstepRun {
+            LaneGroup&            g;
+            std::size_t           max_steps;
+            std::vector<uint32_t> live;
+            std::vector<uint32_t> mask;
+            CpuState              scratch;
+        };
+
+        void stop_lane(LockstepRun& r, std::size_t l, StopReason why) {
+            r.g.stop[l] = why;
+            r.live[l] = 0;
+            r.mask[l] = 0;
+        }
+
+        void stop_masked(LockstepRun& r, StopReason why) {
+            for (std::size_t l = 0; l < r.g.lanes; ++l) {
+                if (r.mask[l]) stop_lane(r, l, why);
+            }
+        }
+
+        /***** load_lane / store_lane *****
+         *   Lane l <-> r.scratch; the lane's Memory moves over and back
+         ******************************/
+        void load_lane(LockstepRun& r, std::size_t l) {
+            LaneGroup& g = r.g;
+            CpuState& s = r.scratch;
+            for (std::size_t i = 0; i < 32; ++i) {
+                s.regs[i]  = g.reg(i)[l];
+                s.fregs[i] = g.freg(i)[l];
+            }
+            s.fcsr = g.fcsr[l];
+            s.pc = g.pc[l];
+            s.fault_addr = g.fault_addr[l];
+            std::swap(s.mem, g.mem[l]);
+        }
+
+        void store_lane(LockstepRun& r, std::size_t l) {
+            LaneGroup& g = r.g;
+            CpuState& s = r.scratch;
+            for (std::size_t i = 1; i < 32; ++i) g.reg(i)[l] = s.regs[i];
+            for (std::size_t i = 0; i < 32; ++i) g.freg(i)[l] = s.fregs[i];
+            g.fcsr[l] = s.fcsr;
+            g.pc[l] = s.pc;
+            g.fault_addr[l] = s.fault_addr;
+            std::swap(s.mem, g.mem[l]);
+        }
+
+        /***** finish_scalar *****
+         *   Takes lane l out of the group and runs the rest of its
+         *   budget on the interpreter
+         ******************************/
+        void finish_scalar(LockstepRun& r, std::size_t l) {
+            load_lane(r, l);
+            RunResult res = run(r.scratch, r.max_steps - r.g.steps[l]);
+            store_lane(r, l);
+            r.g.steps[l] += res.steps;
+            stop_lane(r, l, res.reason);
+        }
+
+        bool touches_text(const LaneGroup& g, uint32_t addr, uint32_t n) {
+            return uint64_t(addr) < uint64_t(g.text_base) + g.text_size && uint64_t(addr) + n > g.text_base;
+        }
+
+        /***** advance *****
+         *   pc += 4 and one more step for every masked lane
+         ******************************/
+        void advance(LaneGroup& g, const uint32_t* m) {
+            uint32_t* pc = g.pc.data();
+            std::size_t* steps = g.steps.data();
+            for (std::size_t l = 0; l < g.lanes; ++l) {
+                pc[l] += 4u & m[l];
+                steps[l] += m[l] & 1u;
+            }
+        }
+
+        // ---------------- issue kernels ----------------
+        // One call runs d for every lane in r.mask. The register kernels
+        // loop over all lanes and blend with the mask, so they have no
+        // branch per lane; the memory kernels and the float arithmetic
+        // only visit the masked lanes.
+
+        using IssueFn = void (*)(LockstepRun& r, const DecodedInstr& d);
+
+        template <K Kind>
+        void issue_alu(LockstepRun& r, const DecodedInstr& d) {
+            LaneGroup& g = r.g;
+            const uint32_t* m = r.mask.data();
+            if (d.rd != 0) {
+                uint32_t* rd = g.reg(d.rd);
+                const uint32_t* a = g.reg(d.rs1);
+                const uint32_t* b = g.reg(d.rs2);
+                const uint32_t imm = static_cast<uint32_t>(d.imm);
+                for (std::size_t l = 0; l < g.lanes; ++l) {
+                    uint32_t v = lane_alu<Kind>(a[l], is_alu_imm(Kind) ? imm : b[l]);
+                    rd[l] = blend(m[l], v, rd[l]);
+                }
+            }
+            advance(g, m);
+        }
+
+        template <K Kind>
+        void issue_branch(LockstepRun& r, const DecodedInstr& d) {
+            LaneGroup& g = r.g;
+            const uint32_t* m = r.mask.data();
+            const uint32_t* a = g.reg(d.rs1);
+            const uint32_t* b = g.reg(d.rs2);
+            const uint32_t imm = static_cast<uint32_t>(d.imm);
+            uint32_t* pc = g.pc.data();
+            std::size_t* steps = g.steps.data();
+            for (std::size_t l = 0; l < g.lanes; ++l) {
+                uint32_t delta = lane_taken<Kind>(a[l], b[l]) ? imm : 4u;
+                pc[l] += delta & m[l];
+                steps[l] += m[l] & 1u;
+            }
+        }
+
+        void issue_jal(LockstepRun& r, const DecodedInstr& d) {
+            LaneGroup& g = r.g;
+            const uint32_t* m = r.mask.data();
+            uint32_t* pc = g.pc.data();
+            std::size_t* steps = g.steps.data();
+            uint32_t* rd = d.rd != 0 ? g.reg(d.rd) : nullptr;
+            for (std::size_t l = 0; l < g.lanes; ++l) {
+                if (rd) rd[l] = blend(m[l], pc[l] + 4, rd[l]);
+                pc[l] = blend(m[l], pc[l] + static_cast<uint32_t>(d.imm), pc[l]);
+                steps[l] += m[l] & 1u;
+            }
+        }
+
+        void issue_jalr(LockstepRun& r, const DecodedInstr& d) {
+            LaneGroup& g = r.g;
+            const uint32_t* m = r.mask.data();
+            uint32_t* pc = g.pc.data();
+            std::size_t* steps = g.steps.data();
+            const uint32_t* a = g.reg(d.rs1);
+            uint32_t* rd = d.rd != 0 ? g.reg(d.rd) : nullptr;
+            for (std::size_t l = 0; l < g.lanes; ++l) {
+                uint32_t target = (a[l] + static_cast<uint32_t>(d.imm)) & ~1u; // before rd, rd may be rs1
+                if (rd) rd[l] = blend(m[l], pc[l] + 4, rd[l]);
+                pc[l] = blend(m[l], target, pc[l]);
+                steps[l] += m[l] & 1u;
+            }
+        }
+
+        template <bool PcRelative>
+        void issue_upper(LockstepRun& r, const DecodedInstr& d) {
+            LaneGroup& g = r.g;
+            const uint32_t* m = r.mask.data();
+            if (d.rd != 0) {
+                uint32_t* rd = g.reg(d.rd);
+                const uint32_t* pc = g.pc.data();
+                for (std::size_t l = 0; l < g.lanes; ++l) {
+                    uint32_t v = static_cast<uint32_t>(d.imm) + (PcRelative ? pc[l] : 0u);
+                    rd[l] = blend(m[l], v, rd[l]);
+                }
+            }
+            advance(g, m);
+        }
+
+        void issue_fence(LockstepRun& r, const DecodedInstr&) {
+            advance(r.g, r.mask.data());
+        }
+
+        template <StopReason Why>
+        void issue_trap(LockstepRun& r, const DecodedInstr&) {
+            stop_masked(r, Why);
+        }
+
+        /***** issue_load / issue_store *****
+         *   Lane by lane, each against its own memory
+         *   - issue_store also does FSW (the value comes from fregs)
+         *   - A store into the text takes its lane out of the group
+         ******************************/
+        template <K Kind>
+        void issue_load(LockstepRun& r, const DecodedInstr& d) {
+            LaneGroup& g = r.g;
+            const uint32_t* a = g.reg(d.rs1);
+            uint32_t* rd = g.reg(d.rd);
+            for (std::size_t l = 0; l < g.lanes; ++l) {
+                if (!r.mask[l]) continue;
+                uint32_t addr = a[l] + static_cast<uint32_t>(d.imm);
+                Memory& mem = g.mem[l];
+                if (!mem.in_range(addr, access_bytes(Kind))) {
+                    g.fault_addr[l] = addr;
+                    stop_lane(r, l, StopReason::AccessFault);
+                    continue;
+                }
+                uint32_t v;
+                if constexpr (Kind == K::Lb)       v = static_cast<uint32_t>(static_cast<int8_t>(mem.load_u8(addr)));
+                else if constexpr (Kind == K::Lh)  v = static_cast<uint32_t>(static_cast<int16_t>(mem.load_u16(addr)));
+                else if constexpr (Kind == K::Lw)  v = mem.load_u32(addr);
+                else if constexpr (Kind == K::Lbu) v = mem.load_u8(addr);
+                else                               v = mem.load_u16(addr);
+                if (d.rd != 0) rd[l] = v;
+                g.pc[l] += 4;
+                ++g.steps[l];
+            }
+        }
+
+        template <K Kind>
+        void issue_store(LockstepRun& r, const DecodedInstr& d) {
+            LaneGroup& g = r.g;
+            const uint32_t* a = g.reg(d.rs1);
+            const uint32_t* b = Kind == K::Fsw ? g.freg(d.rs2) : g.reg(d.rs2);
+            for (std::size_t l = 0; l < g.lanes; ++l) {
+                if (!r.mask[l]) continue;
+                uint32_t addr = a[l] + static_cast<uint32_t>(d.imm);
+                Memory& mem = g.mem[l];
+                if (!mem.in_range(addr, access_bytes(Kind))) {
+                    g.fault_addr[l] = addr;
+                    stop_lane(r, l, StopReason::AccessFault);
+                    continue;
+                }
+                if constexpr (Kind == K::Sb)      mem.store_u8(addr, b[l]);
+                else if constexpr (Kind == K::Sh) mem.store_u16(addr, b[l]);
+                else                              mem.store_u32(addr, b[l]);
+                g.pc[l] += 4;
+                ++g.steps[l];
+                if (touches_text(g, addr, access_bytes(Kind))) {
+                    if (g.steps[l] < r.max_steps) finish_scalar(r, l);
+                    else stop_lane(r, l, StopReason::StepLimit);
+                }
+            }
+        }
+
+        // ---------------- F extension ----------------
+
+        inline uint32_t lane_fflags(const rv::core::FpuFlags& f) {
+            return (f.invalid   ? kFflagNV : 0u)
+                 | (f.overflow  ? kFflagOF : 0u)
+                 | (f.underflow ? kFflagUF : 0u)
+                 | (f.inexact   ? kFflagNX : 0u);
+        }
+
+        template <rv::core::FpuResult32 (*Op)(uint32_t, uint32_t)>
+        void issue_fop(LockstepRun& r, const DecodedInstr& d) {
+            LaneGroup& g = r.g;
+            const uint32_t* a = g.freg(d.rs1);
+            const uint32_t* b = g.freg(d.rs2);
+            uint32_t* rd = g.freg(d.rd);
+            for (std::size_t l = 0; l < g.lanes; ++l) {
+                if (!r.mask[l]) continue;
+                rv::core::FpuResult32 res = Op(a[l], b[l]);
+                rd[l] = res.bits;
+                g.fcsr[l] |= lane_fflags(res.flags);
+            }
+            advance(g, r.mask.data());
+        }
+
+        /***** issue_fsgnj<Op> *****
+         *   Op 0 FSGNJ, 1 FSGNJN, 2 FSGNJX
+         ******************************/
+        template <int Op>
+        void issue_fsgnj(LockstepRun& r, const DecodedInstr& d) {
+            LaneGroup& g = r.g;
+            const uint32_t* m = r.mask.data();
+            const uint32_t* a = g.freg(d.rs1);
+            const uint32_t* b = g.freg(d.rs2);
+            uint32_t* rd = g.freg(d.rd);
+            for (std::size_t l = 0; l < g.lanes; ++l) {
+                uint32_t v;
+                if constexpr (Op == 0)      v = (a[l] & 0x7FFFFFFFu) | (b[l] & 0x80000000u);
+                else if constexpr (Op == 1) v = (a[l] & 0x7FFFFFFFu) | (~b[l] & 0x80000000u);
+                else                        v = a[l] ^ (b[l] & 0x80000000u);
+                rd[l] = blend(m[l], v, rd[l]);
+            }
+            advance(g, m);
+        }
+
+        void issue_fmv_x_w(LockstepRun& r, const DecodedInstr& d) {
+            LaneGroup& g = r.g;
+            const uint32_t* m = r.mask.data();
+            if (d.rd != 0) {
+                const uint32_t* a = g.freg(d.rs1);
+                uint32_t* rd = g.reg(d.rd);
+                for (std::size_t l = 0; l < g.lanes; ++l) rd[l] = blend(m[l], a[l], rd[l]);
+            }
+            advance(g, m);
+        }
+
+        void issue_fmv_w_x(LockstepRun& r, const DecodedInstr& d) {
+            LaneGroup& g = r.g;
+            const uint32_t* m = r.mask.data();
+            const uint32_t* a = g.reg(d.rs1);
+            uint32_t* rd = g.freg(d.rd);
+            for (std::size_t l = 0; l < g.lanes; ++l) rd[l] = blend(m[l], a[l], rd[l]);
+            advance(g, m);
+        }
+
+        void issue_flw(LockstepRun& r, const DecodedInstr& d) {
+            LaneGroup& g = r.g;
+            const uint32_t* a = g.reg(d.rs1);
+            uint32_t* rd = g.freg(d.rd);
+            for (std::size_t l = 0; l < g.lanes; ++l) {
+                if (!r.mask[l]) continue;
+                uint32_t addr = a[l] + static_cast<uint32_t>(d.imm);
+                if (!g.mem[l].in_range(addr, 4)) {
+                    g.fault_addr[l] = addr;
+                    stop_lane(r, l, StopReason::AccessFault);
+                    continue;
+                }
+                rd[l] = g.mem[l].load_u32(addr);
+                g.pc[l] += 4;
+                ++g.steps[l];
+            }
+        }
+
+        /***** issue_scalar *****
+         *   Anything else (the FP CSRs): the interpreter's handler, one
+         *   lane at a time
+         ******************************/
+        void issue_scalar(LockstepRun& r, const DecodedInstr& d) {
+            LaneGroup& g = r.g;
+            for (std::size_t l = 0; l < g.lanes; ++l) {
+                if (!r.mask[l]) continue;
+                load_lane(r, l);
+                StopReason why = d.exec(r.scratch, d);
+                store_lane(r, l);
+                if (why != StopReason::None) stop_lane(r, l, why);
+                else ++g.steps[l];
+            }
+        }
+
+        /***** issue_for<Kind> / kIssueTable *****
+         *   The kernel for each InstrKind, indexed by kind
+         ******************************/
+        template <K Kind>
+        constexpr IssueFn issue_for() {
+            if constexpr (is_alu_imm(Kind) || is_alu_reg(Kind)) return issue_alu<Kind>;
+            else if constexpr (is_branch(Kind))  return issue_branch<Kind>;
+            else if constexpr (is_load(Kind))    return issue_load<Kind>;
+            else if constexpr (is_store(Kind) || Kind == K::Fsw) return issue_store<Kind>;
+            else if constexpr (Kind == K::Lui)   return issue_upper<false>;
+            else if constexpr (Kind == K::Auipc) return issue_upper<true>;
+            else if constexpr (Kind == K::Jal)   return issue_jal;
+            else if constexpr (Kind == K::Jalr)  return issue_jalr;
+            else if constexpr (Kind == K::Fence) return issue_fence;
+            else if constexpr (Kind == K::Ecall)   return issue_trap<StopReason::Ecall>;
+            else if constexpr (Kind == K::Ebreak)  return issue_trap<StopReason::Ebreak>;
+            else if constexpr (Kind == K::Illegal) return issue_trap<StopReason::IllegalInstruction>;
+            else if constexpr (Kind == K::Flw)     return issue_flw;
+            else if constexpr (Kind == K::FaddS)   return issue_fop<rv::core::fadd_f32_u32>;
+            else if constexpr (Kind == K::FsubS)   return issue_fop<rv::core::fsub_f32_u32>;
+            else if constexpr (Kind == K::FmulS)   return issue_fop<rv::core::fmul_f32_u32>;
+            else if constexpr (Kind == K::FsgnjS)  return issue_fsgnj<0>;
+            else if constexpr (Kind == K::FsgnjnS) return issue_fsgnj<1>;
+            else if constexpr (Kind == K::FsgnjxS) return issue_fsgnj<2>;
+            else if constexpr (Kind == K::FmvXW)   return issue_fmv_x_w;
+            else if constexpr (Kind == K::FmvWX)   return issue_fmv_w_x;
+            else return issue_scalar;
+        }
+
+        template <std::size_t... I>
+        constexpr std::array<IssueFn, kInstrKindCount> make_issue_table(std::index_sequence<I...>) {
+            return { issue_for<static_cast<K>(I)>()... };
+        }
+
+        constexpr std::array<IssueFn, kInstrKindCount> kIssueTable =
+            make_issue_table(std::make_index_sequence<kInstrKindCount>{});
+
+        /***** issue *****
+         *   Runs the instruction at pc for the masked lanes
+         *   - Same fetch checks as check_fetch; a pc outside the text
+         *     sends its lanes to the interpreter
+         *   - Returns true if the lanes that ran may now be on different
+         *     pcs (branches and JALR); lanes that stop never count
+         ******************************/
+        bool issue(LockstepRun& r, uint32_t pc) {
+            LaneGroup& g = r.g;
+            if ((pc & 3u) != 0) {
+                stop_masked(r, StopReason::MisalignedFetch);
+                return false;
+            }
+            if (uint64_t(pc) + 4 > g.code.mem.size()) {
+                stop_masked(r, StopReason::PcOutOfRange);
+                return false;
+            }
+            if (pc < g.text_base || uint64_t(pc) + 4 > uint64_t(g.text_base) + g.text_size) {
+                for (std::size_t l = 0; l < g.lanes; ++l) {
+                    if (r.mask[l]) finish_scalar(r, l);
+                }
+                return false;
+            }
+            const DecodedInstr& d = fetch_decoded(g.code, pc);
+            kIssueTable[static_cast<std::size_t>(d.kind)](r, d);
+            return is_branch(d.kind) || d.kind == K::Jalr;
+        }
+
+        /***** check_budget *****
+         *   Stops the lanes that used their whole budget
+         ******************************
+         * Returns:
+         *   std::size_t - issues that can follow before any running
+         *                 lane can reach the budget (0 if none runs)
+         ******************************/
+        std::size_t check_budget(LockstepRun& r) {
+            std::size_t most = 0;
+            bool any = false;
+            for (std::size_t l = 0; l < r.g.lanes; ++l) {
+                if (!r.live[l]) continue;
+                if (r.g.steps[l] >= r.max_steps) {
+                    stop_lane(r, l, StopReason::StepLimit);
+                    continue;
+                }
+                any = true;
+                most = std::max(most, r.g.steps[l]);
+            }
+            return any ? r.max_steps - most : 0;
+        }
+
+    } // anonymous namespace
+
+    /***** make_lane_group *****/
+    LaneGroup make_lane_group(const CpuState& image, std::size_t lanes,
+                              uint32_t text_base, uint32_t text_size) {
+        if ((text_base & 3u) != 0 || !image.mem.in_range(text_base, text_size)) {
+            throw std::invalid_argument("Lane group text range must be word-aligned and inside guest memory");
+        }
+
+        LaneGroup g{ lanes, text_base, text_size, fork(image),
+                     std::vector<uint32_t>(32 * lanes), std::vector<uint32_t>(32 * lanes),
+                     std::vector<uint32_t>(lanes, image.fcsr), std::vector<uint32_t>(lanes, image.pc),
+                     std::vector<uint32_t>(lanes, image.fault_addr), std::vector<std::size_t>(lanes, 0),
+                     std::vector<StopReason>(lanes, StopReason::None), std::vector<Memory>(lanes, image.mem) };
+        for (std::size_t i = 0; i < 32; ++i) {
+            std::fill_n(g.reg(i), lanes, image.regs[i]);
+            std::fill_n(g.freg(i), lanes, image.fregs[i]);
+        }
+        return g;
+    }
+
+    /***** lane_state *****/
+    CpuState lane_state(const LaneGroup& g, std::size_t lane) {
+        CpuState s(static_cast<std::size_t>(g.code.mem.size()));
+        for (std::size_t i = 0; i < 32; ++i) {
+            s.regs[i]  = g.reg(i)[lane];
+            s.fregs[i] = g.freg(i)[lane];
+        }
+        s.fcsr = g.fcsr[lane];
+        s.pc = g.pc[lane];
+        s.fault_addr = g.fault_addr[lane];
+        s.mem = g.mem[lane];
+        return s;
+    }
+
+    /***** run_lockstep *****
+     *   Lowest pc first until every lane has stopped
+     *   - While every running lane is on one pc (together) the mask
+     *     is simply the running lanes, so no scan is needed until a
+     *     branch or JALR may split them
+     *   - A lane retires at most one instruction per issue, so the
+     *     budget only has to be checked every few issues (slack)
+     ******************************/
+    LockstepStats run_lockstep(LaneGroup& g, std::size_t max_steps) {
+        const std::size_t n = g.lanes;
+        std::fill(g.steps.begin(), g.steps.end(), 0);
+        std::fill(g.stop.begin(), g.stop.end(), StopReason::StepLimit);
+        LockstepStats stats{0, 0};
+        if (max_steps == 0 || n == 0) return stats;
+
+        LockstepRun r{ g, max_steps, std::vector<uint32_t>(n, kOn), std::vector<uint32_t>(n, 0),
+                       CpuState(static_cast<std::size_t>(g.code.mem.size())) };
+        std::size_t slack = max_steps;
+        bool together = false;
+        for (;;) {
+            uint32_t lo = std::numeric_limits<uint32_t>::max();
+            if (together) {
+                std::size_t lead = 0;
+                while (lead < n && !r.mask[lead]) ++lead;
+                if (lead == n) break;
+                lo = g.pc[lead];
+            } else {
+                std::size_t running = 0;
+                for (std::size_t l = 0; l < n; ++l) {
+                    if (r.live[l]) {
+                        ++running;
+                        lo = std::min(lo, g.pc[l]);
+                    }
+                }
+                if (running == 0) break;
+                std::size_t on_lo = 0;
+                for (std::size_t l = 0; l < n; ++l) {
+                    r.mask[l] = r.live[l] & (g.pc[l] == lo ? kOn : 0u);
+                    on_lo += r.mask[l] & 1u;
+                }
+                together = on_lo == running;
+            }
+
+            ++stats.issues;
+            if (issue(r, lo)) together = false;
+            if (--slack == 0 && (slack = check_budget(r)) == 0) break;
+        }
+
+        stats.lane_steps = std::accumulate(g.steps.begin(), g.steps.end(), std::size_t(0));
+        return stats;
+    }
+
+} // namespace rv::cpu
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "core/rv32_cpu.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace rv::cpu {
+
+    /***** LaneGroup *****
+     *   N copies (lanes) of one program, run in lockstep
+     *   - Every lane runs the same text, decoded once into code's
+     *     decode cache; lanes only differ in registers and data
+     *   - Registers are struct-of-arrays: register r of every lane is
+     *     one contiguous row, reg(r)[lane]
+     *   - Each lane has its own Memory, a copy-on-write fork of the
+     *     image, so lanes share every page they do not write
+     *
+     *   lanes     - number of lanes
+     *   text_base, text_size - the shared text; lanes must not differ there
+     *   code      - the program image; the shared decode stream lives in it
+     *   regs      - 32 rows of lanes words (x0's row stays 0)
+     *   fregs     - 32 rows of lanes words, raw float32 bits
+     *   fcsr, pc, fault_addr - one word per lane, same meaning as CpuState
+     *   steps     - instructions each lane retired in the last run_lockstep
+     *   stop      - why each lane stopped in the last run_lockstep
+     *               (StepLimit if it used its whole budget)
+     *   mem       - one Memory per lane
+     ******************************/
+    struct LaneGroup {
+        std::size_t             lanes;
+        uint32_t                text_base;
+        uint32_t                text_size;
+        CpuState                code;
+        std::vector<uint32_t>   regs;
+        std::vector<uint32_t>   fregs;
+        std::vector<uint32_t>   fcsr;
+        std::vector<uint32_t>   pc;
+        std::vector<uint32_t>   fault_addr;
+        std::vector<std::size_t> steps;
+        std::vector<StopReason> stop;
+        std::vector<Memory>     mem;
+
+        uint32_t*       reg(std::size_t r)       { return regs.data() + r * lanes; }
+        const uint32_t* reg(std::size_t r) const { return regs.data() + r * lanes; }
+        uint32_t*       freg(std::size_t r)       { return fregs.data() + r * lanes; }
+        const uint32_t* freg(std::size_t r) const { return fregs.data() + r * lanes; }
+    };
+
+    /***** make_lane_group *****
+     *   lanes copies of image, all at image's registers and pc
+     *   - Set each lane's inputs afterwards (reg(r)[lane], mem[lane])
+     *   - [text_base, text_base + text_size) is the code every lane
+     *     runs; it must be word-aligned and inside memory, else
+     *     std::invalid_argument
+     ******************************/
+    LaneGroup make_lane_group(const CpuState& image, std::size_t lanes,
+                              uint32_t text_base, uint32_t text_size);
+
+    /***** lane_state *****
+     *   One lane as a stand-alone CpuState (its memory is a COW copy)
+     ******************************/
+    CpuState lane_state(const LaneGroup& g, std::size_t lane);
+
+    /***** LockstepStats *****
+     *   issues     - instructions fetched and dispatched for a set of lanes
+     *   lane_steps - instructions retired over all lanes
+     *   lane_steps / issues is how many lanes ran together on average
+     ******************************/
+    struct LockstepStats {
+        std::size_t issues;
+        std::size_t lane_steps;
+    };
+
+    /***** run_lockstep *****
+     *   run() on every lane of g at once, SIMT style
+     *   - Each step picks the lowest pc among the running lanes and
+     *     runs that instruction for every lane sitting on it, so lanes
+     *     that split on a branch wait for each other and run together
+     *     again where their paths meet
+     *   - ALU ops, branches, jumps and float moves are one loop over
+     *     the register rows with a lane mask (the compiler vectorizes
+     *     the plain ones); loads, stores and float arithmetic go lane by
+     *     lane; the FP CSR instructions run through the interpreter's
+     *     handler
+     *   - A lane that stores into the text or jumps outside it leaves
+     *     the group and finishes its budget on the interpreter
+     *   - Every lane ends in the same state as run(lane, max_steps)
+     ******************************
+     * Inputs:
+     *   g         - the lanes; updated in place (steps and stop too)
+     *   max_steps - instruction budget for each lane
+     * Returns:
+     *   LockstepStats - how well the lanes stayed together
+     ******************************/
+    LockstepStats run_lockstep(LaneGroup& g, std::size_t max_steps = 1000);
+
+} // namespace rv::cpu
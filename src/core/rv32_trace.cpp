@@ -0,0 +1,323 @@
+#include "core/rv32_trace.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef RV_TRACE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace rv::cpu {
+
+    namespace {
+
+        constexpr char        kMagic[8]   = {'R', 'V', 'T', 'R', 'A', 'C', 'E', '1'};
+        constexpr std::size_t kRecordSize = sizeof(TraceRecord);
+
+        void put32(uint8_t* p, uint32_t v) {
+            p[0] = static_cast<uint8_t>(v);
+            p[1] = static_cast<uint8_t>(v >> 8);
+            p[2] = static_cast<uint8_t>(v >> 16);
+            p[3] = static_cast<uint8_t>(v >> 24);
+        }
+
+        uint32_t get32(const uint8_t* p) {
+            return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+        }
+
+        bool codec_built_in(TraceCodec c) {
+            if (c == TraceCodec::None) return true;
+#ifdef RV_TRACE_ZSTD
+            if (c == TraceCodec::Zstd) return true;
+#endif
+            return false;
+        }
+
+        std::size_t round_up_pow2(std::size_t n) {
+            std::size_t p = 2;
+            while (p < n) p <<= 1;
+            return p;
+        }
+
+    } // anonymous namespace
+
+    /***** trace_dest / trace_has_addr *****
+     *   Only look at the opcode (and funct7 for OP-FP)
+     ******************************/
+    TraceDest trace_dest(uint32_t raw) {
+        switch (raw & 0x7F) {
+            case 0x23: // STORE
+            case 0x27: // STORE-FP
+            case 0x63: // BRANCH
+            case 0x0F: // FENCE
+                return TraceDest::None;
+            case 0x07: // FLW
+                return TraceDest::F;
+            case 0x53: // OP-FP: only FMV.X.W writes an x register
+                return ((raw >> 25) == 0x70) ? TraceDest::X : TraceDest::F;
+            default:
+                return TraceDest::X;
+        }
+    }
+
+    bool trace_has_addr(uint32_t raw) {
+        uint32_t op = raw & 0x7F;
+        return op == 0x03 || op == 0x23 || op == 0x07 || op == 0x27;
+    }
+
+    // ---------------- TraceWriter ----------------
+
+    TraceWriter::TraceWriter(const std::string& path, const TraceOptions& opts)
+        : ring_(round_up_pow2(opts.ring_records)),
+          mask_(ring_.size() - 1),
+          block_records_(std::clamp<std::size_t>(opts.block_records, 1, kMaxTraceBlockRecords)),
+          codec_(opts.codec),
+          file_(nullptr) {
+        if (!codec_built_in(codec_)) {
+            throw std::runtime_error("Trace codec not built in (configure with -DRV_TRACE_ZSTD=ON)");
+        }
+        file_ = std::fopen(path.c_str(), "wb");
+        if (!file_) throw std::runtime_error("Cannot open " + path);
+
+        uint8_t header[16];
+        std::memcpy(header, kMagic, 8);
+        put32(header + 8, kRecordSize);
+        put32(header + 12, static_cast<uint32_t>(codec_));
+        io_ok_ = std::fwrite(header, 1, sizeof header, file_) == sizeof header;
+
+        thread_ = std::thread([this] { writer_loop(); });
+    }
+
+    TraceWriter::~TraceWriter() {
+        close();
+    }
+
+    bool TraceWriter::close() {
+        if (thread_.joinable()) {
+            stop_.store(true, std::memory_order_release);
+            thread_.join();
+        }
+        if (file_) {
+            if (std::fclose(file_) != 0) io_ok_ = false;
+            file_ = nullptr;
+        }
+        return io_ok_;
+    }
+
+    /***** wait_for_space *****
+     *   Ring full: wait for the writer thread to catch up
+     ******************************/
+    void TraceWriter::wait_for_space(std::size_t h) {
+        for (;;) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            if (h - tail_cache_ < ring_.size()) return;
+            std::this_thread::yield();
+        }
+    }
+
+    /***** writer_loop *****
+     *   Drains the ring a block at a time until close()
+     ******************************/
+    void TraceWriter::writer_loop() {
+        std::vector<TraceRecord> block(block_records_);
+        for (;;) {
+            std::size_t t = tail_.load(std::memory_order_relaxed);
+            std::size_t h = head_.load(std::memory_order_acquire);
+            if (h == t) {
+                // stop is set after the last push, so seeing it means
+                // one more look at head finds everything
+                if (stop_.load(std::memory_order_acquire)) {
+                    if (head_.load(std::memory_order_acquire) == t) break;
+                    continue;
+                }
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+                continue;
+            }
+
+            std::size_t n = std::min(h - t, block_records_);
+            for (std::size_t i = 0; i < n; ++i) {
+                block[i] = ring_[(t + i) & mask_];
+            }
+            tail_.store(t + n, std::memory_order_release);
+            write_block(block.data(), n);
+        }
+        if (file_ && std::fflush(file_) != 0) io_ok_ = false;
+    }
+
+    /***** write_block *****
+     *   Packs n records little endian and writes them as one block
+     ******************************/
+    void TraceWriter::write_block(const TraceRecord* recs, std::size_t n) {
+        std::size_t raw_bytes = n * kRecordSize;
+        scratch_.resize(raw_bytes);
+        uint8_t* p = scratch_.data();
+        for (std::size_t i = 0; i < n; ++i, p += kRecordSize) {
+            put32(p, recs[i].pc);
+            put32(p + 4, recs[i].raw);
+            put32(p + 8, recs[i].value);
+            put32(p + 12, recs[i].addr);
+        }
+
+        const uint8_t* payload = scratch_.data();
+        std::size_t payload_bytes = raw_bytes;
+#ifdef RV_TRACE_ZSTD
+        if (codec_ == TraceCodec::Zstd) {
+            packed_.resize(ZSTD_compressBound(raw_bytes));
+            std::size_t z = ZSTD_compress(packed_.data(), packed_.size(), scratch_.data(), raw_bytes, 1);
+            if (ZSTD_isError(z)) {
+                io_ok_ = false;
+                return;
+            }
+            payload = packed_.data();
+            payload_bytes = z;
+        }
+#endif
+        uint8_t hdr[8];
+        put32(hdr, static_cast<uint32_t>(n));
+        put32(hdr + 4, static_cast<uint32_t>(payload_bytes));
+        if (std::fwrite(hdr, 1, sizeof hdr, file_) != sizeof hdr ||
+            std::fwrite(payload, 1, payload_bytes, file_) != payload_bytes) {
+            io_ok_ = false;
+        }
+    }
+
+    // ---------------- TraceReader ----------------
+
+    TraceReader::TraceReader(const std::string& path) : file_(std::fopen(path.c_str(), "rb")), codec_(TraceCodec::None) {
+        if (!file_) throw std::runtime_error("Cannot open " + path);
+
+        uint8_t header[16];
+        if (std::fread(header, 1, sizeof header, file_) != sizeof header ||
+            std::memcmp(header, kMagic, 8) != 0 || get32(header + 8) != kRecordSize) {
+            std::fclose(file_);
+            throw std::runtime_error(path + ": not a CPU trace");
+        }
+        codec_ = static_cast<TraceCodec>(get32(header + 12));
+        if (!codec_built_in(codec_)) {
+            std::fclose(file_);
+            throw std::runtime_error(path + ": trace codec not built in");
+        }
+    }
+
+    TraceReader::~TraceReader() {
+        if (file_) std::fclose(file_);
+    }
+
+    bool TraceReader::next(TraceRecord& out) {
+        while (pos_ == block_.size()) {
+            if (!read_block()) return false;
+        }
+        out = block_[pos_++];
+        return true;
+    }
+
+    /***** read_block *****
+     *   Loads the next block into block_; false at a clean end of file
+     *   - The record count and payload size come from the file, so both
+     *     are checked before anything is allocated for them
+     ******************************/
+    bool TraceReader::read_block() {
+        uint8_t hdr[8];
+        std::size_t got = std::fread(hdr, 1, sizeof hdr, file_);
+        if (got == 0) return false;
+        if (got != sizeof hdr) throw std::runtime_error("Truncated trace block header");
+
+        std::size_t n = get32(hdr);
+        std::size_t bytes = get32(hdr + 4);
+        if (n > kMaxTraceBlockRecords) throw std::runtime_error("Corrupt trace block");
+        std::size_t raw_bytes = n * kRecordSize;
+        if (codec_ == TraceCodec::None && bytes != raw_bytes) throw std::runtime_error("Corrupt trace block");
+#ifdef RV_TRACE_ZSTD
+        if (codec_ == TraceCodec::Zstd && bytes > ZSTD_compressBound(raw_bytes)) {
+            throw std::runtime_error("Corrupt trace block");
+        }
+#endif
+
+        scratch_.resize(bytes);
+        if (std::fread(scratch_.data(), 1, bytes, file_) != bytes) {
+            throw std::runtime_error("Truncated trace block");
+        }
+
+        const uint8_t* p = scratch_.data();
+        std::vector<uint8_t> unpacked;
+        if (codec_ != TraceCodec::None) {
+#ifdef RV_TRACE_ZSTD
+            unpacked.resize(raw_bytes);
+            std::size_t z = ZSTD_decompress(unpacked.data(), raw_bytes, scratch_.data(), bytes);
+            if (ZSTD_isError(z) || z != raw_bytes) throw std::runtime_error("Corrupt trace block");
+            p = unpacked.data();
+#endif
+        }
+
+        block_.resize(n);
+        for (std::size_t i = 0; i < n; ++i, p += kRecordSize) {
+            block_[i] = TraceRecord{get32(p), get32(p + 4), get32(p + 8), get32(p + 12)};
+        }
+        pos_ = 0;
+        return true;
+    }
+
+    // ---------------- run_traced ----------------
+
+    namespace {
+
+        /***** TraceProbe *****
+         *   run_with policy that turns each retired instruction into
+         *   a TraceRecord
+         ******************************/
+        struct TraceProbe {
+            TraceWriter& out;
+            TraceRecord  rec{};
+            TraceDest    dest = TraceDest::None;
+            uint8_t      rd = 0;
+
+            void before(const CpuState& s, const DecodedInstr& d) {
+                rec = TraceRecord{s.pc, d.raw, 0, 0};
+                if (trace_has_addr(d.raw)) {
+                    rec.addr = s.regs[d.rs1] + static_cast<uint32_t>(d.imm); // before rd overwrites rs1
+                }
+                dest = trace_dest(d.raw);
+                rd = d.rd;
+            }
+
+            void after(const CpuState& s, uint32_t) {
+                switch (dest) {
+                    case TraceDest::X:    rec.value = s.regs[rd]; break;
+                    case TraceDest::F:    rec.value = s.fregs[rd]; break;
+                    case TraceDest::None: break;
+                }
+                out.push(rec);
+            }
+        };
+
+    } // anonymous namespace
+
+    /***** run_traced *****
+     *   run_with and a TraceProbe
+     ******************************/
+    RunResult run_traced(CpuState& s, std::size_t max_steps, TraceWriter& out) {
+        TraceProbe probe{out};
+        return run_with(s, max_steps, probe);
+    }
+
+    /***** format_trace_record *****
+     *   pc: raw, then the writeback and the address when there is one
+     ******************************/
+    std::string format_trace_record(const TraceRecord& r) {
+        char buf[80];
+        int n = std::snprintf(buf, sizeof buf, "%08x: %08x", r.pc, r.raw);
+
+        uint32_t rd = (r.raw >> 7) & 0x1F;
+        TraceDest dest = trace_dest(r.raw);
+        if (dest != TraceDest::None && !(dest == TraceDest::X && rd == 0)) {
+            n += std::snprintf(buf + n, sizeof buf - n, "  %c%-2u = 0x%08x",
+                               dest == TraceDest::X ? 'x' : 'f', rd, r.value);
+        }
+        if (trace_has_addr(r.raw)) {
+            std::snprintf(buf + n, sizeof buf - n, "  [0x%08x]", r.addr);
+        }
+        return buf;
+    }
+
+} // namespace rv::cpu
@@ -0,0 +1,196 @@
+#pragma once
+
+#include "core/rv32_cpu.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace rv::cpu {
+
+    /***** TraceRecord *****
+     *   One retired instruction in a CPU trace (16 bytes, fixed width)
+     *
+     *   pc    - address of the instruction
+     *   raw   - the instruction word
+     *   value - what it wrote to its destination register (x or f, see
+     *           trace_dest), 0 if it has none
+     *   addr  - effective address of a load/store, 0 otherwise
+     ******************************/
+    struct TraceRecord {
+        uint32_t pc;
+        uint32_t raw;
+        uint32_t value;
+        uint32_t addr;
+    };
+    static_assert(sizeof(TraceRecord) == 16);
+
+    /***** TraceDest *****
+     *   Which register file an instruction writes back to
+     ******************************/
+    enum class TraceDest : uint8_t {
+        None,
+        X,
+        F
+    };
+
+    /***** trace_dest / trace_has_addr *****
+     *   What a trace decoder needs to know about raw: where rd goes,
+     *   and whether addr is meaningful
+     ******************************/
+    TraceDest trace_dest(uint32_t raw);
+    bool      trace_has_addr(uint32_t raw);
+
+    /***** TraceCodec *****
+     *   How the record blocks of a trace file are stored
+     *   None - raw records
+     *   Zstd - zstd-compressed blocks (only if built with RV_TRACE_ZSTD)
+     ******************************/
+    enum class TraceCodec : uint32_t {
+        None = 0,
+        Zstd = 1
+    };
+
+    /***** kMaxTraceBlockRecords *****
+     *   Most records one block of a trace file may hold; TraceReader
+     *   treats a larger count as a corrupt file
+     ******************************/
+    constexpr std::size_t kMaxTraceBlockRecords = std::size_t(1) << 20;
+
+    /***** TraceOptions *****
+     *   ring_records  - size of the ring between the CPU and the writer
+     *                   thread (rounded up to a power of two)
+     *   block_records - records per block written to the file (1 up to
+     *                   kMaxTraceBlockRecords)
+     *   codec         - block compression
+     ******************************/
+    struct TraceOptions {
+        std::size_t ring_records  = std::size_t(1) << 16;
+        std::size_t block_records = 4096;
+        TraceCodec  codec         = TraceCodec::None;
+    };
+
+    /***** TraceWriter *****
+     *   Streams TraceRecords to a file from a background thread
+     *   - push() puts a record in a lock-free single-producer /
+     *     single-consumer ring; the writer thread drains it in blocks
+     *   - Nothing is dropped: push() waits if the ring is full
+     *   - Only one thread may push
+     *
+     *   File layout (little endian):
+     *     "RVTRACE1", u32 record size (16), u32 codec
+     *     blocks of: u32 record count, u32 payload bytes, payload
+     *
+     * Constructor: TraceWriter(path, opts)
+     *     - Creates/truncates path and starts the writer thread
+     *     - Throws std::runtime_error if the file can't be opened or the
+     *       codec isn't built in
+     ******************************/
+    class TraceWriter {
+    public:
+        explicit TraceWriter(const std::string& path, const TraceOptions& opts = {});
+        ~TraceWriter();
+
+        TraceWriter(const TraceWriter&) = delete;
+        TraceWriter& operator=(const TraceWriter&) = delete;
+
+        /***** push *****
+         *   Queues one record for the writer thread
+         ******************************/
+        void push(const TraceRecord& r) {
+            std::size_t h = head_.load(std::memory_order_relaxed);
+            if (h - tail_cache_ == ring_.size()) wait_for_space(h);
+            ring_[h & mask_] = r;
+            head_.store(h + 1, std::memory_order_release);
+        }
+
+        /***** close *****
+         *   Writes everything still queued, stops the thread and closes
+         *   the file (the destructor does this too)
+         * Returns:
+         *   false if a write to the file failed
+         ******************************/
+        bool close();
+
+        /***** records *****
+         *   How many records were pushed so far
+         ******************************/
+        uint64_t records() const { return head_.load(std::memory_order_relaxed); }
+
+    private:
+        void wait_for_space(std::size_t h);
+        void writer_loop();
+        void write_block(const TraceRecord* recs, std::size_t n);
+
+        std::vector<TraceRecord> ring_;
+        std::size_t              mask_;
+        std::size_t              block_records_;
+        TraceCodec               codec_;
+        std::FILE*               file_;
+
+        alignas(64) std::atomic<std::size_t> head_{0}; // written by push()
+        std::size_t                          tail_cache_ = 0;
+        alignas(64) std::atomic<std::size_t> tail_{0}; // written by the writer thread
+        std::atomic<bool>                    stop_{false};
+        bool                                 io_ok_ = true;
+        std::vector<uint8_t>                 scratch_; // packed records
+        std::vector<uint8_t>                 packed_;  // compressed block
+        std::thread                          thread_;
+    };
+
+    /***** TraceReader *****
+     *   Reads a file written by TraceWriter back, record by record
+     *   - Throws std::runtime_error if the file can't be opened, is not
+     *     a trace, or uses a codec that isn't built in
+     ******************************/
+    class TraceReader {
+    public:
+        explicit TraceReader(const std::string& path);
+        ~TraceReader();
+
+        TraceReader(const TraceReader&) = delete;
+        TraceReader& operator=(const TraceReader&) = delete;
+
+        /***** next *****
+         *   The next record; false at the end of the file
+         *   - Throws std::runtime_error on a truncated or corrupt block
+         ******************************/
+        bool next(TraceRecord& out);
+
+        TraceCodec codec() const { return codec_; }
+
+    private:
+        bool read_block();
+
+        std::FILE*               file_;
+        TraceCodec               codec_;
+        std::vector<TraceRecord> block_;
+        std::size_t              pos_ = 0;
+        std::vector<uint8_t>     scratch_;
+    };
+
+    /***** run_traced *****
+     *   run() in Interpret mode, pushing one TraceRecord per retired
+     *   instruction
+     *   - Same state and RunResult as run(s, max_steps)
+     *   - run() itself is untouched, so runs without a trace pay nothing
+     ******************************
+     * Inputs:
+     *   s         - the CPU state to run
+     *   max_steps - limit to stop looping
+     *   out       - where the records go
+     * Returns:
+     *   RunResult - stop reason and number of steps retired
+     ******************************/
+    RunResult run_traced(CpuState& s, std::size_t max_steps, TraceWriter& out);
+
+    /***** format_trace_record *****
+     *   One record as a line of text, e.g.
+     *     "00001004: 00812183  x3  = 0x0000002a  [0x00000108]"
+     ******************************/
+    std::string format_trace_record(const TraceRecord& r);
+
+} // namespace rv::cpu
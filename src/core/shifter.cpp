@@ -3,58 +3,51 @@
 
 namespace rv::core {
 
-    /***** shifter_execute *****
-     *   Shifts a 32-bit value by n
+    /***** shifter_execute_u32 *****
+     *   Shifts a packed 32-bit value by n
+     *   - Sra fills with copies of bit 31
      **************************
      * Inputs:
-     *   value - 32 bit vector
+     *   value - packed 32-bit value
      *   shamt - how many positions to shift
      *   op    - which kind of shift:
      * Output:
-     *   A new 32-bit bit vector
+     *   The shifted word
      ****************************/
-    Bits shifter_execute(const Bits& value, uint32_t shamt, ShiftOp op) {
-        assert(value.size() == 32);
-
+    uint32_t shifter_execute_u32(uint32_t value, uint32_t shamt, ShiftOp op) {
         uint32_t s = shamt & 31u;
-        Bits out(32, 0);
 
         switch (op) {
-            case ShiftOp::Sll: {
-                for (std::size_t i = 0; i < 32; ++i) {
-                    std::size_t dest = i + s;
-                    if (dest < 32) {
-                        out[dest] = value[i];
-                    }
-                }
-                break;
-            }
+            case ShiftOp::Sll:
+                return value << s;
 
-            case ShiftOp::Srl: {
-                for (std::size_t i = 0; i < 32; ++i) {
-                    std::size_t src = i + s;
-                    if (src < 32) {
-                        out[i] = value[src];
-                    } else {
-                        out[i] = 0;
-                    }
-                }
-                break;
-            }
+            case ShiftOp::Srl:
+                return value >> s;
 
             case ShiftOp::Sra: {
-                Bit sign = value[31];
-                for (std::size_t i = 0; i < 32; ++i) {
-                    std::size_t src = i + s;
-                    if (src < 32) {
-                        out[i] = value[src];
-                    } else {
-                        out[i] = sign;
-                    }
-                }
-                break;
+                // sign_fill is all ones when bit 31 is set
+                uint32_t sign_fill = 0u - (value >> 31);
+                uint32_t kept      = value >> s;
+                uint32_t fill      = s ? (sign_fill << (32u - s)) : 0u;
+                return kept | fill;
             }
         }
-        return out;
+        return value;
+    }
+
+    /***** shifter_execute *****
+     *   Shifts a 32-bit value by n
+     *   - Packs the value, runs shifter_execute_u32, unpacks the result
+     **************************
+     * Inputs:
+     *   value - 32 bit vector
+     *   shamt - how many positions to shift
+     *   op    - which kind of shift:
+     * Output:
+     *   A new 32-bit bit vector
+     ****************************/
+    Bits shifter_execute(const Bits& value, uint32_t shamt, ShiftOp op) {
+        assert(value.size() == 32);
+        return bv_from_u32(shifter_execute_u32(bv_to_u32(value), shamt, op));
     }
 } // namespace rv::core
@@ -29,4 +29,18 @@ namespace rv::core {
      ****************************/
     Bits shifter_execute(const Bits& value, uint32_t shamt, ShiftOp op);
 
+    /***** shifter_execute_u32 *****
+     *   Word-level version of shifter_execute
+     *   - Only the low 5 bits of shamt are used
+     *   - No heap allocation
+     **************************
+     * Inputs:
+     *   value - packed 32-bit value
+     *   shamt - how many positions to shift
+     *   op    - which kind of shift to use
+     * Output:
+     *   The shifted 32-bit result
+     ****************************/
+    uint32_t shifter_execute_u32(uint32_t value, uint32_t shamt, ShiftOp op);
+
 } // namespace rv::core
@@ -0,0 +1,50 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace rv::core {
+
+    /***** TraceSink *****
+     *   Where the MDU and F32 step traces go
+     *   - A default-constructed sink is a null sink: enabled() is false
+     *     and the ops skip building the trace strings at all
+     *   - TraceSink(vec) appends each line to a vector of strings
+     *   - TraceSink(ctx, fn) calls fn(ctx, line) for custom sinks
+     *
+     *   The sink is two pointers, so pass it by value.
+     ******************************/
+    class TraceSink {
+    public:
+        using EmitFn = void (*)(void* ctx, std::string_view line);
+
+        TraceSink() = default;
+
+        explicit TraceSink(std::vector<std::string>& out)
+            : ctx_(&out), fn_(&push_to_vector) {}
+
+        TraceSink(void* ctx, EmitFn fn)
+            : ctx_(ctx), fn_(fn) {}
+
+        /***** enabled *****
+         *   True if lines are kept, so callers can skip formatting
+         ******************************/
+        bool enabled() const { return fn_ != nullptr; }
+
+        /***** emit *****
+         *   Sends one trace line to the sink (no-op for the null sink)
+         ******************************/
+        void emit(std::string_view line) const {
+            if (fn_) fn_(ctx_, line);
+        }
+
+    private:
+        static void push_to_vector(void* ctx, std::string_view line) {
+            static_cast<std::vector<std::string>*>(ctx)->emplace_back(line);
+        }
+
+        void*  ctx_ = nullptr;
+        EmitFn fn_  = nullptr;
+    };
+
+} // namespace rv::core
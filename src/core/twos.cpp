@@ -58,27 +58,19 @@ namespace rv::core {
         ******************************/
     int64_t decode_i32_to_host(const Bits& b) {
         if (b.empty()) return 0;
-        Bits w = b;
-        if (w.size() < 32) w = sign_extend(w, 32);
-        else if (w.size() > 32) w = bv_slice(w, 31, 0);
 
-        Bit sign = w[31];
-
-        auto sum_bits = [](const Bits& x)->int64_t {
-            int64_t acc = 0;
-            for (std::size_t i = 0; i < x.size(); ++i) {
-                if (x[i]) acc += (int64_t(1) << i);
-            }
-            return acc;
-        };
-
-        if (sign == 0) {
-            return sum_bits(w);
-        } else {
-            Bits mag = twos_negate(w); // now magnitude in positive form
-            int64_t m = sum_bits(mag);
-            return -m;
+        // low 32 bits packed into a word, then sign-extended from the
+        // top bit we have when b is narrower
+        std::size_t n = b.size() < 32 ? b.size() : 32;
+        uint32_t w = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            w |= uint32_t(b[i] & 1u) << i;
         }
+        if (n < 32) {
+            uint32_t fill = 0u - uint32_t(b[n - 1] & 1u);
+            w |= fill << n;
+        }
+        return decode_twos_i32_fixed(Bits32(w));
     }
 
 /* -------------------- helpers to make sure we are working with 32 bits -------------------- */
@@ -109,17 +101,11 @@ namespace rv::core {
     ******************************/
     SignMag32 decode_i32_to_sign_and_magnitude(const Bits& b32_in) {
         Bits w = ensure_i32_width(b32_in);
-        Bit sign = w[31];
+        SignMagFixed sm = sign_magnitude_fixed(Bits32(w));
 
-        Bits mag;
-        if (sign == 0) {
-            mag = trim_leading(w);
-        } else {
-            Bits pos = twos_negate(w);
-            mag = trim_leading(pos);
-        }
+        Bits mag = trim_leading(Bits(sm.mag));
         if (mag.empty()) mag = Bits{0};
-        return SignMag32{sign, mag};
+        return SignMag32{sm.sign, mag};
     }
 
     /***** encode_i32_from_sign_and_magnitude *****
@@ -141,23 +127,14 @@ namespace rv::core {
     }
 
     EncodeI32Result encode_twos_i32(int64_t value) {
-        EncodeI32Result res{};
-
-        // Signed 32-bit bounds
-        const int64_t MIN_I32 = -2147483648LL; // -2^31
-        const int64_t MAX_I32 =  2147483647LL; //  2^31 - 1
-
-        // Overflow flag: true if value is outside signed 32-bit range
-        res.overflow = (value < MIN_I32) || (value > MAX_I32);
-
-        int32_t narrowed = static_cast<int32_t>(value);
-
-        // Build a 32-bit 2's comp bit vector
-        res.bits = encode_i32_TEMP_host(narrowed);
-
-        // Pretty hex str
-        res.hex = bv_to_hex_string(res.bits);
+        // the lean encode does the work; this adds the Bits vector
+        // and the hex text on top
+        EncodeI32Fixed enc = encode_twos_i32_fixed(value);
 
+        EncodeI32Result res{};
+        res.overflow = enc.overflow;
+        res.bits     = enc.bits;
+        res.hex      = enc.hex();
         return res;
     }
     int64_t decode_twos_i32(const Bits& b32) {
@@ -1,5 +1,6 @@
 #pragma once
 #include "core/bitvec.hpp"
+#include "core/bitvec_fixed.hpp"
 #include <cstdint>
 #include <string>
 
@@ -111,4 +112,60 @@ namespace rv::core {
       ******************************/
      int64_t decode_twos_i32(const Bits& b32);
 
+ // -------------------------------------------------------------
+ // Fixed-width constexpr versions (no heap, no exceptions), for
+ // working out golden values at compile time
+ // -------------------------------------------------------------
+
+     /***** EncodeI32Fixed *****
+     *   encode_twos_i32 result on a Bits32: just the packed word and
+     *   the overflow flag; the hex text is only made when asked for
+     *
+     *   bits     - 32-bit 2's comp
+     *   overflow - true if the og value did not fit in 32-bit signed range
+     *   word()   - bits as a uint32_t
+     *   hex()    - same text as EncodeI32Result::hex
+     ******************************/
+     struct EncodeI32Fixed {
+      Bits32 bits;
+      bool   overflow;
+
+      constexpr uint32_t    word() const { return static_cast<uint32_t>(bits.to_u64()); }
+      constexpr std::string hex() const { return bits.to_hex(); }
+     };
+
+     /***** encode_twos_i32_fixed *****
+      *   constexpr encode_twos_i32: same bits and overflow flag
+      ******************************/
+     constexpr EncodeI32Fixed encode_twos_i32_fixed(int64_t value) {
+      bool overflow = value < -2147483648LL || value > 2147483647LL;
+      return EncodeI32Fixed{ Bits32(static_cast<uint64_t>(value)), overflow };
+     }
+
+     /***** decode_twos_i32_fixed *****
+      *   constexpr decode_twos_i32 on a Bits32
+      ******************************/
+     constexpr int64_t decode_twos_i32_fixed(const Bits32& b32) {
+      int64_t raw = static_cast<int64_t>(b32.to_u64());
+      return b32.msb() ? raw - (int64_t(1) << 32) : raw;
+     }
+
+     /***** SignMagFixed / sign_magnitude_fixed *****
+      *   constexpr decode_i32_to_sign_and_magnitude on a Bits32
+      *   - mag is |value| zero-extended to 32 bits; INT_MIN gives
+      *     0x80000000 like the Bits version
+      *   - Branchless: mask is all ones for negative values, and
+      *     (v ^ mask) - mask is v or -v
+      ******************************/
+     struct SignMagFixed {
+      Bit    sign;
+      Bits32 mag;
+     };
+
+     constexpr SignMagFixed sign_magnitude_fixed(const Bits32& b32) {
+      uint32_t v    = static_cast<uint32_t>(b32.to_u64());
+      uint32_t mask = 0u - (v >> 31);
+      return SignMagFixed{ static_cast<Bit>(v >> 31), Bits32((v ^ mask) - mask) };
+     }
+
 } // namespace rv::core
@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include "core/alu.hpp"
+#include "core/shifter.hpp"
 #include "core/bitvec.hpp"
 
 using namespace rv::core;
@@ -96,3 +97,92 @@ TEST(AluAddSub, AddThirteenAndMinusThirteen) {
     EXPECT_EQ(res.flags.N, 0);
     EXPECT_EQ(res.flags.Z, 1);
 }
+
+/***** Test: word-level ALU matches Bits API *****
+ * Boundary operands for Add and Sub, checked
+ * against the Bits wrapper and known flags.
+ ******************************/
+TEST(AluWord, MatchesBitsApi) {
+    const uint32_t vals[] = {0x0u, 0x1u, 0x7fffffffu, 0x80000000u, 0xffffffffu, 0xdu, 0xfffffff3u};
+
+    for (uint32_t a : vals) {
+        for (uint32_t b : vals) {
+            for (AluOp op : {AluOp::Add, AluOp::Sub}) {
+                AluResult32 w = alu_execute_u32(a, b, op);
+                AluResult    v = alu_execute(bv_from_u32(a), bv_from_u32(b), op);
+
+                EXPECT_EQ(w.result, bv_to_u32(v.result));
+                EXPECT_EQ(w.flags.N, v.flags.N);
+                EXPECT_EQ(w.flags.Z, v.flags.Z);
+                EXPECT_EQ(w.flags.C, v.flags.C);
+                EXPECT_EQ(w.flags.V, v.flags.V);
+            }
+        }
+    }
+
+    // a - 0: -0 is 0, so the add has no carry out
+    AluResult32 r = alu_execute_u32(0x5u, 0x0u, AluOp::Sub);
+    EXPECT_EQ(r.result, 0x5u);
+    EXPECT_EQ(r.flags.C, 0);
+
+    // 0x80000000 - 1 (same case as SubNegOverflow)
+    r = alu_execute_u32(0x80000000u, 0x1u, AluOp::Sub);
+    EXPECT_EQ(r.result, 0x7fffffffu);
+    EXPECT_EQ(r.flags.V, 1);
+    EXPECT_EQ(r.flags.C, 1);
+}
+
+/***** Test: lazy flags *****
+ * AluLazy32 and the masked calls give the same flags as the full
+ * alu_execute_u32, and leave the flags nobody asked for at 0
+ ******************************/
+TEST(AluLazy, FlagsOnDemandMatchFull) {
+    static_assert(alu_lazy_u32(0x7fffffffu, 1u, AluOp::Add).V() == 1);
+    static_assert(alu_lazy_u32(5u, 5u, AluOp::Sub).Z() == 1);
+
+    const uint32_t words[] = { 0u, 1u, 5u, 0x7fffffffu, 0x80000000u, 0xffffffffu };
+    for (AluOp op : { AluOp::Add, AluOp::Sub, AluOp::Sll }) {
+        for (uint32_t a : words) {
+            for (uint32_t b : words) {
+                AluResult32 full = alu_execute_u32(a, b, op);
+                AluLazy32 lazy = alu_lazy_u32(a, b, op);
+                EXPECT_EQ(lazy.result, full.result);
+                EXPECT_EQ(lazy.N(), full.flags.N);
+                EXPECT_EQ(lazy.Z(), full.flags.Z);
+                EXPECT_EQ(lazy.C(), full.flags.C);
+                EXPECT_EQ(lazy.V(), full.flags.V);
+
+                AluResult32 zc = alu_execute_u32(a, b, op, kAluFlagZ | kAluFlagC);
+                EXPECT_EQ(zc.result, full.result);
+                EXPECT_EQ(zc.flags.Z, full.flags.Z);
+                EXPECT_EQ(zc.flags.C, full.flags.C);
+                EXPECT_EQ(zc.flags.N, 0);
+                EXPECT_EQ(zc.flags.V, 0);
+            }
+        }
+    }
+
+    AluResult just_v = alu_execute(bv_from_u32(0x80000000u), bv_from_u32(1u), AluOp::Sub, kAluFlagV);
+    EXPECT_EQ(bv_to_u32(just_v.result), 0x7fffffffu);
+    EXPECT_EQ(just_v.flags.V, 1);
+    EXPECT_EQ(just_v.flags.C, 0);
+}
+
+/***** Test: shifter *****
+ * Cases:
+ *   0x80000001 << 4       → 0x00000010
+ *   0x80000000 >>> 31     → 0x00000001
+ *   0x80000000 >> 31      → 0xffffffff
+ *   shamt 33 uses only the low 5 bits (1)
+ ******************************/
+TEST(Shifter, LogicalAndArithmetic) {
+    EXPECT_EQ(shifter_execute_u32(0x80000001u, 4, ShiftOp::Sll), 0x00000010u);
+    EXPECT_EQ(shifter_execute_u32(0x80000000u, 31, ShiftOp::Srl), 0x00000001u);
+    EXPECT_EQ(shifter_execute_u32(0x80000000u, 31, ShiftOp::Sra), 0xffffffffu);
+    EXPECT_EQ(shifter_execute_u32(0x40000000u, 0, ShiftOp::Sra), 0x40000000u);
+    EXPECT_EQ(shifter_execute_u32(0x4u, 33, ShiftOp::Srl), 0x2u);
+
+    Bits v = bv_from_u32(0xf0000000u);
+    EXPECT_EQ(bv_to_hex_string(shifter_execute(v, 4, ShiftOp::Sra)), "0xff000000");
+    EXPECT_EQ(bv_to_hex_string(shifter_execute(v, 4, ShiftOp::Srl)), "0xf000000");
+}
@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+#include "core/arena.hpp"
+#include "core/f32.hpp"
+#include "core/mdu.hpp"
+#include "core/twos.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace rv::core;
+
+/***** Test: bump allocation and reset *****
+ * Allocations are aligned, a full chunk
+ * is followed by a bigger one, and reset
+ * hands the same memory out again
+ *******************************/
+TEST(Arena, BumpsAlignsAndReusesChunks) {
+    Arena arena(256);
+
+    void* first = arena.allocate(24, 8);
+    void* aligned = arena.allocate(1, 1);
+    void* wide = arena.allocate(16, 16);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(wide) % 16, 0u);
+    EXPECT_EQ(static_cast<char*>(aligned), static_cast<char*>(first) + 24);
+
+    void* big = arena.allocate(1000, 8); // past the first chunk
+    ASSERT_NE(big, nullptr);
+    std::size_t reserved = arena.bytes_reserved();
+    EXPECT_GE(reserved, 256u + 1000u);
+    EXPECT_GE(arena.bytes_used(), 24u + 1 + 16 + 1000);
+
+    arena.reset();
+    EXPECT_EQ(arena.bytes_used(), 0u);
+    EXPECT_EQ(arena.allocate(24, 8), first);
+    EXPECT_NE(arena.allocate(1000, 8), nullptr);
+    EXPECT_EQ(arena.bytes_reserved(), reserved); // nothing new from upstream
+
+    // pmr containers work on top of it
+    std::pmr::vector<int> v(&arena);
+    for (int i = 0; i < 100; ++i) v.push_back(i);
+    EXPECT_EQ(v[99], 99);
+}
+
+/***** Test: arena trace sink *****
+ * Same lines as the vector sink for a
+ * batch of MDU and F32 calls, and reset
+ * starts over without new chunks
+ *******************************/
+TEST(Arena, TraceLinesMatchVectorSink) {
+    TraceArena traces(1024);
+    auto x = encode_twos_i32(-7).bits;
+    auto y = encode_twos_i32(3).bits;
+    Bits one_five = bv_from_hex_string("0x3fc00000"); // 1.5f
+
+    std::size_t reserved = 0;
+    for (int round = 0; round < 3; ++round) {
+        std::vector<std::string> want = mdu_mul(MulOp::Mul, x, y).trace;
+        for (const std::vector<std::string>& more : {mdu_div(DivOp::Div, x, y).trace,
+                                                     fadd_f32(one_five, one_five).trace}) {
+            want.insert(want.end(), more.begin(), more.end());
+        }
+
+        std::size_t mul_start = traces.size();
+        MulResult m = mdu_mul(MulOp::Mul, x, y, traces.sink());
+        std::size_t div_start = traces.size();
+        mdu_div(DivOp::Div, x, y, traces.sink(), MduEngine::Radix4);
+        fadd_f32(one_five, one_five, traces.sink());
+
+        EXPECT_TRUE(m.trace.empty());
+        EXPECT_EQ(div_start - mul_start, 33u);
+        ASSERT_EQ(traces.size(), want.size());
+        for (std::size_t i = 0; i < want.size(); ++i) {
+            EXPECT_EQ(traces.lines()[i], want[i]) << i;
+        }
+
+        if (round == 0) reserved = traces.arena().bytes_reserved();
+        EXPECT_EQ(traces.arena().bytes_reserved(), reserved);
+        traces.reset();
+        EXPECT_EQ(traces.size(), 0u);
+    }
+}
@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+#include "core/batch.hpp"
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace rv::core;
+
+namespace {
+
+    /***** make_operands *****
+     *   Boundary values first, then random words
+     ******************************/
+    std::vector<uint32_t> make_operands(std::size_t n, uint32_t seed) {
+        std::vector<uint32_t> v = {0x0u, 0x1u, 0x7fffffffu, 0x80000000u, 0xffffffffu, 0xdu, 0xfffffff3u};
+        std::mt19937 rng(seed);
+        while (v.size() < n) v.push_back(rng());
+        v.resize(n);
+        return v;
+    }
+
+} // namespace
+
+/***** Test: batch ALU matches alu_execute_u32 *****
+ * 37 lanes so the scalar tail runs too
+ ******************************/
+TEST(BatchAlu, MatchesScalar) {
+    const std::size_t n = 37;
+    auto a = make_operands(n, 1);
+    auto b = make_operands(n, 2);
+    std::reverse(b.begin(), b.begin() + 7); // mix the boundary pairs
+
+    for (AluOp op : {AluOp::Add, AluOp::Sub, AluOp::Sll}) {
+        std::vector<uint32_t> res(n);
+        std::vector<Bit> N(n), Z(n), C(n), V(n);
+        alu_execute_batch(op, a, b, AluBatchOut{res, N, Z, C, V});
+
+        for (std::size_t i = 0; i < n; ++i) {
+            AluResult32 r = alu_execute_u32(a[i], b[i], op);
+            EXPECT_EQ(res[i], r.result) << "lane " << i;
+            EXPECT_EQ(N[i], r.flags.N) << "lane " << i;
+            EXPECT_EQ(Z[i], r.flags.Z) << "lane " << i;
+            EXPECT_EQ(C[i], r.flags.C) << "lane " << i;
+            EXPECT_EQ(V[i], r.flags.V) << "lane " << i;
+        }
+    }
+}
+
+/***** Test: batch shifter and skipped flags *****
+ ******************************/
+TEST(BatchAlu, ShifterAndOptionalFlags) {
+    const std::size_t n = 21;
+    auto v  = make_operands(n, 3);
+    auto sh = make_operands(n, 4);
+
+    for (ShiftOp op : {ShiftOp::Sll, ShiftOp::Srl, ShiftOp::Sra}) {
+        std::vector<uint32_t> out(n);
+        shifter_execute_batch(op, v, sh, out);
+        for (std::size_t i = 0; i < n; ++i) {
+            EXPECT_EQ(out[i], shifter_execute_u32(v[i], sh[i], op)) << "lane " << i;
+        }
+    }
+
+    // only Z asked for
+    std::vector<uint32_t> res(n);
+    std::vector<Bit> Z(n);
+    alu_execute_batch(AluOp::Sub, v, v, AluBatchOut{res, {}, Z, {}, {}});
+    for (std::size_t i = 0; i < n; ++i) {
+        EXPECT_EQ(res[i], 0u);
+        EXPECT_EQ(Z[i], 1);
+    }
+
+    std::vector<uint32_t> short_out(n - 1);
+    EXPECT_THROW(shifter_execute_batch(ShiftOp::Sll, v, sh, short_out), std::invalid_argument);
+}
+
+/***** Test: batch MDU matches the scalar word kernels *****
+ ******************************/
+TEST(BatchMdu, MatchesScalar) {
+    const std::size_t n = 19;
+    auto a = make_operands(n, 5);
+    auto b = make_operands(n, 6);
+    b[3] = 0; // divide by zero lane
+
+    std::vector<uint32_t> lo(n), hi(n), q(n), r(n);
+    std::vector<Bit> ov(n);
+
+    mdu_mul_batch(MulOp::Mulhu, a, b, MulBatchOut{lo, hi, ov});
+    for (std::size_t i = 0; i < n; ++i) {
+        MulResult32 m = mdu_mul_u32(MulOp::Mulhu, a[i], b[i]);
+        EXPECT_EQ(lo[i], m.lo);
+        EXPECT_EQ(hi[i], m.hi);
+        EXPECT_EQ(ov[i], m.overflow ? 1 : 0);
+    }
+
+    mdu_div_batch(DivOp::Div, a, b, DivBatchOut{q, r, {}});
+    for (std::size_t i = 0; i < n; ++i) {
+        DivResult32 d = mdu_div_u32(DivOp::Div, a[i], b[i]);
+        EXPECT_EQ(q[i], d.q);
+        EXPECT_EQ(r[i], d.r);
+    }
+    EXPECT_EQ(q[3], 0xffffffffu);
+    EXPECT_EQ(r[3], a[3]);
+}
@@ -1,5 +1,6 @@
 #include "gtest/gtest.h"
 #include "core/bitvec.hpp"
+#include "core/bitvec_fixed.hpp"
 
 using namespace rv::core;
 
@@ -52,3 +53,111 @@ TEST(BitVec, TwosNegate) {
     auto n = twos_negate(b);
     EXPECT_EQ(bv_to_hex_string(n), "0xfb");
 }
+
+/***** Test: fixed-width field helpers at compile time *****
+ * Same cases as ExtendAndSlice, on BitVec<4>/<8>
+ ******************************/
+TEST(BitVecFixed, ConstexprFields) {
+    constexpr BitVec<4> a(0xa);
+    static_assert(a.zero_extend<8>().to_u64() == 0x0a);
+    static_assert(a.sign_extend<8>().to_u64() == 0xfa);
+    static_assert(a.zero_extend<8>().slice<3, 0>().to_u64() == 0xa);
+    static_assert(Bits32(0x12345678u).slice<15, 8>().to_u64() == 0x56);
+    static_assert(Bits64(0x80000000u).sign_extend<32>().to_u64() == 0x80000000u);
+    static_assert(Bits32(0x7fffffffu).to_hex() == "0x7fffffff");
+    static_assert(BitVec<12>(0x0af).to_hex(false) == "af");
+
+    EXPECT_EQ(a.pad_left<8>(1).to_hex(), "0xfa");
+}
+
+/***** Test: BitVec <-> Bits round trip *****
+ ******************************/
+TEST(BitVecFixed, ConvertsToAndFromBits) {
+    Bits b = bv_from_hex_string("0x1234abcd");
+    Bits32 w = b;
+    EXPECT_EQ(w.to_u64(), 0x1234abcdu);
+    EXPECT_EQ(w.to_hex(), bv_to_hex_string(b));
+
+    Bits back = w;
+    EXPECT_EQ(back.size(), 32u);
+    EXPECT_EQ(bv_to_hex_string(back), "0x1234abcd");
+
+    // wider input is cut down like zero_extend(b, 8)
+    BitVec<8> low = b;
+    EXPECT_EQ(low.to_u64(), 0xcdu);
+
+    // shifts move bits across the 64-bit word boundary
+    BitVec<96> wide(0x8000000000000001ull);
+    wide <<= 4;
+    EXPECT_EQ(wide.word(0), 0x10u);
+    EXPECT_EQ(wide.word(1), 0x8u);
+    wide >>= 8;
+    EXPECT_EQ(wide.word(0), 0x0800000000000000ull);
+    EXPECT_EQ(wide.word(1), 0x0u);
+}
+
+TEST(BitVecHex, BulkMatchesScalar) {
+    // 1..40 digits covers a partial head word, whole words and both
+    // 8-digit halves of the fast path
+    const std::string digits = "0123456789abcdefABCDEF0f1e2d3c4b5a697887";
+    for (std::size_t len = 1; len <= digits.size(); ++len) {
+        std::string hex = digits.substr(0, len);
+
+        Bits ref;
+        for (auto it = hex.rbegin(); it != hex.rend(); ++it) {
+            unsigned v = std::stoul(std::string(1, *it), nullptr, 16);
+            for (int i = 0; i < 4; ++i) ref.push_back((v >> i) & 1);
+        }
+        Bits b = bv_from_hex_string(hex);
+        EXPECT_EQ(b, trim_leading(ref)) << hex;
+
+        std::string lower = hex;
+        for (char& c : lower) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        std::size_t nz = 0;
+        while (nz + 1 < lower.size() && lower[nz] == '0') ++nz;
+        EXPECT_EQ(bv_to_hex_string(ref, false), lower.substr(nz)) << hex;
+    }
+
+    // odd widths: only the real bits are printed
+    EXPECT_EQ(bv_to_hex_string(Bits(67, 1)), "0x7ffffffffffffffff");
+    EXPECT_EQ(bv_to_pretty_bin(bv_from_hex_string("0x1f0"), 3, ' '), "111 110 000");
+    EXPECT_EQ(bv_to_pretty_bin(Bits(19, 1)), std::string(19, '1'));
+}
+
+TEST(BitVecHex, ReportsFirstBadOffset) {
+    std::vector<uint64_t> words;
+
+    HexParseResult ok = hex_to_words("0x0123456789abcdef0", words);
+    ASSERT_TRUE(ok.ok);
+    EXPECT_EQ(ok.digits, 17u);
+    ASSERT_EQ(words.size(), 2u);
+    EXPECT_EQ(words[0], 0x123456789abcdef0ull);
+    EXPECT_EQ(words[1], 0x0u);
+
+    // bad character in the head, then inside a fast-path chunk
+    HexParseResult head = hex_to_words("0xg123456789abcdef0", words);
+    EXPECT_FALSE(head.ok);
+    EXPECT_EQ(head.bad_offset, 2u);
+
+    HexParseResult body = hex_to_words("1234567890abcdef12345z7890abcdeg", words);
+    EXPECT_FALSE(body.ok);
+    EXPECT_EQ(body.bad_offset, 21u);
+
+    // only one prefix is allowed, and offsets count from the caller's
+    // input with its prefix and '_' separators
+    HexParseResult twice = hex_to_words("0x12", words, false);
+    EXPECT_FALSE(twice.ok);
+    EXPECT_EQ(twice.bad_offset, 1u);
+
+    auto hex_error = [](const std::string& s) -> std::string {
+        try {
+            bv_from_hex_string(s);
+        } catch (const std::invalid_argument& e) {
+            return e.what();
+        }
+        return "no error";
+    };
+    EXPECT_EQ(hex_error("12_34_5x"), "Invalid hex digit at offset 7");
+    EXPECT_EQ(hex_error("0x0x12"), "Invalid hex digit at offset 3");
+    EXPECT_EQ(hex_error("0_x12"), "Invalid hex digit at offset 2");
+}
@@ -1,5 +1,21 @@
 #include <gtest/gtest.h>
 #include "core/rv32_cpu.hpp"
+#include "core/rv32_block.hpp"
+#include "core/rv32_checkpoint.hpp"
+#include "core/rv32_dcache.hpp"
+#include "core/rv32_jobs.hpp"
+#include "core/rv32_parallel.hpp"
+#include "core/mdu.hpp"
+#include "core/f32.hpp"
+#include "core/rv32_loader.hpp"
+#include "core/rv32_trace.hpp"
+#include "core/rv32_profile.hpp"
+#include "core/rv32_simt.hpp"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <unistd.h>
 
 using namespace rv::cpu;
 
@@ -38,6 +54,27 @@ namespace {
     }
 
 
+    uint32_t encode_branch(uint32_t funct3, uint32_t rs1, uint32_t rs2, int32_t offset_bytes) {
+        uint32_t imm = static_cast<uint32_t>(offset_bytes);
+
+        uint32_t imm_12   = (imm >> 12) & 0x1;
+        uint32_t imm_10_5 = (imm >> 5)  & 0x3F;
+        uint32_t imm_4_1  = (imm >> 1)  & 0xF;
+        uint32_t imm_11   = (imm >> 11) & 0x1;
+
+        uint32_t inst = 0;
+        inst |= (imm_12   << 31);
+        inst |= (imm_10_5 << 25);
+        inst |= (rs2      << 20);
+        inst |= (rs1      << 15);
+        inst |= (funct3   << 12);
+        inst |= (imm_4_1  << 8);
+        inst |= (imm_11   << 7);
+        inst |= 0x63;
+
+        return inst;
+    }
+
     uint32_t encode_lui(uint32_t rd, uint32_t imm20) {
         uint32_t inst = 0;
         inst |= (imm20 << 12);
@@ -46,6 +83,39 @@ namespace {
         return inst;
     }
 
+    uint32_t encode_r(uint32_t funct7, uint32_t funct3, uint32_t rd, uint32_t rs1, uint32_t rs2) {
+        return (funct7 << 25) | (rs2 << 20) | (rs1 << 15) | (funct3 << 12) | (rd << 7) | 0x33;
+    }
+
+    uint32_t encode_i(uint32_t opcode, uint32_t funct3, uint32_t rd, uint32_t rs1, int32_t imm) {
+        return ((static_cast<uint32_t>(imm) & 0xFFF) << 20) | (rs1 << 15) | (funct3 << 12) | (rd << 7) | opcode;
+    }
+
+    uint32_t encode_s(uint32_t funct3, uint32_t rs1, uint32_t rs2, int32_t imm) {
+        uint32_t u = static_cast<uint32_t>(imm) & 0xFFF;
+        return ((u >> 5) << 25) | (rs2 << 20) | (rs1 << 15) | (funct3 << 12) | ((u & 0x1F) << 7) | 0x23;
+    }
+
+    uint32_t encode_fp(uint32_t funct7, uint32_t funct3, uint32_t rd, uint32_t rs1, uint32_t rs2) {
+        return (encode_r(funct7, funct3, rd, rs1, rs2) & ~0x7Fu) | 0x53;
+    }
+
+    void put32(std::vector<uint8_t>& f, std::size_t at, uint32_t v) {
+        for (int i = 0; i < 4; ++i) f[at + i] = static_cast<uint8_t>(v >> (8 * i));
+    }
+
+    void put16(std::vector<uint8_t>& f, std::size_t at, uint16_t v) {
+        f[at] = static_cast<uint8_t>(v);
+        f[at + 1] = static_cast<uint8_t>(v >> 8);
+    }
+
+    std::string write_temp(const std::string& name, const std::vector<uint8_t>& bytes) {
+        std::filesystem::path p = std::filesystem::temp_directory_path() / name;
+        std::ofstream out(p, std::ios::binary);
+        out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        return p.string();
+    }
+
     uint32_t encode_auipc(uint32_t rd, uint32_t imm20) {
         uint32_t inst = 0;
         inst |= (imm20 << 12);
@@ -127,6 +197,171 @@ TEST(CpuMem, LwSwSimple) {
     EXPECT_EQ(s.mem[16], 0x2Au);
 }
 
+/***** paged memory *****
+ * A full 4 GiB address space only allocates
+ * the pages that are used, and reset frees
+ * them again.
+ *************************/
+TEST(CpuMem, SparseFourGiBAndReset) {
+    CpuState s(std::size_t(1) << 32);
+    reset(s);
+
+    std::vector<uint32_t> program = {
+        0xfff00093u, // addi x1,x0,-1      (x1 = 0xffffffff)
+        0x02a00113u, // addi x2,x0,42
+        0xfe20ae23u, // sw   x2,-4(x1)     (0xfffffffb)
+        0xffc0a183u  // lw   x3,-4(x1)
+    };
+    load_program(s, program, 0);
+    run(s, program.size());
+
+    EXPECT_EQ(s.regs[3], 42u);
+    EXPECT_EQ(s.mem.load_u32(0xfffffffbu), 42u);
+    EXPECT_EQ(s.mem.pages_touched(), 2u); // code page + top page
+    EXPECT_EQ(s.mem.load_u32(0x80000000u), 0u); // untouched reads as zero
+    EXPECT_EQ(s.mem.pages_touched(), 2u);
+
+    reset(s);
+    EXPECT_EQ(s.mem.pages_touched(), 0u);
+    EXPECT_EQ(s.mem.load_u32(0xfffffffbu), 0u);
+}
+
+/***** page-crossing words *****
+ * A word that straddles two pages reads and
+ * writes the same as a flat byte array, and
+ * still drops decoded code on the next page.
+ *************************/
+TEST(CpuMem, WordAcrossPageBoundary) {
+    Memory m(3 * Memory::kPageSize);
+    m.store_u32(Memory::kPageSize - 2, 0xa1b2c3d4u);
+    EXPECT_EQ(m[Memory::kPageSize - 2], 0xd4u);
+    EXPECT_EQ(m[Memory::kPageSize + 1], 0xa1u);
+    EXPECT_EQ(m.load_u32(Memory::kPageSize - 2), 0xa1b2c3d4u);
+
+    DecodedInstr& slot = m.decoded(Memory::kPageSize);
+    slot.valid = true;
+    EXPECT_TRUE(m.store_u32(Memory::kPageSize - 1, 0));
+    EXPECT_FALSE(m.peek_decoded(Memory::kPageSize)->valid);
+
+    Memory copy = m;
+    EXPECT_TRUE(copy == m);
+    copy.store_u32(8, 1);
+    EXPECT_FALSE(copy == m);
+}
+
+/***** loads outside memory *****
+ * load_program checks the whole program before it writes a word;
+ * in release builds too, a bad address throws instead of writing
+ * past the page table
+ *************************/
+TEST(CpuMem, LoadProgramOutOfRange) {
+    CpuState s(2 * Memory::kPageSize);
+    reset(s);
+    const std::vector<uint32_t> words = { 0x00100093u, 0x00200113u };
+
+    EXPECT_THROW(load_program(s, words, 2 * Memory::kPageSize - 4), std::out_of_range);
+    EXPECT_EQ(s.mem.load_u32(2 * Memory::kPageSize - 4), 0u);    // nothing written
+    EXPECT_THROW(load_program(s, words, 0xFFFFFFFCu), std::out_of_range);
+    EXPECT_THROW(fetch_decoded(s, 8 * Memory::kPageSize), std::out_of_range);
+
+    load_program(s, words, 2 * Memory::kPageSize - 8);          // exactly fits
+    EXPECT_EQ(s.mem.load_u32(2 * Memory::kPageSize - 4), 0x00200113u);
+}
+
+/***** fork and snapshot *****
+ * A fork shares pages until one side writes;
+ * then only that page is copied. restore()
+ * brings back the saved registers and memory.
+ *************************/
+TEST(CpuFork, CopyOnWritePages) {
+    CpuState s(64 * 1024);
+    reset(s);
+
+    std::vector<uint32_t> program = {
+        0x000020b7u, // lui  x1,0x2        (x1 = 0x2000)
+        0x00108113u, // addi x2,x1,1
+        0x0020a023u, // sw   x2,0(x1)
+        0x0000a183u, // lw   x3,0(x1)
+        0x0030a223u  // sw   x3,4(x1)
+    };
+    load_program(s, program, 0);
+    run(s, 3);
+    ASSERT_EQ(s.mem.pages_touched(), 2u);
+
+    CpuSnapshot snap = snapshot(s);
+    CpuState child = fork(s);
+    EXPECT_EQ(child.mem.pages_shared(), 2u);
+    EXPECT_TRUE(child.mem == s.mem);
+
+    run(child, 2);
+    EXPECT_EQ(child.regs[3], 0x2001u);
+    EXPECT_EQ(child.mem.load_u32(0x2004), 0x2001u);
+    EXPECT_EQ(child.mem.pages_shared(), 1u); // only the data page was copied
+    EXPECT_EQ(s.mem.load_u32(0x2004), 0u);   // parent untouched
+    EXPECT_EQ(s.pc, 0x0cu);
+
+    run(s, 2);
+    EXPECT_TRUE(child.mem == s.mem);
+
+    restore(s, snap);
+    EXPECT_EQ(s.pc, 0x0cu);
+    EXPECT_EQ(s.regs[3], 0u);
+    EXPECT_EQ(s.mem.load_u32(0x2004), 0u);
+    EXPECT_EQ(s.mem.load_u32(0x2000), 0x2001u);
+}
+
+/***** forks on threads *****
+ * Two threads fork one parent at the same time, then
+ * two forks whose parent is gone write the same pages
+ * on their own threads. Run it under TSan too.
+ ******************************/
+TEST(CpuFork, ThreadedForksWriteSharedPages) {
+    constexpr uint32_t kPages = 8;
+    auto fill = [](Memory& m, uint32_t tag) {
+        for (uint32_t p = 0; p < kPages; ++p) {
+            for (uint32_t off = 0; off < Memory::kPageSize; off += 4) {
+                m.store_u32(p * Memory::kPageSize + off, tag + p);
+            }
+        }
+    };
+    auto holds = [](const Memory& m, uint32_t tag) {
+        for (uint32_t p = 0; p < kPages; ++p) {
+            for (uint32_t off = 0; off < Memory::kPageSize; off += 4) {
+                if (m.load_u32(p * Memory::kPageSize + off) != tag + p) return false;
+            }
+        }
+        return true;
+    };
+
+    Memory parent(kPages * Memory::kPageSize);
+    fill(parent, 100);
+    std::vector<Memory> copies(2, Memory(0));
+    {
+        std::thread t0([&] { copies[0] = parent; });
+        std::thread t1([&] { copies[1] = parent; });
+        t0.join();
+        t1.join();
+    }
+    fill(parent, 900); // the parent's write cache must not reach the copies
+    EXPECT_TRUE(holds(copies[0], 100));
+    EXPECT_TRUE(holds(copies[1], 100));
+
+    for (int round = 0; round < 20; ++round) {
+        auto base = std::make_unique<Memory>(kPages * Memory::kPageSize);
+        fill(*base, 1);
+        Memory a(*base);
+        Memory b(*base);
+        base.reset();
+
+        std::thread ta([&] { fill(a, 1000); });
+        std::thread tb([&] { fill(b, 2000); });
+        ta.join();
+        tb.join();
+        EXPECT_TRUE(holds(a, 1000)) << "round " << round;
+        EXPECT_TRUE(holds(b, 2000)) << "round " << round;
+    }
+}
+
 /***** branches test *****
  *************************/
 // AI-BEGIN: Tutor/teach test case
@@ -242,3 +477,1241 @@ TEST(CpuUType, AuipcBasic) {
     EXPECT_EQ(s.regs[2], 0x00002004u); // 0x0004 + 0x00002000
     EXPECT_EQ(s.regs[0], 0u);
 }
+
+/***** decode fields and immediates *****
+ ****************************************/
+TEST(CpuDecode, ImmediatesPerFormat) {
+    DecodedInstr addi = decode(0xfff00093u);      // addi x1,x0,-1
+    EXPECT_EQ(addi.format, InstrFormat::I);
+    EXPECT_EQ(addi.rd, 1u);
+    EXPECT_EQ(addi.imm, -1);
+
+    DecodedInstr sw = decode(0x0020a023u);        // sw x2,0(x1)
+    EXPECT_EQ(sw.format, InstrFormat::S);
+    EXPECT_EQ(sw.rs1, 1u);
+    EXPECT_EQ(sw.rs2, 2u);
+    EXPECT_EQ(sw.imm, 0);
+
+    DecodedInstr bne = decode(0x00209463u);       // bne x1,x2,+8
+    EXPECT_EQ(bne.format, InstrFormat::B);
+    EXPECT_EQ(bne.imm, 8);
+
+    DecodedInstr jal = decode(encode_jal(2, -8));
+    EXPECT_EQ(jal.format, InstrFormat::J);
+    EXPECT_EQ(jal.imm, -8);
+
+    DecodedInstr lui = decode(encode_lui(1, 0x000AB));
+    EXPECT_EQ(lui.format, InstrFormat::U);
+    EXPECT_EQ(static_cast<uint32_t>(lui.imm), 0x000AB000u);
+}
+
+/***** rd == x0 handlers *****
+ * Writes to x0 get their own handler at
+ * decode time; the instruction still does
+ * everything except the write (the load,
+ * the jump, the fcsr update).
+ *******************************/
+TEST(CpuDecode, RdZeroPicksItsOwnHandler) {
+    DecodedInstr add_x1 = decode(encode_r(0x00, 0x0, 1, 2, 3));
+    DecodedInstr add_x0 = decode(encode_r(0x00, 0x0, 0, 2, 3));
+    EXPECT_EQ(add_x1.kind, InstrKind::Add);
+    EXPECT_EQ(add_x0.kind, InstrKind::Add);
+    EXPECT_NE(add_x1.exec, add_x0.exec);
+
+    // stores have no rd, so the rd bits do not change the handler
+    EXPECT_EQ(decode(encode_s(0x2, 1, 2, 0)).exec, decode(encode_s(0x2, 1, 2, 4)).exec);
+
+    CpuState s(1024);
+    reset(s);
+    std::vector<uint32_t> program = {
+        encode_i(0x13, 0x0, 1, 0, 0x55),   // addi x1,x0,0x55
+        encode_i(0x13, 0x0, 0, 1, 1),      // addi x0,x1,1
+        encode_r(0x01, 0x0, 0, 1, 1),      // mul  x0,x1,x1
+        encode_i(0x03, 0x2, 0, 0, 0x40),   // lw   x0,0x40(x0)
+        encode_lui(0, 0x12345),            // lui  x0,0x12345
+        0x00105073u,                       // csrrwi x0,fflags,0
+        encode_jal(0, 8),                  // jal  x0,+8
+        encode_i(0x13, 0x0, 2, 0, 1),      // addi x2,x0,1 (skipped)
+        encode_i(0x13, 0x0, 3, 0, 2),      // addi x3,x0,2
+    };
+    load_program(s, program, 0);
+    s.fcsr = 0x1F;
+
+    RunResult r = run(s, 8);
+    EXPECT_EQ(r.steps, 8u);
+    EXPECT_EQ(s.regs[0], 0u);
+    EXPECT_EQ(s.regs[1], 0x55u);
+    EXPECT_EQ(s.regs[2], 0u);
+    EXPECT_EQ(s.regs[3], 2u);
+    EXPECT_EQ(s.fcsr, 0u); // csrrwi with rd == x0 still writes fflags
+    EXPECT_EQ(s.pc, 0x24u);
+}
+
+/***** store over cached code *****
+ * The sw rewrites the instruction at 0x08
+ * after it has already run once, so the
+ * second pass must see the new word.
+ **********************************/
+TEST(CpuDecode, StoreInvalidatesCachedInstr) {
+    CpuState s(1024);
+    reset(s);
+
+    std::vector<uint32_t> program = {
+        encode_lui(6, 0x00700),      // lui  x6,0x00700
+        0x19330313u,                 // addi x6,x6,0x193 (x6 = addi x3,x0,7)
+        0x00100193u,                 // addi x3,x0,1
+        0x00602423u,                 // sw   x6,8(x0)
+        encode_jal(0, -8)            // jal  x0,-8 (back to 0x08)
+    };
+
+    load_program(s, program, 0);
+    run(s, 5);
+
+    EXPECT_EQ(s.regs[3], 1u);
+    EXPECT_FALSE(s.mem.peek_decoded(0x08)->valid); // slot for 0x08 was dropped by sw
+
+    run(s, 1);
+    EXPECT_EQ(s.regs[3], 7u);
+    EXPECT_TRUE(s.mem.peek_decoded(0x08)->valid);
+    EXPECT_EQ(s.mem.peek_decoded(0x08)->raw, 0x00700193u);
+}
+
+/***** block engine vs interpreter *****
+ * Counted loop: x2 += 3, ten times.
+ * Both modes must end in the same state,
+ * also when the budget cuts a block short.
+ ****************************************/
+TEST(CpuBlocks, LoopMatchesInterpreter) {
+    std::vector<uint32_t> program = {
+        0x00a00093u,                    // addi x1,x0,10
+        0x00310113u,                    // addi x2,x2,3
+        0xfff08093u,                    // addi x1,x1,-1
+        encode_branch(0x1, 1, 0, -8),   // bne  x1,x0,-8
+        0x00100193u                     // addi x3,x0,1
+    };
+
+    for (std::size_t budget : {32u, 17u, 5u}) {
+        CpuState a(1024);
+        CpuState b(1024);
+        reset(a);
+        reset(b);
+        load_program(a, program, 0);
+        load_program(b, program, 0);
+
+        run(a, budget, ExecMode::Interpret);
+        run(b, budget, ExecMode::Blocks);
+
+        EXPECT_EQ(a.pc, b.pc) << "budget " << budget;
+        for (int r = 0; r < 32; ++r) {
+            EXPECT_EQ(a.regs[r], b.regs[r]) << "x" << r << " budget " << budget;
+        }
+    }
+
+    CpuState s(1024);
+    reset(s);
+    load_program(s, program, 0);
+    run(s, 32, ExecMode::Blocks);
+    EXPECT_EQ(s.regs[2], 30u);
+    EXPECT_EQ(s.regs[3], 1u);
+}
+
+/***** block engine and stores over code *****
+ **********************************************/
+TEST(CpuBlocks, StoreInvalidatesBlocks) {
+    CpuState s(1024);
+    reset(s);
+
+    std::vector<uint32_t> program = {
+        encode_lui(6, 0x00700),      // lui  x6,0x00700
+        0x19330313u,                 // addi x6,x6,0x193 (x6 = addi x3,x0,7)
+        0x00100193u,                 // addi x3,x0,1
+        0x00602423u,                 // sw   x6,8(x0)
+        encode_jal(0, -8)            // jal  x0,-8 (back to 0x08)
+    };
+
+    load_program(s, program, 0);
+    run(s, 6, ExecMode::Blocks);
+
+    EXPECT_EQ(s.regs[3], 7u);
+    EXPECT_EQ(s.pc, 0x0Cu);
+}
+
+/***** store into its own block *****
+ * A store that overwrites the next op of its block ends the block
+ * there: the new instruction runs and the step count matches the
+ * interpreter
+ ******************************/
+TEST(CpuBlocks, StoreEndsItsBlock) {
+    std::vector<uint32_t> program = {
+        encode_lui(6, 0x00700),      // lui  x6,0x00700
+        0x19330313u,                 // addi x6,x6,0x193 (x6 = addi x3,x0,7)
+        0x00602623u,                 // sw   x6,12(x0)
+        0x00100193u,                 // addi x3,x0,1 (overwritten)
+        0x00100073u                  // ebreak
+    };
+
+    CpuState interp(1024), blocks(1024);
+    for (CpuState* s : { &interp, &blocks }) {
+        reset(*s);
+        load_program(*s, program, 0);
+    }
+    RunResult ri = run(interp, 100, ExecMode::Interpret);
+    RunResult rb = run(blocks, 100, ExecMode::Blocks);
+
+    EXPECT_EQ(rb.reason, StopReason::Ebreak);
+    EXPECT_EQ(rb.steps, ri.steps);
+    EXPECT_EQ(blocks.regs[3], 7u);
+    EXPECT_EQ(blocks.pc, interp.pc);
+}
+
+/***** block cache between runs *****
+ * A second run reuses the blocks of the first, a fork starts
+ * without any, and new code drops them
+ ******************************/
+TEST(CpuBlocks, CacheSurvivesRuns) {
+    std::vector<uint32_t> program = {
+        0x00a00093u,                    // addi x1,x0,10
+        0x00310113u,                    // addi x2,x2,3
+        0xfff08093u,                    // addi x1,x1,-1
+        encode_branch(0x1, 1, 0, -8),   // bne  x1,x0,-8
+        0x00100073u                     // ebreak
+    };
+
+    CpuState s(1024);
+    reset(s);
+    load_program(s, program, 0);
+    run(s, 8, ExecMode::Blocks);
+    ASSERT_TRUE(s.blocks.cache);
+    const Block* loop = s.blocks.cache->blocks.at(4).get();
+
+    EXPECT_EQ(run(s, 1000, ExecMode::Blocks).reason, StopReason::Ebreak);
+    EXPECT_EQ(s.blocks.cache->blocks.at(4).get(), loop);
+    EXPECT_EQ(s.regs[2], 30u);
+
+    CpuState child = fork(s);
+    EXPECT_FALSE(child.blocks.cache);
+
+    program[1] = 0x00510113u;           // addi x2,x2,5
+    load_program(s, program, 0);
+    s.regs[2] = 0;
+    EXPECT_EQ(run(s, 1000, ExecMode::Blocks).reason, StopReason::Ebreak);
+    EXPECT_EQ(s.regs[2], 50u);
+    EXPECT_EQ(s.blocks.cache->blocks.at(4)->ops[0].raw, 0x00510113u);
+}
+
+/***** hoisted bounds checks *****
+ **********************************/
+TEST(CpuBlocks, HoistedBoundsChecks) {
+    std::vector<uint32_t> program = {
+        encode_i(0x03, 0x2, 2, 1, 0),   // lw   x2,0(x1)
+        encode_s(0x2, 1, 2, 8),         // sw   x2,8(x1)
+        0x00408093u,                    // addi x1,x1,4
+        encode_i(0x03, 0x2, 3, 1, 0),   // lw   x3,0(x1)   x1 changed, keeps its check
+        0x00100073u                     // ebreak
+    };
+
+    CpuState s(1024);
+    reset(s);
+    load_program(s, program, 0);
+    std::unique_ptr<Block> b = build_block(s, 0);
+    ASSERT_EQ(b->guards.size(), 1u);
+    EXPECT_EQ(b->guards[0].reg, 1u);
+    EXPECT_EQ(b->guards[0].lo, 0);
+    EXPECT_EQ(b->guards[0].hi, 12);
+    ASSERT_EQ(b->fast_ops.size(), b->ops.size());
+    EXPECT_NE(b->fast_ops[0].exec, b->ops[0].exec);
+    EXPECT_NE(b->fast_ops[1].exec, b->ops[1].exec);
+    EXPECT_EQ(b->fast_ops[3].exec, b->ops[3].exec);
+
+    // in range: the unchecked block body, same result as the interpreter
+    for (ExecMode mode : {ExecMode::Interpret, ExecMode::Blocks}) {
+        reset(s);
+        load_program(s, program, 0);
+        s.mem.store_u32(0x100, 0x11223344u);
+        s.regs[1] = 0x100;
+        RunResult r = run(s, 100, mode);
+        EXPECT_EQ(r.reason, StopReason::Ebreak);
+        EXPECT_EQ(s.mem.load_u32(0x108), 0x11223344u);
+        EXPECT_EQ(s.regs[3], 0u);
+    }
+
+    // guard fails, so each access checks itself and the SW faults
+    reset(s);
+    load_program(s, program, 0);
+    s.regs[1] = 1020;
+    RunResult r = run(s, 100, ExecMode::Blocks);
+    EXPECT_EQ(r.reason, StopReason::AccessFault);
+    EXPECT_EQ(r.steps, 1u);
+    EXPECT_EQ(s.fault_addr, 1028u);
+    EXPECT_EQ(s.pc, 0x04u);
+}
+
+/***** parallel batch runner *****
+ **********************************/
+TEST(CpuRunMany, MatchesSequentialRun) {
+    std::vector<uint32_t> program = {
+        0x00000093u,                    // addi x1,x0,0 (patched below)
+        0x00310113u,                    // addi x2,x2,3
+        0xfff08093u,                    // addi x1,x1,-1
+        encode_branch(0x1, 1, 0, -8),   // bne  x1,x0,-8
+        0x00100193u,                    // addi x3,x0,1
+        encode_jal(0, 0)                // jal  x0,0 (spin)
+    };
+
+    for (ExecMode mode : {ExecMode::Interpret, ExecMode::Blocks}) {
+        std::vector<CpuState> batch;
+        std::vector<CpuState> expect;
+        for (uint32_t i = 0; i < 24; ++i) {
+            program[0] = ((i * 5 + 1) << 20) | 0x00000093u; // addi x1,x0,5i+1
+            CpuState s(1024);
+            reset(s);
+            load_program(s, program, 0);
+            // every other CPU is a fork sharing its pages with the last one
+            batch.push_back(i % 2 ? fork(batch.back()) : s);
+            expect.push_back(batch.back());
+        }
+
+        RunManyOptions opts;
+        opts.max_steps = 200;
+        opts.quantum   = 7;
+        opts.mode      = mode;
+        opts.threads   = 3;
+        std::vector<RunManyResult> res = run_many(batch, opts);
+
+        ASSERT_EQ(res.size(), batch.size());
+        for (std::size_t i = 0; i < batch.size(); ++i) {
+            run(expect[i], 200, mode);
+            EXPECT_EQ(res[i].steps, 200u);
+            EXPECT_EQ(res[i].quanta, 29u); // ceil(200 / 7)
+            EXPECT_EQ(batch[i].pc, expect[i].pc) << "cpu " << i;
+            for (int r = 0; r < 32; ++r) {
+                EXPECT_EQ(batch[i].regs[r], expect[i].regs[r]) << "cpu " << i << " x" << r;
+            }
+        }
+    }
+}
+
+/***** one long task *****
+ * More workers than CPUs: the idle ones park until the batch ends,
+ * and the pool still runs the next batch
+ ******************************/
+TEST(CpuRunMany, IdleWorkersPark) {
+    std::vector<uint32_t> program = {
+        0x00110113u,                    // addi x2,x2,1
+        encode_jal(0, -4)               // jal  x0,-4
+    };
+
+    RunPool pool(4, 3);
+    for (int batch = 0; batch < 2; ++batch) {
+        CpuState s(1024);
+        reset(s);
+        load_program(s, program, 0);
+        RunTask task{ &s, 3000, ExecMode::Interpret };
+        std::vector<RunManyResult> r = pool.run(std::span<const RunTask>(&task, 1));
+        ASSERT_EQ(r.size(), 1u);
+        EXPECT_EQ(r[0].reason, StopReason::StepLimit);
+        EXPECT_EQ(r[0].steps, 3000u);
+        EXPECT_EQ(r[0].quanta, 1000u);
+        EXPECT_EQ(s.regs[2], 1500u);
+    }
+}
+
+/***** shared pool *****
+ * Batches from several threads take turns on one RunPool and each
+ * gets the results of its own tasks
+ ******************************/
+TEST(CpuRunMany, PoolSharedByThreads) {
+    std::vector<uint32_t> program = {
+        0x00000093u,                    // addi x1,x0,0 (patched below)
+        0x00310113u,                    // addi x2,x2,3
+        0xfff08093u,                    // addi x1,x1,-1
+        encode_branch(0x1, 1, 0, -8),   // bne  x1,x0,-8
+        0x00100073u                     // ebreak
+    };
+
+    RunPool pool(2, 5);
+    constexpr unsigned kClients = 4;
+    std::vector<std::vector<CpuState>> cpus(kClients);
+    std::vector<std::vector<RunManyResult>> got(kClients);
+    std::vector<std::thread> clients;
+    for (unsigned c = 0; c < kClients; ++c) {
+        for (uint32_t i = 0; i < 6; ++i) {
+            program[0] = ((c * 6 + i + 1) << 20) | 0x00000093u; // addi x1,x0,n
+            CpuState s(1024);
+            reset(s);
+            load_program(s, program, 0);
+            cpus[c].push_back(s);
+        }
+        clients.emplace_back([&, c] {
+            std::vector<RunTask> tasks;
+            for (CpuState& s : cpus[c]) tasks.push_back(RunTask{ &s, 1000, ExecMode::Blocks });
+            got[c] = pool.run(tasks);
+        });
+    }
+    for (std::thread& t : clients) t.join();
+
+    for (unsigned c = 0; c < kClients; ++c) {
+        ASSERT_EQ(got[c].size(), 6u);
+        for (uint32_t i = 0; i < 6; ++i) {
+            uint32_t n = c * 6 + i + 1;
+            EXPECT_EQ(got[c][i].reason, StopReason::Ebreak);
+            EXPECT_EQ(got[c][i].steps, 3 * n + 1);
+            EXPECT_EQ(cpus[c][i].regs[2], 3 * n);
+        }
+    }
+}
+
+/***** stop reasons *****
+ *************************/
+TEST(CpuStop, EcallAndIllegalStopEarly) {
+    std::vector<uint32_t> program = {
+        0x00500093u,                    // addi x1,x0,5
+        0x00000073u,                    // ecall
+        0x00900093u                     // addi x1,x0,9
+    };                                  // then zeros: illegal
+
+    for (ExecMode mode : {ExecMode::Interpret, ExecMode::Blocks}) {
+        CpuState s(1024);
+        reset(s);
+        load_program(s, program, 0);
+
+        RunResult r = run(s, 1000, mode);
+        EXPECT_EQ(r.reason, StopReason::Ecall);
+        EXPECT_EQ(r.steps, 1u);
+        EXPECT_EQ(s.pc, 0x04u);
+        EXPECT_EQ(s.regs[1], 5u);
+
+        s.pc += 4; // host handled the ecall
+        r = run(s, 1000, mode);
+        EXPECT_EQ(r.reason, StopReason::IllegalInstruction);
+        EXPECT_EQ(r.steps, 1u);
+        EXPECT_EQ(s.pc, 0x0Cu);
+        EXPECT_EQ(s.regs[1], 9u);
+
+        r = run(s, 0, mode);
+        EXPECT_EQ(r.reason, StopReason::StepLimit);
+        EXPECT_EQ(r.steps, 0u);
+    }
+}
+
+TEST(CpuStop, BadFetchAddress) {
+    for (ExecMode mode : {ExecMode::Interpret, ExecMode::Blocks}) {
+        CpuState s(64);
+        reset(s);
+        load_program(s, {0x00100093u, encode_jal(0, 60)}, 0); // jal to 0x40
+        RunResult r = run(s, 1000, mode);
+        EXPECT_EQ(r.reason, StopReason::PcOutOfRange);
+        EXPECT_EQ(r.steps, 2u);
+        EXPECT_EQ(s.pc, 0x40u);
+
+        reset(s);
+        load_program(s, {encode_jalr(1, 0, 6)}, 0);          // jalr to 0x06
+        r = run(s, 1000, mode);
+        EXPECT_EQ(r.reason, StopReason::MisalignedFetch);
+        EXPECT_EQ(r.steps, 1u);
+        EXPECT_EQ(s.pc, 0x06u);
+        EXPECT_EQ(s.regs[1], 4u);
+    }
+    EXPECT_STREQ(stop_reason_name(StopReason::Ebreak), "ebreak");
+}
+
+/***** loads/stores past the end of memory *****
+ ************************************************/
+TEST(CpuStop, AccessPastEndFaults) {
+    for (ExecMode mode : {ExecMode::Interpret, ExecMode::Blocks}) {
+        CpuState s(64);
+        reset(s);
+        load_program(s, {
+            0x03c00093u,                      // addi x1,x0,60
+            encode_i(0x03, 0x2, 2, 1, 0),     // lw   x2,0(x1)  bytes 60..63
+            encode_i(0x03, 0x2, 3, 1, 2),     // lw   x3,2(x1)  bytes 62..65
+        }, 0);
+        s.regs[3] = 0xABCDu;
+        RunResult r = run(s, 1000, mode);
+        EXPECT_EQ(r.reason, StopReason::AccessFault);
+        EXPECT_EQ(r.steps, 2u);
+        EXPECT_EQ(s.pc, 0x08u);
+        EXPECT_EQ(s.fault_addr, 62u);
+        EXPECT_EQ(s.regs[3], 0xABCDu);
+
+        reset(s);
+        load_program(s, {
+            0x03c00093u,                      // addi x1,x0,60
+            encode_s(0x1, 1, 1, 3),           // sh   x1,3(x1)  bytes 63..64
+        }, 0);
+        r = run(s, 1000, mode);
+        EXPECT_EQ(r.reason, StopReason::AccessFault);
+        EXPECT_EQ(r.steps, 1u);
+        EXPECT_EQ(s.fault_addr, 63u);
+        EXPECT_EQ(s.mem.read8(63), 0u);
+    }
+    EXPECT_STREQ(stop_reason_name(StopReason::AccessFault), "access-fault");
+}
+
+/***** rest of RV32I *****
+ **************************/
+TEST(CpuRv32i, CompareAndBranches) {
+    std::vector<uint32_t> program = {
+        encode_i(0x13, 0x0, 1, 0, -5),          // addi  x1,x0,-5
+        encode_i(0x13, 0x0, 2, 0, 3),           // addi  x2,x0,3
+        encode_r(0x00, 0x2, 3, 1, 2),           // slt   x3,x1,x2   -> 1
+        encode_r(0x00, 0x3, 4, 1, 2),           // sltu  x4,x1,x2   -> 0
+        encode_i(0x13, 0x2, 5, 1, -4),          // slti  x5,x1,-4   -> 1
+        encode_i(0x13, 0x3, 6, 2, -1),          // sltiu x6,x2,-1   -> 1
+        encode_branch(0x4, 1, 2, 8),            // blt   x1,x2,+8   taken
+        encode_i(0x13, 0x0, 10, 0, 1),          // addi  x10,x0,1   skipped
+        encode_branch(0x5, 1, 2, 8),            // bge   x1,x2,+8   not taken
+        encode_i(0x13, 0x4, 11, 11, 1),         // xori  x11,x11,1  runs
+        encode_branch(0x6, 1, 2, 8),            // bltu  x1,x2,+8   not taken
+        encode_i(0x13, 0x4, 12, 12, 1),         // xori  x12,x12,1  runs
+        encode_branch(0x7, 1, 2, 8),            // bgeu  x1,x2,+8   taken
+        encode_i(0x13, 0x0, 13, 0, 1),          // addi  x13,x0,1   skipped
+        0x00100073u                             // ebreak
+    };
+
+    for (ExecMode mode : {ExecMode::Interpret, ExecMode::Blocks}) {
+        CpuState s(1024);
+        reset(s);
+        load_program(s, program, 0);
+        RunResult r = run(s, 100, mode);
+
+        EXPECT_EQ(r.reason, StopReason::Ebreak);
+        EXPECT_EQ(r.steps, 12u);
+        EXPECT_EQ(s.regs[3], 1u);
+        EXPECT_EQ(s.regs[4], 0u);
+        EXPECT_EQ(s.regs[5], 1u);
+        EXPECT_EQ(s.regs[6], 1u);
+        EXPECT_EQ(s.regs[10], 0u);
+        EXPECT_EQ(s.regs[11], 1u);
+        EXPECT_EQ(s.regs[12], 1u);
+        EXPECT_EQ(s.regs[13], 0u);
+    }
+}
+
+TEST(CpuRv32i, ByteAndHalfAccess) {
+    CpuState s(1024);
+    reset(s);
+
+    std::vector<uint32_t> program = {
+        encode_i(0x13, 0x0, 1, 0, 0x100),       // addi x1,x0,0x100
+        encode_i(0x13, 0x0, 2, 0, -127),        // addi x2,x0,-127 (0x...81)
+        encode_s(0x0, 1, 2, 0),                 // sb   x2,0(x1)
+        encode_s(0x1, 1, 2, 2),                 // sh   x2,2(x1)
+        encode_i(0x03, 0x0, 3, 1, 0),           // lb   x3,0(x1)
+        encode_i(0x03, 0x4, 4, 1, 0),           // lbu  x4,0(x1)
+        encode_i(0x03, 0x1, 5, 1, 2),           // lh   x5,2(x1)
+        encode_i(0x03, 0x5, 6, 1, 2),           // lhu  x6,2(x1)
+        encode_i(0x03, 0x2, 7, 1, 0)            // lw   x7,0(x1)
+    };
+    load_program(s, program, 0);
+    RunResult r = run(s, program.size());
+
+    EXPECT_EQ(r.reason, StopReason::StepLimit);
+    EXPECT_EQ(s.regs[3], 0xFFFFFF81u);
+    EXPECT_EQ(s.regs[4], 0x81u);
+    EXPECT_EQ(s.regs[5], 0xFFFFFF81u);
+    EXPECT_EQ(s.regs[6], 0xFF81u);
+    EXPECT_EQ(s.regs[7], 0xFF810081u);
+}
+
+/***** M extension *****
+ ************************/
+TEST(CpuMExt, MatchesWordMdu) {
+    using namespace rv::core;
+    const uint32_t vals[] = {0u, 1u, 7u, 0xFFFFFFFFu, 0x80000000u, 0x7FFFFFFFu, 0x12345678u, 0xFFFFFFF9u};
+
+    for (uint32_t funct3 = 0; funct3 < 8; ++funct3) {
+        for (uint32_t a : vals) {
+            for (uint32_t b : vals) {
+                CpuState s(64);
+                reset(s);
+                s.regs[1] = a;
+                s.regs[2] = b;
+                load_program(s, {encode_r(0x01, funct3, 3, 1, 2)}, 0);
+                ASSERT_EQ(step(s), StopReason::None);
+
+                uint32_t want;
+                switch (funct3) {
+                    case 0:  want = mdu_mul_u32(MulOp::Mul, a, b).lo; break;
+                    case 1:  want = mdu_mul_u32(MulOp::Mulh, a, b).hi; break;
+                    case 2:  want = mdu_mul_u32(MulOp::Mulhsu, a, b).hi; break;
+                    case 3:  want = mdu_mul_u32(MulOp::Mulhu, a, b).hi; break;
+                    case 4:  want = mdu_div_u32(DivOp::Div, a, b).q; break;
+                    case 5:  want = mdu_div_u32(DivOp::Divu, a, b).q; break;
+                    case 6:  want = mdu_div_u32(DivOp::Rem, a, b).r; break;
+                    default: want = mdu_div_u32(DivOp::Remu, a, b).r; break;
+                }
+                EXPECT_EQ(s.regs[3], want) << "funct3 " << funct3 << " a " << a << " b " << b;
+            }
+        }
+    }
+
+    // spot checks of the RISC-V special cases
+    CpuState s(64);
+    reset(s);
+    s.regs[1] = 0x80000000u;
+    s.regs[2] = 0xFFFFFFFFu;
+    load_program(s, {encode_r(0x01, 0x4, 3, 1, 2),      // div  x3,x1,x2
+                     encode_r(0x01, 0x7, 4, 1, 0),      // remu x4,x1,x0
+                     encode_r(0x01, 0x3, 5, 2, 2)}, 0); // mulhu x5,x2,x2
+    run(s, 3);
+    EXPECT_EQ(s.regs[3], 0x80000000u);
+    EXPECT_EQ(s.regs[4], 0x80000000u);
+    EXPECT_EQ(s.regs[5], 0xFFFFFFFEu);
+}
+
+/***** F extension *****
+ ************************/
+TEST(CpuFExt, ArithmeticUsesWordKernels) {
+    using namespace rv::core;
+    const uint32_t a = 0x3FC00000u; // 1.5f
+    const uint32_t b = 0xC0100000u; // -2.25f
+
+    CpuState s(1024);
+    reset(s);
+    s.regs[1] = a;
+    s.regs[2] = b;
+    std::vector<uint32_t> program = {
+        encode_fp(0x78, 0x0, 1, 1, 0),          // fmv.w.x  f1,x1
+        encode_fp(0x78, 0x0, 2, 2, 0),          // fmv.w.x  f2,x2
+        encode_fp(0x00, 0x7, 3, 1, 2),          // fadd.s   f3,f1,f2
+        encode_fp(0x04, 0x7, 4, 1, 2),          // fsub.s   f4,f1,f2
+        encode_fp(0x08, 0x7, 5, 1, 2),          // fmul.s   f5,f1,f2
+        encode_fp(0x10, 0x1, 6, 2, 2),          // fneg.s   f6,f2
+        encode_fp(0x10, 0x2, 7, 2, 2),          // fabs.s   f7,f2
+        encode_fp(0x70, 0x0, 10, 3, 0),         // fmv.x.w  x10,f3
+        (encode_s(0x2, 0, 5, 0x100) & ~0x7Fu) | 0x27, // fsw f5,0x100(x0)
+        encode_i(0x07, 0x2, 8, 0, 0x100),       // flw      f8,0x100(x0)
+        encode_i(0x03, 0x2, 11, 0, 0x100)       // lw       x11,0x100(x0)
+    };
+    load_program(s, program, 0);
+    RunResult r = run(s, program.size());
+
+    EXPECT_EQ(r.reason, StopReason::StepLimit);
+    EXPECT_EQ(s.fregs[3], fadd_f32_u32(a, b).bits);
+    EXPECT_EQ(s.fregs[4], fsub_f32_u32(a, b).bits);
+    EXPECT_EQ(s.fregs[5], fmul_f32_u32(a, b).bits);
+    EXPECT_EQ(s.fregs[3], 0xBF400000u);         // -0.75f
+    EXPECT_EQ(s.fregs[6], 0x40100000u);
+    EXPECT_EQ(s.fregs[7], 0x40100000u);
+    EXPECT_EQ(s.regs[10], s.fregs[3]);
+    EXPECT_EQ(s.fregs[8], s.fregs[5]);
+    EXPECT_EQ(s.regs[11], s.fregs[5]);
+    EXPECT_EQ(s.fcsr, 0u);
+}
+
+TEST(CpuFExt, FlagsAccrueInFcsr) {
+    CpuState s(1024);
+    reset(s);
+    s.fregs[1] = 0x7F000000u; // 2^127
+    std::vector<uint32_t> program = {
+        encode_fp(0x08, 0x7, 2, 1, 1),          // fmul.s  f2,f1,f1 (overflow)
+        encode_i(0x73, 0x2, 5, 0, 0x001),       // frflags x5
+        encode_i(0x73, 0x5, 0, 2, 0x002),       // fsrmi   2 (frm = RDN)
+        encode_i(0x73, 0x2, 6, 0, 0x003),       // frcsr   x6
+        encode_i(0x73, 0x1, 7, 0, 0x001),       // fsflags x7,x0 (clear)
+        encode_fp(0x00, 0x5, 3, 1, 1)           // fadd.s with rm=5: illegal
+    };
+    load_program(s, program, 0);
+    RunResult r = run(s, 100);
+    ASSERT_EQ(s.fregs[2], rv::core::fmul_f32_u32(0x7F000000u, 0x7F000000u).bits);
+
+    EXPECT_EQ(r.reason, StopReason::IllegalInstruction);
+    EXPECT_EQ(r.steps, 5u);
+    EXPECT_EQ(s.regs[5], kFflagOF);
+    EXPECT_EQ(s.regs[6], (2u << kFrmShift) | kFflagOF);
+    EXPECT_EQ(s.regs[7], kFflagOF);
+    EXPECT_EQ(s.fcsr, 2u << kFrmShift);
+}
+
+/***** ELF / binary loader *****
+ ********************************/
+TEST(CpuLoader, ElfMapsWholePagesAndCopiesTails) {
+    // text: one full page of addi x2,x2,1 and an ebreak at 0x2000
+    // data: one word at 0x3008 (file offset 0x2008)
+    std::vector<uint8_t> f(0x200C, 0);
+    f[0] = 0x7f; f[1] = 'E'; f[2] = 'L'; f[3] = 'F';
+    f[4] = 1; f[5] = 1; f[6] = 1;               // ELF32, little endian
+    put16(f, 16, 2);                            // ET_EXEC
+    put16(f, 18, 243);                          // EM_RISCV
+    put32(f, 24, 0x1000);                       // e_entry
+    put32(f, 28, 52);                           // e_phoff
+    put16(f, 42, 32);                           // e_phentsize
+    put16(f, 44, 2);                            // e_phnum
+
+    const uint32_t segs[2][5] = {
+        // offset, vaddr, filesz, memsz, flags
+        {0x1000, 0x1000, 0x1004, 0x1004, 5},    // R X
+        {0x2008, 0x3008, 4,      0x10,   6},    // R W
+    };
+    for (int i = 0; i < 2; ++i) {
+        std::size_t ph = 52 + 32 * i;
+        put32(f, ph, 1);                        // PT_LOAD
+        put32(f, ph + 4, segs[i][0]);
+        put32(f, ph + 8, segs[i][1]);
+        put32(f, ph + 12, segs[i][1]);
+        put32(f, ph + 16, segs[i][2]);
+        put32(f, ph + 20, segs[i][3]);
+        put32(f, ph + 24, segs[i][4]);
+    }
+    for (uint32_t a = 0x1000; a < 0x2000; a += 4) put32(f, a, 0x00110113u);
+    put32(f, 0x2000, 0x00100073u);              // ebreak
+    put32(f, 0x2008, 0xCAFEBABEu);
+    std::string path = write_temp("rv_loader_test.elf", f);
+
+    CpuState s(0x4000);
+    reset(s);
+    LoadedImage img = load_elf(s, path);
+    EXPECT_EQ(img.entry, 0x1000u);
+    EXPECT_EQ(s.pc, 0x1000u);
+    EXPECT_EQ(img.bytes_mapped, 0x1000u);
+    EXPECT_EQ(img.bytes_copied, 8u);
+    EXPECT_EQ(s.mem.pages_shared(), 1u);
+    EXPECT_EQ(s.mem.load_u32(0x3008), 0xCAFEBABEu);
+
+    RunResult r = run(s, 5000, ExecMode::Blocks);
+    EXPECT_EQ(r.reason, StopReason::Ebreak);
+    EXPECT_EQ(r.steps, 1024u);
+    EXPECT_EQ(s.regs[2], 1024u);
+
+    // a guest write copies the mapped page, the file stays the same
+    s.mem.store_u32(0x1000, 0x12345678u);
+    EXPECT_EQ(s.mem.load_u32(0x1000), 0x12345678u);
+    EXPECT_EQ(s.mem.pages_shared(), 0u);
+    std::ifstream in(path, std::ios::binary);
+    in.seekg(0x1000);
+    uint8_t back[4];
+    in.read(reinterpret_cast<char*>(back), 4);
+    EXPECT_EQ(back[0], 0x13u);
+
+    // loading again into the used CPU zeroes .bss (0x300C..0x3018)
+    // and drops code that was decoded there
+    s.mem.store_u32(0x3010, 0xDEADBEEFu);
+    s.mem.store_u32(0x3014, 0x00100073u);
+    fetch_decoded(s, 0x3014);
+    CpuState child = fork(s);
+    load_elf(child, path);
+    EXPECT_EQ(child.mem.load_u32(0x3008), 0xCAFEBABEu);
+    EXPECT_EQ(child.mem.load_u32(0x3010), 0u);
+    EXPECT_EQ(child.mem.load_u32(0x3014), 0u);
+    EXPECT_EQ(s.mem.load_u32(0x3010), 0xDEADBEEFu);   // the parent keeps its bytes
+    uint64_t epoch = s.code_epoch;
+    load_elf(s, path);
+    EXPECT_EQ(s.mem.load_u32(0x3014), 0u);
+    EXPECT_FALSE(s.mem.peek_decoded(0x3014)->valid);
+    EXPECT_GT(s.code_epoch, epoch);
+
+    f[18] = 62; // EM_X86_64
+    path = write_temp("rv_loader_test_bad.elf", f);
+    EXPECT_THROW(load_elf(s, path), std::runtime_error);
+    EXPECT_THROW(load_elf(s, path + ".missing"), std::runtime_error);
+}
+
+TEST(CpuLoader, FlatBinary) {
+    std::vector<uint8_t> f(0x1008, 0);
+    for (uint32_t a = 0; a < 0x1000; a += 4) put32(f, a, 0x00110113u); // addi x2,x2,1
+    put32(f, 0x1000, 0x00000073u);                                    // ecall
+    std::string path = write_temp("rv_loader_test.bin", f);
+
+    CpuState s(0x4000);
+    reset(s);
+    LoadedImage img = load_binary(s, path, 0x2004);
+    EXPECT_EQ(s.pc, 0x2004u);
+    EXPECT_EQ(img.bytes_mapped, 0u);            // not page-aligned: copied
+    EXPECT_EQ(img.bytes_copied, 0x1008u);
+    EXPECT_THROW(load_binary(s, path, 0x3000), std::runtime_error);
+
+    reset(s);
+    img = load_binary(s, path, 0x1000);
+    EXPECT_EQ(img.bytes_mapped, 0x1000u);
+    EXPECT_EQ(img.bytes_copied, 8u);
+    RunResult r = run(s, 5000);
+    EXPECT_EQ(r.reason, StopReason::Ecall);
+    EXPECT_EQ(s.regs[2], 1024u);
+}
+
+/***** binary CPU trace *****
+ *****************************/
+TEST(CpuTrace, RecordsEveryRetiredInstruction) {
+    std::vector<uint32_t> program = {
+        encode_i(0x13, 0x0, 1, 0, 0x100),       // addi x1,x0,0x100
+        encode_i(0x13, 0x0, 2, 0, 50),          // addi x2,x0,50
+        encode_s(0x2, 1, 2, 4),                 // sw   x2,4(x1)
+        encode_i(0x03, 0x2, 1, 1, 4),           // lw   x1,4(x1)  (rd == rs1)
+        encode_i(0x13, 0x0, 2, 2, -1),          // addi x2,x2,-1
+        encode_branch(0x1, 2, 0, -4),           // bne  x2,x0,-4
+        encode_i(0x07, 0x2, 3, 0, 0x104),       // flw  f3,0x104(x0)
+        0x00000073u                             // ecall
+    };
+    std::string path = (std::filesystem::temp_directory_path() / "rv_trace_test.bin").string();
+
+    CpuState ref(1024);
+    reset(ref);
+    load_program(ref, program, 0);
+    RunResult want = run(ref, 1000);
+
+    CpuState s(1024);
+    reset(s);
+    load_program(s, program, 0);
+    TraceOptions opts;
+    opts.ring_records  = 8;  // small ring: the CPU has to wait for the writer
+    opts.block_records = 5;
+    RunResult got;
+    {
+        TraceWriter out(path, opts);
+        got = run_traced(s, 1000, out);
+        EXPECT_EQ(out.records(), got.steps);
+        EXPECT_TRUE(out.close());
+    }
+    EXPECT_EQ(got.reason, want.reason);
+    EXPECT_EQ(got.steps, want.steps);
+    EXPECT_EQ(s.pc, ref.pc);
+    EXPECT_EQ(0, std::memcmp(s.regs, ref.regs, sizeof s.regs));
+    EXPECT_EQ(s.fregs[3], 50u);
+
+    TraceReader in(path);
+    std::vector<TraceRecord> recs;
+    TraceRecord r;
+    while (in.next(r)) recs.push_back(r);
+    ASSERT_EQ(recs.size(), got.steps);
+
+    EXPECT_EQ(recs[2].pc, 0x08u);                 // sw
+    EXPECT_EQ(recs[2].addr, 0x104u);
+    EXPECT_EQ(recs[3].addr, 0x104u);              // lw: address from the old x1
+    EXPECT_EQ(recs[3].value, 50u);
+    EXPECT_EQ(recs.back().raw, program[6]);       // flw, ecall didn't retire
+    EXPECT_EQ(recs.back().value, 50u);
+    EXPECT_EQ(trace_dest(recs.back().raw), TraceDest::F);
+    EXPECT_EQ(recs.size(), 4u + 2u * 50u + 1u);
+
+    EXPECT_EQ(format_trace_record(recs[3]), "0000000c: 0040a083  x1  = 0x00000032  [0x00000104]");
+    EXPECT_EQ(format_trace_record(recs[2]), "00000008: 0020a223  [0x00000104]");
+}
+
+TEST(CpuTrace, CompressedBlocks) {
+    std::string path = (std::filesystem::temp_directory_path() / "rv_trace_test.zst").string();
+    TraceOptions opts;
+    opts.codec = TraceCodec::Zstd;
+#ifdef RV_TRACE_ZSTD
+    CpuState s(1024);
+    reset(s);
+    load_program(s, {encode_i(0x13, 0x0, 1, 1, 1), encode_jal(0, -4)}, 0);
+    {
+        TraceWriter out(path, opts);
+        run_traced(s, 10000, out);
+    }
+    TraceReader in(path);
+    EXPECT_EQ(in.codec(), TraceCodec::Zstd);
+    EXPECT_LT(std::filesystem::file_size(path), 10000u * sizeof(TraceRecord) / 10);
+    TraceRecord r;
+    std::size_t n = 0;
+    while (in.next(r)) ++n;
+    EXPECT_EQ(n, 10000u);
+    EXPECT_EQ(r.pc, 0x04u);
+#else
+    EXPECT_THROW(TraceWriter(path, opts), std::runtime_error);
+#endif
+}
+
+/***** corrupt trace blocks *****
+ * A block header with an absurd record count or a payload size that
+ * does not match it is rejected before anything is allocated for it
+ ******************************/
+TEST(CpuTrace, CorruptBlockHeaders) {
+    std::string path = (std::filesystem::temp_directory_path() / "rv_trace_bad.bin").string();
+    {
+        TraceWriter out(path);
+        EXPECT_TRUE(out.close());
+    }
+    std::vector<uint8_t> header(16);
+    {
+        std::ifstream f(path, std::ios::binary);
+        f.read(reinterpret_cast<char*>(header.data()), 16);
+    }
+
+    auto write_block = [&](uint32_t n, uint32_t bytes) {
+        std::vector<uint8_t> file = header;
+        file.resize(24);
+        put32(file, 16, n);
+        put32(file, 20, bytes);
+        std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(file.data()),
+                                                    static_cast<std::streamsize>(file.size()));
+    };
+    TraceRecord r;
+
+    write_block(0xFFFFFFFFu, 0xFFFFFFF0u);      // ~64 GiB of records
+    EXPECT_THROW(TraceReader(path).next(r), std::runtime_error);
+    write_block(4, 0xFFFFFFF0u);                // payload does not match the count
+    EXPECT_THROW(TraceReader(path).next(r), std::runtime_error);
+    write_block(0, 0);                          // an empty block is fine
+    EXPECT_FALSE(TraceReader(path).next(r));
+    std::filesystem::remove(path);
+}
+
+/***** profiler *****
+ *********************/
+TEST(CpuProfile, CountsMixBranchesAndStacks) {
+    std::vector<uint32_t> program = {
+        encode_i(0x13, 0x0, 10, 0, 3),          // 0x00 addi x10,x0,3
+        encode_jal(1, 16),                      // 0x04 jal  ra,f (0x14)
+        encode_i(0x13, 0x0, 10, 10, -1),        // 0x08 addi x10,x10,-1
+        encode_branch(0x1, 10, 0, -8),          // 0x0c bne  x10,x0,-8
+        0x00100073u,                            // 0x10 ebreak
+        encode_i(0x03, 0x2, 5, 0, 0x100),       // 0x14 f: lw x5,0x100(x0)
+        encode_s(0x2, 0, 5, 0x104),             // 0x18 sw   x5,0x104(x0)
+        encode_jalr(0, 1, 0)                    // 0x1c ret
+    };
+
+    CpuState ref(1024);
+    reset(ref);
+    load_program(ref, program, 0);
+    RunResult want = run(ref, 1000);
+
+    CpuState s(1024);
+    reset(s);
+    load_program(s, program, 0);
+    Profile prof;
+    ProfileProbe probe(prof, s.pc);
+    RunResult got = run_with(s, 1000, probe);
+
+    EXPECT_EQ(got.reason, want.reason);
+    EXPECT_EQ(got.steps, 19u);
+    EXPECT_EQ(s.pc, ref.pc);
+    EXPECT_EQ(prof.retired, 19u);
+    EXPECT_EQ(prof.count(InstrKind::Addi), 4u);
+    EXPECT_EQ(prof.count(InstrKind::Jalr), 3u);
+    EXPECT_EQ(prof.branches, 3u);
+    EXPECT_EQ(prof.taken, 2u);
+    EXPECT_EQ(prof.loads, 3u);
+    EXPECT_EQ(prof.stores, 3u);
+    EXPECT_EQ(prof.calls, 3u);
+    EXPECT_EQ(prof.returns, 3u);
+    EXPECT_EQ(prof.cycles, 38u);            // default CycleModel
+    EXPECT_EQ(prof.pc_count(0x00), 1u);
+    EXPECT_EQ(prof.pc_count(0x14), 3u);
+    EXPECT_EQ(prof.pc_count(0x10), 0u);     // ebreak did not retire
+
+    std::vector<PcCount> hot = prof.hot_pcs(2);
+    ASSERT_EQ(hot.size(), 2u);
+    EXPECT_EQ(hot[0].pc, 0x04u);
+    EXPECT_EQ(hot[0].count, 3u);
+
+    EXPECT_EQ(profile_to_folded(prof), "0x00000000 10\n0x00000000;0x00000014 9\n");
+    EXPECT_EQ(profile_to_folded(prof, [](uint32_t pc) { return pc ? std::string("f") : std::string("main"); }),
+              "main 10\nmain;f 9\n");
+
+    std::string json = profile_to_json(prof, 1);
+    EXPECT_NE(json.find("\"retired\": 19,"), std::string::npos);
+    EXPECT_NE(json.find("\"cpi\": 2.000,"), std::string::npos);
+    EXPECT_NE(json.find("\"jalr\": 3"), std::string::npos);
+    EXPECT_NE(json.find("{\"pc\": \"0x00000004\", \"count\": 3}"), std::string::npos);
+}
+
+/***** decode cache file *****
+ * Cold run, save, then a fresh CPU starts with every slot filled;
+ * a changed word or a damaged file is a miss
+ ******************************/
+TEST(CpuDecodeCache, WarmStartAndStaleFiles) {
+    std::vector<uint32_t> program = {
+        0x00a00093u,                    // addi x1,x0,10
+        0x00310113u,                    // addi x2,x2,3
+        0xfff08093u,                    // addi x1,x1,-1
+        encode_branch(0x1, 1, 0, -8),   // bne  x1,x0,-8
+        0x00100073u                     // ebreak
+    };
+    const uint32_t text_size = static_cast<uint32_t>(program.size() * 4);
+
+    CpuState cold(4096);
+    reset(cold);
+    load_program(cold, program, 0x100);
+    RunResult r = run(cold, 1000);
+    ASSERT_EQ(r.reason, StopReason::Ebreak);
+
+    std::string path = decode_cache_path(std::filesystem::temp_directory_path().string(),
+                                         text_hash(cold.mem, 0x100, text_size));
+    EXPECT_EQ(save_decode_cache(cold, 0x100, text_size, path), program.size());
+
+    CpuState warm(4096);
+    reset(warm);
+    for (std::size_t i = 0; i < program.size(); ++i) {
+        warm.mem.store_u32(0x100 + 4 * uint32_t(i), program[i]); // no decode on the way in
+    }
+    warm.pc = 0x100;
+    ASSERT_EQ(warm.mem.peek_decoded(0x100), nullptr);
+
+    DecodeCacheLoad got = load_decode_cache(warm, 0x100, text_size, path);
+    EXPECT_TRUE(got.hit);
+    EXPECT_EQ(got.words, program.size());
+    for (uint32_t pc = 0x100; pc < 0x100 + text_size; pc += 4) {
+        const DecodedInstr* d = warm.mem.peek_decoded(pc);
+        ASSERT_NE(d, nullptr);
+        EXPECT_TRUE(d->valid);
+        EXPECT_EQ(d->exec, decode(d->raw).exec);
+    }
+    EXPECT_EQ(run(warm, 1000).steps, r.steps);
+    EXPECT_EQ(warm.regs[2], cold.regs[2]);
+
+    // one changed word: the whole file is stale
+    CpuState changed(4096);
+    reset(changed);
+    load_program(changed, program, 0x100);
+    changed.mem.store_u32(0x104, 0x00510113u); // addi x2,x2,5
+    invalidate_icache(changed);
+    EXPECT_FALSE(load_decode_cache(changed, 0x100, text_size, path).hit);
+    const DecodedInstr* slot = changed.mem.peek_decoded(0x104);
+    EXPECT_TRUE(slot == nullptr || !slot->valid);
+
+    // two threads saving the same file each use their own temporary
+    std::thread other([&] { save_decode_cache(cold, 0x100, text_size, path); });
+    save_decode_cache(cold, 0x100, text_size, path);
+    other.join();
+    EXPECT_TRUE(load_decode_cache(warm, 0x100, text_size, path).hit);
+
+    // wrong range, another build's instruction table, damaged records,
+    // missing file
+    EXPECT_FALSE(load_decode_cache(warm, 0x104, text_size - 4, path).hit);
+    auto damage = [&](std::streamoff at) {
+        std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+        f.seekg(at);
+        char c = static_cast<char>(f.get());
+        f.seekp(at);
+        f.put(static_cast<char>(c ^ 0x55));
+    };
+    damage(40);
+    EXPECT_FALSE(load_decode_cache(warm, 0x100, text_size, path).hit);
+    damage(40);
+    EXPECT_TRUE(load_decode_cache(warm, 0x100, text_size, path).hit);
+    damage(48 + 4);
+    EXPECT_FALSE(load_decode_cache(warm, 0x100, text_size, path).hit);
+    std::filesystem::remove(path);
+    EXPECT_FALSE(load_decode_cache(warm, 0x100, text_size, path).hit);
+}
+
+/***** job server *****
+ * Three job frames through a pipe (one too big for its memory, one on
+ * the block engine); the results come back in order and match run_job
+ ******************************/
+TEST(CpuJobServer, PipeJobsMatchRunJob) {
+    auto program_bytes = [](const std::vector<uint32_t>& words) {
+        std::vector<uint8_t> b(words.size() * 4);
+        for (std::size_t i = 0; i < words.size(); ++i) put32(b, 4 * i, words[i]);
+        return b;
+    };
+
+    Job loop{};
+    loop.id = 7;
+    loop.mem_size = 4096;
+    loop.base = 0x200;
+    loop.entry = 0x200;
+    loop.max_steps = 1000;
+    loop.mode = ExecMode::Interpret;
+    loop.regs[0] = 99;  // ignored, x0 stays 0
+    loop.regs[1] = 10;
+    loop.fregs[5] = 0x3fc00000u;        // 1.5f, travels both ways untouched
+    loop.fcsr = 0x41u;                  // frm = 2, NX set
+    loop.image = program_bytes({
+        0x00310113u,                    // addi x2,x2,3
+        0xfff08093u,                    // addi x1,x1,-1
+        encode_branch(0x1, 1, 0, -8),   // bne  x1,x0,-8
+        0x00100073u                     // ebreak
+    });
+
+    Job blocks = loop;
+    blocks.id = 8;
+    blocks.mode = ExecMode::Blocks;
+    blocks.max_steps = 5;
+
+    Job too_big = loop;
+    too_big.id = 9;
+    too_big.mem_size = 0x100;
+
+    Job round = decode_job(encode_job(blocks));
+    EXPECT_EQ(round.id, 8u);
+    EXPECT_EQ(round.mode, ExecMode::Blocks);
+    EXPECT_EQ(round.image, blocks.image);
+    EXPECT_EQ(round.fregs[5], 0x3fc00000u);
+    EXPECT_EQ(round.fcsr, 0x41u);
+    EXPECT_THROW(decode_job(std::vector<uint8_t>(10)), std::runtime_error);
+    std::vector<uint8_t> old_format = encode_job(blocks);
+    old_format[0] = kJobFormatVersion - 1;
+    EXPECT_THROW(decode_job(old_format), std::runtime_error);
+
+    int in[2], out[2];
+    ASSERT_EQ(pipe(in), 0);
+    ASSERT_EQ(pipe(out), 0);
+    for (const Job* j : {&loop, &blocks, &too_big}) write_frame(in[1], encode_job(*j));
+    close(in[1]);
+
+    JobServerOptions opts;
+    opts.batch = 2;
+    opts.queue = 1;     // the reader waits for each batch to take its job
+    opts.threads = 2;
+    EXPECT_EQ(serve_jobs(in[0], out[1], opts), 3u);
+    close(in[0]);
+    close(out[1]);
+
+    std::vector<uint8_t> payload;
+    for (const Job* j : {&loop, &blocks, &too_big}) {
+        ASSERT_TRUE(read_frame(out[0], payload));
+        JobResult got = decode_result(payload);
+        JobResult want = run_job(*j);
+        EXPECT_EQ(got.id, j->id);
+        EXPECT_EQ(got.ok, want.ok);
+        EXPECT_EQ(got.reason, want.reason);
+        EXPECT_EQ(got.steps, want.steps);
+        EXPECT_EQ(got.pc, want.pc);
+        EXPECT_EQ(std::memcmp(got.regs, want.regs, sizeof got.regs), 0);
+        EXPECT_EQ(std::memcmp(got.fregs, want.fregs, sizeof got.fregs), 0);
+        EXPECT_EQ(got.fcsr, want.fcsr);
+    }
+    EXPECT_FALSE(read_frame(out[0], payload));
+    close(out[0]);
+
+    // a failed write ends serve_jobs even though the client is still
+    // connected and the reader is blocked waiting for its next frame
+    int idle[2];
+    ASSERT_EQ(pipe(idle), 0);
+    write_frame(idle[1], encode_job(loop));
+    EXPECT_THROW(serve_jobs(idle[0], -1, opts), std::runtime_error);
+    close(idle[0]);
+    close(idle[1]);
+
+    JobResult r = run_job(loop);
+    EXPECT_EQ(r.reason, StopReason::Ebreak);
+    EXPECT_EQ(r.regs[0], 0u);
+    EXPECT_EQ(r.regs[2], 30u);
+    EXPECT_EQ(r.fregs[5], 0x3fc00000u);
+    EXPECT_EQ(r.fcsr, 0x41u);
+    EXPECT_EQ(run_job(blocks).reason, StopReason::StepLimit);
+    EXPECT_FALSE(run_job(too_big).ok);
+}
+
+/***** checkpointed runs *****
+ * Stores one word per 256 bytes over four pages.
+ * Every checkpoint and every replayed slice must
+ * match a serial run to the same step.
+ ******************************/
+TEST(CpuCheckpoint, ReplayMatchesSerialRun) {
+    std::vector<uint32_t> program = {
+        encode_lui(1, 0x00001),         // lui  x1,0x1
+        0x04000113u,                    // addi x2,x0,64
+        0x0020a023u,                    // sw   x2,0(x1)
+        0x10008093u,                    // addi x1,x1,256
+        0xfff10113u,                    // addi x2,x2,-1
+        encode_branch(0x1, 2, 0, -12),  // bne  x2,x0,-12
+        0x00100073u                     // ebreak
+    };
+    auto serial_to = [&](std::size_t steps) {
+        CpuState s(0x8000);
+        reset(s);
+        load_program(s, program, 0);
+        run(s, steps);
+        return s;
+    };
+
+    CpuState s(0x8000);
+    reset(s);
+    load_program(s, program, 0);
+    CheckpointLog log = run_checkpointed(s, 1000, 16);
+
+    EXPECT_EQ(log.result.reason, StopReason::Ebreak);
+    EXPECT_EQ(log.result.steps, 2u + 64u * 4u);  // ebreak does not retire
+    ASSERT_EQ(log.checkpoints.size(), 17u);
+    EXPECT_TRUE(log.checkpoints[0].pages.empty());
+    EXPECT_EQ(log.checkpoints[1].pages.size(), 1u);  // four stores, one page
+
+    CpuState want = serial_to(1000);
+    EXPECT_EQ(s.pc, want.pc);
+    EXPECT_TRUE(s.mem == want.mem);
+
+    for (std::size_t k : {3u, 16u}) {
+        CpuState got = state_at_checkpoint(log, k);
+        CpuState ref = serial_to(log.checkpoints[k].step);
+        EXPECT_EQ(got.pc, ref.pc) << "checkpoint " << k;
+        EXPECT_EQ(std::memcmp(got.regs, ref.regs, sizeof got.regs), 0) << "checkpoint " << k;
+        EXPECT_TRUE(got.mem == ref.mem) << "checkpoint " << k;
+    }
+    EXPECT_THROW(state_at_checkpoint(log, 17), std::out_of_range);
+
+    const std::vector<ReplaySlice> slices = { {200, 30}, {5, 10}, {77, 40}, {500, 10} };
+    std::vector<CpuState> ends;
+    for (std::size_t i = 0; i < slices.size(); ++i) ends.emplace_back(16);
+    replay_slices(log, slices, [&](std::size_t i, CpuState& st, const ReplaySlice& r) {
+        run(st, r.count);
+        ends[i] = std::move(st);
+    }, 3);
+
+    for (std::size_t i = 0; i < slices.size(); ++i) {
+        CpuState ref = serial_to(slices[i].begin + slices[i].count);
+        EXPECT_EQ(ends[i].pc, ref.pc) << "slice " << i;
+        EXPECT_EQ(std::memcmp(ends[i].regs, ref.regs, sizeof ref.regs), 0) << "slice " << i;
+        EXPECT_TRUE(ends[i].mem == ref.mem) << "slice " << i;
+    }
+}
+
+/***** lockstep lanes *****
+ * Collatz on 64 inputs: every lane takes its own
+ * path through the loop. Lane 5 stores into the text
+ * and lane 7 faults; every lane must still end like
+ * run() on its own, for a full and a cut budget.
+ ******************************/
+TEST(CpuLockstep, LanesMatchSerialRuns) {
+    std::vector<uint32_t> program = {
+        encode_i(0x13, 0, 11, 0, 0),        // 0x00 addi x11,x0,0
+        encode_i(0x13, 0, 12, 0, 1),        // 0x04 addi x12,x0,1
+        encode_branch(0x0, 10, 12, 0x2c),   // 0x08 beq  x10,x12,done
+        encode_i(0x13, 7, 13, 10, 1),       // 0x0c andi x13,x10,1
+        encode_branch(0x1, 13, 0, 12),      // 0x10 bne  x13,x0,odd
+        encode_i(0x13, 5, 10, 10, 1),       // 0x14 srli x10,x10,1
+        encode_jal(0, 16),                  // 0x18 jal  x0,next
+        encode_i(0x13, 1, 14, 10, 1),       // 0x1c odd: slli x14,x10,1
+        encode_r(0x00, 0, 10, 10, 14),      // 0x20 add  x10,x10,x14
+        encode_i(0x13, 0, 10, 10, 1),       // 0x24 addi x10,x10,1
+        encode_i(0x13, 0, 11, 11, 1),       // 0x28 next: addi x11,x11,1
+        encode_s(0x2, 15, 11, 0),           // 0x2c sw   x11,0(x15)
+        encode_jal(0, -0x28),               // 0x30 jal  x0,0x08
+        encode_r(0x01, 0, 16, 11, 11),      // 0x34 done: mul x16,x11,x11
+        encode_i(0x03, 2, 17, 15, 0),       // 0x38 lw   x17,0(x15)
+        encode_fp(0x78, 0, 1, 16, 0),       // 0x3c fmv.w.x f1,x16
+        0x00100073u                         // 0x40 ebreak
+    };
+
+    CpuState image(0x2000);
+    reset(image);
+    load_program(image, program, 0);
+
+    for (std::size_t budget : {2000u, 150u}) {
+        LaneGroup g = make_lane_group(image, 64, 0, static_cast<uint32_t>(4 * program.size()));
+        for (std::size_t l = 0; l < g.lanes; ++l) {
+            g.reg(10)[l] = static_cast<uint32_t>(l + 1);
+            g.reg(15)[l] = static_cast<uint32_t>(0x1000 + 4 * l);
+        }
+        g.reg(15)[5] = 0x10;         // overwrites the bne
+        g.reg(15)[7] = 0xfffff000u;  // outside memory
+
+        std::vector<CpuState> want;
+        for (std::size_t l = 0; l < g.lanes; ++l) want.push_back(lane_state(g, l));
+
+        LockstepStats st = run_lockstep(g, budget);
+        EXPECT_LT(st.issues, st.lane_steps) << "budget " << budget;
+
+        for (std::size_t l = 0; l < g.lanes; ++l) {
+            RunResult r = run(want[l], budget);
+            CpuState got = lane_state(g, l);
+            EXPECT_EQ(g.stop[l], r.reason) << "lane " << l << " budget " << budget;
+            EXPECT_EQ(g.steps[l], r.steps) << "lane " << l << " budget " << budget;
+            EXPECT_EQ(got.pc, want[l].pc) << "lane " << l << " budget " << budget;
+            EXPECT_EQ(std::memcmp(got.regs, want[l].regs, sizeof got.regs), 0) << "lane " << l;
+            EXPECT_EQ(got.fregs[1], want[l].fregs[1]) << "lane " << l;
+            EXPECT_EQ(got.fault_addr, want[l].fault_addr) << "lane " << l;
+            EXPECT_TRUE(got.mem == want[l].mem) << "lane " << l;
+        }
+        if (budget == 2000u) {
+            EXPECT_EQ(g.stop[0], StopReason::Ebreak);
+            EXPECT_EQ(g.stop[7], StopReason::AccessFault);
+            EXPECT_EQ(g.reg(11)[26], 111u);  // 27 takes 111 steps to reach 1
+        }
+    }
+
+    EXPECT_THROW(make_lane_group(image, 4, 2, 8), std::invalid_argument);
+}
@@ -115,4 +115,81 @@ TEST(FloatF32, Mul_1eMinus38_Times_1eMinus2_Underflow) {
     EXPECT_TRUE(res.flags.underflow);
     EXPECT_FALSE(res.flags.overflow);
 }
-// AI-END
\ No newline at end of file
+// AI-END
+
+/***** Test: trace sinks *****
+ *   Null sink gives the same bits and flags
+ *   with no trace; a vector sink gets the
+ *   same lines as the traced call
+ ***************************/
+TEST(FloatF32, SinkMatchesTracedCall) {
+    Bits a = bv_from_hex_string("0x40100000"); // 2.25
+    Bits b = bv_from_hex_string("0x3fc00000"); // 1.5
+
+    auto traced = fsub_f32(a, b);
+    auto quiet  = fsub_f32(a, b, TraceSink{});
+    EXPECT_EQ(quiet.bits, traced.bits);
+    EXPECT_TRUE(quiet.trace.empty());
+
+    std::vector<std::string> lines;
+    auto mul = fmul_f32(a, b, TraceSink(lines));
+    EXPECT_TRUE(mul.trace.empty());
+    EXPECT_EQ(lines, fmul_f32(a, b).trace);
+    EXPECT_EQ(lines.front(), "fmul_f32 start");
+
+    // NaN results are the same 32-bit canonical NaN on both paths
+    Bits nan  = bv_from_hex_string("0x7fc00000");
+    Bits zero = bv_from_u32(0);
+    Bits inf  = bv_from_u32(0x7f800000u);
+    for (const auto& [x, y] : {std::pair{nan, b}, std::pair{zero, inf}}) {
+        auto mul_traced = fmul_f32(x, y);
+        auto mul_quiet  = fmul_f32(x, y, TraceSink{});
+        EXPECT_EQ(mul_quiet.bits, mul_traced.bits);
+        EXPECT_EQ(mul_traced.bits.size(), 32u);
+        EXPECT_EQ(bv_to_u32(mul_traced.bits), 0x7fc00000u);
+    }
+    auto sub_traced = fsub_f32(inf, inf);
+    auto sub_quiet  = fsub_f32(inf, inf, TraceSink{});
+    EXPECT_EQ(sub_quiet.bits, sub_traced.bits);
+    EXPECT_EQ(sub_traced.bits.size(), 32u);
+}
+
+/***** Test: word-level kernels *****
+ *   fadd/fsub/fmul_f32_u32 give the same bits
+ *   and flags as the bit-level (traced) code
+ *   on special values and random patterns
+ ***************************/
+TEST(FloatF32, WordKernelsMatchBitLevel) {
+    std::vector<uint32_t> vals = {
+        0x00000000, 0x80000000, 0x3f800000, 0xbf800000, 0x3fc00000,
+        0x40100000, 0x7f7fffff, 0xff7fffff, 0x00000001, 0x807fffff,
+        0x00800000, 0x7f800000, 0xff800000, 0x7fc00000, 0x7f800001,
+        0x3f800001, 0x3f7fffff, 0x4b000000, 0x33800000, 0x5f000000,
+    };
+    uint32_t x = 12345;
+    for (int i = 0; i < 200; ++i) {
+        x = x * 1664525u + 1013904223u;
+        vals.push_back(x);
+    }
+
+    auto same = [](const FpuResult& ref, const FpuResult32& w) {
+        return bv_to_u32(ref.bits) == w.bits &&
+               ref.flags.overflow  == w.flags.overflow &&
+               ref.flags.underflow == w.flags.underflow &&
+               ref.flags.invalid   == w.flags.invalid &&
+               ref.flags.inexact   == w.flags.inexact;
+    };
+
+    for (std::size_t i = 0; i < vals.size(); i += 3) {
+        for (std::size_t j = 0; j < vals.size(); j += 7) {
+            Bits a = bv_from_u32(vals[i]);
+            Bits b = bv_from_u32(vals[j]);
+            EXPECT_TRUE(same(fadd_f32(a, b), fadd_f32_u32(vals[i], vals[j])))
+                << std::hex << vals[i] << " + " << vals[j];
+            EXPECT_TRUE(same(fsub_f32(a, b), fsub_f32_u32(vals[i], vals[j])))
+                << std::hex << vals[i] << " - " << vals[j];
+            EXPECT_TRUE(same(fmul_f32(a, b), fmul_f32_u32(vals[i], vals[j])))
+                << std::hex << vals[i] << " * " << vals[j];
+        }
+    }
+}
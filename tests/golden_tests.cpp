@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+#include "core/golden.hpp"
+#include "core/alu.hpp"
+#include "core/mdu.hpp"
+#include "core/twos.hpp"
+
+using namespace rv::core;
+
+/***** Test: constexpr twos layer *****
+ * Checked at compile time, then against
+ * the Bits versions for the same values
+ *******************************/
+TEST(GoldenFixed, ConstexprTwosMatchesRuntime) {
+    static_assert(encode_twos_i32_fixed(-1).bits.to_u64() == 0xffffffffu);
+    static_assert(encode_twos_i32_fixed(2147483648LL).overflow);
+    static_assert(decode_twos_i32_fixed(Bits32(0x80000000u)) == -2147483648LL);
+    static_assert(sign_magnitude_fixed(Bits32(0xfffffff9u)).mag.to_u64() == 7);
+    static_assert(sign_magnitude_fixed(Bits32(0x80000000u)).mag.to_u64() == 0x80000000u);
+    static_assert(alu_execute_u32(0x80000000u, 1, AluOp::Sub).flags.V == 1);
+
+    const int64_t vals[] = {0, 1, -1, -7, 13, 2147483647LL, -2147483648LL,
+                            2147483648LL, -2147483649LL};
+    for (int64_t v : vals) {
+        EncodeI32Result ref = encode_twos_i32(v);
+        EncodeI32Fixed  fx  = encode_twos_i32_fixed(v);
+        EXPECT_EQ(fx.bits, Bits32(ref.bits)) << v;
+        EXPECT_EQ(fx.overflow, ref.overflow) << v;
+        EXPECT_EQ(fx.bits.to_hex(), ref.hex) << v;
+        EXPECT_EQ(decode_twos_i32_fixed(fx.bits), decode_twos_i32(ref.bits)) << v;
+
+        SignMag32    sm  = decode_i32_to_sign_and_magnitude(ref.bits);
+        SignMagFixed smx = sign_magnitude_fixed(fx.bits);
+        EXPECT_EQ(smx.sign, sm.sign) << v;
+        EXPECT_EQ(smx.mag, Bits32(sm.mag)) << v;
+    }
+}
+
+/***** Test: i8 x i8 golden products *****
+ * Every entry against the bit-level
+ * shift-add MDU and the word kernel
+ *******************************/
+TEST(GoldenMul, BitLevelMduMatchesTable) {
+    ASSERT_EQ(golden_mul_i8_table().size(), 65536u);
+    for (int a = -128; a < 128; ++a) {
+        for (int b = -128; b < 128; ++b) {
+            int16_t want = golden_mul_i8(static_cast<int8_t>(a), static_cast<int8_t>(b));
+            ASSERT_EQ(want, a * b);
+
+            MulResult r = mdu_mul(MulOp::Mul, encode_twos_i32(a).bits, encode_twos_i32(b).bits,
+                                  TraceSink{});
+            ASSERT_EQ(bv_to_u32(r.lo), static_cast<uint32_t>(int32_t(want))) << a << " * " << b;
+            ASSERT_FALSE(r.overflow) << a << " * " << b;
+
+            MulResult32 w = mdu_mul_u32(MulOp::Mul, static_cast<uint32_t>(a), static_cast<uint32_t>(b));
+            ASSERT_EQ(w.lo, static_cast<uint32_t>(int32_t(want))) << a << " * " << b;
+        }
+    }
+}
+
+/***** Test: ADD/SUB boundary flags *****
+ * alu_execute on bit vectors against the
+ * flags worked out from the definitions
+ *******************************/
+TEST(GoldenAlu, AddSubBoundaryFlags) {
+    ASSERT_EQ(golden_add_sub().size(), 12u * 12u * 2u);
+    for (const GoldenAluCase& c : golden_add_sub()) {
+        AluResult r = alu_execute(bv_from_u32(c.a), bv_from_u32(c.b), c.op);
+        const char* op = c.op == AluOp::Add ? " + " : " - ";
+        EXPECT_EQ(bv_to_u32(r.result), c.result) << std::hex << c.a << op << c.b;
+        EXPECT_EQ(r.flags.N, c.flags.N) << std::hex << c.a << op << c.b;
+        EXPECT_EQ(r.flags.Z, c.flags.Z) << std::hex << c.a << op << c.b;
+        EXPECT_EQ(r.flags.C, c.flags.C) << std::hex << c.a << op << c.b;
+        EXPECT_EQ(r.flags.V, c.flags.V) << std::hex << c.a << op << c.b;
+    }
+}
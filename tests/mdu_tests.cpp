@@ -100,4 +100,125 @@ TEST(MduDiv, IntMinDivMinusOneSpecialCase) {
     ASSERT_FALSE(res.trace.empty());
     EXPECT_NE(res.trace[0].find("INT_MIN / -1 special case"), std::string::npos);
 }
-// AI-END
\ No newline at end of file
+// AI-END
+
+/***** Test: trace sinks *****
+ *   Null sink: same result, no trace lines
+ *   Vector sink: same lines as the traced call
+ *******************************/
+TEST(MduTrace, SinkMatchesTracedCall) {
+    auto enc_a = encode_twos_i32(12345678);
+    auto enc_b = encode_twos_i32(-87654321);
+
+    auto traced = mdu_mul(MulOp::Mul, enc_a.bits, enc_b.bits);
+    auto quiet  = mdu_mul(MulOp::Mul, enc_a.bits, enc_b.bits, TraceSink{});
+
+    EXPECT_EQ(quiet.lo, traced.lo);
+    EXPECT_EQ(quiet.hi, traced.hi);
+    EXPECT_EQ(quiet.overflow, traced.overflow);
+    EXPECT_TRUE(quiet.trace.empty());
+
+    std::vector<std::string> lines;
+    auto sunk = mdu_mul(MulOp::Mul, enc_a.bits, enc_b.bits, TraceSink(lines));
+    EXPECT_TRUE(sunk.trace.empty());
+    EXPECT_EQ(lines, traced.trace);
+
+    auto enc_n = encode_twos_i32(-7);
+    auto enc_d = encode_twos_i32(3);
+    auto div_traced = mdu_div(DivOp::Div, enc_n.bits, enc_d.bits);
+    std::vector<std::string> div_lines;
+    auto div_sunk = mdu_div(DivOp::Div, enc_n.bits, enc_d.bits, TraceSink(div_lines));
+
+    EXPECT_EQ(div_sunk.q, div_traced.q);
+    EXPECT_EQ(div_sunk.r, div_traced.r);
+    ASSERT_EQ(div_lines.size(), 32u);
+    EXPECT_EQ(div_lines, div_traced.trace);
+    EXPECT_EQ(div_lines.back(), "step 31: R=0x1 Q=0x2");
+}
+
+/***** Test: word kernels vs bit-level MDU *****
+ *   Mul/Mulh against mdu_mul, Div against mdu_div,
+ *   plus the unsigned and mixed-sign high halves
+ *******************************/
+TEST(MduWord, MatchesBitLevel) {
+    const int32_t vals[] = {0, 1, -1, 7, -7, 3, 12345678, -87654321,
+                            2147483647, -2147483647 - 1};
+
+    for (int32_t x : vals) {
+        for (int32_t y : vals) {
+            auto ex = encode_twos_i32(x);
+            auto ey = encode_twos_i32(y);
+            uint32_t ux = static_cast<uint32_t>(x);
+            uint32_t uy = static_cast<uint32_t>(y);
+
+            MulResult   ref = mdu_mul(MulOp::Mul, ex.bits, ey.bits, TraceSink{});
+            MulResult32 w   = mdu_mul_u32(MulOp::Mulh, ux, uy);
+            EXPECT_EQ(w.lo, bv_to_u32(ref.lo)) << x << " * " << y;
+            EXPECT_EQ(w.hi, bv_to_u32(ref.hi)) << x << " * " << y;
+            EXPECT_EQ(w.overflow, ref.overflow) << x << " * " << y;
+
+            DivResult   dref = mdu_div(DivOp::Div, ex.bits, ey.bits, TraceSink{});
+            DivResult32 dw   = mdu_div_u32(DivOp::Div, ux, uy);
+            EXPECT_EQ(dw.q, bv_to_u32(dref.q)) << x << " / " << y;
+            EXPECT_EQ(dw.r, bv_to_u32(dref.r)) << x << " / " << y;
+            EXPECT_EQ(dw.overflow, dref.overflow) << x << " / " << y;
+        }
+    }
+
+    // 0xffffffff * 0xffffffff unsigned = 0xfffffffe_00000001
+    MulResult32 hu = mdu_mul_u32(MulOp::Mulhu, 0xffffffffu, 0xffffffffu);
+    EXPECT_EQ(hu.hi, 0xfffffffeu);
+    EXPECT_EQ(hu.lo, 0x00000001u);
+
+    // -1 (signed) * 0xffffffff (unsigned) = -0xffffffff
+    MulResult32 hsu = mdu_mul_u32(MulOp::Mulhsu, 0xffffffffu, 0xffffffffu);
+    EXPECT_EQ(hsu.hi, 0xffffffffu);
+    EXPECT_EQ(hsu.lo, 0x00000001u);
+
+    DivResult32 du = mdu_div_u32(DivOp::Remu, 0xfffffff9u, 3u);
+    EXPECT_EQ(du.q, 0x55555553u);
+    EXPECT_EQ(du.r, 0x0u);
+}
+
+/***** Test: packed engines vs bit-serial *****
+ *   Radix4 and Radix16 give the same bits, flags and trace
+ *   lines as the BitSerial reference, special cases included
+ *******************************/
+TEST(MduEngine, PackedEnginesMatchBitSerial) {
+    const int32_t vals[] = {0, 1, -1, 2, -2, 3, -7, 255, -65536, 12345678,
+                            -87654321, 2147483647, -2147483647 - 1};
+    const MduEngine engines[] = {MduEngine::Radix4, MduEngine::Radix16};
+
+    for (int32_t x : vals) {
+        for (int32_t y : vals) {
+            auto ex = encode_twos_i32(x);
+            auto ey = encode_twos_i32(y);
+            MulResult ref  = mdu_mul(MulOp::Mul, ex.bits, ey.bits);
+            DivResult dref = mdu_div(DivOp::Div, ex.bits, ey.bits);
+
+            for (MduEngine e : engines) {
+                std::vector<std::string> lines;
+                MulResult m = mdu_mul(MulOp::Mul, ex.bits, ey.bits, TraceSink(lines), e);
+                EXPECT_EQ(m.lo, ref.lo) << x << " * " << y;
+                EXPECT_EQ(m.hi, ref.hi) << x << " * " << y;
+                EXPECT_EQ(m.overflow, ref.overflow) << x << " * " << y;
+                EXPECT_EQ(lines, ref.trace) << x << " * " << y;
+
+                lines.clear();
+                DivResult d = mdu_div(DivOp::Div, ex.bits, ey.bits, TraceSink(lines), e);
+                EXPECT_EQ(d.q, dref.q) << x << " / " << y;
+                EXPECT_EQ(d.r, dref.r) << x << " / " << y;
+                EXPECT_EQ(d.overflow, dref.overflow) << x << " / " << y;
+                EXPECT_EQ(lines, dref.trace) << x << " / " << y;
+            }
+        }
+    }
+
+    // with a null sink the packed engines skip the trace entirely
+    auto ea = encode_twos_i32(-12345);
+    auto eb = encode_twos_i32(678);
+    DivResult quiet = mdu_div(DivOp::Div, ea.bits, eb.bits, TraceSink{}, MduEngine::Radix16);
+    EXPECT_EQ(bv_to_u32(quiet.q), static_cast<uint32_t>(-12345 / 678));
+    EXPECT_EQ(bv_to_u32(quiet.r), static_cast<uint32_t>(-12345 % 678));
+    EXPECT_TRUE(quiet.trace.empty());
+}
@@ -69,4 +69,40 @@ TEST(TwosEncodeDecode, BoundaryValues) {
         }
     }
 }
-// AI-END
\ No newline at end of file
+// AI-END
+
+TEST(TwosLean, EncodeMatchesFullResult) {
+    const int64_t values[] = {
+        0, 1, -1, 13, -13, 0x7fff, -0x8000,
+        2147483647LL, -2147483648LL, 2147483648LL, -2147483649LL, 0x123456789LL
+    };
+
+    for (int64_t v : values) {
+        EncodeI32Fixed lean = encode_twos_i32_fixed(v);
+        EncodeI32Result full = encode_twos_i32(v);
+
+        EXPECT_EQ(lean.overflow, full.overflow) << "value=" << v;
+        EXPECT_EQ(lean.word(), static_cast<uint32_t>(v)) << "value=" << v;
+        EXPECT_EQ(lean.hex(), full.hex) << "value=" << v;
+        EXPECT_EQ(Bits(lean.bits), full.bits) << "value=" << v;
+    }
+}
+
+TEST(TwosLean, BranchlessSignMagnitude) {
+    static_assert(sign_magnitude_fixed(Bits32(0xfffffff3u)).sign == 1);
+    static_assert(sign_magnitude_fixed(Bits32(0xfffffff3u)).mag.to_u64() == 13);
+    static_assert(sign_magnitude_fixed(Bits32(0x80000000u)).mag.to_u64() == 0x80000000u);
+
+    const uint32_t words[] = { 0u, 1u, 13u, 0x7fffffffu, 0x80000000u, 0x80000001u, 0xffffffffu };
+    for (uint32_t w : words) {
+        SignMagFixed lean = sign_magnitude_fixed(Bits32(w));
+        SignMag32 full = decode_i32_to_sign_and_magnitude(Bits32(w));
+
+        EXPECT_EQ(lean.sign, full.sign);
+        EXPECT_EQ(lean.mag.to_u64(), Bits32(full.mag).to_u64()) << std::hex << w;
+    }
+
+    // narrow and wide inputs to decode_i32_to_host still sign-extend / slice
+    EXPECT_EQ(decode_i32_to_host(Bits{1, 0, 1, 1}), -3);
+    EXPECT_EQ(decode_i32_to_host(Bits(40, 1)), -1);
+}
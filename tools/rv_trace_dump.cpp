@@ -0,0 +1,38 @@
+#include "core/rv32_trace.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+
+using namespace rv::cpu;
+
+/***** rv_trace_dump *****
+ *   Prints a binary CPU trace (written by TraceWriter) as text, one
+ *   line per retired instruction
+ *
+ *   usage: rv_trace_dump <trace-file> [max-records]
+ ******************************/
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 3) {
+        std::fprintf(stderr, "usage: %s <trace-file> [max-records]\n", argv[0]);
+        return 2;
+    }
+    unsigned long long limit = (argc == 3) ? std::strtoull(argv[2], nullptr, 10) : ~0ull;
+
+    try {
+        TraceReader in(argv[1]);
+        TraceRecord r;
+        unsigned long long n = 0;
+        while (n < limit && in.next(r)) {
+            std::string line = format_trace_record(r);
+            line.push_back('\n');
+            std::fwrite(line.data(), 1, line.size(), stdout);
+            ++n;
+        }
+        std::fprintf(stderr, "%llu records\n", n);
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "%s: %s\n", argv[0], e.what());
+        return 1;
+    }
+    return 0;
+}